@@ -6,12 +6,13 @@ namespace DynamicBookFramework_API
 {
 	// Define constants for the API
 	constexpr auto FrameworkPluginName = "DynamicBookFramework"; // The name of your plugin's DLL
-	constexpr auto InterfaceVersion = 1;
+	constexpr auto InterfaceVersion = 2;
 
 	// Define unique message types. Using FourCC codes is a good practice to avoid conflicts.
 	enum APIMessageType : std::uint32_t
 	{
-		kAppendEntry = 'DBFA' // 'D' 'B' 'F' 'A' for Dynamic Book Framework Append
+		kAppendEntry = 'DBFA',      // 'D' 'B' 'F' 'A' for Dynamic Book Framework Append (v1, one entry per message)
+		kRequestInterface = 'DBFI'  // 'D' 'B' 'F' 'I' for Dynamic Book Framework Interface (v2 function table)
 	};
 
 	// Define the data structure for the message.
@@ -23,4 +24,52 @@ namespace DynamicBookFramework_API
 		const char* textToAppend;   // The new entry text to add
 	};
 
+	// --- Interface version 2 ---
+	// Obtain the table once (e.g. at kPostPostLoad) and keep the pointer; it stays valid for the whole session:
+	//
+	//     DynamicBookFramework_API::RequestInterfaceMessage request{ DynamicBookFramework_API::InterfaceVersion, nullptr };
+	//     SKSE::GetMessagingInterface()->Dispatch(DynamicBookFramework_API::kRequestInterface, &request, sizeof(request),
+	//                                             DynamicBookFramework_API::FrameworkPluginName);
+	//     if (request.interfaceOut) { ... }
+	//
+	// Fields are only ever appended to the table. Check structSize before calling a function added after version 2.
+
+	// Called once per book after a batch of its entries has been handed to the framework, in the order they were queued.
+	// Runs on the thread that flushed: the game thread for automatic flushes, the caller's thread for FlushPending.
+	// After FlushPending the entries are in the session buffer; after an automatic flush they may still be in its
+	// intake queue, which every read (counts, rendering, search) drains first, so the difference is not observable.
+	// A callback must not call FlushPending, AddCommitCallback or RemoveCommitCallback; that would deadlock.
+	using EntriesCommittedCallback = void (*)(const char* bookTitleKey, std::uint32_t entryCount, void* userData);
+
+	struct DynamicBookFrameworkInterface
+	{
+		std::uint32_t interfaceVersion; // Version of this table; 2 or newer
+		std::uint32_t structSize;       // sizeof(DynamicBookFrameworkInterface) in the framework build
+
+		// Queues entries for one book and returns how many were accepted. Thread-safe and cheap: entries are
+		// committed in one batch on the next game-thread tick (or by FlushPending), not one message each.
+		std::uint32_t (*AppendEntries)(const char* bookTitleKey, const char* const* texts, std::uint32_t count);
+
+		// Entries added this session that are not yet written to disk (committed plus still queued).
+		std::uint32_t (*GetEntryCount)(const char* bookTitleKey);
+
+		// Length in bytes of the book's rendered HTML, or 0 if it is not currently rendered.
+		std::uint64_t (*GetRenderedLength)(const char* bookTitleKey);
+
+		// Commits every queued entry into the session buffer now, on the calling thread. May wait for a save or a
+		// book assembly in progress, so prefer the automatic flush on threads that must not stall.
+		void (*FlushPending)();
+
+		// Registers a completion callback for every book. Several plugins may register; each pair is called once per batch.
+		void (*AddCommitCallback)(EntriesCommittedCallback callback, void* userData);
+		// Waits for any running call of the pair to finish; once it returns, the callback is not called again.
+		void (*RemoveCommitCallback)(EntriesCommittedCallback callback, void* userData);
+	};
+
+	struct RequestInterfaceMessage
+	{
+		std::uint32_t requestedVersion;                // The version the caller was built against
+		const DynamicBookFrameworkInterface* interfaceOut; // Filled in by the framework; stays null if the version is unsupported
+	};
+
 } // namespace DynamicBookFramework_API
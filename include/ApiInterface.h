@@ -0,0 +1,19 @@
+//ApiInterface.h
+#pragma once
+#include "PCH.h"
+#include "API.h"
+
+namespace DynamicBookFramework {
+
+    // Framework side of the version 2 C API declared in API.h.
+    namespace ApiInterface {
+
+        // The function table handed out to plugins. Static for the lifetime of the DLL.
+        const DynamicBookFramework_API::DynamicBookFrameworkInterface* GetInterface();
+
+        // Answers a kRequestInterface message: fills interfaceOut when the requested version is supported.
+        void HandleRequest(DynamicBookFramework_API::RequestInterfaceMessage& a_request, const char* a_sender);
+
+    } // namespace ApiInterface
+
+} // namespace DynamicBookFramework
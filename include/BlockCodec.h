@@ -0,0 +1,64 @@
+//BlockCodec.h
+#pragma once
+// Deliberately free of PCH.h: works on the text of book files and the save history, like SaveCompactor.
+#include "SaveCompactor.h"
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // Optional compressed storage for the save blocks of older saves. A compressed block keeps its ;;SAVE_BLOCK and
+    // ;;END_SAVE_DATA;; lines, so every other pass still sees a block; its header gains LZ4="<raw size>" and its
+    // lines hold the LZ4 block of the content, in base64 lines of 76 characters so the book stays a text file.
+    // The raw content is the block's lines as the readers return them: each ending in '\n', without '\r'.
+    namespace BlockCodec {
+
+        // Blocks smaller than this stay plain: the header and base64 lines would eat most of the saving.
+        constexpr std::size_t kMinBlockSize = 1024;
+
+        // The raw size recorded in a block header, or std::nullopt if the block is stored as plain text.
+        std::optional<std::size_t> GetRawSize(std::string_view a_headerLine);
+
+        // The base64 lines for a block's raw content, each ending in '\n'.
+        std::string Encode(std::string_view a_content);
+
+        /**
+         * @brief The raw content of a compressed block. Line breaks between the base64 lines are skipped.
+         * @return std::nullopt if the lines are not valid base64 or do not decode to exactly a_rawSize bytes.
+         */
+        std::optional<std::string> Decode(std::string_view a_encoded, std::size_t a_rawSize);
+
+        // Which blocks a recode pass should compress and which it should store as plain text again.
+        // Blocks whose ID is in neither set are left as they are.
+        struct EncodingPlan {
+            std::unordered_set<std::string> compress;
+            std::unordered_set<std::string> expand;
+        };
+
+        /**
+         * @brief Splits the saves in the history into cold and recent ones.
+         * @param a_compress False plans to expand every block, so turning the setting off can undo it.
+         * @param a_plainRecentSaves The N most recently logged saves of each timeline stay plain. They are the
+         * ones a load most likely starts from, and the only ones that are still being appended to.
+         */
+        EncodingPlan PlanEncoding(const std::vector<SaveCompactor::HistoryRecord>& a_history, bool a_compress, std::size_t a_plainRecentSaves);
+
+        struct RecodeResult {
+            std::string text;             // The recoded file; only meaningful when something was compressed or expanded
+            std::size_t blocksCompressed = 0;
+            std::size_t blocksExpanded = 0;
+            std::size_t blocksCorrupt = 0; // Compressed blocks that could not be decoded; left as they are
+        };
+
+        // Compresses and expands complete blocks by the plan. Static text, unterminated blocks and blocks that
+        // would not get smaller are left exactly as they are. Lines are written with the block's own line ending.
+        RecodeResult RecodeBook(std::string_view a_text, const EncodingPlan& a_plan);
+
+    } // namespace BlockCodec
+
+} // namespace DynamicBookFramework
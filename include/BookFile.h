@@ -0,0 +1,50 @@
+//BookFile.h
+#pragma once
+// Deliberately free of PCH.h: plain file I/O on a path, so the save strategies can be exercised outside the game.
+#include <cstddef>
+#include <filesystem>
+#include <string_view>
+
+namespace DynamicBookFramework {
+
+    // Crash-safe writes of book .txt files.
+    namespace BookFile {
+
+        enum class WriteMode {
+            kFailed,
+            kUnchanged,      // Nothing differed; the file was not touched
+            kAppended,       // Only the new bytes were appended and flushed
+            kReplaced        // Whole file written to a temporary and renamed over the original
+        };
+
+        // Writes the whole file, creating or truncating it, and flushes it to the disk before returning.
+        bool WriteDurably(const std::filesystem::path& a_path, std::string_view a_content);
+
+        // Renames a file or folder and flushes the rename, so the new name is on disk when this returns.
+        // A file replaces an existing a_to; a folder does not.
+        bool MoveDurably(const std::filesystem::path& a_from, const std::filesystem::path& a_to);
+
+        /**
+         * @brief Writes a_content to a temporary file next to a_path, flushes it to the disk and renames it over
+         * a_path with a write-through move, so a crash or power loss leaves either the old or the new file, never
+         * a half-written one.
+         */
+        bool ReplaceAtomically(const std::filesystem::path& a_path, std::string_view a_content);
+
+        // Bytes at the end of the file compared against a_previous before appending to it.
+        constexpr std::size_t kAppendVerifyBytes = 4096;
+
+        /**
+         * @brief Saves a_content with the smallest write that is still safe.
+         * @param a_previous What the caller last read from or wrote to a_path. The file is left alone when a_content
+         * equals it and the file on disk still does too. When a_content only adds to a_previous and the file still
+         * ends with it, just the new bytes are appended and flushed; a crash then leaves at worst a torn tail after
+         * the intact old text. Any other edit goes through ReplaceAtomically.
+         */
+        WriteMode Save(const std::filesystem::path& a_path, std::string_view a_previous, std::string_view a_content);
+
+        const char* GetWriteModeName(WriteMode a_mode);
+
+    } // namespace BookFile
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,48 @@
+//BookMappingCache.h
+#pragma once
+#include "PCH.h"
+#include <functional>
+
+namespace DynamicBookFramework {
+
+    // Persists the result of the mapping INI scan in a small binary manifest so that an unchanged
+    // install does not have to re-parse any INI under Data/SKSE/Plugins/DynamicBookFramework at startup.
+    namespace BookMappingCache {
+
+        // One mapping INI as it was last parsed.
+        struct IniRecord {
+            std::wstring path;
+            std::uintmax_t size = 0;
+            std::int64_t writeTime = 0;
+            std::vector<std::pair<std::wstring, std::wstring>> mappings; // Book title -> full .txt path, in file order
+        };
+
+        // Parses a single mapping INI into (title, full .txt path) pairs.
+        using ParseIniFn = std::function<std::vector<std::pair<std::wstring, std::wstring>>(const std::filesystem::path& iniPath)>;
+
+        enum class ScanMode {
+            kManifest,   // Stat the INIs the manifest lists; the folder is listed only when there is no manifest
+            kListFolder, // List the folder, parsing only INIs that are new or changed
+            kReparseAll  // Ignore the manifest, list the folder and parse every INI
+        };
+
+        /**
+         * @brief Returns every mapping INI under searchPath in scan order, re-parsing only the ones that changed.
+         * An INI is reused when its path, size and timestamp match a manifest record. With kManifest an INI added
+         * under searchPath is not seen; directory timestamps cannot tell, because Mod Organizer 2's virtual file
+         * system adds and removes a mod's INIs without changing them. RefreshFromListing catches up later.
+         * @param searchPath The root folder that holds the mapping INIs.
+         * @param parseIni Called for each INI that is new or whose size/timestamp changed.
+         */
+        std::vector<IniRecord> LoadIniRecords(const std::filesystem::path& searchPath, const ParseIniFn& parseIni, ScanMode mode);
+
+        /**
+         * @brief Lists searchPath and brings the manifest up to date with it, parsing only new or changed INIs.
+         * Meant for a worker thread once startup has been served from the manifest.
+         * @return True if the INIs or their order changed, so the mappings should be loaded again.
+         */
+        bool RefreshFromListing(const std::filesystem::path& searchPath, const ParseIniFn& parseIni);
+
+    } // namespace BookMappingCache
+
+} // namespace DynamicBookFramework
@@ -1,9 +1,15 @@
 
 #pragma once
 #include "PCH.h"
+#include "BookTextCache.h"
+#include "Cancellation.h"
+#include <functional>
+#include <future>
 
 namespace DynamicBookFramework {
 
+	struct DynamicBookRecord;
+
 	class BookMenuWatcher : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
 	public:
 		static BookMenuWatcher* GetSingleton();
@@ -11,15 +17,39 @@ namespace DynamicBookFramework {
 
 		// --- Public methods for other components ---
 		bool ReloadAndCacheBook(RE::TESObjectBOOK* bookToReload);
-		std::optional<std::string> GetCachedHtmlForBook(RE::FormID bookFormID);
+		// Re-renders a book from its file's new text, which the caller has just saved, instead of reading it back.
+		bool RenderSavedBook(RE::TESObjectBOOK* book, std::string_view fileText);
+		// Shared and immutable, so the caller may hold it across a SetBookText call even if the cache evicts it.
+		std::shared_ptr<const std::string> GetCachedHtmlForBook(RE::FormID bookFormID);
+		BookTextCache& GetTextCache() { return _bookTexts; }
+
+		/**
+		 * @brief Called by the SetBookText detour: waits for a book whose preparation is still running on the worker pool.
+		 * @param bookFormID The book being displayed.
+		 * @param timeout How long the game thread may block.
+		 * @return True if the HTML is ready (or nothing was pending). False on timeout; the open book is then
+		 * refreshed automatically once preparation finishes, so the caller should show a placeholder.
+		 */
+		bool WaitForPreparedBook(RE::FormID bookFormID, std::chrono::milliseconds timeout);
+
+		// --- Prefetch support ---
+		bool IsDynamicBook(RE::FormID bookFormID) const;
+		// True if the cached HTML was built from the book's current content and file.
+		bool IsBookPrepared(RE::FormID bookFormID);
+		// Prepares a mapped book at low priority so a later open hits the cache. onFinished runs on the worker
+		// when the job ends, after any prepare the player's open started, so the cache then holds the current page.
+		// Returns false (and never calls onFinished) if the book is not mapped.
+		bool PrefetchBook(RE::FormID bookFormID, std::function<void()> onFinished);
+
+		// Token of the current BookMenu load. Cancelled when the menu closes or another book is opened,
+		// so tasks queued for the open book can tell they are stale.
+		CancellationToken GetCurrentLoadToken();
 
 		void SetLastOpenedBook(RE::FormID a_formID, const std::string& a_title);
 		RE::FormID GetLastOpenedDynamicBook();
 		std::string GetLastOpenedDynamicBookTitle();
 		void ClearLastOpenedBook();
 
-		std::map<RE::FormID, std::string> dynamicBookTexts;
-
 	private:
 		BookMenuWatcher() = default;
 		~BookMenuWatcher() override = default;
@@ -29,9 +59,53 @@ namespace DynamicBookFramework {
 		BookMenuWatcher& operator=(BookMenuWatcher&&) = delete;
         
         // --- FIX: Added missing declaration for the helper function ---
-        void PrepareAndCacheBookContent(RE::TESObjectBOOK* bookToPrepare);
+        // Skips rendering when the book is unchanged since its cached HTML was built, unless forceRender is set.
+        void PrepareAndCacheBookContent(RE::TESObjectBOOK* bookToPrepare, bool forceRender = false);
+
+        // Book open path: resolves the book on the game thread, then queues the file I/O and markup on the worker pool.
+        void RequestPrepare(RE::TESObjectBOOK* bookToPrepare);
+
+        // The Settings a rendered page depends on. Captured on the game thread when a job is queued, because the
+        // settings menu writes them there while a worker may be rendering.
+        struct RenderSettings {
+            std::string fontFace;
+            int fontSize = 0;
+        };
+        static RenderSettings CaptureRenderSettings();
+
+        // Reads, formats and caches one book. Safe to call from any thread. Stops between stages once the token is
+        // cancelled and then publishes nothing. Returns false if it was cancelled. fileText replaces the book's file.
+        bool RenderBook(const std::shared_ptr<DynamicBookRecord>& record, RE::FormID formID, bool forceRender,
+            const RenderSettings& settings, const CancellationToken& cancel = {}, std::optional<std::string_view> fileText = std::nullopt);
+
+        // Has the worker pool read ahead the images a book references, so the detour's LoadPNG finds them cached.
+        void PreloadImages(const std::string& content, const CancellationToken& cancel);
+
+        // The unchanged check RenderBook uses to skip work.
+        bool IsRenderCurrent(const DynamicBookRecord& record, RE::FormID formID, std::int64_t& fileTime);
+
+        // Worker side of RequestPrepare: publishes completion and triggers a refresh if the detour gave up waiting.
+        struct PendingPrepare;
+        void FinishPrepare(RE::FormID formID, const std::shared_ptr<PendingPrepare>& pending);
+
+        // Cancels the running BookMenu load (if any) and returns the token for a new one.
+        CancellationToken BeginLoad();
+        void CancelLoad();
         
         // --- Private Members ---
+        static constexpr std::size_t kDefaultTextCacheBudget = 64ull * 1024 * 1024;
+        BookTextCache _bookTexts{ kDefaultTextCacheBudget }; // Rendered HTML by FormID
+        struct PendingPrepare {
+            std::promise<void> done;
+            std::shared_future<void> future{ done.get_future().share() };
+            CancellationToken cancel;
+        };
+        std::mutex _pendingMutex;
+        std::unordered_map<RE::FormID, std::shared_ptr<PendingPrepare>> _pendingPrepares;
+        std::atomic<RE::FormID> _refreshWhenReady{ 0 }; // Set by the detour on timeout, consumed by FinishPrepare
+        std::mutex _loadMutex;
+        CancellationSource _currentLoad;
+
         RE::FormID _lastOpenedDynamicBookID{ 0 };
         std::string _lastOpenedDynamicBookTitle;
 	};
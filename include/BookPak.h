@@ -0,0 +1,109 @@
+//BookPak.h
+#pragma once
+// Deliberately free of PCH.h: the archive format is shared by the plugin and the dbfpak tool.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // .dbfpak: many book .txt files and their title mappings in one memory-mapped archive.
+    //
+    // Layout (little-endian):
+    //   Header  magic "DBFPAK\0\0", u32 version, u32 entry count, u64 index offset, u64 index size
+    //   Data    the stored bytes of each entry, back to back
+    //   Index   per entry: u16 title length, title (UTF-8), u16 file name length, file name (UTF-8, relative to
+    //           the books folder), u64 offset, u64 stored size, u64 raw size, u64 FNV-1a hash of the raw bytes,
+    //           u8 codec, 7 reserved bytes
+    namespace BookPak {
+
+        constexpr std::string_view kExtension = ".dbfpak";
+        constexpr std::uint32_t kVersion = 1;
+        // Largest raw size of one entry. A book is a few megabytes at most; an index record claiming more is corrupt.
+        constexpr std::uint64_t kMaxEntrySize = 256ull << 20;
+
+        enum class Codec : std::uint8_t {
+            kStored = 0,
+            kLz4 = 1
+        };
+
+        struct Entry {
+            std::string title;
+            std::string fileName;
+            std::uint64_t offset = 0;
+            std::uint64_t storedSize = 0;
+            std::uint64_t rawSize = 0;
+            std::uint64_t hash = 0;
+            Codec codec = Codec::kStored;
+        };
+
+        // 64-bit FNV-1a, the content hash recorded per entry.
+        std::uint64_t Hash(std::string_view a_data);
+
+        const char* GetCodecName(Codec a_codec);
+
+        // An open archive. The file stays mapped for the archive's lifetime and entries are read straight from it.
+        class Archive {
+        public:
+            /**
+             * @brief Maps the file and validates the header and every index record against the file size and
+             * kMaxEntrySize, so reading an entry never allocates more than its record can honestly hold.
+             * @return nullptr with a_error set if the file cannot be opened or is not a valid archive.
+             */
+            static std::unique_ptr<Archive> Open(const std::filesystem::path& a_path, std::string& a_error);
+
+            ~Archive();
+            Archive(const Archive&) = delete;
+            Archive& operator=(const Archive&) = delete;
+
+            const std::filesystem::path& GetPath() const { return _path; }
+            const std::vector<Entry>& GetEntries() const { return _entries; }
+
+            // The entry for a title, or nullptr. Titles are matched exactly, as the mapping INIs are.
+            const Entry* Find(std::string_view a_title) const;
+
+            /**
+             * @brief The entry's original bytes, decompressed if needed and checked against the recorded hash.
+             * @return std::nullopt if the entry is corrupt.
+             */
+            std::optional<std::string> Read(const Entry& a_entry) const;
+
+        private:
+            Archive() = default;
+
+            std::filesystem::path _path;
+            std::string_view _data; // The mapped file
+            std::vector<Entry> _entries;
+            std::unordered_map<std::string_view, std::size_t> _byTitle;
+        };
+
+        struct SourceEntry {
+            std::string title;
+            std::string fileName;
+            std::string content;
+        };
+
+        struct WriteStats {
+            std::size_t entries = 0;
+            std::size_t compressedEntries = 0;
+            std::uint64_t rawBytes = 0;
+            std::uint64_t storedBytes = 0;
+        };
+
+        /**
+         * @brief Writes an archive to a temporary file and renames it over a_path.
+         * @param a_compress Store entries with LZ4 where that saves at least a tenth of their size.
+         * @return std::nullopt with a_error set on failure.
+         */
+        std::optional<WriteStats> Write(const std::filesystem::path& a_path, const std::vector<SourceEntry>& a_entries,
+            bool a_compress, std::string& a_error);
+
+    } // namespace BookPak
+
+} // namespace DynamicBookFramework
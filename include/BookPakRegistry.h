@@ -0,0 +1,41 @@
+//BookPakRegistry.h
+#pragma once
+#include "PCH.h"
+#include "BookPak.h"
+
+namespace DynamicBookFramework {
+
+    // The .dbfpak archives installed at the top level of the DynamicBookFramework folder. Each packed book is mapped
+    // to the path its loose .txt would have in the books folder, and is read from the archive only while no file
+    // exists there: a loose file, or a mapping INI, always overrides the archive.
+    namespace BookPakRegistry {
+
+        struct Stats {
+            std::size_t archives = 0;
+            std::size_t books = 0;
+            std::uint64_t mappedBytes = 0;
+        };
+
+        /**
+         * @brief Maps every archive in a_searchPath, in file name order (later archives override earlier ones),
+         * and replaces the previous set.
+         * @return The packed books as (title, full .txt path) pairs, for LoadBookMappings to merge with the INI mappings.
+         */
+        std::vector<std::pair<std::wstring, std::wstring>> Load(const std::filesystem::path& a_searchPath, const std::filesystem::path& a_booksFolder);
+
+        /**
+         * @brief The packed text of a book, if the archive entry for a_title is the one mapped to a_path.
+         * @return std::nullopt if no archive holds the book there, or the entry is corrupt.
+         */
+        std::optional<std::string> Read(std::string_view a_title, const std::filesystem::path& a_path);
+
+        /**
+         * @brief Writes the packed text to a_path if no loose file exists there yet, so a save block or an editor
+         * save extends the packed book instead of replacing it. True if a_path exists afterwards.
+         */
+        bool MaterializeLooseCopy(std::string_view a_title, const std::filesystem::path& a_path);
+
+        Stats GetStats();
+    }
+
+} // namespace DynamicBookFramework
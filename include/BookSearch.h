@@ -0,0 +1,47 @@
+//BookSearch.h
+#pragma once
+#include "PCH.h"
+#include "SearchIndex.h"
+
+namespace DynamicBookFramework {
+
+    // Full-text search across every mapped book. The index is built on the worker pool from the same
+    // assembled content the books display, kept current as entries are appended, and re-synced on save.
+    namespace BookSearch {
+
+        constexpr std::size_t kMaxHits = 200;
+
+        // Re-indexes every mapped book in the background. Called after a game is loaded or started.
+        void Rebuild();
+
+        // Indexes entries as they are appended. Never blocks: the entries are queued and indexed on the worker pool.
+        void OnEntriesAppended(const std::string& fileKey, const std::vector<std::string>& entries);
+
+        // Re-indexes one book from its assembled content in the background (editor saves, external edits).
+        void Reindex(const std::string& fileKey);
+
+        // Re-indexes the books that received entries since the last save, so their save-block anchors are current.
+        void OnGameSaved();
+
+        bool IsBuilding();
+        double GetLastBuildMilliseconds();
+
+        std::vector<SearchIndex::Hit> Query(std::string_view query, std::size_t maxHits = kMaxHits);
+        SearchIndex::Stats GetStats();
+        std::uint64_t GetVersion();
+
+        /**
+         * @brief Opens the book a hit belongs to and turns to the page holding the hit's anchor. Safe to call from
+         * any thread; the menu work is queued to the game thread. If the book is already open it only jumps.
+         */
+        void OpenAtHit(const std::string& bookKey, const std::string& anchor);
+
+        // Called once a book's real text is in the menu, by the SetBookText hook or the refresh that replaces its
+        // placeholder: performs the jump OpenAtHit left for it.
+        void ApplyPendingJump(RE::GFxMovieView* movieView, RE::FormID bookFormID);
+
+        // Drops a jump left for a book whose menu closed before the jump could be applied.
+        void OnBookMenuClosed(RE::FormID bookFormID);
+    }
+
+} // namespace DynamicBookFramework
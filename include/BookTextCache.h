@@ -0,0 +1,62 @@
+//BookTextCache.h
+#pragma once
+#include "PCH.h"
+#include <list>
+
+namespace DynamicBookFramework {
+
+    // Rendered book HTML by FormID, bounded by a byte budget with least-recently-used eviction.
+    // Thread-safe: the SetBookText detour, BookUIManager and watcher tasks all read and write it.
+    class BookTextCache {
+    public:
+        struct Stats {
+            std::uint64_t hits = 0;
+            std::uint64_t misses = 0;
+            std::uint64_t evictions = 0;
+            std::size_t entries = 0;
+            std::size_t bytes = 0;
+            std::size_t byteBudget = 0;
+        };
+
+        explicit BookTextCache(std::size_t a_byteBudget) : _byteBudget(a_byteBudget) {}
+
+        // Returns the cached HTML and marks it most recently used. The string is shared and immutable,
+        // so it stays valid for the caller even if the entry is evicted or replaced meanwhile.
+        std::shared_ptr<const std::string> Get(RE::FormID a_formID);
+
+        // Presence check that does not touch the LRU order or the hit/miss counters.
+        bool Contains(RE::FormID a_formID) const;
+
+        // Size of the cached HTML in bytes (0 if absent). Like Contains, it leaves the LRU order and counters alone.
+        std::size_t GetLength(RE::FormID a_formID) const;
+
+        void Put(RE::FormID a_formID, std::string a_html);
+        void Erase(RE::FormID a_formID);
+        void Clear();
+
+        // Evicts immediately if the new budget is smaller than what is cached.
+        void SetByteBudget(std::size_t a_byteBudget);
+
+        Stats GetStats() const;
+        void ResetCounters();
+
+    private:
+        struct Entry {
+            RE::FormID formID;
+            std::shared_ptr<const std::string> html;
+        };
+
+        // Caller must hold _mutex. The most recently used entry is never evicted, so one oversized book still caches.
+        void EvictToBudget();
+
+        mutable std::mutex _mutex;
+        std::list<Entry> _lru; // Front is the most recently used
+        std::unordered_map<RE::FormID, std::list<Entry>::iterator> _index;
+        std::size_t _bytes = 0;
+        std::size_t _byteBudget;
+        std::uint64_t _hits = 0;
+        std::uint64_t _misses = 0;
+        std::uint64_t _evictions = 0;
+    };
+
+} // namespace DynamicBookFramework
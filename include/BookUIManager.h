@@ -10,7 +10,12 @@ namespace DynamicBookFramework {
         // by re-reading its associated .txt file and re-invoking the SetBookText logic.
         // Returns true if a refresh was attempted (i.e., book menu was open and it was a dynamic book).
         // Returns false if the book menu wasn't open, not a dynamic book, or an error occurred.
-        bool RefreshCurrentlyOpenBook();
+        // With reload == false the HTML already in the cache is pushed as-is (used once background preparation finishes).
+        bool RefreshCurrentlyOpenBook(bool reload = true);
+
+        // Called after the editor saves bookTitle. Refreshes the open book only if it is that book, rendering the
+        // saved text (fileText) instead of reading the file back. Returns true if it refreshed.
+        bool RefreshSavedBook(const std::string& bookTitle, std::string_view fileText);
 
     } // namespace BookUIManager
 }
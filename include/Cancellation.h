@@ -0,0 +1,33 @@
+//Cancellation.h
+#pragma once
+#include "PCH.h"
+
+namespace DynamicBookFramework {
+
+    // Read side of a cancellation flag. Long-running work polls it at stage boundaries.
+    // A default-constructed token is never cancelled.
+    class CancellationToken {
+    public:
+        CancellationToken() = default;
+
+        bool IsCancelled() const { return _flag && _flag->load(std::memory_order_acquire); }
+
+    private:
+        friend class CancellationSource;
+        explicit CancellationToken(std::shared_ptr<const std::atomic<bool>> a_flag) : _flag(std::move(a_flag)) {}
+
+        std::shared_ptr<const std::atomic<bool>> _flag;
+    };
+
+    // Owner side. Every token handed out by one source shares its flag; Cancel() is permanent for that source.
+    class CancellationSource {
+    public:
+        void Cancel() { _flag->store(true, std::memory_order_release); }
+        bool IsCancelled() const { return _flag->load(std::memory_order_acquire); }
+        CancellationToken GetToken() const { return CancellationToken(_flag); }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> _flag = std::make_shared<std::atomic<bool>>(false);
+    };
+
+} // namespace DynamicBookFramework
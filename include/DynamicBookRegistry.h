@@ -0,0 +1,78 @@
+//DynamicBookRegistry.h
+#pragma once
+#include "PCH.h"
+
+namespace DynamicBookFramework {
+
+    // Everything the hot paths need to know about one mapped book, resolved once when mappings load.
+    struct DynamicBookRecord {
+        std::string key;                // UTF-8 title. This is the fileKey used by SessionDataManager and is shared by every FormID with this title.
+        std::filesystem::path path;     // Full path of the backing .txt file.
+
+        // Cached state: contentVersion is bumped whenever the book's content may have changed
+        // (append, editor save, game load, settings change). renderedVersion records which version
+        // the cached HTML was built from, so an unchanged book can be reopened without re-rendering.
+        std::atomic<std::uint64_t> contentVersion{ 1 };
+        std::atomic<std::uint64_t> renderedVersion{ 0 };
+        std::atomic<std::int64_t> renderedFileTime{ 0 };
+
+        // Entry counts for the script and API queries, kept by SessionDataManager so they are read without its lock.
+        // savedEntryLinesStamp is the book-files stamp the saved count was taken at, 0 while it is not known; it is
+        // cleared before savedEntryLines changes and set after, so a reader that sees it unchanged read a whole count.
+        std::atomic<std::uint32_t> pendingEntries{ 0 };
+        std::atomic<std::uint32_t> pendingEntryLines{ 0 };
+        std::atomic<std::uint64_t> savedEntryLines{ 0 };
+        std::atomic<std::uint64_t> savedEntryLinesStamp{ 0 };
+        std::atomic<bool> entryCountQueued{ false };
+    };
+
+    // Transparent hash so the title indexes can be queried with a std::string_view or const char* without allocating.
+    struct TitleHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view title) const noexcept { return std::hash<std::string_view>{}(title); }
+    };
+
+    template <class T>
+    using TitleMap = std::unordered_map<std::string, T, TitleHash, std::equal_to<>>;
+
+    // Maps every TESObjectBOOK whose title has a mapping to its DynamicBookRecord, and indexes every book form by title.
+    // Built from g_dynamicBooks at kDataLoaded and rebuilt whenever the mappings are reloaded.
+    class DynamicBookRegistry {
+    public:
+        static DynamicBookRegistry* GetSingleton();
+
+        // Rebuilds all indexes from the title->path table. Must run after TESDataHandler is available.
+        void Rebuild(const std::unordered_map<std::wstring, std::wstring>& bookMappings);
+
+        // The BookMenu open path: a single integer hash lookup.
+        std::shared_ptr<DynamicBookRecord> FindByFormID(RE::FormID formID) const;
+
+        // Lookup by UTF-8 title/fileKey, used by SessionDataManager, the API and the editor.
+        std::shared_ptr<DynamicBookRecord> FindByKey(std::string_view key) const;
+
+        // Title -> book form for every TESObjectBOOK in the load order, mapped or not.
+        // When several forms share a title the first one in the form array wins, as the old linear scan did.
+        RE::TESObjectBOOK* FindBookByTitle(std::string_view title) const;
+
+        // Marks a book's content as changed so the next open re-renders it.
+        void MarkChanged(std::string_view key);
+
+        // Marks every book as changed (new save loaded, font settings changed).
+        void InvalidateAll();
+
+        // Calls a_func for every mapped book's record, under the registry lock; keep it short.
+        void ForEachRecord(const std::function<void(DynamicBookRecord&)>& a_func);
+
+    private:
+        DynamicBookRegistry() = default;
+        ~DynamicBookRegistry() = default;
+        DynamicBookRegistry(const DynamicBookRegistry&) = delete;
+        DynamicBookRegistry& operator=(const DynamicBookRegistry&) = delete;
+
+        mutable std::mutex _mutex;
+        std::unordered_map<RE::FormID, std::shared_ptr<DynamicBookRecord>> _byFormID;
+        TitleMap<std::shared_ptr<DynamicBookRecord>> _byKey;
+        TitleMap<RE::TESObjectBOOK*> _booksByTitle;
+    };
+
+} // namespace DynamicBookFramework
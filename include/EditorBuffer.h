@@ -0,0 +1,73 @@
+//EditorBuffer.h
+#pragma once
+// Deliberately free of PCH.h and ImGui: the buffer is plain text bookkeeping, so paging and splicing
+// can be exercised outside the game.
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // Text behind the Dynamic Book Editor. Books up to kPagedThreshold are edited in one piece.
+    // Larger books keep a line index and hand only one page of lines to the text widget at a time;
+    // the page is spliced back into the full text when it is committed.
+    class EditorBuffer {
+    public:
+        static constexpr std::size_t kPagedThreshold = 256 * 1024;
+        static constexpr std::size_t kPageLines = 200;
+
+        void Assign(std::string a_text);
+        void Clear();
+
+        bool IsPaged() const { return _paged; }
+        std::size_t GetSize() const;
+
+        // The text the editor widget binds to: the whole book, or the current page when paged.
+        std::string& GetEditText() { return _paged ? _page : _text; }
+
+        // Records an edit made through GetEditText: bumps the revision and flags the page for the next commit.
+        void MarkEdited() {
+            ++_revision;
+            _pageDirty = _paged;
+        }
+
+        // Changes on every Assign and every edit, so observers can tell the text moved on without comparing it.
+        std::uint64_t GetRevision() const { return _revision; }
+
+        // Writes an edited page back into the full text and rebuilds the line index. No-op when unchanged.
+        void CommitPage();
+
+        // Commits the current page, then moves the page to start at a_line (clamped to the last line).
+        void SetPageStart(std::size_t a_line);
+
+        std::size_t GetPageStart() const { return _pageStart; }
+        std::size_t GetPageEnd() const { return _pageEnd; }
+        std::size_t GetLineCount() const { return _lineStarts.size(); }
+
+        // One line of the committed text, without its line break.
+        std::string_view GetLine(std::size_t a_index) const;
+
+        // The complete text, with any pending page edits committed first.
+        const std::string& GetText();
+
+        // A copy of the complete text including an uncommitted page, leaving the page open for editing.
+        std::string CopyText() const;
+
+    private:
+        void RebuildLineIndex();
+        void LoadPage();
+        std::size_t LineOffset(std::size_t a_line) const;
+
+        std::string _text;
+        std::vector<std::size_t> _lineStarts; // Byte offset of every line in _text; only kept while paged
+        std::string _page;
+        std::size_t _pageStart = 0;
+        std::size_t _pageEnd = 0;
+        bool _paged = false;
+        bool _pageDirty = false;
+        std::uint64_t _revision = 0;
+    };
+
+} // namespace DynamicBookFramework
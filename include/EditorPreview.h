@@ -0,0 +1,73 @@
+//EditorPreview.h
+#pragma once
+#include "PCH.h"
+#include "IncrementalFormatter.h"
+
+namespace DynamicBookFramework {
+
+    class EditorBuffer;
+
+    // One displayable piece of the formatted book, reduced to what ImGui can draw.
+    struct PreviewBlock {
+        enum class Type : std::uint8_t {
+            kParagraph,
+            kListItem,
+            kImage,
+            kPagebreak
+        };
+
+        Type type = Type::kParagraph;
+        std::string text;               // Paragraph/list text with tags stripped, or the image path
+        std::string align;              // Paragraph alignment from the markup ("left", "center", ...)
+        std::uint32_t width = 0;        // Image size in book pixels
+        std::uint32_t height = 0;
+        std::size_t segment = 0;        // Key of the formatter segment the block came from (IncrementalFormatter::Result)
+    };
+
+    struct PreviewDocument {
+        std::vector<PreviewBlock> blocks;
+        std::uint64_t revision = 0;           // EditorBuffer revision this was built from
+        std::size_t segments = 0;
+        std::size_t formattedSegments = 0;
+        double milliseconds = 0.0;
+    };
+
+    // Live preview for the Dynamic Book Editor. Once typing pauses, the editor text is run through the book
+    // markup on the worker pool; only the segments that changed are formatted again.
+    class EditorPreview {
+    public:
+        static constexpr std::chrono::milliseconds kTypingPause{ 300 };
+
+        EditorPreview();
+
+        // Called once per frame with the text being edited. Cheap unless a new preview is due.
+        void Update(const EditorBuffer& a_buffer);
+
+        // The latest finished preview, or nullptr before the first one.
+        std::shared_ptr<const PreviewDocument> GetDocument() const;
+
+        // True while a preview is being built or the text changed since the last one.
+        bool IsStale(const EditorBuffer& a_buffer) const;
+
+        // Parses the HTML the book markup produces into preview blocks. With the formatter's segment keys and
+        // ends, each block is tagged with the segment its line starts in.
+        static std::vector<PreviewBlock> ParseHtml(std::string_view a_html, std::span<const std::size_t> a_segmentKeys = {},
+            std::span<const std::size_t> a_segmentEnds = {});
+
+    private:
+        // Shared with the worker job, so a preview still running when the editor goes away has somewhere to land.
+        struct State {
+            mutable std::mutex mutex;
+            std::shared_ptr<const PreviewDocument> document;
+            std::atomic<bool> running{ false };
+            IncrementalFormatter formatter; // Only touched by the one running job
+            explicit State(IncrementalFormatter::FormatFunc a_format) : formatter(std::move(a_format)) {}
+        };
+
+        std::shared_ptr<State> _state;
+        std::uint64_t _seenRevision = 0;
+        std::uint64_t _submittedRevision = 0;
+        std::chrono::steady_clock::time_point _lastChange{};
+    };
+
+} // namespace DynamicBookFramework
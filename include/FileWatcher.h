@@ -25,6 +25,11 @@ namespace DynamicBookFramework{ // Or your main plugin namespace
         // @param bookTitle The unique identifier for the book to stop watching.
         void StopMonitoringBookFile(const std::string& bookTitle);
 
+        // Records the file's current timestamp for a book the plugin itself just wrote, so the watcher
+        // does not report the change back. The writer refreshes the book on its own.
+        // @param bookTitle The unique identifier for the book that was written.
+        void NotifyFileUpdated(const std::string& bookTitle);
+
     } // namespace FileWatcher
 
 } // 
\ No newline at end of file
@@ -0,0 +1,37 @@
+//ImageHeader.h
+#pragma once
+// Deliberately free of PCH.h: plain header reads and parsing, so the probe can be tested and measured outside the game.
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace DynamicBookFramework {
+
+    // Image dimensions read straight from the file header, without decoding any pixels. The game-side lookup with
+    // its cache is in ImageInfo.h.
+    namespace ImageInfo {
+
+        struct ImageSize {
+            std::uint32_t width = 0;
+            std::uint32_t height = 0;
+        };
+
+        // Bytes needed to identify a PNG (signature + IHDR) or a DDS (magic + header up to dwWidth).
+        constexpr std::size_t kHeaderProbeBytes = 24;
+
+        /**
+         * @brief Reads width and height from the start of a PNG or DDS file.
+         * @param a_header The first bytes of the file; at least kHeaderProbeBytes for a result.
+         * @return The size, or nullopt if the format is not recognised or the header is malformed.
+         */
+        std::optional<ImageSize> ParseHeader(std::string_view a_header);
+
+        // The first kHeaderProbeBytes of a file (fewer if it is shorter), or empty if it cannot be opened.
+        std::string ReadHeader(const std::filesystem::path& a_path);
+
+    } // namespace ImageInfo
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,23 @@
+//ImageInfo.h
+#pragma once
+#include "PCH.h"
+#include "ImageHeader.h"
+
+namespace DynamicBookFramework {
+
+    // Image sizes for [IMG=] tags; the header parsing itself is in ImageHeader.h.
+    namespace ImageInfo {
+
+        // Size of the image an [IMG=] tag refers to, read from the first bytes of the file. Cached by path and
+        // modification time.
+        std::optional<ImageSize> GetImageSize(std::string_view a_imagePath);
+
+        // Case and slash-direction insensitive key, the way the game resolves asset paths.
+        std::string NormalizePath(std::string_view a_imagePath);
+
+        // Where an [IMG=] path lives as a loose file. Relative paths are relative to Data, like every other asset.
+        std::filesystem::path ResolveOnDisk(std::string_view a_imagePath);
+
+    } // namespace ImageInfo
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,77 @@
+//ImageRegistry.h
+#pragma once
+#include "PCH.h"
+#include "Cancellation.h"
+#include "DynamicBookRegistry.h"
+#include <list>
+
+namespace DynamicBookFramework {
+
+    // Textures for [IMG=] images, kept across books so reopening an illustrated book, or opening another that shares
+    // its images, copies a loaded texture into the BookMenu instead of calling LoadPNG again. Bounded by a byte budget
+    // (decoded size from the image header) with least-recently-used eviction; an evicted texture stays alive in any
+    // menu still showing it.
+    //
+    // LoadPNG takes only a path and decodes and uploads in one call, so it cannot be split. What the worker pool can
+    // do is Warm: read each referenced file once while the book is prepared, so the game-thread LoadPNG finds it in
+    // the OS file cache, and size it for the budget.
+    class ImageRegistry {
+    public:
+        struct Stats {
+            std::size_t entries = 0;
+            std::size_t bytes = 0;
+            std::size_t byteBudget = 0;
+            std::uint64_t uploads = 0;   // LoadPNG calls on the game thread
+            std::uint64_t reuses = 0;    // Textures handed out without one
+            std::uint64_t evictions = 0;
+            std::uint64_t warmed = 0;    // Files read ahead on the worker pool
+        };
+
+        static ImageRegistry* GetSingleton();
+
+        // Queues a low-priority worker job that reads the images not resident yet. Any thread.
+        void Warm(std::vector<std::string> a_imagePaths, const CancellationToken& a_cancel = {});
+
+        /**
+         * @brief Game thread only: the texture for an image, loading it with LoadPNG if it is not resident.
+         * @param a_imagePath The path from the [IMG=] tag.
+         * @param a_texture Receives a copy sharing the registry's texture, with filePath set to "img://<path>".
+         * @return False if LoadPNG failed; nothing is cached then, so the next open tries again.
+         */
+        bool Acquire(std::string_view a_imagePath, RE::BSScaleformExternalTexture& a_texture);
+
+        void SetByteBudget(std::size_t a_byteBudget);
+        void Clear();
+        Stats GetStats() const;
+
+    private:
+        ImageRegistry() = default;
+        ~ImageRegistry() = default;
+        ImageRegistry(const ImageRegistry&) = delete;
+        ImageRegistry& operator=(const ImageRegistry&) = delete;
+
+        struct Entry {
+            std::string key;
+            RE::BSScaleformExternalTexture texture;
+            std::size_t bytes = 0;
+        };
+
+        // Worker side of Warm.
+        void WarmNow(const std::vector<std::string>& a_imagePaths, const CancellationToken& a_cancel);
+
+        // Caller must hold _mutex. The most recently used entry is never evicted, so one oversized image still caches.
+        void EvictToBudget();
+
+        mutable std::mutex _mutex;
+        std::list<Entry> _lru; // Front is the most recently used
+        TitleMap<std::list<Entry>::iterator> _index;
+        TitleMap<std::int64_t> _warmed; // Key -> write time of the file when it was read ahead
+        std::size_t _bytes = 0;
+        std::size_t _byteBudget = 64ull * 1024 * 1024;
+        std::uint64_t _uploads = 0;
+        std::uint64_t _reuses = 0;
+        std::uint64_t _evictions = 0;
+        std::uint64_t _warmedCount = 0;
+    };
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,58 @@
+//IncrementalFormatter.h
+#pragma once
+// Deliberately free of PCH.h: the formatter is injected, so segmenting and reuse can be exercised outside the game.
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // Formats book text one segment at a time and keeps each segment's HTML, so re-formatting after an edit
+    // only runs the formatter on the segments whose text changed.
+    //
+    // Segments are cut where a run of blank lines starts after a text line. The markup formatter carries no
+    // state across that point (lists and paragraphs are closed, the blank-line count starts again), so the
+    // concatenated segment HTML equals formatting the whole text at once. Cut points depend on the nearby
+    // text only, which keeps the segments after an edit identical to the ones before it.
+    class IncrementalFormatter {
+    public:
+        using FormatFunc = std::function<std::string(const std::string&)>;
+
+        struct Result {
+            std::string html;
+            std::size_t segments = 0;
+            std::size_t formattedSegments = 0; // Segments the formatter actually ran on
+            std::vector<std::size_t> segmentKeys; // Hash of each segment's text; the same while a segment is unchanged
+            std::vector<std::size_t> segmentEnds; // Offset in html where each segment's HTML ends
+        };
+
+        static constexpr std::size_t kMinSegmentBytes = 1024;
+        static constexpr std::size_t kMaxSegmentBytes = 16 * 1024;
+
+        explicit IncrementalFormatter(FormatFunc a_format) : _format(std::move(a_format)) {}
+
+        // Not thread-safe: one Format call at a time.
+        Result Format(std::string_view a_text);
+
+        // Drops every cached segment.
+        void Clear() { _cache.clear(); }
+
+        static std::vector<std::string_view> Split(std::string_view a_text);
+
+    private:
+        struct Entry {
+            std::string text;
+            std::string html;
+            std::uint64_t lastUsed = 0;
+        };
+
+        FormatFunc _format;
+        std::unordered_multimap<std::size_t, Entry> _cache; // Keyed by the hash of the segment text
+        std::uint64_t _generation = 0;
+    };
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,45 @@
+//IniParser.h
+#pragma once
+#include <filesystem>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    namespace IniParser {
+
+        // Invoked once per key/value pair, in file order.
+        // @param section The current section name without brackets (empty before the first section header).
+        // @param key The trimmed key.
+        // @param value The trimmed value, with one pair of surrounding quotes removed.
+        using EntryCallback = std::function<void(std::string_view section, std::string_view key, std::string_view value)>;
+
+        // Reads a whole file with a single read and returns its content as UTF-8.
+        // Understands UTF-8 (with or without BOM) and UTF-16 LE/BE (with BOM, or LE without one). Text that is not
+        // valid UTF-8 is read in the ANSI code page, as GetPrivateProfileString reads it (Latin-1 off Windows).
+        // @return The decoded text, or std::nullopt if the file could not be opened.
+        std::optional<std::string> ReadFileAsUtf8(const std::filesystem::path& filePath);
+
+        // Walks already-decoded INI text once. Lines starting with ';' or '#' are comments.
+        void Parse(std::string_view text, const EntryCallback& callback);
+
+        /**
+         * @brief The key/value pairs of one section, as GetPrivateProfileString resolves them: section and key
+         * names are case-insensitive, and the first definition of a key wins. Keys with an empty value are skipped.
+         */
+        std::vector<std::pair<std::string, std::string>> CollectSection(std::string_view text, std::string_view section);
+
+        // Reads and parses a file in one pass. There is no limit on section or value size.
+        // @return false if the file could not be opened.
+        bool ParseFile(const std::filesystem::path& filePath, const EntryCallback& callback);
+
+        // Case-insensitive ASCII comparison, matching how Windows profile APIs treat section and key names.
+        bool EqualsIgnoreCase(std::string_view a, std::string_view b);
+
+    } // namespace IniParser
+
+} // namespace DynamicBookFramework
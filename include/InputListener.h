@@ -1,6 +1,16 @@
 #pragma once
 #include "PCH.h"
 
+// Everything a hotkey can do. Keyboard scancodes are resolved to one of these through a 256-entry table.
+enum class HotkeyAction : std::uint8_t {
+    kNone = 0,
+    kToggleEditor,
+    kFocusTextInput,
+    kSubmitTextInput,
+    kNextBookmark,
+    kPreviousBookmark
+};
+
 class InputListener : public RE::BSTEventSink<RE::InputEvent*>
 {
 public:
@@ -13,9 +23,21 @@ public:
     // This is the main callback that will be called by the game for every input event.
     RE::BSEventNotifyControl ProcessEvent(RE::InputEvent* const* a_event, RE::BSTEventSource<RE::InputEvent*>* a_eventSource) override;
 
+    // Rebuilds the scancode -> action table from the Settings hotkeys. Call whenever a hotkey changes.
+    void RebuildActionTable();
+
+    // Called by BookMenuWatcher on BookMenu open/close so the input path never has to query RE::UI.
+    void SetBookMenuOpen(bool a_open);
+
 private:
     InputListener() = default;
     ~InputListener() override = default;
     InputListener(const InputListener&) = delete;
     InputListener& operator=(const InputListener&) = delete;
+
+    static constexpr std::size_t kActionTableSize = 256;
+
+    // Written from the settings/editor path, read on every input event. Relaxed atomics keep the read a plain load.
+    std::array<std::atomic<HotkeyAction>, kActionTableSize> _actions{};
+    std::atomic<bool> _bookMenuOpen{ false };
 };
@@ -0,0 +1,54 @@
+//Log.h
+#pragma once
+#include "PCH.h"
+
+namespace DynamicBookFramework {
+
+    // Asynchronous logging with one logger per subsystem. Callers only format and enqueue into a bounded
+    // ring buffer; a background thread writes the plugin log, flushing once a second. Errors and criticals are
+    // written and flushed by the caller instead, so they survive a crash that follows them.
+    namespace Log {
+
+        enum class Subsystem : std::uint8_t {
+            kHook,      // SetBookText detour
+            kSession,   // SessionDataManager: appends, saves, loads
+            kWatcher,   // BookMenuWatcher and FileWatcher
+            kUI,        // BookUIManager, editor window, hotkeys
+            kCount
+        };
+
+        // Creates the async pipeline and the subsystem loggers. Called once from SKSEPluginLoad, before anything logs.
+        void Setup();
+
+        // Writes out everything still queued and stops the background threads; later messages are written
+        // directly. Runs when the player quits (see InstallQuitHook) and from the std::terminate handler and
+        // unhandled-exception filter Setup installs. Never called on DLL detach.
+        void Shutdown();
+
+        // Calls Shutdown on the game thread once the player confirms quitting. Called at kDataLoaded, once the UI exists.
+        void InstallQuitHook();
+
+        // Sets a subsystem's level, e.g. from the [Logging] section of Settings.ini.
+        void SetLevel(Subsystem a_subsystem, spdlog::level::level_enum a_level);
+        spdlog::level::level_enum GetLevel(Subsystem a_subsystem);
+
+        // Restores the built-in levels: hot paths (the hook) stay quiet unless asked for.
+        void ResetLevels();
+
+        // Accepts trace, debug, info, warn/warning, error, critical or off (case-insensitive).
+        std::optional<spdlog::level::level_enum> ParseLevel(std::string_view a_name);
+        std::string_view LevelToString(spdlog::level::level_enum a_level);
+
+        // The [Logging] key for a subsystem ("Hook", "Session", "Watcher", "UI").
+        std::string_view GetSettingName(Subsystem a_subsystem);
+
+        spdlog::logger& Get(Subsystem a_subsystem);
+
+        inline spdlog::logger& Hook() { return Get(Subsystem::kHook); }
+        inline spdlog::logger& Session() { return Get(Subsystem::kSession); }
+        inline spdlog::logger& Watcher() { return Get(Subsystem::kWatcher); }
+        inline spdlog::logger& UI() { return Get(Subsystem::kUI); }
+
+    } // namespace Log
+
+} // namespace DynamicBookFramework
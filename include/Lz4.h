@@ -0,0 +1,34 @@
+//Lz4.h
+#pragma once
+// Deliberately free of PCH.h: a plain byte codec, shared by the plugin and the dbfpak tool.
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace DynamicBookFramework {
+
+    // The LZ4 block format (no frame header or checksums), so data compressed here can be read by any LZ4
+    // implementation and the other way round. Built in rather than vendored: book text only needs the fast,
+    // greedy compressor and a bounds-checked decompressor.
+    namespace Lz4 {
+
+        // Upper bound of Compress's output for a_size input bytes (incompressible data grows slightly).
+        constexpr std::size_t GetMaxCompressedSize(std::size_t a_size) { return a_size + a_size / 255 + 16; }
+
+        // Upper bound of the decompressed size of a_size block bytes: a match byte expands to at most 255 bytes.
+        // A recorded raw size above this is corrupt, and is rejected before anything is allocated for it.
+        constexpr std::size_t GetMaxDecompressedSize(std::size_t a_size) { return a_size * 255 + 16; }
+
+        std::string Compress(std::string_view a_input);
+
+        /**
+         * @brief Decompresses one block. Never reads or writes out of bounds on corrupt input.
+         * @param a_rawSize The exact decompressed size, which the block format does not record itself.
+         * @return false if the block is malformed, does not decode to exactly a_rawSize bytes, or a_rawSize is more
+         * than GetMaxDecompressedSize allows or cannot be allocated.
+         */
+        bool Decompress(std::string_view a_input, std::size_t a_rawSize, std::string& a_out);
+
+    } // namespace Lz4
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,85 @@
+//MpscQueue.h
+#pragma once
+// Deliberately free of PCH.h: a plain standard-library container that can be exercised outside the game.
+#include <atomic>
+#include <optional>
+#include <utility>
+
+namespace DynamicBookFramework {
+
+    // Unbounded multi-producer, single-consumer queue (Dmitry Vyukov's intrusive design).
+    // Push is wait-free: one allocation, one atomic exchange and one store, so producers never block.
+    // TryPop must only be called by one thread at a time; callers serialise consumers themselves.
+    // A push that is still in progress on another thread can briefly hide the items queued after it;
+    // TryPop then returns nullopt and those items show up on the next drain.
+    template <class T>
+    class MpscQueue {
+    public:
+        MpscQueue() : _head(&_stub), _tail(&_stub) {}
+
+        ~MpscQueue() {
+            while (TryPop()) {
+            }
+        }
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue& operator=(const MpscQueue&) = delete;
+
+        void Push(T a_value) {
+            auto* node = new Node;
+            node->value.emplace(std::move(a_value));
+            PushNode(node);
+        }
+
+        std::optional<T> TryPop() {
+            Node* tail = _tail;
+            Node* next = tail->next.load(std::memory_order_acquire);
+            if (tail == &_stub) {
+                if (!next) {
+                    return std::nullopt;
+                }
+                _tail = next;
+                tail = next;
+                next = next->next.load(std::memory_order_acquire);
+            }
+            if (next) {
+                _tail = next;
+                return TakeValue(tail);
+            }
+            if (tail != _head.load(std::memory_order_acquire)) {
+                return std::nullopt; // A producer has swapped _head but not linked its node yet.
+            }
+            // tail is the last node: put the stub behind it so tail can be handed out.
+            PushNode(&_stub);
+            next = tail->next.load(std::memory_order_acquire);
+            if (next) {
+                _tail = next;
+                return TakeValue(tail);
+            }
+            return std::nullopt;
+        }
+
+    private:
+        struct Node {
+            std::atomic<Node*> next{ nullptr };
+            std::optional<T> value;
+        };
+
+        void PushNode(Node* a_node) {
+            a_node->next.store(nullptr, std::memory_order_relaxed);
+            Node* previous = _head.exchange(a_node, std::memory_order_acq_rel);
+            previous->next.store(a_node, std::memory_order_release);
+        }
+
+        static std::optional<T> TakeValue(Node* a_node) {
+            std::optional<T> value = std::move(a_node->value);
+            delete a_node;
+            return value;
+        }
+
+        alignas(64) std::atomic<Node*> _head; // Producers push here
+        alignas(64) Node* _tail;              // Consumer pops here
+        Node _stub;
+    };
+
+} // namespace DynamicBookFramework
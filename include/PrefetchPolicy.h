@@ -0,0 +1,73 @@
+//PrefetchPolicy.h
+#pragma once
+// Deliberately free of PCH.h and RE types: the policy only sees FormIDs and numbers, so it can be driven
+// by a fake event source outside the game.
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace DynamicBookFramework {
+
+    // Where a prefetch candidate was spotted.
+    enum class PrefetchSource : std::uint8_t {
+        kCrosshair,  // The player is looking at a book in the world
+        kInventory   // A book was added to the player's inventory
+    };
+
+    struct PrefetchConfig {
+        bool crosshair = true;
+        bool inventory = true;
+        std::size_t maxConcurrentJobs = 1;
+        // Prefetching stops once the rendered-text cache holds this much, so speculative work never
+        // pushes out pages the player actually opened.
+        std::size_t memoryBudgetBytes = 16ull * 1024 * 1024;
+        // A book that was just considered is not considered again until this much time has passed.
+        std::chrono::milliseconds retryCooldown{ 30000 };
+    };
+
+    // A job reserved by TryBegin. The generation ties it to the game session it was started in.
+    struct PrefetchJob {
+        std::uint32_t formID = 0;
+        std::uint64_t generation = 0;
+    };
+
+    // Decides which books are worth warming. Thread-safe.
+    class PrefetchPolicy {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        void SetConfig(const PrefetchConfig& a_config);
+        PrefetchConfig GetConfig() const;
+
+        /**
+         * @brief Decides whether a mapped book seen by an event source should be prepared now.
+         * @param a_formID The book form.
+         * @param a_source The event that surfaced it.
+         * @param a_alreadyPrepared True if its rendered HTML is cached and current.
+         * @param a_cachedBytes Bytes currently held by the rendered-text cache.
+         * @param a_now Current time, passed in so callers control the clock.
+         * @return The reserved job, if any. The caller must then start it and call OnJobFinished when it ends.
+         */
+        std::optional<PrefetchJob> TryBegin(std::uint32_t a_formID, PrefetchSource a_source, bool a_alreadyPrepared, std::size_t a_cachedBytes, Clock::time_point a_now);
+
+        // Ignored for a job reserved before the last Reset, so it cannot release a job of the new session.
+        void OnJobFinished(const PrefetchJob& a_job);
+
+        std::size_t GetActiveJobCount() const;
+
+        // Forgets cooldowns and active jobs (new game or save loaded). Jobs still running finish on their own.
+        void Reset();
+
+    private:
+        mutable std::mutex _mutex;
+        PrefetchConfig _config;
+        std::uint64_t _generation = 0;
+        std::unordered_set<std::uint32_t> _activeJobs;
+        std::unordered_map<std::uint32_t, Clock::time_point> _lastAttempt;
+    };
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,35 @@
+//Prefetcher.h
+#pragma once
+#include "PCH.h"
+#include "PrefetchPolicy.h"
+
+namespace DynamicBookFramework {
+
+    // Warms the rendered-text cache for mapped books the player is likely to open next: books under the
+    // crosshair and books added to the player's inventory. Work runs at low priority on the WorkerPool.
+    class Prefetcher :
+        public RE::BSTEventSink<SKSE::CrosshairRefEvent>,
+        public RE::BSTEventSink<RE::TESContainerChangedEvent> {
+    public:
+        static Prefetcher* GetSingleton();
+
+        // Registers both event sinks. Called once at kDataLoaded.
+        void Register();
+
+        PrefetchPolicy& GetPolicy() { return _policy; }
+
+        RE::BSEventNotifyControl ProcessEvent(const SKSE::CrosshairRefEvent* a_event, RE::BSTEventSource<SKSE::CrosshairRefEvent>*) override;
+        RE::BSEventNotifyControl ProcessEvent(const RE::TESContainerChangedEvent* a_event, RE::BSTEventSource<RE::TESContainerChangedEvent>*) override;
+
+    private:
+        Prefetcher() = default;
+        ~Prefetcher() override = default;
+        Prefetcher(const Prefetcher&) = delete;
+        Prefetcher& operator=(const Prefetcher&) = delete;
+
+        void Consider(const RE::TESObjectBOOK* a_book, PrefetchSource a_source);
+
+        PrefetchPolicy _policy;
+    };
+
+} // namespace DynamicBookFramework
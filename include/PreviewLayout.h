@@ -0,0 +1,58 @@
+//PreviewLayout.h
+#pragma once
+// Deliberately free of PCH.h and ImGui: heights come from the caller, so clipping can be exercised outside the game.
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // Vertical layout of the editor preview's blocks, for drawing only the ones in view. Blocks differ in height
+    // (wrapped paragraphs, images, page breaks), so each block is placed at the sum of the heights before it.
+    // A block starts with an estimate; once drawn, its measured height replaces the estimate and is kept per
+    // formatter segment, so after an edit only the blocks of re-formatted segments are estimated again.
+    class PreviewLayout {
+    public:
+        using EstimateFunc = std::function<float(std::size_t a_block)>;
+
+        /**
+         * @brief Lays out a new document, or the same one at a new width.
+         * @param a_blockSegments For each block, the key of the formatter segment it came from.
+         * @param a_width Wrap width. Heights measured at another width are dropped.
+         * @param a_estimate Height of a block that has not been drawn at this width yet.
+         */
+        void Assign(const std::vector<std::size_t>& a_blockSegments, float a_width, const EstimateFunc& a_estimate);
+
+        float GetWidth() const { return _width; }
+        std::size_t GetBlockCount() const { return _heights.size(); }
+
+        // Top of a block; GetOffset(GetBlockCount()) is the height of the whole document.
+        float GetOffset(std::size_t a_block) const;
+        float GetTotalHeight() const { return GetOffset(_heights.size()); }
+
+        // First and one-past-last block overlapping [a_top, a_bottom).
+        std::pair<std::size_t, std::size_t> GetVisibleRange(float a_top, float a_bottom) const;
+
+        // Records the height a block took when drawn; the blocks after it move.
+        void SetMeasuredHeight(std::size_t a_block, float a_height);
+
+    private:
+        // Where a block's measured height is kept: its segment's list, at its index within the segment.
+        struct Slot {
+            std::size_t segment = 0;
+            std::size_t index = 0;
+        };
+
+        void UpdateOffsets() const;
+
+        float _width = -1.0f;
+        std::vector<float> _heights;
+        std::vector<Slot> _slots;
+        std::unordered_map<std::size_t, std::vector<float>> _measured; // Per segment key; 0 = not measured yet
+        mutable std::vector<float> _offsets;                           // Prefix sums of _heights
+        mutable bool _offsetsDirty = true;
+    };
+
+} // namespace DynamicBookFramework
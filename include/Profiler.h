@@ -0,0 +1,89 @@
+//Profiler.h
+#pragma once
+#include "PCH.h"
+#include <array>
+#include <atomic>
+
+namespace DynamicBookFramework {
+
+    // Lightweight stage timers for the book-open, refresh and save paths. Each stage aggregates into a
+    // fixed log-linear histogram of atomic counters, so recording never locks or allocates.
+    namespace Profiler {
+
+        enum class Stage : std::uint8_t {
+            kPrepareTotal,
+            kPrepareContent,
+            kPrepareBookmarks,
+            kPrepareMarkup,
+            kPrepareFontWrap,
+
+            kContentTotal,
+            kContentParse,
+            kContentHistory,
+            kContentAssemble,
+
+            kProcessChunk,
+
+            kSaveTotal,
+            kSaveHistoryLog,
+            kSaveBlocks,
+
+            kRefreshTotal,
+            kRefreshReload,
+            kRefreshSetBookText,
+
+            kCount
+        };
+
+        struct StageStats {
+            std::uint64_t count = 0;
+            std::uint64_t totalNs = 0;
+            std::uint64_t p50Ns = 0;
+            std::uint64_t p95Ns = 0;
+            std::uint64_t p99Ns = 0;
+            std::uint64_t maxNs = 0;
+        };
+
+        void Record(Stage a_stage, std::uint64_t a_nanoseconds) noexcept;
+
+        // Percentiles are read from the histogram and are accurate to one bucket (within ~25%).
+        StageStats GetStats(Stage a_stage);
+
+        void Reset();
+
+        const char* GetStageName(Stage a_stage);
+
+        // Records the time from construction (or the last Next()) to destruction, Next() or Stop().
+        class ScopedTimer {
+        public:
+            explicit ScopedTimer(Stage a_stage) noexcept : _stage(a_stage), _start(std::chrono::steady_clock::now()) {}
+            ~ScopedTimer() { Stop(); }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+            // Ends the current stage and starts timing the next one, for functions that run in sequential phases.
+            void Next(Stage a_stage) noexcept {
+                Stop();
+                _stage = a_stage;
+                _start = std::chrono::steady_clock::now();
+                _running = true;
+            }
+
+            void Stop() noexcept {
+                if (_running) {
+                    _running = false;
+                    auto elapsed = std::chrono::steady_clock::now() - _start;
+                    Record(_stage, static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+                }
+            }
+
+        private:
+            Stage _stage;
+            std::chrono::steady_clock::time_point _start;
+            bool _running = true;
+        };
+
+    } // namespace Profiler
+
+} // namespace DynamicBookFramework
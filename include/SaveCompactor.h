@@ -0,0 +1,64 @@
+//SaveCompactor.h
+#pragma once
+// Deliberately free of PCH.h: works on the text of book files and the save history, so the reachability
+// rules can be exercised outside the game.
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // Finds the ;;SAVE_BLOCK sections and _SaveHistory.log records no save can display any more, and removes them.
+    // A block is shown only when its save ID is on the parent chain of the save being played, so a block is kept
+    // when its ID is an ancestor (or itself) of a save that still exists, or falls under the retention policy.
+    namespace SaveCompactor {
+
+        struct RetentionPolicy {
+            // Every block and record of the N most recent timelines is kept whether or not a save still reaches it,
+            // so reverting to a save deleted moments ago in the current playthrough loses nothing. 0 keeps none extra.
+            std::size_t keepRecentTimelines = 1;
+            // False keeps every block and record, for a pass that only changes how the blocks are stored.
+            bool removeUnreachable = true;
+            // Store the blocks of all but the N most recent saves of each timeline LZ4-compressed (see BlockCodec).
+            // False stores every block as plain text again.
+            bool compressColdBlocks = false;
+            std::size_t plainRecentSaves = 10;
+        };
+
+        struct HistoryRecord {
+            std::string id;
+            std::string timeline;
+            std::string parent;
+        };
+
+        struct BookResult {
+            std::string text;             // The compacted file; only meaningful when blocksRemoved > 0
+            std::size_t blocksKept = 0;
+            std::size_t blocksRemoved = 0;
+        };
+
+        // Parses one ;;SAVE_BLOCK or history line's KEY="value" pair. Empty if the key is missing.
+        std::string_view ParseValue(std::string_view a_line, std::string_view a_key);
+
+        std::vector<HistoryRecord> ParseHistory(std::string_view a_historyText);
+
+        /**
+         * @brief The save IDs whose blocks must be kept.
+         * @param a_roots Saves that can still be loaded (files in the saves folder) plus the save being played.
+         * IDs are compared without the .ess extension.
+         */
+        std::unordered_set<std::string> FindLiveSaves(const std::vector<HistoryRecord>& a_history,
+            const std::vector<std::string>& a_roots, const RetentionPolicy& a_policy);
+
+        // Drops every complete save block whose ID is not live, with the blank line written before it.
+        // Static text and unterminated blocks are left exactly as they are.
+        BookResult CompactBook(std::string_view a_text, const std::unordered_set<std::string>& a_live);
+
+        // Drops history lines whose ID is not live. Lines that are not records are kept. Returns the count removed.
+        std::size_t CompactHistory(std::string_view a_historyText, const std::unordered_set<std::string>& a_live, std::string& a_out);
+
+    } // namespace SaveCompactor
+
+} // namespace DynamicBookFramework
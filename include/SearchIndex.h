@@ -0,0 +1,137 @@
+//SearchIndex.h
+#pragma once
+// Deliberately free of PCH.h: the index only sees book keys and text, so it can be built and measured outside the game.
+#include <atomic>
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // Inverted index over the assembled text of every dynamic book: token -> (book, byte offset).
+    // Tokens are lower-cased runs of letters and digits (bytes >= 0x80 count as letters, so UTF-8 words stay whole);
+    // markup between < and > is skipped. Thread-safe; every call takes one short lock.
+    class SearchIndex {
+    public:
+        struct Hit {
+            std::string bookKey;
+            std::uint32_t offset = 0;   // Byte offset of the match in the indexed text
+            std::string snippet;        // The match with some surrounding text, on one line
+            std::string anchor;         // Nearest anchor before the match for GotoPageByAnchor, or empty for the first page
+        };
+
+        struct Stats {
+            std::size_t books = 0;
+            std::size_t tokens = 0;     // Distinct tokens
+            std::size_t postings = 0;
+            std::size_t textBytes = 0;
+            std::size_t memoryBytes = 0; // Estimate of the heap the index holds
+        };
+
+        static constexpr std::size_t kMinTokenLength = 2;
+        static constexpr std::size_t kMaxTagLength = 256;
+
+        // Indexes a book's text, replacing whatever was indexed for it before.
+        void ReplaceBook(const std::string& a_bookKey, std::string a_text);
+
+        // Indexes text added to the end of a book. Only the new text is tokenised.
+        void AppendToBook(const std::string& a_bookKey, std::string_view a_text);
+
+        void RemoveBook(std::string_view a_bookKey);
+        void Clear();
+
+        /**
+         * @brief Finds the places where every word of a_query occurs in one book. The last word also matches as a
+         * prefix, so results show up while the word is still being typed.
+         * @return Up to a_maxHits hits, in book order and then text order.
+         */
+        std::vector<Hit> Query(std::string_view a_query, std::size_t a_maxHits) const;
+
+        Stats GetStats() const;
+
+        // Bumped by every change to the index, so callers can cache query results until it moves.
+        std::uint64_t GetVersion() const { return _version.load(); }
+
+        // The tokeniser, exposed for the query side and for tests: calls a_onToken(token, offset) for each token.
+        template <class F>
+        static void Tokenize(std::string_view a_text, std::size_t a_baseOffset, F&& a_onToken);
+
+    private:
+        struct Posting {
+            std::uint32_t book;
+            std::uint32_t offset;
+        };
+
+        struct Anchor {
+            std::uint32_t offset;
+            std::string name;
+        };
+
+        // Transparent, so tokens are looked up as string_views without allocating.
+        struct TokenHash {
+            using is_transparent = void;
+            std::size_t operator()(std::string_view a_token) const noexcept { return std::hash<std::string_view>{}(a_token); }
+        };
+
+        struct Book {
+            std::string key;
+            std::string text;
+            std::vector<Anchor> anchors;       // Sorted by offset
+            std::vector<std::uint32_t> tokens; // Distinct token ids occurring in the book, for removal
+            bool live = false;
+        };
+
+        void IndexText(std::uint32_t a_book, std::size_t a_from);
+        void RemoveBookLocked(std::uint32_t a_book);
+        std::uint32_t GetOrAddBook(const std::string& a_bookKey);
+        std::string MakeSnippet(const Book& a_book, std::uint32_t a_offset, std::size_t a_length) const;
+        std::string FindAnchor(const Book& a_book, std::uint32_t a_offset) const;
+
+        mutable std::mutex _mutex;
+        std::atomic<std::uint64_t> _version{ 0 };
+        std::vector<Book> _books;
+        std::unordered_map<std::string, std::uint32_t> _bookIds;
+        std::vector<std::uint32_t> _freeBooks;
+        std::unordered_map<std::string, std::uint32_t, TokenHash, std::equal_to<>> _tokenIds;
+        std::vector<std::vector<Posting>> _postings; // By token id, in indexing order
+    };
+
+    template <class F>
+    void SearchIndex::Tokenize(std::string_view a_text, std::size_t a_baseOffset, F&& a_onToken) {
+        auto isWordByte = [](unsigned char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+        };
+        std::string token;
+        std::size_t pos = 0;
+        while (pos < a_text.size()) {
+            auto c = static_cast<unsigned char>(a_text[pos]);
+            if (c == '<' && pos + 1 < a_text.size() && (std::isalpha(static_cast<unsigned char>(a_text[pos + 1])) || a_text[pos + 1] == '/')) {
+                // Only a '<' that opens a short tag is markup; "a < b" in prose is text.
+                std::size_t tagEnd = a_text.find('>', pos);
+                if (tagEnd != std::string_view::npos && tagEnd - pos <= kMaxTagLength) {
+                    pos = tagEnd + 1;
+                    continue;
+                }
+            }
+            if (!isWordByte(c)) {
+                ++pos;
+                continue;
+            }
+            std::size_t start = pos;
+            token.clear();
+            while (pos < a_text.size() && isWordByte(static_cast<unsigned char>(a_text[pos]))) {
+                char ch = a_text[pos++];
+                token.push_back(ch >= 'A' && ch <= 'Z' ? static_cast<char>(ch - 'A' + 'a') : ch);
+            }
+            if (token.size() >= kMinTokenLength) {
+                a_onToken(std::string_view(token), a_baseOffset + start);
+            }
+        }
+    }
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,65 @@
+//SegmentStore.h
+#pragma once
+// Deliberately free of PCH.h: plain file I/O on a book path, so the layout and migrations can be exercised outside the game.
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace DynamicBookFramework {
+
+    // Optional per-timeline storage for a book's save blocks. A segmented book keeps its .txt file as the static
+    // template and stores the blocks of each timeline in <name>.segments/<timeline>.txt, so assembling one
+    // character's journal only opens the segments on that character's history chain.
+    // A book is segmented exactly when its segment directory exists.
+    namespace SegmentStore {
+
+        // Where the journal goes in a segmented template. Without it the journal follows the template.
+        constexpr std::string_view kJournalMarker = ";;JOURNAL;;";
+
+        // A save on the history chain being assembled, in chain order (oldest first).
+        struct ChainLink {
+            std::string id;
+            std::string timeline; // Empty if the history has no record of it
+        };
+
+        struct MigrationResult {
+            bool ok = false;
+            std::size_t blocks = 0;
+            std::size_t segments = 0;
+            std::string error;
+        };
+
+        std::filesystem::path GetDirectory(const std::filesystem::path& a_bookPath);
+        bool IsSegmented(const std::filesystem::path& a_bookPath);
+        std::filesystem::path GetSegmentPath(const std::filesystem::path& a_bookPath, std::string_view a_timeline);
+
+        // Every segment file of a book.
+        std::vector<std::filesystem::path> ListSegments(const std::filesystem::path& a_bookPath);
+
+        /**
+         * @brief Assembles a segmented book the way SessionDataManager assembles a single file: template text, and
+         * at the journal marker each chain save's block behind an <a name='ID'> anchor, oldest first.
+         * @param a_entryLineCount If set, receives the number of block lines included.
+         */
+        std::string Assemble(const std::filesystem::path& a_bookPath, const std::vector<ChainLink>& a_chain, std::size_t* a_entryLineCount);
+
+        // Appends one complete block (;;SAVE_BLOCK line through ;;END_SAVE_DATA;;) to the timeline's segment.
+        bool AppendBlock(const std::filesystem::path& a_bookPath, std::string_view a_timeline, std::string_view a_blockText);
+
+        // Moves a single-file book's blocks into segments by their TIMELINE and leaves the static text as the template.
+        MigrationResult Split(const std::filesystem::path& a_bookPath);
+
+        /**
+         * @brief Folds the segments back into the book's .txt file and removes the segment directory.
+         * @param a_historyOrder Positions of each save ID's records in the history log. The n-th block of an ID is
+         * placed by its n-th record, which is where OnGameSave would have appended it; unknown blocks go last.
+         */
+        MigrationResult Merge(const std::filesystem::path& a_bookPath,
+            const std::unordered_map<std::string, std::vector<std::size_t>>& a_historyOrder);
+
+    } // namespace SegmentStore
+
+} // namespace DynamicBookFramework
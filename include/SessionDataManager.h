@@ -1,12 +1,48 @@
 //SessionDataManager.h
 #pragma once
 #include "PCH.h"
+#include "MpscQueue.h"
+#include "SaveCompactor.h"
+#include "SegmentStore.h"
 
 
 namespace DynamicBookFramework {
 
+    // What a save data compaction found, and removed (or compressed) unless it was a dry run.
+    struct CompactionReport {
+        bool dryRun = false;
+        bool compressionOnly = false;       // Nothing was removed; only how blocks are stored changed
+        std::string skippedReason;          // Set when the pass refused to run; nothing was touched
+        std::size_t savesFound = 0;
+        std::size_t liveSaves = 0;
+        std::size_t booksScanned = 0;
+        std::size_t booksRewritten = 0;     // Books with unreachable or recoded blocks (rewritten unless dryRun)
+        std::size_t booksChangedMeanwhile = 0; // Left alone because they changed while the pass ran
+        std::size_t blocksKept = 0;
+        std::size_t blocksRemoved = 0;
+        std::size_t blocksCompressed = 0;
+        std::size_t blocksExpanded = 0;     // Stored as plain text again
+        std::size_t historyRecordsRemoved = 0;
+        std::uintmax_t bytesBefore = 0;
+        std::uintmax_t bytesAfter = 0;
+        double milliseconds = 0.0;
+    };
+
+    // What converting the mapped books between single files and per-timeline segments did.
+    struct StorageMigrationReport {
+        bool toSegments = false;
+        std::size_t booksConverted = 0;
+        std::size_t booksAlready = 0;       // Already stored the requested way
+        std::size_t booksFailed = 0;
+        std::size_t blocksMoved = 0;
+        std::size_t segments = 0;
+        std::string firstError;
+        double milliseconds = 0.0;
+    };
+
     //Manages text data that is buffered per session and committed to disk only on game save.
-    //This implementation uses metadata blocks within single files to manage save-specific content.
+    //This implementation uses metadata blocks within single files to manage save-specific content,
+    //or per-timeline segment files for books converted with MigrateStorage.
     class SessionDataManager {
     public:
         static SessionDataManager* GetSingleton();
@@ -29,6 +65,26 @@ namespace DynamicBookFramework {
          */
         void AppendEntry(const std::string& fileKey, const std::string& entryText);
 
+        /**
+         * @brief Adds several entries for one file key. Never blocks: the entries go into a lock-free queue, and the
+         * consumer that drains it resolves the book, bumps its content version and indexes the entries for search.
+         * @return The number of entries added.
+         */
+        std::size_t AppendEntries(const std::string& fileKey, std::vector<std::string> entries);
+
+        // Moves queued appends into the session buffer, so content versions and the search index see them. Takes
+        // _dataMutex only when something was appended since the last drain. Called before anything that checks a
+        // book's content version.
+        void CommitQueuedEntries();
+
+        // As above, but never waits: if another thread holds _dataMutex, the entries stay queued until it or the
+        // next reader drains them. For callers that must not block (Papyrus tasklets, search queries).
+        void TryCommitQueuedEntries();
+
+        // Number of entries buffered for this mapped book in the current session (not yet written by a save).
+        // Lock-free apart from the title lookup; see TryCommitQueuedEntries for entries still in the queue.
+        std::size_t GetPendingEntryCount(const std::string& fileKey);
+
         /**
          * @brief Gets the full content for a given file for the CURRENT save.
          * It combines what's on disk (from the correct metadata block) with what's pending in the session buffer.
@@ -38,6 +94,18 @@ namespace DynamicBookFramework {
          */
         std::string GetFullContent(const std::string& fileKey);
 
+        // As above, with fileText standing in for the book's file: used to show text the editor has just saved
+        // without reading it back. A segmented book is still read from its segments.
+        std::string GetFullContent(const std::string& fileKey, std::string_view fileText);
+
+        /**
+         * @brief Number of entry lines the player can currently see in this book: lines in the current timeline's
+         * save blocks plus the lines of every pending entry. Never takes _dataMutex or reads the book: the saved
+         * count is recorded whenever the book is assembled and carried forward by saves, and checked against the
+         * book's file stamps. When it is not known, a count is queued on the worker pool and nullopt is returned.
+         */
+        std::optional<std::size_t> GetEntryCount(const std::string& fileKey);
+
         std::string GetCurrentSaveIdentifier();
         void OnGameLoad();
 
@@ -56,6 +124,31 @@ namespace DynamicBookFramework {
         int _getSaveNumberFromIdentifier(const std::string& identifier) const;
 
         std::string ExtractTimelineID(const std::string& saveName);
+
+        /**
+         * @brief Removes the save blocks and history records that no save in the saves folder can reach any more.
+         * Reads and compacts off the lock; each rewrite is checked against the file and written atomically under
+         * _dataMutex. Refuses to run when the saves folder or the history log looks empty. Blocks that survive are
+         * compressed or expanded as policy.compressColdBlocks says. Blocking; see ScheduleCompaction.
+         */
+        CompactionReport CompactSaveData(const SaveCompactor::RetentionPolicy& policy, bool dryRun);
+
+        // Runs CompactSaveData on the worker pool. Ignored while a compaction or migration is running.
+        void ScheduleCompaction(const SaveCompactor::RetentionPolicy& policy, bool dryRun);
+        std::optional<CompactionReport> GetLastCompactionReport();
+
+        /**
+         * @brief Converts every mapped book to per-timeline segments, or folds segmented books back into single files.
+         * Each book is converted under _dataMutex, so no save can append to it halfway. Blocking; see ScheduleStorageMigration.
+         */
+        StorageMigrationReport MigrateStorage(bool toSegments);
+
+        // Runs MigrateStorage on the worker pool. Ignored while a compaction or migration is running.
+        void ScheduleStorageMigration(bool toSegments);
+        std::optional<StorageMigrationReport> GetLastStorageMigrationReport();
+
+        // True while a compaction or storage migration is running on the worker pool.
+        bool IsMaintenanceRunning() const { return _maintenanceRunning.load(); }
         
     private:
         SessionDataManager() = default;
@@ -69,6 +162,45 @@ namespace DynamicBookFramework {
         std::map<std::string, std::vector<std::string>> _sessionPendingEntries;
         std::mutex _dataMutex; // Protects access to the _sessionPendingEntries map
 
+        // Appends from Papyrus, the API and mod events land here first, so producers never wait on a reader holding
+        // _dataMutex. Whoever holds _dataMutex is the single consumer.
+        struct IncomingEntries {
+            std::string fileKey;
+            std::vector<std::string> entries;
+        };
+        MpscQueue<IncomingEntries> _incomingEntries;
+        std::atomic<std::uint64_t> _appendSequence{ 0 };  // Bumped by producers after each push
+        std::atomic<std::uint64_t> _drainedSequence{ 0 }; // _appendSequence as of the last drain
+
+        // Moves everything queued so far into _sessionPendingEntries, bumping each book's content version and
+        // passing the entries to BookSearch. Caller must hold _dataMutex.
+        void DrainIncomingEntries();
+
+        // The last history record of each save ID, parsed once and re-read only when the log changes.
+        struct HistoryEntry {
+            std::string parent;
+            std::string timeline;
+        };
+        struct HistoryCache {
+            bool exists = false;
+            std::uintmax_t size = 0;
+            std::filesystem::file_time_type writeTime{};
+            std::unordered_map<std::string, HistoryEntry> entries;
+        };
+        HistoryCache _historyCache;
+
+        // Refreshes _historyCache if the log changed on disk. Caller must hold _dataMutex.
+        const HistoryCache& GetHistory();
+
+        // The current save and its ancestors, oldest first, with the timeline each was saved in. Caller must hold _dataMutex.
+        std::vector<SegmentStore::ChainLink> BuildHistoryChain();
+
+        // Shared body of both GetFullContent overloads. Records the visible saved entry lines on the book's record.
+        // fileText, when set, is used instead of reading the book's file.
+        std::string AssembleContent(const std::string& fileKey, std::optional<std::string_view> fileText = std::nullopt);
+
+        std::atomic<bool> _saveLoaded{ false }; // Set by OnGameLoad; entry counts mean nothing before it
+
         std::string _currentSaveIdentifier; // e.g., "MyNordWarriorSave01"
 
         std::string g_currentSaveName;
@@ -79,6 +211,11 @@ namespace DynamicBookFramework {
         
         std::filesystem::path g_historyLogPath = "Data/SKSE/Plugins/DynamicBookFramework/_SaveHistory.log";
 
+        std::atomic<bool> _maintenanceRunning{ false };
+        std::mutex _reportMutex;
+        std::optional<CompactionReport> _lastCompactionReport;
+        std::optional<StorageMigrationReport> _lastStorageMigrationReport;
+
     };
 
 } // namespace DynamicBookFramework
\ No newline at end of file
@@ -15,7 +15,21 @@ namespace Settings {
     extern int bookmarkPageHotkey; // Default: C key
     extern int nextBookmarkHotkey;
     extern int previousBookmarkHotkey;
+    extern int focusTextInputHotkey;  // Default: X key
+    extern int submitTextInputHotkey; // Default: Enter
     extern bool isWaitingForHotkey;
+    extern int renderedTextCacheMB; // Byte budget for cached book HTML, in megabytes
+    extern int imageCacheMB;        // Byte budget for [IMG=] textures kept across books, in megabytes
+    extern int prepareTimeoutMs;    // How long SetBookText waits for a background-prepared book before showing a placeholder
+    extern int workerThreadCount;   // Background threads used to prepare books (read once at startup)
+    extern bool prefetchOnCrosshair;  // Warm books the player looks at
+    extern bool prefetchOnInventory;  // Warm books added to the player's inventory
+    extern int prefetchMaxJobs;
+    extern int prefetchBudgetMB;      // Prefetching pauses once the rendered-text cache holds this much
+    extern bool compactSaveDataOnLoad; // Remove unreachable save blocks in the background after the first load
+    extern int keepRecentTimelines;    // Timelines kept whole by save data compaction
+    extern bool compressColdBlocks;    // Store the save blocks of older saves LZ4-compressed
+    extern int plainRecentSaves;       // Saves per timeline whose blocks stay plain text
 
     extern std::map<std::string, std::vector<std::string>> g_bookmarks;
 
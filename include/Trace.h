@@ -0,0 +1,42 @@
+//Trace.h
+#pragma once
+#include "PCH.h"
+
+namespace DynamicBookFramework {
+
+    // Bounded in-memory record of plugin activity (book opens, refreshes, saves, appends, watcher ticks,
+    // main-thread tasks) that can be dumped as Chrome trace JSON for chrome://tracing or ui.perfetto.dev.
+    // Once the buffer is full the oldest events are overwritten.
+    namespace Trace {
+
+        // Records a begin ("B") or end ("E") event on the calling thread. name and category must be string literals.
+        void Begin(const char* a_name, const char* a_category, std::string_view a_detail = {});
+        void End(const char* a_name, const char* a_category);
+
+        /**
+         * @brief Writes the buffered events to DynamicBookFramework_Trace_<timestamp>.json next to the plugin log.
+         * @return The path of the written file, or std::nullopt if it could not be written.
+         */
+        std::optional<std::filesystem::path> DumpToLogFolder();
+
+        void Clear();
+
+        // Begin on construction, end on destruction.
+        class ScopedEvent {
+        public:
+            ScopedEvent(const char* a_name, const char* a_category, std::string_view a_detail = {}) : _name(a_name), _category(a_category) {
+                Begin(_name, _category, a_detail);
+            }
+            ~ScopedEvent() { End(_name, _category); }
+
+            ScopedEvent(const ScopedEvent&) = delete;
+            ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+        private:
+            const char* _name;
+            const char* _category;
+        };
+
+    } // namespace Trace
+
+} // namespace DynamicBookFramework
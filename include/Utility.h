@@ -1,6 +1,7 @@
 
 #pragma once
 #include "PCH.h"
+#include "BookMappingCache.h"
 
 
 namespace logger = SKSE::log;
@@ -18,7 +19,11 @@ namespace HtmlFormatText { // Or your preferred namespace if you have one for ut
 }
 
 void SetupLog();
-void LoadBookMappings();
+// Rebuilds g_dynamicBooks. Startup is served from the manifest; explicit user reloads reparse every INI.
+void LoadBookMappings(DynamicBookFramework::BookMappingCache::ScanMode scanMode = DynamicBookFramework::BookMappingCache::ScanMode::kManifest);
+// Lists the mapping folder on the worker pool and reloads the mappings on the game thread if its INIs changed.
+// Catches what a manifest-served load cannot see, such as a mod enabled in Mod Organizer 2 since the last run.
+void VerifyBookMappingListing();
 std::optional<std::wstring> GetDynamicBookPathByTitle(const std::wstring& bookTitle);
 std::wstring string_to_wstring(const std::string& str);
 std::string wstring_to_utf8(const std::wstring& wstr);
@@ -0,0 +1,50 @@
+//WorkerPool.h
+#pragma once
+#include "PCH.h"
+#include <array>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+namespace DynamicBookFramework {
+
+    // A small fixed pool of background threads for book preparation and other file work that must stay off
+    // the game thread. Tasks run in priority order, FIFO within a priority.
+    class WorkerPool {
+    public:
+        enum class Priority : std::uint8_t {
+            kHigh,      // The player is waiting on it (book open)
+            kNormal,
+            kLow,       // Speculative work that may never be used
+            kCount
+        };
+
+        static WorkerPool* GetSingleton();
+
+        // Starts the threads. Called once at kDataLoaded, after settings are loaded.
+        void Start(std::size_t a_threadCount);
+
+        // Finishes the running tasks, drops the queued ones and joins the threads.
+        void Stop();
+
+        // Queues a task. Before Start() (or after Stop()) the task runs inline on the calling thread.
+        void Submit(std::function<void()> a_task, Priority a_priority = Priority::kNormal);
+
+        std::size_t GetQueuedCount() const;
+
+    private:
+        WorkerPool() = default;
+        ~WorkerPool() { Stop(); }
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        void WorkerLoop();
+
+        mutable std::mutex _mutex;
+        std::condition_variable _wake;
+        std::array<std::deque<std::function<void()>>, static_cast<std::size_t>(Priority::kCount)> _queues;
+        std::vector<std::thread> _threads;
+        bool _running = false;
+    };
+
+} // namespace DynamicBookFramework
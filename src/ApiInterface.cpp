@@ -0,0 +1,164 @@
+//ApiInterface.cpp
+#include "ApiInterface.h"
+#include "SessionDataManager.h"
+#include "BookMenuWatcher.h"
+#include "DynamicBookRegistry.h"
+#include "Log.h"
+#include "Trace.h"
+#include "Utility.h"
+#include "PCH.h"
+#include <shared_mutex>
+
+
+namespace DynamicBookFramework {
+    namespace ApiInterface {
+
+        namespace { // Anonymous namespace for the staging queue and the exported functions
+
+            using Callback = DynamicBookFramework_API::EntriesCommittedCallback;
+
+            // Entries queued by AppendEntries, committed to SessionDataManager in one batch per book.
+            std::mutex g_stagingMutex;
+            TitleMap<std::vector<std::string>> g_stagedEntries;
+            std::atomic<bool> g_flushScheduled{ false };
+            // Held for a whole flush, so two batches of one book reach the session in the order they were staged.
+            std::mutex g_flushMutex;
+
+            // Shared while callbacks run, so RemoveCommitCallback returns only once its callback is no longer running.
+            std::shared_mutex g_callbackMutex;
+            std::vector<std::pair<Callback, void*>> g_callbacks;
+
+            // a_commit also moves the batch from SessionDataManager's queue into its session buffer, waiting for
+            // _dataMutex if need be. The automatic game-thread flush leaves that to the next reader instead.
+            void Flush(bool a_commit) {
+                std::lock_guard<std::mutex> flushLock(g_flushMutex);
+                TitleMap<std::vector<std::string>> batch;
+                {
+                    std::lock_guard<std::mutex> lock(g_stagingMutex);
+                    batch.swap(g_stagedEntries);
+                    g_flushScheduled.store(false);
+                }
+                if (batch.empty()) {
+                    return;
+                }
+                Trace::ScopedEvent traceEvent("ApiFlush", "session");
+
+                auto* sessionManager = SessionDataManager::GetSingleton();
+                std::vector<std::pair<std::string, std::uint32_t>> handedOff;
+                handedOff.reserve(batch.size());
+                for (auto& [key, entries] : batch) {
+                    handedOff.emplace_back(key, static_cast<std::uint32_t>(sessionManager->AppendEntries(key, std::move(entries))));
+                }
+                if (a_commit) {
+                    sessionManager->CommitQueuedEntries();
+                }
+
+                std::shared_lock<std::shared_mutex> lock(g_callbackMutex);
+                for (const auto& [key, count] : handedOff) {
+                    for (const auto& [callback, userData] : g_callbacks) {
+                        callback(key.c_str(), count, userData);
+                    }
+                }
+            }
+
+            std::uint32_t AppendEntries(const char* bookTitleKey, const char* const* texts, std::uint32_t count) {
+                if (!bookTitleKey || !texts || count == 0) {
+                    return 0;
+                }
+                std::vector<std::string> entries;
+                entries.reserve(count);
+                for (std::uint32_t i = 0; i < count; ++i) {
+                    if (texts[i]) {
+                        entries.emplace_back(texts[i]);
+                    }
+                }
+                if (entries.empty()) {
+                    return 0;
+                }
+                auto accepted = static_cast<std::uint32_t>(entries.size());
+                {
+                    std::lock_guard<std::mutex> lock(g_stagingMutex);
+                    auto& staged = g_stagedEntries[bookTitleKey];
+                    staged.insert(staged.end(), std::make_move_iterator(entries.begin()), std::make_move_iterator(entries.end()));
+                }
+
+                // One game-thread task per burst, however many calls land before it runs.
+                if (!g_flushScheduled.exchange(true)) {
+                    if (auto* taskInterface = SKSE::GetTaskInterface()) {
+                        taskInterface->AddTask([]() { Flush(false); });
+                    } else {
+                        Flush(false);
+                    }
+                }
+                return accepted;
+            }
+
+            std::uint32_t GetEntryCount(const char* bookTitleKey) {
+                if (!bookTitleKey) {
+                    return 0;
+                }
+                std::size_t staged = 0;
+                {
+                    std::lock_guard<std::mutex> lock(g_stagingMutex);
+                    if (auto it = g_stagedEntries.find(std::string_view(bookTitleKey)); it != g_stagedEntries.end()) {
+                        staged = it->second.size();
+                    }
+                }
+                return static_cast<std::uint32_t>(staged + SessionDataManager::GetSingleton()->GetPendingEntryCount(bookTitleKey));
+            }
+
+            std::uint64_t GetRenderedLength(const char* bookTitleKey) {
+                if (!bookTitleKey) {
+                    return 0;
+                }
+                auto* book = DynamicBookRegistry::GetSingleton()->FindBookByTitle(bookTitleKey);
+                return book ? BookMenuWatcher::GetSingleton()->GetTextCache().GetLength(book->GetFormID()) : 0;
+            }
+
+            void FlushPending() {
+                Flush(true);
+            }
+
+            void AddCommitCallback(Callback callback, void* userData) {
+                if (!callback) {
+                    return;
+                }
+                std::unique_lock<std::shared_mutex> lock(g_callbackMutex);
+                g_callbacks.emplace_back(callback, userData);
+            }
+
+            void RemoveCommitCallback(Callback callback, void* userData) {
+                std::unique_lock<std::shared_mutex> lock(g_callbackMutex);
+                std::erase(g_callbacks, std::make_pair(callback, userData));
+            }
+
+            const DynamicBookFramework_API::DynamicBookFrameworkInterface g_interface{
+                DynamicBookFramework_API::InterfaceVersion,
+                sizeof(DynamicBookFramework_API::DynamicBookFrameworkInterface),
+                &AppendEntries,
+                &GetEntryCount,
+                &GetRenderedLength,
+                &FlushPending,
+                &AddCommitCallback,
+                &RemoveCommitCallback
+            };
+        }
+
+        const DynamicBookFramework_API::DynamicBookFrameworkInterface* GetInterface() {
+            return &g_interface;
+        }
+
+        void HandleRequest(DynamicBookFramework_API::RequestInterfaceMessage& a_request, const char* a_sender) {
+            // Version 1 was messages only, so any request is for version 2 or later; newer requests get the newest table we have.
+            if (a_request.requestedVersion < 2) {
+                logger::warn("API: '{}' requested interface version {}, which has no function table.", a_sender ? a_sender : "?", a_request.requestedVersion);
+                a_request.interfaceOut = nullptr;
+                return;
+            }
+            a_request.interfaceOut = GetInterface();
+            logger::info("API: Handed interface version {} to '{}' (requested {}).", DynamicBookFramework_API::InterfaceVersion,
+                a_sender ? a_sender : "?", a_request.requestedVersion);
+        }
+
+    } // namespace ApiInterface
+} // namespace DynamicBookFramework
@@ -0,0 +1,262 @@
+//BlockCodec.cpp
+#include "BlockCodec.h"
+#include "Lz4.h"
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <unordered_map>
+
+
+namespace DynamicBookFramework {
+    namespace BlockCodec {
+
+        namespace { // Anonymous namespace for line handling and base64
+
+            constexpr std::string_view kBlockStart = ";;SAVE_BLOCK ";
+            constexpr std::string_view kBlockEnd = ";;END_SAVE_DATA;;";
+            constexpr std::string_view kHeaderEnd = ";;";
+            constexpr std::string_view kSizeKey = "LZ4";
+            constexpr std::size_t kLineLength = 76;
+            constexpr std::string_view kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+            std::string_view NextLine(std::string_view a_text, std::size_t& a_pos) {
+                std::size_t end = a_text.find('\n', a_pos);
+                end = end == std::string_view::npos ? a_text.size() : end + 1;
+                std::string_view line = a_text.substr(a_pos, end - a_pos);
+                a_pos = end;
+                return line;
+            }
+
+            std::string_view TrimEnd(std::string_view a_line) {
+                while (!a_line.empty() && (a_line.back() == '\n' || a_line.back() == '\r')) {
+                    a_line.remove_suffix(1);
+                }
+                return a_line;
+            }
+
+            std::string_view StripExtension(std::string_view a_id) {
+                if (a_id.size() > 4 && a_id.substr(a_id.size() - 4) == ".ess") {
+                    a_id.remove_suffix(4);
+                }
+                return a_id;
+            }
+
+            // 0-63 for alphabet characters, 64 for padding and 255 for anything else.
+            constexpr std::array<unsigned char, 256> MakeDecodeTable() {
+                std::array<unsigned char, 256> table{};
+                for (auto& value : table) {
+                    value = 255;
+                }
+                for (std::size_t i = 0; i < kAlphabet.size(); ++i) {
+                    table[static_cast<unsigned char>(kAlphabet[i])] = static_cast<unsigned char>(i);
+                }
+                table['='] = 64;
+                return table;
+            }
+            constexpr auto kDecodeTable = MakeDecodeTable();
+
+            // The header with LZ4="<size>" added before its closing ;; or removed, and a_lineEnd appended.
+            std::string WithRawSize(std::string_view a_header, std::optional<std::size_t> a_rawSize, std::string_view a_lineEnd) {
+                std::string header(TrimEnd(a_header));
+                if (a_rawSize) {
+                    header.insert(header.size() - kHeaderEnd.size(), " " + std::string(kSizeKey) + "=\"" + std::to_string(*a_rawSize) + "\"");
+                } else {
+                    std::size_t start = header.find(" " + std::string(kSizeKey) + "=\"");
+                    std::size_t end = start == std::string::npos ? std::string::npos : header.find('"', start + kSizeKey.size() + 3);
+                    if (end != std::string::npos) {
+                        header.erase(start, end + 1 - start);
+                    }
+                }
+                header += a_lineEnd;
+                return header;
+            }
+        }
+
+        std::optional<std::size_t> GetRawSize(std::string_view a_headerLine) {
+            std::string_view value = SaveCompactor::ParseValue(a_headerLine, kSizeKey);
+            std::size_t size = 0;
+            auto [end, error] = std::from_chars(value.data(), value.data() + value.size(), size);
+            if (value.empty() || error != std::errc() || end != value.data() + value.size()) {
+                return std::nullopt;
+            }
+            return size;
+        }
+
+        std::string Encode(std::string_view a_content) {
+            std::string packed = Lz4::Compress(a_content);
+            std::string encoded;
+            std::size_t encodedSize = (packed.size() + 2) / 3 * 4;
+            encoded.reserve(encodedSize + encodedSize / kLineLength + 1);
+            std::size_t lineLength = 0;
+            auto put = [&](char a_c) {
+                encoded.push_back(a_c);
+                if (++lineLength == kLineLength) {
+                    encoded.push_back('\n');
+                    lineLength = 0;
+                }
+            };
+            for (std::size_t i = 0; i < packed.size(); i += 3) {
+                std::uint32_t group = static_cast<std::uint32_t>(static_cast<unsigned char>(packed[i])) << 16;
+                std::size_t available = packed.size() - i;
+                if (available > 1) {
+                    group |= static_cast<std::uint32_t>(static_cast<unsigned char>(packed[i + 1])) << 8;
+                }
+                if (available > 2) {
+                    group |= static_cast<unsigned char>(packed[i + 2]);
+                }
+                put(kAlphabet[(group >> 18) & 63]);
+                put(kAlphabet[(group >> 12) & 63]);
+                put(available > 1 ? kAlphabet[(group >> 6) & 63] : '=');
+                put(available > 2 ? kAlphabet[group & 63] : '=');
+            }
+            if (lineLength > 0) {
+                encoded.push_back('\n');
+            }
+            return encoded;
+        }
+
+        std::optional<std::string> Decode(std::string_view a_encoded, std::size_t a_rawSize) {
+            std::string packed(a_encoded.size() / 4 * 3 + 3, '\0');
+            char* out = packed.data();
+            std::uint32_t group = 0;
+            std::size_t count = 0;   // Characters in the current group
+            std::size_t padding = 0;
+            for (char c : a_encoded) {
+                unsigned char value = kDecodeTable[static_cast<unsigned char>(c)];
+                if (value < 64 && padding == 0) {
+                    group = (group << 6) | value;
+                } else if (c == '\n' || c == '\r') {
+                    continue;
+                } else if (value == 64 && count >= 2) {
+                    ++padding;
+                    group <<= 6;
+                } else {
+                    return std::nullopt; // Not base64, or data after the padding
+                }
+                if (++count == 4) {
+                    out[0] = static_cast<char>(group >> 16);
+                    out[1] = static_cast<char>((group >> 8) & 0xFF);
+                    out[2] = static_cast<char>(group & 0xFF);
+                    out += 3 - padding;
+                    group = 0;
+                    count = 0;
+                }
+            }
+            packed.resize(static_cast<std::size_t>(out - packed.data()));
+            if (count != 0) {
+                return std::nullopt;
+            }
+            // Decompress rejects a size no block this long can expand to before allocating it.
+            std::string content;
+            if (!Lz4::Decompress(packed, a_rawSize, content)) {
+                return std::nullopt;
+            }
+            return content;
+        }
+
+        EncodingPlan PlanEncoding(const std::vector<SaveCompactor::HistoryRecord>& a_history, bool a_compress, std::size_t a_plainRecentSaves) {
+            EncodingPlan plan;
+            // A save ID is logged again every time it is overwritten; its last record places it.
+            std::unordered_set<std::string_view> seen;
+            std::unordered_map<std::string_view, std::size_t> recentPerTimeline;
+            for (auto it = a_history.rbegin(); it != a_history.rend(); ++it) {
+                if (!seen.insert(it->id).second) {
+                    continue;
+                }
+                std::size_t& recent = recentPerTimeline[it->timeline];
+                if (!a_compress || recent < a_plainRecentSaves) {
+                    plan.expand.insert(it->id);
+                } else {
+                    plan.compress.insert(it->id);
+                }
+                ++recent;
+            }
+            return plan;
+        }
+
+        RecodeResult RecodeBook(std::string_view a_text, const EncodingPlan& a_plan) {
+            RecodeResult result;
+            result.text.reserve(a_text.size());
+            std::size_t pos = 0;
+            while (pos < a_text.size()) {
+                std::size_t lineStart = pos;
+                std::string_view line = NextLine(a_text, pos);
+                if (!line.starts_with(kBlockStart)) {
+                    result.text.append(line);
+                    continue;
+                }
+
+                // Find the end marker; a block cut off by a crash is left alone.
+                std::size_t bodyStart = pos;
+                std::size_t bodyEnd = std::string_view::npos;
+                std::size_t scan = pos;
+                while (scan < a_text.size()) {
+                    std::size_t innerStart = scan;
+                    std::string_view inner = NextLine(a_text, scan);
+                    if (inner.starts_with(kBlockEnd)) {
+                        bodyEnd = innerStart;
+                        break;
+                    }
+                    if (inner.starts_with(kBlockStart)) {
+                        break;
+                    }
+                }
+                if (bodyEnd == std::string_view::npos || !TrimEnd(line).ends_with(kHeaderEnd)) {
+                    result.text.append(line);
+                    continue;
+                }
+                std::string_view body = a_text.substr(bodyStart, bodyEnd - bodyStart);
+                std::string_view blockEnd = a_text.substr(bodyEnd, scan - bodyEnd);
+                std::string_view lineEnd = line.ends_with("\r\n") ? "\r\n" : "\n";
+                std::string id(StripExtension(SaveCompactor::ParseValue(line, "ID")));
+                auto rawSize = GetRawSize(line);
+
+                std::string recoded;
+                if (!rawSize && a_plan.compress.contains(id)) {
+                    std::string content;
+                    content.reserve(body.size());
+                    for (std::size_t bodyPos = 0; bodyPos < body.size();) {
+                        content.append(TrimEnd(NextLine(body, bodyPos)));
+                        content.push_back('\n');
+                    }
+                    if (content.size() >= kMinBlockSize) {
+                        std::string encoded = Encode(content);
+                        std::string encodedBody;
+                        for (std::size_t encodedPos = 0; encodedPos < encoded.size();) {
+                            encodedBody.append(TrimEnd(NextLine(encoded, encodedPos)));
+                            encodedBody.append(lineEnd);
+                        }
+                        // Worth it only if the encoded lines save at least a tenth of what they replace.
+                        if (encodedBody.size() < body.size() - body.size() / 10) {
+                            recoded = WithRawSize(line, content.size(), lineEnd) + encodedBody;
+                            ++result.blocksCompressed;
+                        }
+                    }
+                } else if (rawSize && a_plan.expand.contains(id)) {
+                    if (auto content = Decode(body, *rawSize)) {
+                        recoded = WithRawSize(line, std::nullopt, lineEnd);
+                        for (std::size_t contentPos = 0; contentPos < content->size();) {
+                            recoded.append(TrimEnd(NextLine(*content, contentPos)));
+                            recoded.append(lineEnd);
+                        }
+                        ++result.blocksExpanded;
+                    } else {
+                        ++result.blocksCorrupt;
+                    }
+                }
+
+                if (recoded.empty()) {
+                    result.text.append(a_text.substr(lineStart, scan - lineStart));
+                } else {
+                    result.text.append(recoded);
+                    result.text.append(blockEnd);
+                }
+                pos = scan;
+            }
+            return result;
+        }
+
+    } // namespace BlockCodec
+
+} // namespace DynamicBookFramework
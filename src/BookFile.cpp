@@ -0,0 +1,155 @@
+//BookFile.cpp
+#include "BookFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace DynamicBookFramework {
+    namespace BookFile {
+
+        namespace { // Anonymous namespace for the durable file writes
+
+            // True if the file on disk is as long as a_expected and holds its bytes from a_from to the end.
+            bool DiskMatches(const std::filesystem::path& a_path, std::string_view a_expected, std::size_t a_from = 0) {
+                std::error_code ec;
+                auto size = std::filesystem::file_size(a_path, ec);
+                if (ec || size != a_expected.size()) {
+                    return false;
+                }
+                std::ifstream file(a_path, std::ios::binary);
+                if (!file.is_open()) {
+                    return false;
+                }
+                std::string onDisk(a_expected.size() - a_from, '\0');
+                file.seekg(static_cast<std::streamoff>(a_from));
+                file.read(onDisk.data(), static_cast<std::streamsize>(onDisk.size()));
+                return file.gcount() == static_cast<std::streamsize>(onDisk.size()) && onDisk == a_expected.substr(a_from);
+            }
+
+#ifdef _WIN32
+            // Writes a_content to an open handle and flushes it out of the OS cache, then closes the handle.
+            bool WriteAndClose(HANDLE a_file, std::string_view a_content) {
+                bool ok = true;
+                for (std::size_t offset = 0; ok && offset < a_content.size();) {
+                    DWORD chunk = static_cast<DWORD>(std::min<std::size_t>(a_content.size() - offset, 1u << 30));
+                    DWORD written = 0;
+                    ok = WriteFile(a_file, a_content.data() + offset, chunk, &written, nullptr) && written == chunk;
+                    offset += written;
+                }
+                ok = ok && FlushFileBuffers(a_file);
+                return CloseHandle(a_file) && ok;
+            }
+
+            // Adds a_bytes at the end of an existing file and flushes them before returning.
+            bool AppendDurably(const std::filesystem::path& a_path, std::string_view a_bytes) {
+                HANDLE file = CreateFileW(a_path.c_str(), FILE_APPEND_DATA, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                return file != INVALID_HANDLE_VALUE && WriteAndClose(file, a_bytes);
+            }
+
+            // The rename itself is flushed too, so the new name is on disk when this returns. Folders cannot replace.
+            bool MoveOver(const std::filesystem::path& a_from, const std::filesystem::path& a_to) {
+                std::error_code ec;
+                DWORD flags = MOVEFILE_WRITE_THROUGH | (std::filesystem::is_directory(a_from, ec) ? 0 : MOVEFILE_REPLACE_EXISTING);
+                return MoveFileExW(a_from.c_str(), a_to.c_str(), flags);
+            }
+#else
+            bool WriteAndClose(int a_file, std::string_view a_content) {
+                bool ok = true;
+                for (std::size_t offset = 0; ok && offset < a_content.size();) {
+                    auto written = write(a_file, a_content.data() + offset, a_content.size() - offset);
+                    ok = written > 0;
+                    offset += ok ? static_cast<std::size_t>(written) : 0;
+                }
+                ok = ok && fsync(a_file) == 0;
+                return close(a_file) == 0 && ok;
+            }
+
+            bool AppendDurably(const std::filesystem::path& a_path, std::string_view a_bytes) {
+                int file = open(a_path.c_str(), O_WRONLY | O_APPEND);
+                return file >= 0 && WriteAndClose(file, a_bytes);
+            }
+
+            bool MoveOver(const std::filesystem::path& a_from, const std::filesystem::path& a_to) {
+                if (std::rename(a_from.c_str(), a_to.c_str()) != 0) {
+                    return false;
+                }
+                int folder = open(a_to.parent_path().empty() ? "." : a_to.parent_path().c_str(), O_RDONLY);
+                if (folder >= 0) {
+                    fsync(folder);
+                    close(folder);
+                }
+                return true;
+            }
+#endif
+        }
+
+#ifdef _WIN32
+        bool WriteDurably(const std::filesystem::path& a_path, std::string_view a_content) {
+            HANDLE file = CreateFileW(a_path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            return file != INVALID_HANDLE_VALUE && WriteAndClose(file, a_content);
+        }
+#else
+        bool WriteDurably(const std::filesystem::path& a_path, std::string_view a_content) {
+            int file = open(a_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            return file >= 0 && WriteAndClose(file, a_content);
+        }
+#endif
+
+        bool MoveDurably(const std::filesystem::path& a_from, const std::filesystem::path& a_to) {
+            return MoveOver(a_from, a_to);
+        }
+
+        bool ReplaceAtomically(const std::filesystem::path& a_path, std::string_view a_content) {
+            auto tempPath = a_path;
+            tempPath += L".tmp";
+            std::error_code ec;
+            if (!WriteDurably(tempPath, a_content) || !MoveOver(tempPath, a_path)) {
+                std::filesystem::remove(tempPath, ec);
+                return false;
+            }
+            return true;
+        }
+
+        WriteMode Save(const std::filesystem::path& a_path, std::string_view a_previous, std::string_view a_content) {
+            if (a_content == a_previous && DiskMatches(a_path, a_previous)) {
+                return WriteMode::kUnchanged;
+            }
+
+            // A pure append leaves every existing byte where it is, so only the new ones need to reach the disk.
+            // The file must still be what the caller last saw; its length and last bytes are checked for that.
+            bool pureAppend = !a_previous.empty() && a_content.size() > a_previous.size() && a_content.starts_with(a_previous);
+            if (pureAppend && DiskMatches(a_path, a_previous, a_previous.size() - std::min(a_previous.size(), kAppendVerifyBytes))) {
+                if (AppendDurably(a_path, a_content.substr(a_previous.size()))) {
+                    return WriteMode::kAppended;
+                }
+                // Part of the new text may have landed; the full replace below writes the file as it should be.
+            }
+            return ReplaceAtomically(a_path, a_content) ? WriteMode::kReplaced : WriteMode::kFailed;
+        }
+
+        const char* GetWriteModeName(WriteMode a_mode) {
+            switch (a_mode) {
+            case WriteMode::kUnchanged:
+                return "unchanged";
+            case WriteMode::kAppended:
+                return "appended";
+            case WriteMode::kReplaced:
+                return "replaced";
+            default:
+                return "failed";
+            }
+        }
+
+    } // namespace BookFile
+} // namespace DynamicBookFramework
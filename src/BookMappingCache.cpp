@@ -0,0 +1,246 @@
+//BookMappingCache.cpp
+#include "BookMappingCache.h"
+#include "Utility.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+    namespace BookMappingCache {
+
+        namespace { // Anonymous namespace for the manifest format
+
+            constexpr std::uint32_t kManifestMagic = 'DBFM';
+            constexpr std::uint32_t kManifestVersion = 2; // 1 also recorded directory timestamps
+            constexpr auto kManifestFileName = L"DynamicBookFramework_MappingCache.bin";
+
+            struct Manifest {
+                std::vector<IniRecord> inis;
+            };
+
+            std::int64_t GetWriteTime(const std::filesystem::path& path, std::error_code& ec) {
+                auto time = std::filesystem::last_write_time(path, ec);
+                return ec ? 0 : static_cast<std::int64_t>(time.time_since_epoch().count());
+            }
+
+            // --- Writing ---
+            void WriteU32(std::string& out, std::uint32_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+            void WriteU64(std::string& out, std::uint64_t value) { out.append(reinterpret_cast<const char*>(&value), sizeof(value)); }
+            void WriteString(std::string& out, const std::wstring& value) {
+                WriteU32(out, static_cast<std::uint32_t>(value.size()));
+                out.append(reinterpret_cast<const char*>(value.data()), value.size() * sizeof(wchar_t));
+            }
+
+            // --- Reading (bounds-checked; any overrun marks the whole manifest invalid) ---
+            struct Reader {
+                std::string_view data;
+                size_t pos = 0;
+                bool ok = true;
+
+                template <class T>
+                T Read() {
+                    T value{};
+                    if (!ok || pos + sizeof(T) > data.size()) {
+                        ok = false;
+                        return value;
+                    }
+                    std::memcpy(&value, data.data() + pos, sizeof(T));
+                    pos += sizeof(T);
+                    return value;
+                }
+
+                std::wstring ReadString() {
+                    auto length = Read<std::uint32_t>();
+                    size_t bytes = static_cast<size_t>(length) * sizeof(wchar_t);
+                    if (!ok || pos + bytes > data.size()) {
+                        ok = false;
+                        return {};
+                    }
+                    std::wstring value(length, L'\0');
+                    std::memcpy(value.data(), data.data() + pos, bytes);
+                    pos += bytes;
+                    return value;
+                }
+            };
+
+            std::optional<Manifest> ReadManifest(const std::filesystem::path& manifestPath) {
+                std::ifstream file(manifestPath, std::ios::binary | std::ios::ate);
+                if (!file.is_open()) {
+                    return std::nullopt;
+                }
+                auto size = file.tellg();
+                if (size <= 0) {
+                    return std::nullopt;
+                }
+                std::string buffer(static_cast<size_t>(size), '\0');
+                file.seekg(0);
+                file.read(buffer.data(), buffer.size());
+
+                Reader reader{ buffer };
+                if (reader.Read<std::uint32_t>() != kManifestMagic || reader.Read<std::uint32_t>() != kManifestVersion) {
+                    return std::nullopt;
+                }
+
+                Manifest manifest;
+                auto iniCount = reader.Read<std::uint32_t>();
+                for (std::uint32_t i = 0; reader.ok && i < iniCount; ++i) {
+                    IniRecord ini;
+                    ini.path = reader.ReadString();
+                    ini.size = reader.Read<std::uint64_t>();
+                    ini.writeTime = reader.Read<std::int64_t>();
+                    auto mappingCount = reader.Read<std::uint32_t>();
+                    for (std::uint32_t m = 0; reader.ok && m < mappingCount; ++m) {
+                        std::wstring title = reader.ReadString();
+                        std::wstring txtPath = reader.ReadString();
+                        ini.mappings.emplace_back(std::move(title), std::move(txtPath));
+                    }
+                    manifest.inis.push_back(std::move(ini));
+                }
+
+                if (!reader.ok) {
+                    logger::warn("BookMappingCache: Manifest '{}' is truncated or corrupt. Ignoring it.", wstring_to_utf8(manifestPath.wstring()));
+                    return std::nullopt;
+                }
+                return manifest;
+            }
+
+            void WriteManifest(const std::filesystem::path& manifestPath, const Manifest& manifest) {
+                std::string out;
+                WriteU32(out, kManifestMagic);
+                WriteU32(out, kManifestVersion);
+                WriteU32(out, static_cast<std::uint32_t>(manifest.inis.size()));
+                for (const auto& ini : manifest.inis) {
+                    WriteString(out, ini.path);
+                    WriteU64(out, ini.size);
+                    WriteU64(out, static_cast<std::uint64_t>(ini.writeTime));
+                    WriteU32(out, static_cast<std::uint32_t>(ini.mappings.size()));
+                    for (const auto& [title, txtPath] : ini.mappings) {
+                        WriteString(out, title);
+                        WriteString(out, txtPath);
+                    }
+                }
+
+                // Write to a temporary file first so a crash never leaves a half-written manifest behind.
+                auto tempPath = manifestPath;
+                tempPath += L".tmp";
+                {
+                    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                    if (!file.is_open()) {
+                        logger::warn("BookMappingCache: Could not write manifest to '{}'.", wstring_to_utf8(tempPath.wstring()));
+                        return;
+                    }
+                    file.write(out.data(), out.size());
+                }
+                std::error_code ec;
+                std::filesystem::rename(tempPath, manifestPath, ec);
+                if (ec) {
+                    logger::warn("BookMappingCache: Could not replace manifest: {}", ec.message());
+                    std::filesystem::remove(tempPath, ec);
+                }
+            }
+
+            // The manifest lives next to the plugin log rather than inside the scanned mod folder.
+            std::filesystem::path GetManifestPath(const std::filesystem::path& searchPath) {
+                if (auto logsFolder = SKSE::log::log_directory()) {
+                    return *logsFolder / kManifestFileName;
+                }
+                return searchPath.parent_path() / kManifestFileName;
+            }
+
+            // Reuses the cached record if size and timestamp still match, otherwise re-parses the INI.
+            IniRecord ResolveIni(const std::filesystem::path& iniPath, const std::unordered_map<std::wstring, const IniRecord*>& cached,
+                                 const ParseIniFn& parseIni, bool& changed) {
+                IniRecord record;
+                record.path = iniPath.wstring();
+
+                std::error_code ec;
+                record.size = std::filesystem::file_size(iniPath, ec);
+                record.writeTime = GetWriteTime(iniPath, ec);
+
+                auto it = cached.find(record.path);
+                if (it != cached.end() && it->second->size == record.size && it->second->writeTime == record.writeTime) {
+                    record.mappings = it->second->mappings;
+                    return record;
+                }
+
+                logger::info("  -> Parsing mappings from '{}'", wstring_to_utf8(record.path));
+                record.mappings = parseIni(iniPath);
+                changed = true;
+                return record;
+            }
+
+            // Every mapping INI under searchPath, in listing order. A folder that cannot be read ends the listing there.
+            std::vector<std::filesystem::path> ListIniFiles(const std::filesystem::path& searchPath) {
+                std::vector<std::filesystem::path> inis;
+                std::error_code ec;
+                std::filesystem::recursive_directory_iterator it(searchPath, ec);
+                for (; !ec && it != std::filesystem::end(it); it.increment(ec)) {
+                    std::error_code typeEc;
+                    if (it->is_regular_file(typeEc) && it->path().extension() == ".ini") {
+                        inis.push_back(it->path());
+                    }
+                }
+                if (ec) {
+                    logger::warn("BookMappingCache: Listing '{}' stopped early: {}", searchPath.string(), ec.message());
+                }
+                return inis;
+            }
+
+            // Resolves iniPaths against the manifest and rewrites it if anything differs. Sets changed if it did.
+            Manifest Resolve(const std::filesystem::path& searchPath, const std::vector<std::filesystem::path>& iniPaths,
+                             const std::optional<Manifest>& manifest, const ParseIniFn& parseIni, bool& changed) {
+                std::unordered_map<std::wstring, const IniRecord*> cached;
+                if (manifest) {
+                    for (const auto& ini : manifest->inis) {
+                        cached[ini.path] = &ini;
+                    }
+                }
+
+                Manifest result;
+                changed = !manifest;
+                for (const auto& iniPath : iniPaths) {
+                    result.inis.push_back(ResolveIni(iniPath, cached, parseIni, changed));
+                }
+                // An INI that was removed, or a listing in a different order, changes the mappings as well.
+                changed = changed || !std::ranges::equal(result.inis, manifest->inis, {}, &IniRecord::path, &IniRecord::path);
+
+                if (changed) {
+                    logger::info("BookMappingCache: Mapping INIs under '{}' changed. {} INIs now.", searchPath.string(), result.inis.size());
+                    WriteManifest(GetManifestPath(searchPath), result);
+                }
+                return result;
+            }
+        }
+
+        std::vector<IniRecord> LoadIniRecords(const std::filesystem::path& searchPath, const ParseIniFn& parseIni, ScanMode mode) {
+            auto manifest = mode == ScanMode::kReparseAll ? std::nullopt : ReadManifest(GetManifestPath(searchPath));
+
+            std::vector<std::filesystem::path> iniPaths;
+            if (manifest && mode == ScanMode::kManifest) {
+                // One stat per known INI instead of a walk of the whole tree. One that is gone is dropped here.
+                for (const auto& ini : manifest->inis) {
+                    std::error_code ec;
+                    if (std::filesystem::is_regular_file(ini.path, ec)) {
+                        iniPaths.emplace_back(ini.path);
+                    }
+                }
+            } else {
+                iniPaths = ListIniFiles(searchPath);
+            }
+
+            bool changed = false;
+            auto result = Resolve(searchPath, iniPaths, manifest, parseIni, changed);
+            if (!changed) {
+                logger::info("BookMappingCache: Manifest is current ({} INIs). Reused every parsed mapping.", result.inis.size());
+            }
+            return std::move(result.inis);
+        }
+
+        bool RefreshFromListing(const std::filesystem::path& searchPath, const ParseIniFn& parseIni) {
+            auto manifest = ReadManifest(GetManifestPath(searchPath));
+            bool changed = false;
+            Resolve(searchPath, ListIniFiles(searchPath), manifest, parseIni, changed);
+            return changed;
+        }
+
+    } // namespace BookMappingCache
+} // namespace DynamicBookFramework
@@ -4,6 +4,14 @@
 #include "Utility.h"
 #include "BookUIManager.h"
 #include "Settings.h"
+#include "DynamicBookRegistry.h"
+#include "InputListener.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "WorkerPool.h"
+#include "BookSearch.h"
+#include "ImageRegistry.h"
 #include "PCH.h"
 
 
@@ -19,15 +27,21 @@ namespace DynamicBookFramework {
 			return RE::BSEventNotifyControl::kContinue;
 		}
 
+		InputListener::GetSingleton()->SetBookMenuOpen(a_event->opening);
+
 		if (a_event->opening) {
+			Trace::ScopedEvent traceEvent("BookOpen", "book");
 			if (auto* currentBookObject = RE::BookMenu::GetTargetForm()) {
-				this->PrepareAndCacheBookContent(currentBookObject);
+				this->RequestPrepare(currentBookObject);
 			} else {
-				logger::warn("BookMenuWatcher::ProcessEvent: RE::BookMenu::GetTargetForm() returned null.");
+				Log::Watcher().warn("BookMenuWatcher::ProcessEvent: RE::BookMenu::GetTargetForm() returned null.");
 			}
 		} else {
+			// Anything still preparing or queued for this book is now pointless.
+			this->CancelLoad();
+			BookSearch::OnBookMenuClosed(GetLastOpenedDynamicBook());
 			if (auto lastOpenedTitle = GetLastOpenedDynamicBookTitle(); !lastOpenedTitle.empty()) {
-				logger::info("BookMenuWatcher: Book menu closing. Stopping file watch for book '{}'.", lastOpenedTitle);
+				Log::Watcher().info("BookMenuWatcher: Book menu closing. Stopping file watch for book '{}'.", lastOpenedTitle);
 				FileWatcher::StopMonitoringBookFile(lastOpenedTitle);
 				this->ClearLastOpenedBook(); 
 			}
@@ -36,75 +50,285 @@ namespace DynamicBookFramework {
 		return RE::BSEventNotifyControl::kContinue;
 	}
 
-	void BookMenuWatcher::PrepareAndCacheBookContent(RE::TESObjectBOOK* bookToPrepare) {
+	void BookMenuWatcher::PrepareAndCacheBookContent(RE::TESObjectBOOK* bookToPrepare, bool forceRender) {
 		if (!bookToPrepare) {
             return;
         }
 		
-		const char* bookTitleCStr = bookToPrepare->GetFullName();
-		if (!bookTitleCStr || *bookTitleCStr == '\0') {
+		// A single FormID lookup decides whether this is one of our books; no title conversion on the open path.
+		RE::FormID currentFormID = bookToPrepare->GetFormID();
+		auto record = DynamicBookRegistry::GetSingleton()->FindByFormID(currentFormID);
+
+		if (record) {
+			this->SetLastOpenedBook(currentFormID, record->key); 
+			FileWatcher::MonitorBookFile(record->key, record->path);
+			this->RenderBook(record, currentFormID, forceRender, CaptureRenderSettings());
+		} else {
+			_bookTexts.Erase(currentFormID);
+			if (_lastOpenedDynamicBookID == currentFormID) {
+				ClearLastOpenedBook();
+			}
+		}
+	}
+
+	void BookMenuWatcher::RequestPrepare(RE::TESObjectBOOK* bookToPrepare) {
+		if (!bookToPrepare) {
             return;
         }
-		std::string currentTitle(bookTitleCStr);
+
 		RE::FormID currentFormID = bookToPrepare->GetFormID();
-<<<<<<< Updated upstream
-		
-		std::wstring wCurrentTitle = string_to_wstring(currentTitle);
-		auto dynamicBookPathOpt = GetDynamicBookPathByTitle(wCurrentTitle);
-        
-=======
+		auto record = DynamicBookRegistry::GetSingleton()->FindByFormID(currentFormID);
+		if (!record) {
+			_bookTexts.Erase(currentFormID);
+			if (_lastOpenedDynamicBookID == currentFormID) {
+				ClearLastOpenedBook();
+			}
+			return;
+		}
+		this->SetLastOpenedBook(currentFormID, record->key);
+		FileWatcher::MonitorBookFile(record->key, record->path);
 
-		Settings::g_bookmarks.erase(currentTitle);
-		std::string rawText = SessionDataManager::GetSingleton()->GetFullContent(currentTitle);
-		auto foundTags = Settings::ParseTagsFromText(rawText);
+		// A newer open supersedes whatever the previous one was still doing.
+		CancellationToken cancel = BeginLoad();
 
-		if (!foundTags.empty()) {
-			Settings::g_bookmarks[currentTitle] = foundTags;
-			logger::info("Found and registered {} bookmark tags for {}.", foundTags.size(), currentTitle);
+		std::shared_ptr<PendingPrepare> pending;
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			// BeginLoad has cancelled any job still preparing this book; it will not publish, so start over.
+			auto& slot = _pendingPrepares[currentFormID];
+			slot = std::make_shared<PendingPrepare>();
+			slot->cancel = cancel;
+			pending = slot;
 		}
 
-		auto dynamicBookPathOpt = GetDynamicBookPathByTitle(string_to_wstring(currentTitle));
+		WorkerPool::GetSingleton()->Submit([this, record, currentFormID, pending, settings = CaptureRenderSettings()]() {
+			try {
+				this->RenderBook(record, currentFormID, false, settings, pending->cancel);
+			} catch (const std::exception& e) {
+				Log::Watcher().error("BookMenuWatcher: Preparing '{}' failed: {}", record->key, e.what());
+			}
+			this->FinishPrepare(currentFormID, pending);
+		}, WorkerPool::Priority::kHigh);
+	}
 
->>>>>>> Stashed changes
-		if (dynamicBookPathOpt) {
-			const std::wstring& dynamicBookPath_w = *dynamicBookPathOpt;
-			
-			FileWatcher::MonitorBookFile(currentTitle, dynamicBookPath_w);
-			this->SetLastOpenedBook(currentFormID, currentTitle); 
-
-			// --- FIX: Use SessionDataManager to get the full, combined content ---
-			// The fileKey for the personal journal should be the book's title to match the API call.
-            std::string fileKey = currentTitle; 
-			std::string fileContent = SessionDataManager::GetSingleton()->GetFullContent(fileKey);
-            logger::info("BookMenuWatcher: Loaded combined content for key '{}'. Total length: {}", fileKey, fileContent.length());
-            
-			// Process the final content from SessionDataManager
-			std::string textToStoreForBook;
-			if (fileContent.rfind(";;RAW_HTML;;", 0) == 0) {
-                logger::info("BookMenuWatcher: Raw HTML marker found. Using content as-is after marker.");
-				size_t markerLineEnd = fileContent.find('\n');
-                if (markerLineEnd != std::string::npos) {
-                    textToStoreForBook = fileContent.substr(markerLineEnd + 1);
-                } else { 
-                    textToStoreForBook = ""; 
-                }
-			} else {
-                logger::info("BookMenuWatcher: No raw HTML marker. Applying general markup.");
-                std::string body = HtmlFormatText::ApplyGeneralBookMarkup_ProcessChunk(fileContent);
-                std::string defaultFontFace = Settings::defaultFontFace; 
-    			int defaultFontSize = Settings::defaultFontSize;
-                textToStoreForBook = "<font face=\"" + defaultFontFace + "\" size=\"" + std::to_string(defaultFontSize) + "\">\n" + body + "</font>";
+	void BookMenuWatcher::FinishPrepare(RE::FormID formID, const std::shared_ptr<PendingPrepare>& pending) {
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			if (auto it = _pendingPrepares.find(formID); it != _pendingPrepares.end() && it->second == pending) {
+				_pendingPrepares.erase(it);
 			}
-			
-			this->dynamicBookTexts[currentFormID] = textToStoreForBook; // Update the cache
-			logger::info("BookMenuWatcher: Prepared and cached content for '{}'.", currentTitle);
+		}
+		pending->done.set_value();
 
-		} else {
-			this->dynamicBookTexts.erase(currentFormID);
-			if (_lastOpenedDynamicBookTitle == currentTitle) {
-				ClearLastOpenedBook();
+		if (pending->cancel.IsCancelled()) {
+			return; // The menu closed or a newer open owns the refresh.
+		}
+
+		// The detour already showed a placeholder for this book; push the real page now.
+		RE::FormID expected = formID;
+		if (_refreshWhenReady.compare_exchange_strong(expected, 0)) {
+			if (auto* taskInterface = SKSE::GetTaskInterface()) {
+				taskInterface->AddTask([cancel = pending->cancel]() {
+					if (cancel.IsCancelled()) {
+						return;
+					}
+					Trace::ScopedEvent taskEvent("MainThreadTask: Show prepared book", "task");
+					BookUIManager::RefreshCurrentlyOpenBook(false);
+				});
+			}
+		}
+	}
+
+	CancellationToken BookMenuWatcher::BeginLoad() {
+		std::lock_guard<std::mutex> lock(_loadMutex);
+		_currentLoad.Cancel();
+		_currentLoad = CancellationSource();
+		return _currentLoad.GetToken();
+	}
+
+	void BookMenuWatcher::CancelLoad() {
+		{
+			std::lock_guard<std::mutex> lock(_loadMutex);
+			_currentLoad.Cancel();
+		}
+		_refreshWhenReady.store(0);
+	}
+
+	CancellationToken BookMenuWatcher::GetCurrentLoadToken() {
+		std::lock_guard<std::mutex> lock(_loadMutex);
+		return _currentLoad.GetToken();
+	}
+
+	bool BookMenuWatcher::WaitForPreparedBook(RE::FormID bookFormID, std::chrono::milliseconds timeout) {
+		std::shared_future<void> future;
+		{
+			std::lock_guard<std::mutex> lock(_pendingMutex);
+			auto it = _pendingPrepares.find(bookFormID);
+			if (it == _pendingPrepares.end()) {
+				return true;
+			}
+			future = it->second->future;
+		}
+
+		if (future.wait_for(timeout) == std::future_status::ready) {
+			return true;
+		}
+
+		_refreshWhenReady.store(bookFormID);
+		// Preparation may have finished between the timeout and the store above, before it could see the flag.
+		if (future.wait_for(std::chrono::milliseconds(0)) == std::future_status::ready) {
+			RE::FormID expected = bookFormID;
+			_refreshWhenReady.compare_exchange_strong(expected, 0);
+			return true;
+		}
+		Log::Watcher().info("BookMenuWatcher: FormID {:X} is still being prepared after {} ms. Showing a placeholder.", bookFormID, timeout.count());
+		return false;
+	}
+
+	bool BookMenuWatcher::IsRenderCurrent(const DynamicBookRecord& record, RE::FormID formID, std::int64_t& fileTime) {
+		// Appends only reach the content version once the session manager drains its queue.
+		SessionDataManager::GetSingleton()->CommitQueuedEntries();
+		std::error_code ec;
+		auto fileWriteTime = std::filesystem::last_write_time(record.path, ec);
+		fileTime = ec ? 0 : static_cast<std::int64_t>(fileWriteTime.time_since_epoch().count());
+		return record.renderedVersion.load() == record.contentVersion.load() && record.renderedFileTime.load() == fileTime &&
+			_bookTexts.Contains(formID);
+	}
+
+	bool BookMenuWatcher::IsDynamicBook(RE::FormID bookFormID) const {
+		return DynamicBookRegistry::GetSingleton()->FindByFormID(bookFormID) != nullptr;
+	}
+
+	bool BookMenuWatcher::IsBookPrepared(RE::FormID bookFormID) {
+		auto record = DynamicBookRegistry::GetSingleton()->FindByFormID(bookFormID);
+		std::int64_t fileTime = 0;
+		return record && IsRenderCurrent(*record, bookFormID, fileTime);
+	}
+
+	bool BookMenuWatcher::PrefetchBook(RE::FormID bookFormID, std::function<void()> onFinished) {
+		auto record = DynamicBookRegistry::GetSingleton()->FindByFormID(bookFormID);
+		if (!record) {
+			return false;
+		}
+
+		WorkerPool::GetSingleton()->Submit([this, record, bookFormID, settings = CaptureRenderSettings(), onFinished = std::move(onFinished)]() {
+			// If the player opened the book meanwhile, the high-priority job owns it. It was queued ahead of this one,
+			// so it is running or done; once it publishes, the render below finds the page current and returns.
+			std::shared_future<void> pending;
+			{
+				std::lock_guard<std::mutex> lock(_pendingMutex);
+				if (auto it = _pendingPrepares.find(bookFormID); it != _pendingPrepares.end()) {
+					pending = it->second->future;
+				}
+			}
+			if (pending.valid()) {
+				pending.wait();
+			}
+			try {
+				this->RenderBook(record, bookFormID, false, settings);
+			} catch (const std::exception& e) {
+				Log::Watcher().error("BookMenuWatcher: Prefetching '{}' failed: {}", record->key, e.what());
+			}
+			if (onFinished) {
+				onFinished();
 			}
+		}, WorkerPool::Priority::kLow);
+		return true;
+	}
+
+	BookMenuWatcher::RenderSettings BookMenuWatcher::CaptureRenderSettings() {
+		return { Settings::defaultFontFace, Settings::defaultFontSize };
+	}
+
+	bool BookMenuWatcher::RenderBook(const std::shared_ptr<DynamicBookRecord>& record, RE::FormID currentFormID, bool forceRender,
+		const RenderSettings& settings, const CancellationToken& cancel, std::optional<std::string_view> fileText) {
+		Profiler::ScopedTimer totalTimer(Profiler::Stage::kPrepareTotal);
+		const std::string& currentTitle = record->key;
+		Trace::ScopedEvent traceEvent("PrepareBook", "book", currentTitle);
+
+		auto cancelled = [&](const char* stage) {
+			if (!cancel.IsCancelled()) {
+				return false;
+			}
+			Log::Watcher().debug("BookMenuWatcher: Preparation of '{}' cancelled before {}.", currentTitle, stage);
+			return true;
+		};
+		if (cancelled("load")) {
+			return false;
+		}
+
+		// Reopening a book whose content and file are unchanged reuses the HTML rendered last time. Queued appends
+		// are drained first, so the version read here already counts them.
+		SessionDataManager::GetSingleton()->CommitQueuedEntries();
+		std::uint64_t contentVersion = record->contentVersion.load();
+		std::int64_t fileTime = 0;
+		if (IsRenderCurrent(*record, currentFormID, fileTime) && !forceRender) {
+			Log::Watcher().info("BookMenuWatcher: '{}' is unchanged since it was last rendered. Using cached content.", currentTitle);
+			return true;
+		}
+
+		// --- FIX: Use SessionDataManager to get the full, combined content ---
+		// The fileKey for the personal journal should be the book's title to match the API call.
+		Profiler::ScopedTimer stageTimer(Profiler::Stage::kPrepareContent);
+		auto* sessionManager = SessionDataManager::GetSingleton();
+		std::string fileContent = fileText ? sessionManager->GetFullContent(currentTitle, *fileText) : sessionManager->GetFullContent(currentTitle);
+        Log::Watcher().info("BookMenuWatcher: Loaded combined content for key '{}'. Total length: {}", currentTitle, fileContent.length());
+
+		if (cancelled("assemble")) {
+			return false;
 		}
+		PreloadImages(fileContent, cancel);
+
+		// Bookmarks are read by the hotkey and editor code on other threads, so they are published from the game thread.
+		stageTimer.Next(Profiler::Stage::kPrepareBookmarks);
+		auto foundTags = Settings::ParseTagsFromText(fileContent);
+		if (auto* taskInterface = SKSE::GetTaskInterface()) {
+			taskInterface->AddTask([title = currentTitle, tags = std::move(foundTags), cancel]() mutable {
+				if (cancel.IsCancelled()) {
+					return;
+				}
+				if (tags.empty()) {
+					Settings::g_bookmarks.erase(title);
+				} else {
+					Log::Watcher().info("Found and registered {} bookmark tags for {}.", tags.size(), title);
+					Settings::g_bookmarks[title] = std::move(tags);
+				}
+			});
+		}
+        
+		if (cancelled("markup")) {
+			return false;
+		}
+
+		// Process the final content from SessionDataManager
+		stageTimer.Next(Profiler::Stage::kPrepareMarkup);
+		std::string textToStoreForBook;
+		if (fileContent.rfind(";;RAW_HTML;;", 0) == 0) {
+            Log::Watcher().debug("BookMenuWatcher: Raw HTML marker found. Using content as-is after marker.");
+			size_t markerLineEnd = fileContent.find('\n');
+            if (markerLineEnd != std::string::npos) {
+                textToStoreForBook = fileContent.substr(markerLineEnd + 1);
+            } else { 
+                textToStoreForBook = ""; 
+            }
+		} else {
+            Log::Watcher().debug("BookMenuWatcher: No raw HTML marker. Applying general markup.");
+            std::string body = HtmlFormatText::ApplyGeneralBookMarkup_ProcessChunk(fileContent);
+            stageTimer.Next(Profiler::Stage::kPrepareFontWrap);
+            textToStoreForBook = "<font face=\"" + settings.fontFace + "\" size=\"" + std::to_string(settings.fontSize) + "\">\n" + body + "</font>";
+		}
+		
+		stageTimer.Stop();
+
+		// Last check before anything becomes visible: a cancelled load never lands in the cache.
+		if (cancelled("publish")) {
+			return false;
+		}
+		_bookTexts.Put(currentFormID, std::move(textToStoreForBook)); // Update the cache
+		record->renderedVersion.store(contentVersion);
+		record->renderedFileTime.store(fileTime);
+		Log::Watcher().info("BookMenuWatcher: Prepared and cached content for '{}'.", currentTitle);
+		return true;
 	}	
     
     // This is the implementation for the public method declared in the header.
@@ -112,18 +336,35 @@ namespace DynamicBookFramework {
     bool BookMenuWatcher::ReloadAndCacheBook(RE::TESObjectBOOK* bookToReload) {
         // We can add more logic here if needed, but for now, it just calls the main worker function.
         // The return value could be more robust, checking if content was actually cached.
-        this->PrepareAndCacheBookContent(bookToReload);
-        return this->dynamicBookTexts.contains(bookToReload->GetFormID());
+        this->PrepareAndCacheBookContent(bookToReload, true);
+        return _bookTexts.Contains(bookToReload->GetFormID());
     }
 
+	bool BookMenuWatcher::RenderSavedBook(RE::TESObjectBOOK* book, std::string_view fileText) {
+		auto record = book ? DynamicBookRegistry::GetSingleton()->FindByFormID(book->GetFormID()) : nullptr;
+		if (!record) {
+			return false;
+		}
+		this->RenderBook(record, book->GetFormID(), true, CaptureRenderSettings(), {}, fileText);
+		return _bookTexts.Contains(book->GetFormID());
+	}
+
 <<<<<<< Updated upstream
-	std::optional<std::string> BookMenuWatcher::GetCachedHtmlForBook(RE::FormID bookFormID) {
-		auto it = this->dynamicBookTexts.find(bookFormID);
-		if (it != this->dynamicBookTexts.end()) {
+	std::shared_ptr<const std::string> BookMenuWatcher::GetCachedHtmlForBook(RE::FormID bookFormID) {
+		return _bookTexts.Get(bookFormID);
+	}
+
+	void BookMenuWatcher::PreloadImages(const std::string&, const CancellationToken&) {
+		// This pipeline renders no [IMG=] tags, so there is nothing to read ahead.
+	}
 =======
+	void BookMenuWatcher::PreloadImages(const std::string& content, const CancellationToken& cancel) {
+		ImageRegistry::GetSingleton()->Warm(ExtractImagePathsFromText(content), cancel);
+	}
+
 	bool BookMenuWatcher::ReloadAndCacheBook(RE::TESObjectBOOK* bookToReload) {
-		this->PrepareAndCacheBookContent(bookToReload);
-		return _dynamicBookTexts.contains(bookToReload->GetFormID());
+		this->PrepareAndCacheBookContent(bookToReload, true);
+		return _bookTexts.Contains(bookToReload->GetFormID());
 	}
 
 	std::string BookMenuWatcher::GetFullDynamicTextForBook(RE::TESObjectBOOK* book) {
@@ -163,11 +404,11 @@ namespace DynamicBookFramework {
 	std::optional<std::string> BookMenuWatcher::GetCachedVanillaText(const std::string& bookTitle) {
 		auto it = _vanillaBookTexts.find(bookTitle);
 		if (it != _vanillaBookTexts.end()) {
->>>>>>> Stashed changes
 			return it->second;
 		}
 		return std::nullopt;
 	}
+>>>>>>> Stashed changes
     
     // --- Implementation of tracker methods ---
     void BookMenuWatcher::SetLastOpenedBook(RE::FormID a_formID, const std::string& a_title) {
@@ -0,0 +1,337 @@
+//BookPak.cpp
+#include "BookPak.h"
+#include "Lz4.h"
+
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+namespace DynamicBookFramework {
+    namespace BookPak {
+
+        namespace { // Anonymous namespace for the on-disk layout and file mapping
+
+            constexpr char kMagic[8] = { 'D', 'B', 'F', 'P', 'A', 'K', '\0', '\0' };
+            constexpr std::size_t kHeaderSize = sizeof(kMagic) + 4 + 4 + 8 + 8;
+            constexpr std::size_t kMinEntrySize = 2 + 2 + 8 + 8 + 8 + 8 + 1 + 7; // Empty title and file name
+
+            // --- Writing ---
+            template <class T>
+            void WriteValue(std::string& a_out, T a_value) {
+                a_out.append(reinterpret_cast<const char*>(&a_value), sizeof(a_value));
+            }
+
+            void WriteString(std::string& a_out, std::string_view a_value) {
+                WriteValue(a_out, static_cast<std::uint16_t>(a_value.size()));
+                a_out.append(a_value);
+            }
+
+            // --- Reading (bounds-checked; any overrun marks the whole index invalid) ---
+            struct Reader {
+                std::string_view data;
+                std::size_t pos = 0;
+                bool ok = true;
+
+                template <class T>
+                T Read() {
+                    T value{};
+                    if (!ok || data.size() - pos < sizeof(T)) {
+                        ok = false;
+                        return value;
+                    }
+                    std::memcpy(&value, data.data() + pos, sizeof(T));
+                    pos += sizeof(T);
+                    return value;
+                }
+
+                std::string ReadString() {
+                    auto length = Read<std::uint16_t>();
+                    if (!ok || data.size() - pos < length) {
+                        ok = false;
+                        return {};
+                    }
+                    std::string value(data.substr(pos, length));
+                    pos += length;
+                    return value;
+                }
+            };
+
+            struct MappedFile {
+                const char* data = nullptr;
+                std::size_t size = 0;
+            };
+
+#ifdef _WIN32
+            std::optional<MappedFile> MapFile(const std::filesystem::path& a_path) {
+                HANDLE file = CreateFileW(a_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE) {
+                    return std::nullopt;
+                }
+                LARGE_INTEGER size{};
+                if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+                    CloseHandle(file);
+                    return std::nullopt;
+                }
+                HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                CloseHandle(file); // The mapping keeps the file open.
+                if (!mapping) {
+                    return std::nullopt;
+                }
+                void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping); // And the view keeps the mapping.
+                if (!view) {
+                    return std::nullopt;
+                }
+                return MappedFile{ static_cast<const char*>(view), static_cast<std::size_t>(size.QuadPart) };
+            }
+
+            void UnmapFile(const char* a_data, std::size_t) {
+                UnmapViewOfFile(a_data);
+            }
+#else
+            std::optional<MappedFile> MapFile(const std::filesystem::path& a_path) {
+                int file = open(a_path.c_str(), O_RDONLY);
+                if (file < 0) {
+                    return std::nullopt;
+                }
+                struct stat info{};
+                if (fstat(file, &info) != 0 || info.st_size == 0) {
+                    close(file);
+                    return std::nullopt;
+                }
+                void* view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+                close(file);
+                if (view == MAP_FAILED) {
+                    return std::nullopt;
+                }
+                return MappedFile{ static_cast<const char*>(view), static_cast<std::size_t>(info.st_size) };
+            }
+
+            void UnmapFile(const char* a_data, std::size_t a_size) {
+                munmap(const_cast<char*>(a_data), a_size);
+            }
+#endif
+        }
+
+        std::uint64_t Hash(std::string_view a_data) {
+            std::uint64_t hash = 14695981039346656037ull;
+            for (char c : a_data) {
+                hash ^= static_cast<unsigned char>(c);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+
+        const char* GetCodecName(Codec a_codec) {
+            switch (a_codec) {
+            case Codec::kStored:
+                return "stored";
+            case Codec::kLz4:
+                return "lz4";
+            }
+            return "unknown";
+        }
+
+        std::unique_ptr<Archive> Archive::Open(const std::filesystem::path& a_path, std::string& a_error) {
+            auto mapped = MapFile(a_path);
+            if (!mapped) {
+                a_error = "could not map the file";
+                return nullptr;
+            }
+            std::unique_ptr<Archive> archive(new Archive());
+            archive->_path = a_path;
+            archive->_data = std::string_view(mapped->data, mapped->size);
+
+            Reader header{ archive->_data };
+            char magic[sizeof(kMagic)];
+            for (char& c : magic) {
+                c = header.Read<char>();
+            }
+            auto version = header.Read<std::uint32_t>();
+            auto count = header.Read<std::uint32_t>();
+            auto indexOffset = header.Read<std::uint64_t>();
+            auto indexSize = header.Read<std::uint64_t>();
+            if (!header.ok || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+                a_error = "not a .dbfpak archive";
+                return nullptr;
+            }
+            if (version != kVersion) {
+                a_error = "unsupported archive version " + std::to_string(version);
+                return nullptr;
+            }
+            if (indexOffset < kHeaderSize || indexOffset > mapped->size || indexSize > mapped->size - indexOffset) {
+                a_error = "the index lies outside the file";
+                return nullptr;
+            }
+
+            Reader index{ archive->_data.substr(static_cast<std::size_t>(indexOffset), static_cast<std::size_t>(indexSize)) };
+            if (count > indexSize / kMinEntrySize) {
+                a_error = "the index is truncated";
+                return nullptr;
+            }
+            archive->_entries.reserve(count);
+            for (std::uint32_t i = 0; i < count && index.ok; ++i) {
+                Entry entry;
+                entry.title = index.ReadString();
+                entry.fileName = index.ReadString();
+                entry.offset = index.Read<std::uint64_t>();
+                entry.storedSize = index.Read<std::uint64_t>();
+                entry.rawSize = index.Read<std::uint64_t>();
+                entry.hash = index.Read<std::uint64_t>();
+                entry.codec = static_cast<Codec>(index.Read<std::uint8_t>());
+                for (int reserved = 0; reserved < 7; ++reserved) {
+                    index.Read<std::uint8_t>();
+                }
+                if (!index.ok) {
+                    break;
+                }
+                if (entry.offset < kHeaderSize || entry.offset > indexOffset || entry.storedSize > indexOffset - entry.offset) {
+                    a_error = "entry '" + entry.title + "' lies outside the data section";
+                    return nullptr;
+                }
+                if (entry.codec != Codec::kStored && entry.codec != Codec::kLz4) {
+                    a_error = "entry '" + entry.title + "' uses an unknown codec";
+                    return nullptr;
+                }
+                if (entry.rawSize > kMaxEntrySize) {
+                    a_error = "entry '" + entry.title + "' is larger than " + std::to_string(kMaxEntrySize) + " bytes";
+                    return nullptr;
+                }
+                if ((entry.codec == Codec::kStored && entry.storedSize != entry.rawSize) ||
+                    (entry.codec == Codec::kLz4 && entry.rawSize > Lz4::GetMaxDecompressedSize(static_cast<std::size_t>(entry.storedSize)))) {
+                    a_error = "entry '" + entry.title + "' has inconsistent sizes";
+                    return nullptr;
+                }
+                archive->_entries.push_back(std::move(entry));
+            }
+            if (!index.ok) {
+                a_error = "the index is truncated";
+                return nullptr;
+            }
+            // As in a mapping INI, the first record of a title wins.
+            for (std::size_t i = 0; i < archive->_entries.size(); ++i) {
+                archive->_byTitle.emplace(archive->_entries[i].title, i);
+            }
+            return archive;
+        }
+
+        Archive::~Archive() {
+            if (_data.data()) {
+                UnmapFile(_data.data(), _data.size());
+            }
+        }
+
+        const Entry* Archive::Find(std::string_view a_title) const {
+            auto it = _byTitle.find(a_title);
+            return it != _byTitle.end() ? &_entries[it->second] : nullptr;
+        }
+
+        std::optional<std::string> Archive::Read(const Entry& a_entry) const {
+            std::string_view stored = _data.substr(static_cast<std::size_t>(a_entry.offset), static_cast<std::size_t>(a_entry.storedSize));
+            std::string content;
+            if (a_entry.codec == Codec::kLz4) {
+                if (!Lz4::Decompress(stored, static_cast<std::size_t>(a_entry.rawSize), content)) {
+                    return std::nullopt;
+                }
+            } else {
+                content.assign(stored);
+            }
+            if (Hash(content) != a_entry.hash) {
+                return std::nullopt;
+            }
+            return content;
+        }
+
+        std::optional<WriteStats> Write(const std::filesystem::path& a_path, const std::vector<SourceEntry>& a_entries,
+            bool a_compress, std::string& a_error) {
+            WriteStats stats;
+            std::string data;
+            std::string index;
+            for (const auto& source : a_entries) {
+                if (source.title.size() > 0xFFFF || source.fileName.size() > 0xFFFF) {
+                    a_error = "a title or file name is longer than 65535 bytes";
+                    return std::nullopt;
+                }
+                if (source.content.size() > kMaxEntrySize) {
+                    a_error = "'" + source.fileName + "' is larger than " + std::to_string(kMaxEntrySize) + " bytes";
+                    return std::nullopt;
+                }
+                Entry entry;
+                entry.offset = kHeaderSize + data.size();
+                entry.rawSize = source.content.size();
+                entry.hash = Hash(source.content);
+                std::string compressed;
+                if (a_compress) {
+                    compressed = Lz4::Compress(source.content);
+                }
+                if (a_compress && compressed.size() < source.content.size() - source.content.size() / 10) {
+                    entry.codec = Codec::kLz4;
+                    data += compressed;
+                    ++stats.compressedEntries;
+                } else {
+                    data += source.content;
+                }
+                entry.storedSize = kHeaderSize + data.size() - entry.offset;
+
+                WriteString(index, source.title);
+                WriteString(index, source.fileName);
+                WriteValue(index, entry.offset);
+                WriteValue(index, entry.storedSize);
+                WriteValue(index, entry.rawSize);
+                WriteValue(index, entry.hash);
+                WriteValue(index, static_cast<std::uint8_t>(entry.codec));
+                index.append(7, '\0');
+
+                ++stats.entries;
+                stats.rawBytes += entry.rawSize;
+                stats.storedBytes += entry.storedSize;
+            }
+
+            std::string header(kMagic, sizeof(kMagic));
+            WriteValue(header, kVersion);
+            WriteValue(header, static_cast<std::uint32_t>(a_entries.size()));
+            WriteValue(header, static_cast<std::uint64_t>(kHeaderSize + data.size()));
+            WriteValue(header, static_cast<std::uint64_t>(index.size()));
+
+            auto tempPath = a_path;
+            tempPath += ".tmp";
+            {
+                std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) {
+                    a_error = "could not create " + tempPath.string();
+                    return std::nullopt;
+                }
+                file.write(header.data(), static_cast<std::streamsize>(header.size()));
+                file.write(data.data(), static_cast<std::streamsize>(data.size()));
+                file.write(index.data(), static_cast<std::streamsize>(index.size()));
+                if (!file.good()) {
+                    file.close();
+                    std::error_code ec;
+                    std::filesystem::remove(tempPath, ec);
+                    a_error = "could not write " + tempPath.string();
+                    return std::nullopt;
+                }
+            }
+            std::error_code ec;
+            std::filesystem::rename(tempPath, a_path, ec);
+            if (ec) {
+                std::filesystem::remove(tempPath, ec);
+                a_error = "could not replace " + a_path.string();
+                return std::nullopt;
+            }
+            return stats;
+        }
+
+    } // namespace BookPak
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,137 @@
+//BookPakRegistry.cpp
+#include "BookPakRegistry.h"
+#include "DynamicBookRegistry.h"
+#include "Utility.h"
+#include "Log.h"
+#include "Trace.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+    namespace BookPakRegistry {
+
+        namespace { // Anonymous namespace for the open archives
+
+            struct PackedBook {
+                const BookPak::Archive* archive = nullptr;
+                const BookPak::Entry* entry = nullptr;
+                std::filesystem::path path;
+            };
+
+            // Replaced as a whole on reload. Readers hold their own reference, so an archive stays mapped until
+            // the last read from it finishes.
+            struct State {
+                std::vector<std::unique_ptr<BookPak::Archive>> archives;
+                TitleMap<PackedBook> books;
+            };
+
+            std::shared_ptr<const State> g_state = std::make_shared<State>();
+            std::mutex g_stateMutex;
+
+            std::shared_ptr<const State> GetState() {
+                std::lock_guard<std::mutex> lock(g_stateMutex);
+                return g_state;
+            }
+
+            const PackedBook* Find(const State& a_state, std::string_view a_title, const std::filesystem::path& a_path) {
+                auto it = a_state.books.find(a_title);
+                if (it == a_state.books.end() || it->second.path != a_path) {
+                    return nullptr;
+                }
+                return &it->second;
+            }
+        }
+
+        std::vector<std::pair<std::wstring, std::wstring>> Load(const std::filesystem::path& a_searchPath, const std::filesystem::path& a_booksFolder) {
+            Trace::ScopedEvent traceEvent("LoadBookPaks", "book");
+            std::vector<std::filesystem::path> paths;
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(a_searchPath, ec)) {
+                if (entry.is_regular_file(ec) && entry.path().extension() == BookPak::kExtension) {
+                    paths.push_back(entry.path());
+                }
+            }
+            std::sort(paths.begin(), paths.end());
+
+            auto state = std::make_shared<State>();
+            for (const auto& path : paths) {
+                std::string error;
+                auto archive = BookPak::Archive::Open(path, error);
+                if (!archive) {
+                    logger::warn("  -> Could not open '{}': {}. Skipping.", wstring_to_utf8(path.wstring()), error);
+                    continue;
+                }
+                for (const auto& entry : archive->GetEntries()) {
+                    // The file name is where a loose copy gets written, so it must stay inside the books folder.
+                    auto relative = std::filesystem::path(string_to_wstring(entry.fileName)).lexically_normal();
+                    if (relative.empty() || relative.has_root_path() || *relative.begin() == L"..") {
+                        logger::warn("  -> Skipping '{}' in '{}': its file name leaves the books folder.", entry.title, wstring_to_utf8(path.filename().wstring()));
+                        continue;
+                    }
+                    state->books.insert_or_assign(entry.title, PackedBook{ archive.get(), &entry, a_booksFolder / relative });
+                }
+                logger::info("  -> Mapped '{}' ({} books).", wstring_to_utf8(path.filename().wstring()), archive->GetEntries().size());
+                state->archives.push_back(std::move(archive));
+            }
+
+            std::vector<std::pair<std::wstring, std::wstring>> mappings;
+            mappings.reserve(state->books.size());
+            for (const auto& [title, book] : state->books) {
+                mappings.emplace_back(string_to_wstring(title), book.path.wstring());
+            }
+            {
+                std::lock_guard<std::mutex> lock(g_stateMutex);
+                g_state = std::move(state);
+            }
+            return mappings;
+        }
+
+        std::optional<std::string> Read(std::string_view a_title, const std::filesystem::path& a_path) {
+            auto state = GetState();
+            const auto* book = Find(*state, a_title, a_path);
+            if (!book) {
+                return std::nullopt;
+            }
+            auto content = book->archive->Read(*book->entry);
+            if (!content) {
+                Log::Session().error("BookPakRegistry: '{}' in '{}' is corrupt.", a_title, wstring_to_utf8(book->archive->GetPath().filename().wstring()));
+            }
+            return content;
+        }
+
+        bool MaterializeLooseCopy(std::string_view a_title, const std::filesystem::path& a_path) {
+            std::error_code ec;
+            if (std::filesystem::exists(a_path, ec)) {
+                return true;
+            }
+            auto content = Read(a_title, a_path);
+            if (!content) {
+                return false;
+            }
+            std::filesystem::create_directories(a_path.parent_path(), ec);
+            std::ofstream file(a_path, std::ios::binary | std::ios::trunc);
+            file.write(content->data(), static_cast<std::streamsize>(content->size()));
+            if (!file.good()) {
+                Log::Session().error("BookPakRegistry: Could not write a loose copy of '{}'.", a_title);
+                return false;
+            }
+            Log::Session().info("BookPakRegistry: Wrote a loose copy of packed book '{}'; it now overrides the archive.", a_title);
+            return true;
+        }
+
+        Stats GetStats() {
+            auto state = GetState();
+            Stats stats;
+            stats.archives = state->archives.size();
+            stats.books = state->books.size();
+            for (const auto& archive : state->archives) {
+                for (const auto& entry : archive->GetEntries()) {
+                    stats.mappedBytes += entry.storedSize;
+                }
+            }
+            return stats;
+        }
+
+    } // namespace BookPakRegistry
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,261 @@
+//BookSearch.cpp
+#include "BookSearch.h"
+#include "SessionDataManager.h"
+#include "DynamicBookRegistry.h"
+#include "MpscQueue.h"
+#include "WorkerPool.h"
+#include "Utility.h"
+#include "Log.h"
+#include "Trace.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+    namespace BookSearch {
+
+        namespace { // Anonymous namespace for the index, the append queue and the pending jump
+
+            SearchIndex g_index;
+
+            // Bumped by every Rebuild. A running rebuild stops when it is superseded, and queued appends from
+            // before it are dropped because the rebuild reads them from the session buffer itself.
+            std::atomic<std::uint64_t> g_generation{ 0 };
+            std::atomic<bool> g_building{ false };
+            std::atomic<double> g_lastBuildMs{ 0.0 };
+
+            struct AppendedEntries {
+                std::uint64_t generation;
+                std::string fileKey;
+                std::string text;
+            };
+            MpscQueue<AppendedEntries> g_appended;
+            std::atomic<bool> g_drainScheduled{ false };
+            std::mutex g_drainMutex; // Makes the drain job the queue's single consumer
+
+            // Books that took appends since the last save. Appended text has no save-block anchor yet, and an append
+            // that races a rebuild or re-index can be indexed twice; re-indexing these on save settles both.
+            std::mutex g_dirtyMutex;
+            std::set<std::string> g_dirtyKeys;
+
+            struct PendingJump {
+                RE::FormID formID = 0;
+                std::string anchor;
+            };
+            std::mutex g_jumpMutex;
+            PendingJump g_pendingJump;
+
+            constexpr int kOpenAttempts = 30;
+
+            void DrainAppended() {
+                std::lock_guard<std::mutex> lock(g_drainMutex);
+                g_drainScheduled.store(false);
+                Trace::ScopedEvent traceEvent("SearchAppend", "search");
+                std::set<std::string> touched;
+                while (auto appended = g_appended.TryPop()) {
+                    if (appended->generation != g_generation.load()) {
+                        continue;
+                    }
+                    g_index.AppendToBook(appended->fileKey, appended->text);
+                    touched.insert(std::move(appended->fileKey));
+                }
+                if (!touched.empty()) {
+                    std::lock_guard<std::mutex> dirtyLock(g_dirtyMutex);
+                    g_dirtyKeys.merge(touched);
+                }
+            }
+
+            void JumpToAnchor(RE::GFxMovieView* movieView, const std::string& anchor) {
+                if (!movieView || anchor.empty()) {
+                    return;
+                }
+                RE::FxResponseArgs<1> gotoArgs;
+                gotoArgs.Add(anchor.c_str());
+                RE::FxDelegate::Invoke(movieView, "GotoPageByAnchor", gotoArgs);
+            }
+
+            RE::BookMenu* GetOpenBookMenu() {
+                auto* ui = RE::UI::GetSingleton();
+                if (!ui || !ui->IsMenuOpen(RE::BookMenu::MENU_NAME)) {
+                    return nullptr;
+                }
+                auto menu = ui->GetMenu(RE::BookMenu::MENU_NAME);
+                return menu ? static_cast<RE::BookMenu*>(menu.get()) : nullptr;
+            }
+
+            void ClearPendingJump(RE::FormID formID) {
+                std::lock_guard<std::mutex> lock(g_jumpMutex);
+                if (g_pendingJump.formID == formID) {
+                    g_pendingJump = {};
+                }
+            }
+
+            // Runs on the game thread. Another book may still be closing, so wait a few frames for the menu to go away.
+            void OpenBookWhenMenuClosed(RE::FormID formID, int attemptsLeft) {
+                if (GetOpenBookMenu()) {
+                    if (attemptsLeft > 0) {
+                        SKSE::GetTaskInterface()->AddTask([formID, attemptsLeft]() { OpenBookWhenMenuClosed(formID, attemptsLeft - 1); });
+                    } else {
+                        Log::UI().warn("BookSearch: The open book did not close. Not opening {:X}.", formID);
+                        ClearPendingJump(formID);
+                    }
+                    return;
+                }
+                auto* book = RE::TESForm::LookupByID<RE::TESObjectBOOK>(formID);
+                if (!book) {
+                    ClearPendingJump(formID);
+                    return;
+                }
+                RE::BSString description;
+                book->GetDescription(description, nullptr);
+                RE::BookMenu::OpenBookMenu(description, nullptr, nullptr, book, RE::NiPoint3{}, RE::NiMatrix3{}, 1.0f, true);
+            }
+        }
+
+        void Rebuild() {
+            std::uint64_t generation = g_generation.fetch_add(1) + 1;
+            auto titles = GetAllBookTitles();
+            g_building.store(true);
+
+            WorkerPool::GetSingleton()->Submit([generation, titles = std::move(titles)]() {
+                Trace::ScopedEvent traceEvent("SearchRebuild", "search");
+                auto start = std::chrono::steady_clock::now();
+                g_index.Clear();
+                {
+                    std::lock_guard<std::mutex> lock(g_dirtyMutex);
+                    g_dirtyKeys.clear();
+                }
+                auto* sessionManager = SessionDataManager::GetSingleton();
+                for (const auto& title : titles) {
+                    if (g_generation.load() != generation) {
+                        return; // A newer rebuild owns the index now.
+                    }
+                    try {
+                        g_index.ReplaceBook(title, sessionManager->GetFullContent(title));
+                    } catch (const std::exception& e) {
+                        Log::Session().error("BookSearch: Could not index '{}': {}", title, e.what());
+                    }
+                }
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                g_lastBuildMs.store(ms);
+                if (g_generation.load() == generation) {
+                    g_building.store(false);
+                }
+                auto stats = g_index.GetStats();
+                Log::Session().info("BookSearch: Indexed {} books ({} tokens, {} postings, ~{} KB) in {:.1f} ms.",
+                    stats.books, stats.tokens, stats.postings, stats.memoryBytes / 1024, ms);
+            }, WorkerPool::Priority::kLow);
+        }
+
+        void OnEntriesAppended(const std::string& fileKey, const std::vector<std::string>& entries) {
+            if (entries.empty()) {
+                return;
+            }
+            // Laid out the way AssembleContent lays out pending entries, so offsets and snippets read the same.
+            std::string text;
+            for (const auto& entry : entries) {
+                text += '\n';
+                text += entry;
+            }
+            text += '\n';
+            g_appended.Push({ g_generation.load(), fileKey, std::move(text) });
+
+            // One indexing job per burst, however many appends land before it runs.
+            if (!g_drainScheduled.exchange(true)) {
+                WorkerPool::GetSingleton()->Submit([]() { DrainAppended(); }, WorkerPool::Priority::kLow);
+            }
+        }
+
+        void Reindex(const std::string& fileKey) {
+            std::uint64_t generation = g_generation.load();
+            WorkerPool::GetSingleton()->Submit([fileKey, generation]() {
+                // The session manager is read before the index lock is taken; the two are never held together.
+                std::string content = SessionDataManager::GetSingleton()->GetFullContent(fileKey);
+                if (g_generation.load() == generation) {
+                    g_index.ReplaceBook(fileKey, std::move(content));
+                }
+            }, WorkerPool::Priority::kLow);
+        }
+
+        void OnGameSaved() {
+            std::set<std::string> dirty;
+            {
+                std::lock_guard<std::mutex> lock(g_dirtyMutex);
+                dirty.swap(g_dirtyKeys);
+            }
+            for (const auto& key : dirty) {
+                Reindex(key);
+            }
+        }
+
+        bool IsBuilding() {
+            return g_building.load();
+        }
+
+        double GetLastBuildMilliseconds() {
+            return g_lastBuildMs.load();
+        }
+
+        std::vector<SearchIndex::Hit> Query(std::string_view query, std::size_t maxHits) {
+            // Appended entries are handed to the index when the session manager drains them.
+            SessionDataManager::GetSingleton()->TryCommitQueuedEntries();
+            return g_index.Query(query, maxHits);
+        }
+
+        SearchIndex::Stats GetStats() {
+            return g_index.GetStats();
+        }
+
+        std::uint64_t GetVersion() {
+            return g_index.GetVersion();
+        }
+
+        void OpenAtHit(const std::string& bookKey, const std::string& anchor) {
+            auto* taskInterface = SKSE::GetTaskInterface();
+            if (!taskInterface) {
+                return;
+            }
+            taskInterface->AddTask([bookKey, anchor]() {
+                auto* book = DynamicBookRegistry::GetSingleton()->FindBookByTitle(bookKey);
+                if (!book) {
+                    Log::UI().warn("BookSearch: No book form is titled '{}'.", bookKey);
+                    return;
+                }
+
+                auto* bookMenu = GetOpenBookMenu();
+                if (bookMenu && bookMenu->uiMovie && RE::BookMenu::GetTargetForm() == book) {
+                    JumpToAnchor(bookMenu->GetRuntimeData().book.get(), anchor);
+                    return;
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(g_jumpMutex);
+                    g_pendingJump = { book->GetFormID(), anchor };
+                }
+                if (bookMenu) {
+                    if (auto* messageQueue = RE::UIMessageQueue::GetSingleton()) {
+                        messageQueue->AddMessage(RE::BookMenu::MENU_NAME, RE::UI_MESSAGE_TYPE::kHide, nullptr);
+                    }
+                }
+                OpenBookWhenMenuClosed(book->GetFormID(), kOpenAttempts);
+            });
+        }
+
+        void ApplyPendingJump(RE::GFxMovieView* movieView, RE::FormID bookFormID) {
+            std::string anchor;
+            {
+                std::lock_guard<std::mutex> lock(g_jumpMutex);
+                if (g_pendingJump.formID != bookFormID) {
+                    return;
+                }
+                anchor = std::move(g_pendingJump.anchor);
+                g_pendingJump = {};
+            }
+            JumpToAnchor(movieView, anchor);
+        }
+
+        void OnBookMenuClosed(RE::FormID bookFormID) {
+            ClearPendingJump(bookFormID);
+        }
+    }
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,93 @@
+//BookTextCache.cpp
+#include "BookTextCache.h"
+#include "Log.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+
+    std::shared_ptr<const std::string> BookTextCache::Get(RE::FormID a_formID) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _index.find(a_formID);
+        if (it == _index.end()) {
+            ++_misses;
+            return nullptr;
+        }
+        ++_hits;
+        _lru.splice(_lru.begin(), _lru, it->second);
+        return it->second->html;
+    }
+
+    bool BookTextCache::Contains(RE::FormID a_formID) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _index.contains(a_formID);
+    }
+
+    std::size_t BookTextCache::GetLength(RE::FormID a_formID) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _index.find(a_formID);
+        return it != _index.end() ? it->second->html->size() : 0;
+    }
+
+    void BookTextCache::Put(RE::FormID a_formID, std::string a_html) {
+        auto html = std::make_shared<const std::string>(std::move(a_html));
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (auto it = _index.find(a_formID); it != _index.end()) {
+            _bytes -= it->second->html->size();
+            it->second->html = std::move(html);
+            _lru.splice(_lru.begin(), _lru, it->second);
+        } else {
+            _lru.push_front({ a_formID, std::move(html) });
+            _index.emplace(a_formID, _lru.begin());
+        }
+        _bytes += _lru.front().html->size();
+        EvictToBudget();
+    }
+
+    void BookTextCache::Erase(RE::FormID a_formID) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (auto it = _index.find(a_formID); it != _index.end()) {
+            _bytes -= it->second->html->size();
+            _lru.erase(it->second);
+            _index.erase(it);
+        }
+    }
+
+    void BookTextCache::Clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lru.clear();
+        _index.clear();
+        _bytes = 0;
+    }
+
+    void BookTextCache::SetByteBudget(std::size_t a_byteBudget) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _byteBudget = a_byteBudget;
+        EvictToBudget();
+    }
+
+    BookTextCache::Stats BookTextCache::GetStats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return { _hits, _misses, _evictions, _lru.size(), _bytes, _byteBudget };
+    }
+
+    void BookTextCache::ResetCounters() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _hits = 0;
+        _misses = 0;
+        _evictions = 0;
+    }
+
+    void BookTextCache::EvictToBudget() {
+        while (_bytes > _byteBudget && _lru.size() > 1) {
+            const auto& victim = _lru.back();
+            Log::Watcher().debug("BookTextCache: Evicting FormID {:X} ({} bytes) to stay within {} bytes.", victim.formID, victim.html->size(), _byteBudget);
+            _bytes -= victim.html->size();
+            _index.erase(victim.formID);
+            _lru.pop_back();
+            ++_evictions;
+        }
+    }
+
+} // namespace DynamicBookFramework
@@ -4,28 +4,35 @@
 #include "Utility.h"            
 #include "SetBookTextHook.h"  
 #include "SessionDataManager.h" 
+#include "BookSearch.h"
+#include "DynamicBookRegistry.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Trace.h"
 #include "PCH.h" 
 
 
 namespace DynamicBookFramework {
     namespace BookUIManager {
 
-        bool RefreshCurrentlyOpenBook() {
+        bool RefreshCurrentlyOpenBook(bool reload) {
             auto* ui = RE::UI::GetSingleton();
             if (!ui || !ui->IsMenuOpen(RE::BookMenu::MENU_NAME)) {
-                logger::trace("BookUIManager: BookMenu not open or UI singleton not found. No refresh performed.");
+                Log::UI().trace("BookUIManager: BookMenu not open or UI singleton not found. No refresh performed.");
                 return false; // Not an error, just nothing to do
             }
+            Profiler::ScopedTimer totalTimer(Profiler::Stage::kRefreshTotal);
+            Trace::ScopedEvent traceEvent("Refresh", "ui");
 
             RE::GPtr<RE::IMenu> menuInstance = ui->GetMenu(RE::BookMenu::MENU_NAME);
             if (!menuInstance) {
-                logger::warn("BookUIManager: Could not get BookMenu instance handle.");
+                Log::UI().warn("BookUIManager: Could not get BookMenu instance handle.");
                 return false;
             }
 
             auto* bookMenu = static_cast<RE::BookMenu*>(menuInstance.get());
             if (!bookMenu) {
-                logger::warn("BookUIManager: Could not cast to BookMenu.");
+                Log::UI().warn("BookUIManager: Could not cast to BookMenu.");
                 return false;
             }
 
@@ -33,7 +40,7 @@ namespace DynamicBookFramework {
             // --- FIX: Call GetRuntimeData() and store as a reference. Use '.' for member access. ---
             auto& runtimeData = bookMenu->GetRuntimeData();
 =======
-            logger::info("BookUIManager: Triggering live refresh for '{}'...", currentBook->GetName());
+            Log::UI().info("BookUIManager: Triggering live refresh for '{}'...", currentBook->GetName());
 
             // --- THE SAFE LIVE REFRESH LOGIC ---
 
@@ -51,41 +58,43 @@ namespace DynamicBookFramework {
             
             // Accessing runtimeData.book which is the GFxMovieView GPtr
             if (!runtimeData.book) { 
-                logger::warn("BookUIManager: BookMenu's runtimeData.book (uiMovie) is null.");
+                Log::UI().warn("BookUIManager: BookMenu's runtimeData.book (uiMovie) is null.");
                 return false;
             }
 
             RE::GFxMovieView* currentMovieView = runtimeData.book.get(); // Get raw pointer from GPtr
             if (!currentMovieView) {
-                logger::warn("BookUIManager: runtimeData.book internal pointer is null.");
+                Log::UI().warn("BookUIManager: runtimeData.book internal pointer is null.");
                 return false;
             }
 
             RE::TESObjectBOOK* currentBook = RE::BookMenu::GetTargetForm(); // Static function from RE::BookMenu
             if (!currentBook) {
-                logger::warn("BookUIManager: Could not get target form for the currently open book.");
+                Log::UI().warn("BookUIManager: Could not get target form for the currently open book.");
                 return false;
             }
 
             std::string bookTitle = currentBook->GetFullName() ? currentBook->GetFullName() : "";
             RE::FormID bookFormID = currentBook->GetFormID();
-            logger::info("BookUIManager: Attempting to refresh content for book: '{}' (FormID: {:X})", bookTitle, bookFormID);
+            Log::UI().info("BookUIManager: Attempting to refresh content for book: '{}' (FormID: {:X})", bookTitle, bookFormID);
 
             // Step 1: Tell BookMenuWatcher to reload this book's content from its .txt file
-            bool recached = BookMenuWatcher::GetSingleton()->ReloadAndCacheBook(currentBook); 
+            Profiler::ScopedTimer stageTimer(Profiler::Stage::kRefreshReload);
+            bool recached = !reload || BookMenuWatcher::GetSingleton()->ReloadAndCacheBook(currentBook); 
             if (!recached) {
-                logger::warn("BookUIManager: Failed to reload/re-cache book content for '{}'. Refresh aborted.", bookTitle);
+                Log::UI().warn("BookUIManager: Failed to reload/re-cache book content for '{}'. Refresh aborted.", bookTitle);
                 return false; 
             }
 
             // Step 2: Get the now fresh HTML from BookMenuWatcher's cache
-            auto htmlOpt = BookMenuWatcher::GetSingleton()->GetCachedHtmlForBook(bookFormID); 
-            if (!htmlOpt) { 
-                logger::error("BookUIManager: Failed to get cached HTML for '{}' after successful reload.", bookTitle);
+            auto cachedHtml = BookMenuWatcher::GetSingleton()->GetCachedHtmlForBook(bookFormID); 
+            if (!cachedHtml) { 
+                Log::UI().error("BookUIManager: Failed to get cached HTML for '{}' after successful reload.", bookTitle);
                 return false; 
             }
-            const std::string& fullHtmlToShow = *htmlOpt;
-            logger::trace("BookUIManager: Retrieved fresh HTML from cache (length: {}).", fullHtmlToShow.length());
+            const std::string& fullHtmlToShow = *cachedHtml;
+            stageTimer.Stop();
+            Log::UI().trace("BookUIManager: Retrieved fresh HTML from cache (length: {}).", fullHtmlToShow.length());
 
             // Step 3: Prepare FxResponseArgs and call the game's SetBookText thunk
             // --- FIX: Accessing isNote through the runtimeData reference ---
@@ -96,8 +105,12 @@ namespace DynamicBookFramework {
             fxArgs[1].SetBoolean(isNote);
 
             if (SetBookTextHook::g_rawOriginalThunkPtr) {
-                logger::info("BookUIManager: Re-invoking original SetBookText thunk with new content for '{}'.", bookTitle);
+                Log::UI().info("BookUIManager: Re-invoking original SetBookText thunk with new content for '{}'.", bookTitle);
+                stageTimer.Next(Profiler::Stage::kRefreshSetBookText);
                 SetBookTextHook::g_rawOriginalThunkPtr(currentMovieView, "SetBookText", &fxArgs, 0);
+                stageTimer.Stop();
+                // A search that opened this book is still waiting for its page if the detour showed the placeholder.
+                BookSearch::ApplyPendingJump(currentMovieView, bookFormID);
 
                 // SKSE::ModCallbackEvent modEvent{ "DBF_onToggleInputMode", "", 0.0f, nullptr };
                 // auto* modEventSource = SKSE::GetModCallbackEventSource();
@@ -109,11 +122,29 @@ namespace DynamicBookFramework {
                 // }
                 return true;
             } else {
-                logger::error("BookUIManager: Original SetBookText thunk pointer (g_rawOriginalThunkPtr) is null. Cannot refresh book content.");
+                Log::UI().error("BookUIManager: Original SetBookText thunk pointer (g_rawOriginalThunkPtr) is null. Cannot refresh book content.");
                 return false;
             }
         }
 
+        bool RefreshSavedBook(const std::string& bookTitle, std::string_view fileText) {
+            auto* ui = RE::UI::GetSingleton();
+            if (!ui || !ui->IsMenuOpen(RE::BookMenu::MENU_NAME)) {
+                return false;
+            }
+            auto* currentBook = RE::BookMenu::GetTargetForm();
+            auto record = currentBook ? DynamicBookRegistry::GetSingleton()->FindByFormID(currentBook->GetFormID()) : nullptr;
+            if (!record || record->key != bookTitle) {
+                Log::UI().trace("BookUIManager: '{}' is not the open book. No refresh performed.", bookTitle);
+                return false;
+            }
+            if (!BookMenuWatcher::GetSingleton()->RenderSavedBook(currentBook, fileText)) {
+                Log::UI().warn("BookUIManager: Could not render the saved text of '{}'. Refresh aborted.", bookTitle);
+                return false;
+            }
+            return RefreshCurrentlyOpenBook(false);
+        }
+
     } // namespace BookUIManager
         
 }
\ No newline at end of file
@@ -0,0 +1,95 @@
+//DynamicBookRegistry.cpp
+#include "DynamicBookRegistry.h"
+#include "Utility.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+
+    DynamicBookRegistry* DynamicBookRegistry::GetSingleton() {
+        static DynamicBookRegistry singleton;
+        return &singleton;
+    }
+
+    void DynamicBookRegistry::Rebuild(const std::unordered_map<std::wstring, std::wstring>& bookMappings) {
+        TitleMap<std::shared_ptr<DynamicBookRecord>> byKey;
+        byKey.reserve(bookMappings.size());
+        for (const auto& [title_w, path_w] : bookMappings) {
+            auto record = std::make_shared<DynamicBookRecord>();
+            record->key = wstring_to_utf8(title_w);
+            record->path = path_w;
+            byKey.emplace(record->key, std::move(record));
+        }
+
+        // Walk the book forms once: index every title, and resolve the mapped ones to their record
+        // so neither the open path nor any title lookup ever has to scan the form array again.
+        std::unordered_map<RE::FormID, std::shared_ptr<DynamicBookRecord>> byFormID;
+        TitleMap<RE::TESObjectBOOK*> booksByTitle;
+        if (auto* dataHandler = RE::TESDataHandler::GetSingleton()) {
+            auto& books = dataHandler->GetFormArray<RE::TESObjectBOOK>();
+            booksByTitle.reserve(books.size());
+            for (auto* book : books) {
+                const char* name = book ? book->GetFullName() : nullptr;
+                if (!name || *name == '\0') {
+                    continue;
+                }
+                std::string_view title(name);
+                booksByTitle.try_emplace(std::string(title), book);
+                if (auto it = byKey.find(title); it != byKey.end()) {
+                    byFormID.emplace(book->GetFormID(), it->second);
+                }
+            }
+        } else {
+            logger::warn("DynamicBookRegistry: TESDataHandler not available. Book forms were not resolved.");
+        }
+
+        size_t formCount = byFormID.size();
+        size_t titleCount = byKey.size();
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _byKey = std::move(byKey);
+            _byFormID = std::move(byFormID);
+            _booksByTitle = std::move(booksByTitle);
+        }
+        logger::info("DynamicBookRegistry: Resolved {} book forms for {} mapped titles.", formCount, titleCount);
+    }
+
+    std::shared_ptr<DynamicBookRecord> DynamicBookRegistry::FindByFormID(RE::FormID formID) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _byFormID.find(formID);
+        return it != _byFormID.end() ? it->second : nullptr;
+    }
+
+    std::shared_ptr<DynamicBookRecord> DynamicBookRegistry::FindByKey(std::string_view key) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _byKey.find(key);
+        return it != _byKey.end() ? it->second : nullptr;
+    }
+
+    RE::TESObjectBOOK* DynamicBookRegistry::FindBookByTitle(std::string_view title) const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _booksByTitle.find(title);
+        return it != _booksByTitle.end() ? it->second : nullptr;
+    }
+
+    void DynamicBookRegistry::MarkChanged(std::string_view key) {
+        if (auto record = FindByKey(key)) {
+            record->contentVersion.fetch_add(1);
+        }
+    }
+
+    void DynamicBookRegistry::InvalidateAll() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& [key, record] : _byKey) {
+            record->contentVersion.fetch_add(1);
+        }
+    }
+
+    void DynamicBookRegistry::ForEachRecord(const std::function<void(DynamicBookRecord&)>& a_func) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& [key, record] : _byKey) {
+            a_func(*record);
+        }
+    }
+
+} // namespace DynamicBookFramework
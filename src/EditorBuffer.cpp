@@ -0,0 +1,109 @@
+//EditorBuffer.cpp
+#include "EditorBuffer.h"
+
+#include <algorithm>
+
+
+namespace DynamicBookFramework {
+
+    void EditorBuffer::Assign(std::string a_text) {
+        _text = std::move(a_text);
+        _page.clear();
+        _pageDirty = false;
+        _pageStart = 0;
+        ++_revision;
+        _paged = _text.size() > kPagedThreshold;
+        if (_paged) {
+            RebuildLineIndex();
+            LoadPage();
+        } else {
+            _lineStarts.clear();
+            _pageEnd = 0;
+        }
+    }
+
+    void EditorBuffer::Clear() {
+        Assign({});
+    }
+
+    std::size_t EditorBuffer::GetSize() const {
+        if (!_paged) {
+            return _text.size();
+        }
+        return _text.size() - (LineOffset(_pageEnd) - LineOffset(_pageStart)) + _page.size();
+    }
+
+    void EditorBuffer::CommitPage() {
+        if (!_paged || !_pageDirty) {
+            return;
+        }
+        std::size_t begin = LineOffset(_pageStart);
+        _text.replace(begin, LineOffset(_pageEnd) - begin, _page);
+        _pageDirty = false;
+        RebuildLineIndex();
+        // The page keeps its first line; its end moves with however many lines the edit added or removed.
+        LoadPage();
+    }
+
+    void EditorBuffer::SetPageStart(std::size_t a_line) {
+        if (!_paged) {
+            return;
+        }
+        CommitPage();
+        _pageStart = std::min(a_line, _lineStarts.size() - 1);
+        LoadPage();
+    }
+
+    std::string_view EditorBuffer::GetLine(std::size_t a_index) const {
+        if (a_index >= _lineStarts.size()) {
+            return {};
+        }
+        std::string_view line(_text);
+        line = line.substr(_lineStarts[a_index], LineOffset(a_index + 1) - _lineStarts[a_index]);
+        if (line.ends_with('\n')) {
+            line.remove_suffix(1);
+        }
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        return line;
+    }
+
+    const std::string& EditorBuffer::GetText() {
+        CommitPage();
+        return _text;
+    }
+
+    std::string EditorBuffer::CopyText() const {
+        if (!_paged || !_pageDirty) {
+            return _text;
+        }
+        std::size_t begin = LineOffset(_pageStart);
+        std::size_t end = LineOffset(_pageEnd);
+        std::string text;
+        text.reserve(_text.size() - (end - begin) + _page.size());
+        text.append(_text, 0, begin).append(_page).append(_text, end, std::string::npos);
+        return text;
+    }
+
+    void EditorBuffer::RebuildLineIndex() {
+        _lineStarts.clear();
+        _lineStarts.reserve(_text.size() / 48 + 1);
+        _lineStarts.push_back(0);
+        for (std::size_t pos = _text.find('\n'); pos != std::string::npos; pos = _text.find('\n', pos + 1)) {
+            _lineStarts.push_back(pos + 1);
+        }
+    }
+
+    void EditorBuffer::LoadPage() {
+        _pageStart = std::min(_pageStart, _lineStarts.size() - 1);
+        _pageEnd = std::min(_pageStart + kPageLines, _lineStarts.size());
+        std::size_t begin = LineOffset(_pageStart);
+        _page.assign(_text, begin, LineOffset(_pageEnd) - begin);
+    }
+
+    std::size_t EditorBuffer::LineOffset(std::size_t a_line) const {
+        return a_line < _lineStarts.size() ? _lineStarts[a_line] : _text.size();
+    }
+
+} // namespace DynamicBookFramework
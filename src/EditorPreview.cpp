@@ -0,0 +1,216 @@
+//EditorPreview.cpp
+#include "EditorPreview.h"
+#include "EditorBuffer.h"
+#include "BlockCodec.h"
+#include "SegmentStore.h"
+#include "WorkerPool.h"
+#include "Utility.h"
+#include "Log.h"
+#include "Trace.h"
+#include "PCH.h"
+#include <charconv>
+
+
+namespace DynamicBookFramework {
+
+    namespace { // Anonymous namespace for source cleanup and HTML scanning
+
+        constexpr std::string_view kRawHtmlMarker = ";;RAW_HTML;;";
+
+        // The editor shows the file as stored: CRLF line ends, compressed save blocks, and the save-block and
+        // journal markers the session manager strips before formatting. Undo them so the preview sees what the
+        // book pipeline sees.
+        std::string PrepareSource(std::string_view a_text) {
+            std::string source;
+            source.reserve(a_text.size());
+            std::size_t pos = 0;
+            std::optional<std::size_t> rawSize; // Set inside a compressed block
+            std::string encoded;
+            while (pos < a_text.size()) {
+                std::size_t lineEnd = a_text.find('\n', pos);
+                lineEnd = lineEnd == std::string_view::npos ? a_text.size() : lineEnd + 1;
+                std::string_view line = a_text.substr(pos, lineEnd - pos);
+                pos = lineEnd;
+                if (line.starts_with(";;SAVE_BLOCK ")) {
+                    rawSize = BlockCodec::GetRawSize(line);
+                    encoded.clear();
+                    continue;
+                }
+                if (line.starts_with(";;END_SAVE_DATA;;") && rawSize) {
+                    source += BlockCodec::Decode(encoded, *rawSize).value_or(std::string());
+                    rawSize.reset();
+                    continue;
+                }
+                if (line.starts_with(";;END_SAVE_DATA;;") || line.starts_with(SegmentStore::kJournalMarker)) {
+                    continue;
+                }
+                if (rawSize) {
+                    encoded.append(line);
+                    continue;
+                }
+                for (char c : line) {
+                    if (c != '\r') {
+                        source.push_back(c);
+                    }
+                }
+            }
+            return source;
+        }
+
+        // Value of name='...' or name="..." inside a tag, or empty.
+        std::string_view GetAttribute(std::string_view a_tag, std::string_view a_name) {
+            std::size_t pos = 0;
+            while ((pos = a_tag.find(a_name, pos)) != std::string_view::npos) {
+                std::size_t valueStart = pos + a_name.size();
+                if (valueStart + 1 < a_tag.size() && a_tag[valueStart] == '=' && (a_tag[valueStart + 1] == '\'' || a_tag[valueStart + 1] == '"')) {
+                    char quote = a_tag[valueStart + 1];
+                    std::size_t valueEnd = a_tag.find(quote, valueStart + 2);
+                    if (valueEnd != std::string_view::npos) {
+                        return a_tag.substr(valueStart + 2, valueEnd - valueStart - 2);
+                    }
+                }
+                pos = valueStart;
+            }
+            return {};
+        }
+
+        // Text content of a line of markup: <br> becomes a line break, every other tag is dropped.
+        std::string StripTags(std::string_view a_html) {
+            std::string text;
+            text.reserve(a_html.size());
+            std::size_t pos = 0;
+            while (pos < a_html.size()) {
+                if (a_html[pos] != '<') {
+                    text.push_back(a_html[pos++]);
+                    continue;
+                }
+                std::size_t tagEnd = a_html.find('>', pos);
+                if (tagEnd == std::string_view::npos) {
+                    text.append(a_html.substr(pos));
+                    break;
+                }
+                std::string_view tag = a_html.substr(pos + 1, tagEnd - pos - 1);
+                if (tag == "br" || tag == "br/" || tag == "br /") {
+                    text.push_back('\n');
+                }
+                pos = tagEnd + 1;
+            }
+            return text;
+        }
+
+        std::uint32_t ParseDimension(std::string_view a_value) {
+            std::uint32_t value = 0;
+            std::from_chars(a_value.data(), a_value.data() + a_value.size(), value);
+            return value;
+        }
+    }
+
+    EditorPreview::EditorPreview() :
+        _state(std::make_shared<State>([](const std::string& a_chunk) { return HtmlFormatText::ApplyGeneralBookMarkup_ProcessChunk(a_chunk); })) {}
+
+    std::vector<PreviewBlock> EditorPreview::ParseHtml(std::string_view a_html, std::span<const std::size_t> a_segmentKeys,
+        std::span<const std::size_t> a_segmentEnds) {
+        std::vector<PreviewBlock> blocks;
+        std::size_t pos = 0;
+        std::size_t segment = 0;
+        while (pos < a_html.size()) {
+            while (segment + 1 < a_segmentEnds.size() && pos >= a_segmentEnds[segment]) {
+                ++segment;
+            }
+            std::size_t lineEnd = a_html.find('\n', pos);
+            lineEnd = lineEnd == std::string_view::npos ? a_html.size() : lineEnd;
+            std::string_view line = a_html.substr(pos, lineEnd - pos);
+            pos = lineEnd + 1;
+
+            std::size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos) {
+                continue;
+            }
+            line = line.substr(first);
+
+            PreviewBlock block;
+            block.segment = segment < a_segmentKeys.size() ? a_segmentKeys[segment] : 0;
+            if (line.find("[pagebreak]") != std::string_view::npos || line.find("[Pagebreak]") != std::string_view::npos) {
+                block.type = PreviewBlock::Type::kPagebreak;
+            } else if (auto imgStart = line.find("<img "); imgStart != std::string_view::npos) {
+                std::string_view tag = line.substr(imgStart, line.find('>', imgStart) - imgStart);
+                std::string_view source = GetAttribute(tag, "src");
+                if (source.starts_with("img://")) {
+                    source.remove_prefix(6);
+                }
+                block.type = PreviewBlock::Type::kImage;
+                block.text.assign(source);
+                block.width = ParseDimension(GetAttribute(tag, "width"));
+                block.height = ParseDimension(GetAttribute(tag, "height"));
+            } else if (line.starts_with("<li>")) {
+                block.type = PreviewBlock::Type::kListItem;
+                block.text = StripTags(line);
+            } else {
+                if (line.starts_with("<p")) {
+                    block.align.assign(GetAttribute(line.substr(0, line.find('>')), "align"));
+                }
+                block.text = StripTags(line);
+                if (block.text.find_first_not_of(" \t\n") == std::string::npos) {
+                    continue; // <ul>, <font>, closing tags and other lines without text
+                }
+            }
+            blocks.push_back(std::move(block));
+        }
+        return blocks;
+    }
+
+    void EditorPreview::Update(const EditorBuffer& a_buffer) {
+        auto now = std::chrono::steady_clock::now();
+        std::uint64_t revision = a_buffer.GetRevision();
+        if (revision != _seenRevision) {
+            _seenRevision = revision;
+            _lastChange = now;
+        }
+        if ((revision == _submittedRevision && GetDocument()) || now - _lastChange < kTypingPause) {
+            return;
+        }
+        // One preview at a time; if one is still running, the next frame tries again.
+        if (_state->running.exchange(true)) {
+            return;
+        }
+        _submittedRevision = revision;
+
+        WorkerPool::GetSingleton()->Submit([state = _state, text = a_buffer.CopyText(), revision]() {
+            Trace::ScopedEvent traceEvent("EditorPreview", "ui");
+            auto start = std::chrono::steady_clock::now();
+            auto document = std::make_shared<PreviewDocument>();
+            document->revision = revision;
+            try {
+                std::string source = PrepareSource(text);
+                if (source.starts_with(kRawHtmlMarker)) {
+                    std::size_t markerLineEnd = source.find('\n');
+                    document->blocks = ParseHtml(markerLineEnd != std::string::npos ? std::string_view(source).substr(markerLineEnd + 1) : std::string_view());
+                } else {
+                    auto result = state->formatter.Format(source);
+                    document->blocks = ParseHtml(result.html, result.segmentKeys, result.segmentEnds);
+                    document->segments = result.segments;
+                    document->formattedSegments = result.formattedSegments;
+                }
+            } catch (const std::exception& e) {
+                Log::UI().error("EditorPreview: Formatting the preview failed: {}", e.what());
+            }
+            document->milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            {
+                std::lock_guard<std::mutex> lock(state->mutex);
+                state->document = std::move(document);
+            }
+            state->running.store(false);
+        }, WorkerPool::Priority::kNormal);
+    }
+
+    std::shared_ptr<const PreviewDocument> EditorPreview::GetDocument() const {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        return _state->document;
+    }
+
+    bool EditorPreview::IsStale(const EditorBuffer& a_buffer) const {
+        auto document = GetDocument();
+        return _state->running.load() || !document || document->revision != a_buffer.GetRevision();
+    }
+
+} // namespace DynamicBookFramework
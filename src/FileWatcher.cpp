@@ -1,6 +1,10 @@
 #include "FileWatcher.h"
 #include "BookUIManager.h" // To call RefreshCurrentlyOpenBook()
+#include "BookMenuWatcher.h"
 #include "Utility.h"       // For logger alias
+#include "Log.h"
+#include "Trace.h"
+#include "BookSearch.h"
 #include "PCH.h"           // For common headers
 
 namespace DynamicBookFramework { // Using your project-wide namespace
@@ -36,6 +40,7 @@ namespace DynamicBookFramework { // Using your project-wide namespace
                 if (filesToCheck.empty()) {
                     continue;
                 }
+                Trace::ScopedEvent traceEvent("WatcherTick", "watcher");
                 
                 for (auto& pair : filesToCheck) {
                     const std::string& bookTitle = pair.first;
@@ -46,48 +51,59 @@ namespace DynamicBookFramework { // Using your project-wide namespace
                             auto currentWriteTime = std::filesystem::last_write_time(fileInfo.path);
 
                             if (currentWriteTime > fileInfo.lastWriteTime) {
-                                logger::info("FileWatcher: Detected change in '{}'.", wstring_to_utf8(fileInfo.path.wstring()).c_str());
                                 {
                                     std::lock_guard<std::mutex> lock(g_monitoredFilesMutex);
-                                    if (g_monitoredFiles.count(bookTitle)) {
-                                        g_monitoredFiles[bookTitle].lastWriteTime = currentWriteTime;
+                                    auto it = g_monitoredFiles.find(bookTitle);
+                                    // Already recorded by NotifyFileUpdated since the snapshot was taken.
+                                    if (it == g_monitoredFiles.end() || it->second.lastWriteTime >= currentWriteTime) {
+                                        continue;
                                     }
+                                    it->second.lastWriteTime = currentWriteTime;
                                 }
+                                Log::Watcher().info("FileWatcher: Detected change in '{}'.", wstring_to_utf8(fileInfo.path.wstring()).c_str());
+                                BookSearch::Reindex(bookTitle);
                                 
                                 // --- FIX: Use the std::function overload of AddTask with a lambda ---
                                 if (auto* taskInterface = SKSE::GetTaskInterface()) {
-                                    taskInterface->AddTask([]() {
+                                    // Tied to the book that is open now; skipped if the menu closes or another book opens first.
+                                    auto cancel = BookMenuWatcher::GetSingleton()->GetCurrentLoadToken();
+                                    taskInterface->AddTask([cancel]() {
+                                        if (cancel.IsCancelled()) {
+                                            Log::Watcher().debug("FileWatcher Task: Book menu changed since the refresh was queued. Skipping.");
+                                            return;
+                                        }
                                         // This code will be executed on the main game thread
-                                        logger::info("FileWatcher Task: Running RefreshCurrentlyOpenBook() on main thread via lambda.");
+                                        Trace::ScopedEvent taskEvent("MainThreadTask: Refresh", "task");
+                                        Log::Watcher().info("FileWatcher Task: Running RefreshCurrentlyOpenBook() on main thread via lambda.");
                                         BookUIManager::RefreshCurrentlyOpenBook();
                                     });
                                 }
                             }
                         }
                     } catch (const std::filesystem::filesystem_error& e) {
-                        logger::error("FileWatcher: Filesystem error while checking '{}': {}", wstring_to_utf8(fileInfo.path.wstring()).c_str(), e.what());
+                        Log::Watcher().error("FileWatcher: Filesystem error while checking '{}': {}", wstring_to_utf8(fileInfo.path.wstring()).c_str(), e.what());
                     }
                 }
             }
-            logger::info("FileWatcher: Watcher thread loop has finished.");
+            Log::Watcher().info("FileWatcher: Watcher thread loop has finished.");
         }
 
         void Start() {
             if (g_watcherThread.joinable()) {
-                logger::warn("FileWatcher: Start() called, but watcher thread is already running.");
+                Log::Watcher().warn("FileWatcher: Start() called, but watcher thread is already running.");
                 return;
             }
-            logger::info("FileWatcher: Starting watcher thread...");
+            Log::Watcher().info("FileWatcher: Starting watcher thread...");
             g_stopWatcherFlag.store(false);
             g_watcherThread = std::thread(WatchFilesLoop);
         }
 
         void Stop() {
             if (g_watcherThread.joinable()) {
-                logger::info("FileWatcher: Stopping watcher thread...");
+                Log::Watcher().info("FileWatcher: Stopping watcher thread...");
                 g_stopWatcherFlag.store(true);
                 g_watcherThread.join(); 
-                logger::info("FileWatcher: Watcher thread stopped.");
+                Log::Watcher().info("FileWatcher: Watcher thread stopped.");
             }
         }
 
@@ -99,19 +115,32 @@ namespace DynamicBookFramework { // Using your project-wide namespace
                     info.path = filePath;
                     info.lastWriteTime = std::filesystem::last_write_time(filePath);
                     g_monitoredFiles[bookTitle] = info;
-                    logger::info("FileWatcher: Now monitoring '{}' for changes.", wstring_to_utf8(filePath.wstring()).c_str());
+                    Log::Watcher().info("FileWatcher: Now monitoring '{}' for changes.", wstring_to_utf8(filePath.wstring()).c_str());
                 } else {
-                    logger::warn("FileWatcher: Cannot monitor file '{}' because it does not exist.", wstring_to_utf8(filePath.wstring()).c_str());
+                    Log::Watcher().warn("FileWatcher: Cannot monitor file '{}' because it does not exist.", wstring_to_utf8(filePath.wstring()).c_str());
                 }
             } catch (const std::filesystem::filesystem_error& e) {
-                logger::error("FileWatcher: Filesystem error accessing '{}': {}", wstring_to_utf8(filePath.wstring()).c_str(), e.what());
+                Log::Watcher().error("FileWatcher: Filesystem error accessing '{}': {}", wstring_to_utf8(filePath.wstring()).c_str(), e.what());
             }
         }
 
         void StopMonitoringBookFile(const std::string& bookTitle) {
             std::lock_guard<std::mutex> lock(g_monitoredFilesMutex);
             if (g_monitoredFiles.erase(bookTitle) > 0) {
-                logger::info("FileWatcher: Stopped monitoring book '{}'.", bookTitle);
+                Log::Watcher().info("FileWatcher: Stopped monitoring book '{}'.", bookTitle);
+            }
+        }
+
+        void NotifyFileUpdated(const std::string& bookTitle) {
+            std::lock_guard<std::mutex> lock(g_monitoredFilesMutex);
+            auto it = g_monitoredFiles.find(bookTitle);
+            if (it == g_monitoredFiles.end()) {
+                return;
+            }
+            std::error_code ec;
+            auto writeTime = std::filesystem::last_write_time(it->second.path, ec);
+            if (!ec) {
+                it->second.lastWriteTime = writeTime;
             }
         }
 
@@ -5,6 +5,22 @@
 #include "Settings.h"
 #include "BookUIManager.h"
 #include "Utility.h"
+#include "DynamicBookRegistry.h"
+#include "InputListener.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "BookMenuWatcher.h"
+#include "ImageRegistry.h"
+#include "EditorBuffer.h"
+#include "EditorPreview.h"
+#include "PreviewLayout.h"
+#include "BookFile.h"
+#include "FileWatcher.h"
+#include "BookSearch.h"
+#include "BookPakRegistry.h"
+
+namespace Log = DynamicBookFramework::Log;
 
 
 
@@ -20,7 +36,7 @@ namespace ImGuiRender {
         // This call is correct for this library.
         EditorWindow = SKSEMenuFramework::AddWindow(RenderEditorWindow);
         //ImGui::StyleColorsDark();
-        logger::info("Registered Dynamic Book Editor window.");
+        Log::UI().info("Registered Dynamic Book Editor window.");
     }
 
     // Public function to toggle the menu's visibility.
@@ -57,7 +73,7 @@ namespace ImGuiRender {
         // 1. Create the new book's .txt file
         std::ofstream bookFile(bookPath);
         if (!bookFile.is_open()) {
-            logger::error("Failed to create new book file at: {}", bookPath.string());
+            Log::UI().error("Failed to create new book file at: {}", bookPath.string());
             return false;
         }
         bookFile << "--- " << bookTitle << " ---\n\n";
@@ -88,29 +104,78 @@ namespace ImGuiRender {
             // 4. Now, write the new book mapping.
             iniFile << bookTitle << " = " << safeFilename << "\n";
             iniFile.close();
-            logger::info("New book '{}' added to INI.", bookTitle);
+            Log::UI().info("New book '{}' added to INI.", bookTitle);
         } else {
-            logger::error("Failed to open INI file to add new book mapping.");
+            Log::UI().error("Failed to open INI file to add new book mapping.");
             // We don't return false, because the .txt file was still created.
             // The user can add the mapping manually if needed.
         }
 
-        // 3. Reload the mappings so the new book appears in the list.
-        LoadBookMappings();
+        // 3. Reload the mappings so the new book appears in the list. UserBooks.ini may be new, so list the folder.
+        LoadBookMappings(DynamicBookFramework::BookMappingCache::ScanMode::kListFolder);
+        return true;
+    }
+
+    namespace { // Anonymous namespace for the editor's view of the file on disk
+        // What the editor last read from or wrote to disk, so a save only has to write what changed.
+        std::string g_diskTitle;
+        std::string g_diskContent;
+    }
+
+    // Reads a book's file byte for byte, so editor offsets match the file when saving.
+    bool LoadBookFile(const std::string& bookTitle, std::string& content) {
+        content.clear();
+        auto record = DynamicBookFramework::DynamicBookRegistry::GetSingleton()->FindByKey(bookTitle);
+        if (!record) return false;
+        std::ifstream file(record->path, std::ios::binary | std::ios::ate);
+        if (file.is_open()) {
+            auto size = file.tellg();
+            if (size < 0) {
+                Log::UI().error("Could not read the size of {}.", wstring_to_utf8(record->path.wstring()));
+                return false;
+            }
+            content.resize(static_cast<std::size_t>(size));
+            file.seekg(0);
+            if (!file.read(content.data(), static_cast<std::streamsize>(content.size()))) {
+                Log::UI().error("Could not read {}.", wstring_to_utf8(record->path.wstring()));
+                content.clear();
+                return false;
+            }
+        } else if (auto packed = DynamicBookFramework::BookPakRegistry::Read(bookTitle, record->path)) {
+            // A packed book is edited from the archive; the first save writes the loose file that overrides it.
+            content = std::move(*packed);
+        } else {
+            return false;
+        }
+        g_diskTitle = bookTitle;
+        g_diskContent = content;
         return true;
     }
 
-    // Helper function to write to files.
+    // Saves through BookFile, then tells the watcher and the registry directly instead of waiting for the
+    // watcher to notice the new timestamp. The caller refreshes the open book.
     bool WriteBookFile(const std::string& bookTitle, const std::string& content) {
-        if (auto pathOpt = GetDynamicBookPathByTitle(string_to_wstring(bookTitle))) {
-            std::filesystem::path bookPath = *pathOpt;
-            std::ofstream bookFile(bookPath, std::ios::out | std::ios::trunc);
-            if (!bookFile.is_open()) return false;
-            bookFile << content;
-            bookFile.close();
-            return true;
-        }
-        return false;
+        using namespace DynamicBookFramework;
+        auto record = DynamicBookRegistry::GetSingleton()->FindByKey(bookTitle);
+        if (!record) return false;
+
+        std::string_view previous = g_diskTitle == bookTitle ? std::string_view(g_diskContent) : std::string_view();
+        std::error_code ec;
+        std::filesystem::create_directories(record->path.parent_path(), ec); // A packed-only mod may not ship the books folder
+        auto mode = BookFile::Save(record->path, previous, content);
+        if (mode == BookFile::WriteMode::kFailed) {
+            Log::UI().error("Failed to save '{}' to {}.", bookTitle, wstring_to_utf8(record->path.wstring()));
+            return false;
+        }
+        Log::UI().info("Saved '{}' ({}, {} bytes).", bookTitle, BookFile::GetWriteModeName(mode), content.size());
+        g_diskTitle = bookTitle;
+        g_diskContent = content;
+        if (mode != BookFile::WriteMode::kUnchanged) {
+            FileWatcher::NotifyFileUpdated(bookTitle);
+            DynamicBookRegistry::GetSingleton()->MarkChanged(bookTitle);
+            BookSearch::Reindex(bookTitle);
+        }
+        return true;
     }
 
     void RenderHotkeyButton(const char* label, int& hotkeySetting) {
@@ -136,6 +201,7 @@ namespace ImGuiRender {
                     int dxScancode = Settings::ImGuiKeyToDXScancode(static_cast<ImGuiKey>(key));
                     if (dxScancode != 0) {
                         hotkeySetting = dxScancode;
+                        InputListener::GetSingleton()->RebuildActionTable();
                     }
                     isWaiting = false;
                     break;
@@ -163,6 +229,7 @@ namespace ImGuiRender {
                     int dxScancode = Settings::ImGuiKeyToDXScancode(static_cast<ImGuiKey>(key));
                     if (dxScancode != 0) {
                         hotkeySetting = dxScancode;
+                        InputListener::GetSingleton()->RebuildActionTable();
                     }
                     isWaiting = false;
                     break;
@@ -179,6 +246,444 @@ namespace ImGuiRender {
         }
     }
 
+    // Save blocks and history records left behind by deleted saves. Scan reports what Compact would remove.
+    // Compact also compresses old blocks (or expands them when compression is off); Recompress only does that.
+    // Below that, converting the books between single files and per-timeline segments.
+    void RenderSaveDataSection() {
+        using namespace DynamicBookFramework;
+        auto* sessionManager = SessionDataManager::GetSingleton();
+
+        ImGui::SeparatorText("Save Data");
+        bool settingsChanged = ImGui::Checkbox("Compact after the first load of each session", &Settings::compactSaveDataOnLoad);
+        ImGui::SetNextItemWidth(120.0f);
+        if (ImGui::InputInt("Recent timelines to keep whole", &Settings::keepRecentTimelines)) {
+            Settings::keepRecentTimelines = std::clamp(Settings::keepRecentTimelines, 0, 100);
+            settingsChanged = true;
+        }
+        settingsChanged |= ImGui::Checkbox("Compress the save blocks of older saves", &Settings::compressColdBlocks);
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Old blocks are stored LZ4-compressed and decompressed only when a journal shows them.");
+        }
+        ImGui::SetNextItemWidth(120.0f);
+        if (ImGui::InputInt("Recent saves per timeline left uncompressed", &Settings::plainRecentSaves)) {
+            Settings::plainRecentSaves = std::clamp(Settings::plainRecentSaves, 0, 1000);
+            settingsChanged = true;
+        }
+        if (settingsChanged) {
+            Settings::SaveSettings();
+        }
+
+        SaveCompactor::RetentionPolicy policy;
+        policy.keepRecentTimelines = static_cast<std::size_t>(Settings::keepRecentTimelines);
+        policy.compressColdBlocks = Settings::compressColdBlocks;
+        policy.plainRecentSaves = static_cast<std::size_t>(Settings::plainRecentSaves);
+        bool busy = sessionManager->IsMaintenanceRunning();
+        if (busy) {
+            ImGui::BeginDisabled();
+        }
+        if (ImGui::Button("Scan")) {
+            sessionManager->ScheduleCompaction(policy, true);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Compact")) {
+            sessionManager->ScheduleCompaction(policy, false);
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Recompress")) {
+            auto recodeOnly = policy;
+            recodeOnly.removeUnreachable = false;
+            sessionManager->ScheduleCompaction(recodeOnly, false);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Compresses or expands save blocks to match the settings above without removing any.");
+        }
+        if (busy) {
+            ImGui::EndDisabled();
+            ImGui::SameLine();
+            ImGui::TextDisabled("Working...");
+        }
+
+        if (auto report = sessionManager->GetLastCompactionReport(); report && !report->skippedReason.empty()) {
+            ImGui::TextDisabled("Skipped: %s", report->skippedReason.c_str());
+        } else if (report) {
+            if (!report->compressionOnly) {
+                ImGui::Text("%s %zu of %zu save blocks in %zu of %zu books, and %zu history records (%zu saves found, %zu reachable).",
+                    report->dryRun ? "Unreachable:" : "Removed", report->blocksRemoved, report->blocksKept + report->blocksRemoved,
+                    report->booksRewritten, report->booksScanned, report->historyRecordsRemoved, report->savesFound, report->liveSaves);
+            }
+            if (report->compressionOnly || report->blocksCompressed + report->blocksExpanded > 0) {
+                ImGui::Text("%s %zu save blocks and %s %zu.", report->dryRun ? "Would compress" : "Compressed", report->blocksCompressed,
+                    report->dryRun ? "expand" : "expanded", report->blocksExpanded);
+            }
+            ImGui::Text("%.2f MB -> %.2f MB in %.0f ms.", static_cast<double>(report->bytesBefore) / (1024.0 * 1024.0),
+                static_cast<double>(report->bytesAfter) / (1024.0 * 1024.0), report->milliseconds);
+            if (report->booksChangedMeanwhile > 0) {
+                ImGui::TextDisabled("%zu books changed during the pass and were left for next time.", report->booksChangedMeanwhile);
+            }
+        }
+
+        ImGui::Spacing();
+        ImGui::TextUnformatted("Storage:");
+        ImGui::SameLine();
+        if (busy) {
+            ImGui::BeginDisabled();
+        }
+        if (ImGui::Button("Split by Timeline")) {
+            sessionManager->ScheduleStorageMigration(true);
+        }
+        if (ImGui::IsItemHovered()) {
+            ImGui::SetTooltip("Keeps each book's save blocks in one file per timeline, so a journal opens only its own character's history.");
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Merge to Single Files")) {
+            sessionManager->ScheduleStorageMigration(false);
+        }
+        if (busy) {
+            ImGui::EndDisabled();
+        }
+        if (auto report = sessionManager->GetLastStorageMigrationReport()) {
+            ImGui::Text("%s %zu books (%zu blocks, %zu segments), %zu already were, %zu failed, in %.0f ms.",
+                report->toSegments ? "Split" : "Merged", report->booksConverted, report->blocksMoved, report->segments,
+                report->booksAlready, report->booksFailed, report->milliseconds);
+            if (!report->firstError.empty()) {
+                ImGui::TextDisabled("%s", report->firstError.c_str());
+            }
+        }
+    }
+
+    // Per-stage timings collected by Profiler::ScopedTimer, in milliseconds.
+    void RenderPerformanceTab() {
+        using namespace DynamicBookFramework;
+        static std::string lastTraceMessage;
+
+        if (ImGui::Button("Reset")) {
+            Profiler::Reset();
+            BookMenuWatcher::GetSingleton()->GetTextCache().ResetCounters();
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Dump Trace")) {
+            if (auto tracePath = Trace::DumpToLogFolder()) {
+                lastTraceMessage = "Trace written to " + tracePath->filename().string();
+            } else {
+                lastTraceMessage = "Could not write the trace. See the plugin log.";
+            }
+        }
+        ImGui::SameLine();
+        ImGui::TextDisabled("Times in ms. Percentiles are histogram estimates.");
+        if (!lastTraceMessage.empty()) {
+            ImGui::TextDisabled("%s", lastTraceMessage.c_str());
+        }
+        ImGui::Spacing();
+
+        constexpr ImGuiTableFlags tableFlags = ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_SizingStretchProp;
+        if (ImGui::BeginTable("perf_table", 7, tableFlags)) {
+            ImGui::TableSetupColumn("Stage", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+            ImGui::TableSetupColumn("Count");
+            ImGui::TableSetupColumn("Mean");
+            ImGui::TableSetupColumn("p50");
+            ImGui::TableSetupColumn("p95");
+            ImGui::TableSetupColumn("p99");
+            ImGui::TableSetupColumn("Max");
+            ImGui::TableHeadersRow();
+
+            auto toMs = [](std::uint64_t a_ns) { return static_cast<double>(a_ns) / 1'000'000.0; };
+            for (std::size_t i = 0; i < static_cast<std::size_t>(Profiler::Stage::kCount); ++i) {
+                auto stage = static_cast<Profiler::Stage>(i);
+                auto stats = Profiler::GetStats(stage);
+
+                ImGui::TableNextRow();
+                ImGui::TableSetColumnIndex(0);
+                ImGui::Text("%s", Profiler::GetStageName(stage));
+                ImGui::TableSetColumnIndex(1);
+                ImGui::Text("%llu", static_cast<unsigned long long>(stats.count));
+                if (stats.count == 0) {
+                    continue;
+                }
+                ImGui::TableSetColumnIndex(2);
+                ImGui::Text("%.3f", toMs(stats.totalNs) / static_cast<double>(stats.count));
+                ImGui::TableSetColumnIndex(3);
+                ImGui::Text("%.3f", toMs(stats.p50Ns));
+                ImGui::TableSetColumnIndex(4);
+                ImGui::Text("%.3f", toMs(stats.p95Ns));
+                ImGui::TableSetColumnIndex(5);
+                ImGui::Text("%.3f", toMs(stats.p99Ns));
+                ImGui::TableSetColumnIndex(6);
+                ImGui::Text("%.3f", toMs(stats.maxNs));
+            }
+            ImGui::EndTable();
+        }
+
+        ImGui::Spacing();
+        auto& textCache = BookMenuWatcher::GetSingleton()->GetTextCache();
+        auto cacheStats = textCache.GetStats();
+        ImGui::Text("Rendered text cache: %zu books, %.2f / %.2f MB", cacheStats.entries,
+            static_cast<double>(cacheStats.bytes) / (1024.0 * 1024.0), static_cast<double>(cacheStats.byteBudget) / (1024.0 * 1024.0));
+        ImGui::Text("Hits: %llu  Misses: %llu  Evictions: %llu", static_cast<unsigned long long>(cacheStats.hits),
+            static_cast<unsigned long long>(cacheStats.misses), static_cast<unsigned long long>(cacheStats.evictions));
+
+        auto imageStats = ImageRegistry::GetSingleton()->GetStats();
+        ImGui::Text("Image textures: %zu images, %.2f / %.2f MB", imageStats.entries,
+            static_cast<double>(imageStats.bytes) / (1024.0 * 1024.0), static_cast<double>(imageStats.byteBudget) / (1024.0 * 1024.0));
+        ImGui::Text("LoadPNG: %llu  Reused: %llu  Evictions: %llu  Read ahead: %llu", static_cast<unsigned long long>(imageStats.uploads),
+            static_cast<unsigned long long>(imageStats.reuses), static_cast<unsigned long long>(imageStats.evictions),
+            static_cast<unsigned long long>(imageStats.warmed));
+
+        ImGui::Spacing();
+        RenderSaveDataSection();
+    }
+
+    // Searches every dynamic book as the query is typed. Open shows the book at the page holding the hit.
+    void RenderSearchTab() {
+        using namespace DynamicBookFramework;
+        static char queryBuffer[256] = "";
+        static std::string lastQuery;
+        static std::uint64_t lastVersion = 0;
+        static std::vector<SearchIndex::Hit> hits;
+        static SearchIndex::Stats stats;
+
+        ImGui::SetNextItemWidth(-1.0f);
+        ImGui::InputTextWithHint("##SearchQuery", "Search all dynamic books...", queryBuffer, sizeof(queryBuffer));
+
+        // Only query again when the text or the index changed.
+        std::uint64_t version = BookSearch::GetVersion();
+        if (lastQuery != queryBuffer || lastVersion != version) {
+            lastQuery = queryBuffer;
+            lastVersion = version;
+            hits = BookSearch::Query(lastQuery);
+            stats = BookSearch::GetStats();
+        }
+
+        if (BookSearch::IsBuilding()) {
+            ImGui::TextDisabled("Indexing books... (%zu so far)", stats.books);
+        } else {
+            ImGui::TextDisabled("%zu books, %zu words, %.2f MB indexed in %.0f ms.", stats.books, stats.tokens,
+                static_cast<double>(stats.memoryBytes) / (1024.0 * 1024.0), BookSearch::GetLastBuildMilliseconds());
+        }
+        if (!lastQuery.empty()) {
+            ImGui::TextDisabled(hits.size() >= BookSearch::kMaxHits ? "First %zu matches." : "%zu matches.", hits.size());
+        }
+        ImGui::Separator();
+
+        ImVec2 avail{};
+        ImGui::GetContentRegionAvail(&avail);
+        ImGui::BeginChild("SearchResults", avail, false, 0);
+        auto* clipper = ImGui::ImGuiListClipperManager::Create();
+        ImGui::ImGuiListClipperManager::Begin(clipper, static_cast<int>(hits.size()), ImGui::GetFrameHeightWithSpacing());
+        while (ImGui::ImGuiListClipperManager::Step(clipper)) {
+            for (int i = clipper->DisplayStart; i < clipper->DisplayEnd; ++i) {
+                const auto& hit = hits[static_cast<std::size_t>(i)];
+                ImGui::PushID(i);
+                if (ImGui::SmallButton("Open")) {
+                    BookSearch::OpenAtHit(hit.bookKey, hit.anchor);
+                }
+                ImGui::SameLine();
+                ImGui::TextDisabled("%s", hit.bookKey.c_str());
+                ImGui::SameLine();
+                ImGui::TextUnformatted(hit.snippet.c_str(), hit.snippet.c_str() + hit.snippet.size());
+                ImGui::PopID();
+            }
+        }
+        ImGui::ImGuiListClipperManager::End(clipper);
+        ImGui::ImGuiListClipperManager::Destroy(clipper);
+        ImGui::EndChild();
+    }
+
+    // Lets InputTextMultiline grow a std::string instead of writing into a fixed char array.
+    int InputTextResizeCallback(ImGuiInputTextCallbackData* data) {
+        if (data->EventFlag == ImGuiInputTextFlags_CallbackResize) {
+            auto* str = static_cast<std::string*>(data->UserData);
+            str->resize(data->BufTextLen);
+            data->Buf = str->data();
+        }
+        return 0;
+    }
+
+    bool InputTextMultiline(const char* label, std::string& text, const ImVec2& size) {
+        return ImGui::InputTextMultiline(label, text.data(), text.capacity() + 1, size,
+                                         ImGuiInputTextFlags_CallbackResize, InputTextResizeCallback, &text);
+    }
+
+    // Small books are one text box. Large ones get a line-virtualised read-only view (click a line to edit
+    // from there) above a text box holding a single page, so neither widget lays out the whole book per frame.
+    void RenderEditorContent(DynamicBookFramework::EditorBuffer& buffer) {
+        using DynamicBookFramework::EditorBuffer;
+        if (!buffer.IsPaged()) {
+            if (InputTextMultiline("##Editor", buffer.GetEditText(), ImVec2(-FLT_MIN, -FLT_MIN))) {
+                buffer.MarkEdited();
+            }
+            return;
+        }
+
+        std::size_t lineCount = buffer.GetLineCount();
+        ImGui::Text("Lines %zu-%zu of %zu (%.2f MB)", buffer.GetPageStart() + 1, buffer.GetPageEnd(), lineCount,
+            static_cast<double>(buffer.GetSize()) / (1024.0 * 1024.0));
+        ImGui::SameLine();
+        if (ImGui::SmallButton("< Prev")) {
+            buffer.SetPageStart(buffer.GetPageStart() > EditorBuffer::kPageLines ? buffer.GetPageStart() - EditorBuffer::kPageLines : 0);
+        }
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Next >")) {
+            buffer.SetPageStart(buffer.GetPageStart() + EditorBuffer::kPageLines);
+        }
+
+        ImVec2 avail{};
+        ImGui::GetContentRegionAvail(&avail);
+        ImGui::BeginChild("EditorLines", ImVec2(avail.x, avail.y * 0.4f), true, 0);
+        ImGui::PushTextWrapPos(-1.0f); // Unwrapped, so every row has the height the clipper assumes
+        auto* clipper = ImGui::ImGuiListClipperManager::Create();
+        ImGui::ImGuiListClipperManager::Begin(clipper, static_cast<int>(lineCount), ImGui::GetTextLineHeightWithSpacing());
+        while (ImGui::ImGuiListClipperManager::Step(clipper)) {
+            for (int i = clipper->DisplayStart; i < clipper->DisplayEnd; ++i) {
+                auto line = static_cast<std::size_t>(i);
+                if (line >= buffer.GetPageStart() && line < buffer.GetPageEnd()) {
+                    ImGui::Text("%6zu", line + 1);
+                } else {
+                    ImGui::TextDisabled("%6zu", line + 1);
+                }
+                ImGui::SameLine();
+                std::string_view text = buffer.GetLine(line);
+                ImGui::TextUnformatted(text.data(), text.data() + text.size());
+                if (ImGui::IsItemClicked()) {
+                    buffer.SetPageStart(line);
+                }
+            }
+        }
+        ImGui::ImGuiListClipperManager::End(clipper);
+        ImGui::ImGuiListClipperManager::Destroy(clipper);
+        ImGui::PopTextWrapPos();
+        ImGui::EndChild();
+
+        if (InputTextMultiline("##EditorPage", buffer.GetEditText(), ImVec2(-FLT_MIN, -FLT_MIN))) {
+            buffer.MarkEdited();
+        }
+        if (ImGui::IsItemDeactivatedAfterEdit()) {
+            buffer.CommitPage();
+        }
+    }
+
+    // Approximates the BookMenu page: wrapped paragraphs, bullets, image frames at book size and page breaks.
+    // Only the blocks in view are drawn, placed by PreviewLayout from the heights measured when they were last drawn.
+    void RenderPreviewPane(const DynamicBookFramework::EditorPreview& preview, const DynamicBookFramework::EditorBuffer& buffer) {
+        using DynamicBookFramework::PreviewBlock;
+        auto document = preview.GetDocument();
+        if (!document) {
+            ImGui::TextDisabled("Preparing preview...");
+            return;
+        }
+        ImGui::TextDisabled("%zu blocks, %zu/%zu segments formatted, %.1f ms%s", document->blocks.size(), document->formattedSegments,
+            document->segments, document->milliseconds, preview.IsStale(buffer) ? " (updating)" : "");
+        ImGui::Separator();
+
+        ImVec2 region{};
+        ImGui::GetContentRegionAvail(&region);
+        ImGui::BeginChild("PreviewBlocks", ImVec2(region.x, region.y), false, 0);
+        ImGui::PushTextWrapPos(0.0f);
+        ImVec2 avail{};
+        ImGui::GetContentRegionAvail(&avail);
+
+        auto imageSize = [&](const PreviewBlock& a_block) {
+            float width = static_cast<float>(a_block.width ? a_block.width : 290);
+            float height = static_cast<float>(a_block.height ? a_block.height : 389);
+            float scale = std::min(1.0f, avail.x / width);
+            return ImVec2(width * scale, height * scale);
+        };
+
+        static DynamicBookFramework::PreviewLayout layout;
+        static std::shared_ptr<const DynamicBookFramework::PreviewDocument> laidOut;
+        if (document != laidOut || avail.x != layout.GetWidth()) {
+            std::vector<std::size_t> blockSegments;
+            blockSegments.reserve(document->blocks.size());
+            for (const auto& block : document->blocks) {
+                blockSegments.push_back(block.segment);
+            }
+            float itemSpacing = ImGui::GetStyle()->ItemSpacing.y;
+            layout.Assign(blockSegments, avail.x, [&](std::size_t a_block) {
+                const auto& block = document->blocks[a_block];
+                switch (block.type) {
+                case PreviewBlock::Type::kPagebreak:
+                    return ImGui::GetTextLineHeightWithSpacing();
+                case PreviewBlock::Type::kImage:
+                    return imageSize(block).y + itemSpacing;
+                default: {
+                    ImVec2 textSize;
+                    ImGui::CalcTextSize(&textSize, block.text.c_str(), nullptr, false, block.type == PreviewBlock::Type::kListItem ? -1.0f : avail.x);
+                    return textSize.y + itemSpacing;
+                }
+                }
+            });
+            laidOut = document;
+        }
+
+        float originY = ImGui::GetCursorPosY();
+        float scrollY = ImGui::GetScrollY();
+        auto [first, last] = layout.GetVisibleRange(scrollY - originY, scrollY - originY + ImGui::GetWindowHeight());
+        ImGui::SetCursorPosY(originY + layout.GetOffset(first));
+        for (std::size_t i = first; i < last; ++i) {
+            const auto& block = document->blocks[i];
+            float blockTop = ImGui::GetCursorPosY();
+            switch (block.type) {
+            case PreviewBlock::Type::kPagebreak:
+                ImGui::SeparatorText("page break");
+                break;
+            case PreviewBlock::Type::kListItem:
+                ImGui::BulletText("%s", block.text.c_str());
+                break;
+            case PreviewBlock::Type::kImage: {
+                ImVec2 size = imageSize(block);
+                ImGui::SetCursorPosX(ImGui::GetCursorPosX() + (avail.x - size.x) * 0.5f);
+                ImGui::PushID(static_cast<int>(i));
+                ImGui::BeginChild("Image", size, true, 0);
+                ImGui::TextDisabled("%s", block.text.c_str());
+                ImGui::EndChild();
+                ImGui::PopID();
+                break;
+            }
+            default: {
+                ImVec2 textSize;
+                ImGui::CalcTextSize(&textSize, block.text.c_str(), nullptr, false, -1.0f);
+                bool shifted = (block.align == "center" || block.align == "right") && textSize.x < avail.x;
+                if (shifted) {
+                    float factor = block.align == "center" ? 0.5f : 1.0f;
+                    ImGui::SetCursorPosX(ImGui::GetCursorPosX() + (avail.x - textSize.x) * factor);
+                }
+                ImGui::TextUnformatted(block.text.c_str(), block.text.c_str() + block.text.size());
+                break;
+            }
+            }
+            layout.SetMeasuredHeight(i, ImGui::GetCursorPosY() - blockTop);
+        }
+        // Reserve the height of the blocks below the view so the scrollbar covers the whole document.
+        ImGui::SetCursorPosY(originY + layout.GetOffset(last));
+        ImGui::Dummy(ImVec2(0.0f, layout.GetTotalHeight() - layout.GetOffset(last)));
+        ImGui::PopTextWrapPos();
+        ImGui::EndChild();
+    }
+
+    // The editor with an optional live preview beside it. The preview only does work while it is shown.
+    void RenderEditorRegion(DynamicBookFramework::EditorBuffer& buffer, const ImVec2& size) {
+        static DynamicBookFramework::EditorPreview preview;
+        static bool showPreview = true;
+
+        ImGui::Checkbox("Live Preview", &showPreview);
+        float spacing = ImGui::GetStyle()->ItemSpacing.x;
+        float height = size.y - ImGui::GetFrameHeightWithSpacing();
+        float editorWidth = showPreview ? (size.x - spacing) * 0.5f : size.x;
+
+        ImGui::BeginChild("EditorRegion", ImVec2(editorWidth, height), true, 0);
+        ImGui::PushTextWrapPos(0.0f);
+        RenderEditorContent(buffer);
+        ImGui::PopTextWrapPos();
+        ImGui::EndChild();
+
+        if (showPreview) {
+            preview.Update(buffer);
+            ImGui::SameLine(0.0f, spacing);
+            ImGui::BeginChild("PreviewRegion", ImVec2(editorWidth, height), true, 0);
+            RenderPreviewPane(preview, buffer);
+            ImGui::EndChild();
+        }
+    }
+
     void RenderEditorWindow() {
         if (!EditorWindow || !EditorWindow->IsOpen) {
             return;
@@ -198,7 +703,7 @@ namespace ImGuiRender {
             return;
         }
         
-        static char editorBuffer[16384] = "";
+        static DynamicBookFramework::EditorBuffer editorBuffer;
         static std::vector<std::string> bookTitles;
         static int selectedBookIndex = -1;
         ImGui::PushStyleVar(ImGuiStyleVar_FrameRounding, 6.0f);
@@ -302,6 +807,7 @@ namespace ImGuiRender {
 
                     if (ImGui::Button("Save & Apply", ImVec2(button_width, 0))) {
                         Settings::SaveSettings();
+                        DynamicBookFramework::DynamicBookRegistry::GetSingleton()->InvalidateAll();
                         DynamicBookFramework::BookUIManager::RefreshCurrentlyOpenBook();
                     }
                     ImGui::SameLine(0.0f, spacing);
@@ -310,11 +816,11 @@ namespace ImGuiRender {
                     }
                     ImGui::SameLine(0.0f, spacing);
                     if (ImGui::Button("Reload Mappings", ImVec2(button_width, 0))) {
-                        LoadBookMappings();
+                        LoadBookMappings(DynamicBookFramework::BookMappingCache::ScanMode::kReparseAll);
                         Settings::ScanAllBooksForBookmarks();
                         bookTitles = GetAllBookTitles();
                         selectedBookIndex = bookTitles.empty() ? -1 : 0;
-                        strcpy_s(editorBuffer, "");
+                        editorBuffer.Clear();
                     }
                     ImGui::Spacing();
                 }
@@ -372,6 +878,7 @@ namespace ImGuiRender {
 
             if (ImGui::Button("Save & Apply", ImVec2(button_width, 0))) {
                 Settings::SaveSettings();
+                DynamicBookFramework::DynamicBookRegistry::GetSingleton()->InvalidateAll();
                 DynamicBookFramework::BookUIManager::RefreshCurrentlyOpenBook();
             }
             ImGui::SameLine(0.0f, spacing);
@@ -380,10 +887,10 @@ namespace ImGuiRender {
             }
             ImGui::SameLine(0.0f, spacing);
             if (ImGui::Button("Reload Mappings", ImVec2(button_width, 0))) {
-                LoadBookMappings();
+                LoadBookMappings(DynamicBookFramework::BookMappingCache::ScanMode::kReparseAll);
                 bookTitles = GetAllBookTitles();
                 selectedBookIndex = bookTitles.empty() ? -1 : 0;
-                strcpy_s(editorBuffer, "");
+                editorBuffer.Clear();
             }
             ImGui::Spacing();
         }
@@ -423,17 +930,11 @@ namespace ImGuiRender {
         if (ImGui::Button("Load for Editing", ImVec2(buttonWidth, 0))) {
             if (selectedBookIndex != -1 && !bookTitles.empty()) {
                 std::string bookTitle = bookTitles[selectedBookIndex];
-                if (auto pathOpt = GetDynamicBookPathByTitle(string_to_wstring(bookTitle))) {
-                    if (std::filesystem::exists(*pathOpt)) {
-                        std::ifstream file(*pathOpt);
-                        std::stringstream buffer;
-                        buffer << file.rdbuf();
-                        strcpy_s(editorBuffer, sizeof(editorBuffer), buffer.str().c_str());
-                    } else {
-                        strcpy_s(editorBuffer, "");
-                    }
+                std::string content;
+                if (LoadBookFile(bookTitle, content)) {
+                    editorBuffer.Assign(std::move(content));
                 } else {
-                    strcpy_s(editorBuffer, "");
+                    editorBuffer.Clear();
                 }
             }
         }
@@ -447,17 +948,14 @@ namespace ImGuiRender {
         ImGui::GetContentRegionAvail(&avail);
         float saveHeight = ImGui::GetFrameHeightWithSpacing();
         ImVec2 editorSize = ImVec2(avail.x, avail.y - saveHeight);
-        ImGui::BeginChild("EditorRegion", editorSize, true, 0);
-        ImGui::PushTextWrapPos(0.0f);
-        ImGui::InputTextMultiline("##Editor", editorBuffer, sizeof(editorBuffer),
-                                ImVec2(-FLT_MIN, -FLT_MIN), 0, nullptr, nullptr);
-        ImGui::PopTextWrapPos();
-        ImGui::EndChild();
+        RenderEditorRegion(editorBuffer, editorSize);
         if (ImGui::Button("Save Changes", ImVec2(avail.x, 0))) {
             if (!bookTitles.empty()) {
                 std::string bookTitle = bookTitles[selectedBookIndex];
-                std::string newContent = editorBuffer;
-                WriteBookFile(bookTitle, newContent);
+                const std::string& newContent = editorBuffer.GetText();
+                if (WriteBookFile(bookTitle, newContent)) {
+                    DynamicBookFramework::BookUIManager::RefreshSavedBook(bookTitle, newContent);
+                }
             }
         }
         if (ImGui::BeginPopupModal("Create New Book", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
@@ -475,17 +973,11 @@ namespace ImGuiRender {
                 if (ImGui::Button("Load for Editing", ImVec2(buttonWidth, 0))) {
                     if (selectedBookIndex != -1 && !bookTitles.empty()) {
                         std::string bookTitle = bookTitles[selectedBookIndex];
-                        if (auto pathOpt = GetDynamicBookPathByTitle(string_to_wstring(bookTitle))) {
-                            if (std::filesystem::exists(*pathOpt)) {
-                                std::ifstream file(*pathOpt);
-                                std::stringstream buffer;
-                                buffer << file.rdbuf();
-                                strcpy_s(editorBuffer, sizeof(editorBuffer), buffer.str().c_str());
-                            } else {
-                                strcpy_s(editorBuffer, "");
-                            }
+                        std::string content;
+                        if (LoadBookFile(bookTitle, content)) {
+                            editorBuffer.Assign(std::move(content));
                         } else {
-                            strcpy_s(editorBuffer, "");
+                            editorBuffer.Clear();
 >>>>>>> Stashed changes
                         }
                     }
@@ -505,13 +997,13 @@ namespace ImGuiRender {
 
                         if (vanillaContentOpt) {
                             // If content was found in the cache, copy it into the editor buffer
-                            strcpy_s(editorBuffer, sizeof(editorBuffer), vanillaContentOpt->c_str());
-                            logger::info("Loaded cached vanilla content for '{}' into editor.", bookTitle);
+                            editorBuffer.Assign(*vanillaContentOpt);
+                            Log::UI().info("Loaded cached vanilla content for '{}' into editor.", bookTitle);
                         } else {
                             // If not found, inform the user they need to open the book first
                             const char* message = "## Open the book in-game first to cache its vanilla content. ##";
-                            strcpy_s(editorBuffer, sizeof(editorBuffer), message);
-                            logger::warn("Could not load vanilla content for '{}'. It has not been cached yet.", bookTitle);
+                            editorBuffer.Assign(message);
+                            Log::UI().warn("Could not load vanilla content for '{}'. It has not been cached yet.", bookTitle);
                         }
                     }
                 }
@@ -526,34 +1018,18 @@ namespace ImGuiRender {
                 ImGui::GetContentRegionAvail(&avail);
                 float saveHeight = ImGui::GetFrameHeightWithSpacing();
                 ImVec2 editorSize = ImVec2(avail.x, avail.y - saveHeight);
-                ImGui::BeginChild("EditorRegion", editorSize, true, 0);
-                ImGui::PushTextWrapPos(0.0f);
-                ImGui::InputTextMultiline("##Editor", editorBuffer, sizeof(editorBuffer),
-                                        ImVec2(-FLT_MIN, -FLT_MIN), 0, nullptr, nullptr);
-                ImGui::PopTextWrapPos();
-                ImGui::EndChild();
+                RenderEditorRegion(editorBuffer, editorSize);
                 if (ImGui::Button("Save Changes", ImVec2(avail.x, 0))) {
                     if (selectedBookIndex != -1 && !bookTitles.empty()) {
                         std::string bookTitle = bookTitles[selectedBookIndex];
-                        std::string newContent = editorBuffer;
-
-                        // Step 1: Write the new content to the file.
-                        WriteBookFile(bookTitle, newContent);
-                        logger::info("Saved new content for '{}' to file.", bookTitle);
+                        const std::string& newContent = editorBuffer.GetText();
 
-                        // Step 2: Notify the file watcher that we just updated this file.
-                        // This prevents the watcher from triggering a second, unnecessary refresh.
-                        DynamicBookFramework::FileWatcher::NotifyFileUpdated(bookTitle);
-
-                        // Step 3: Manually reload the watcher's cache with the new content.
-                        if (auto* currentBook = RE::BookMenu::GetTargetForm()) {
-                            if (currentBook->GetFullName() == bookTitle) {
-                                DynamicBookFramework::BookMenuWatcher::GetSingleton()->ReloadAndCacheBook(currentBook);
-                            }
+                        // Step 1: Write the new content to the file. This also updates the file watcher and
+                        // marks the book changed, so nothing has to re-read the file to notice the save.
+                        if (WriteBookFile(bookTitle, newContent)) {
+                            // Step 2: If that book is open, show the saved text straight from the editor buffer.
+                            DynamicBookFramework::BookUIManager::RefreshSavedBook(bookTitle, newContent);
                         }
-                        
-                        // Step 4: Manually trigger an instant UI refresh for immediate feedback.
-                        DynamicBookFramework::BookUIManager::RefreshCurrentlyOpenBook();
                     }
                 }
                 if (ImGui::BeginPopupModal("Create New Mapping", NULL, ImGuiWindowFlags_AlwaysAutoResize)) {
@@ -654,6 +1130,17 @@ namespace ImGuiRender {
                 }
                 ImGui::EndTabItem();
             }
+
+            if (ImGui::BeginTabItem("Search")) {
+                RenderSearchTab();
+                ImGui::EndTabItem();
+            }
+
+            // --- TAB 3: PERFORMANCE ---
+            if (ImGui::BeginTabItem("Performance")) {
+                RenderPerformanceTab();
+                ImGui::EndTabItem();
+            }
             ImGui::EndTabBar();
         }
         ImGui::End();
@@ -0,0 +1,59 @@
+//ImageHeader.cpp
+#include "ImageHeader.h"
+
+#include <fstream>
+
+
+namespace DynamicBookFramework {
+    namespace ImageInfo {
+
+        namespace { // Anonymous namespace for the header formats
+
+            constexpr std::string_view kPngSignature{ "\x89PNG\r\n\x1a\n", 8 };
+            constexpr std::string_view kPngHeaderChunk{ "IHDR", 4 };
+            constexpr std::string_view kDdsMagic{ "DDS ", 4 };
+            constexpr std::uint32_t kDdsHeaderSize = 124;
+
+            std::uint32_t ReadU32BE(std::string_view data, std::size_t offset) {
+                auto byte = [&](std::size_t i) { return static_cast<std::uint32_t>(static_cast<unsigned char>(data[offset + i])); };
+                return (byte(0) << 24) | (byte(1) << 16) | (byte(2) << 8) | byte(3);
+            }
+
+            std::uint32_t ReadU32LE(std::string_view data, std::size_t offset) {
+                auto byte = [&](std::size_t i) { return static_cast<std::uint32_t>(static_cast<unsigned char>(data[offset + i])); };
+                return byte(0) | (byte(1) << 8) | (byte(2) << 16) | (byte(3) << 24);
+            }
+        }
+
+        std::optional<ImageSize> ParseHeader(std::string_view a_header) {
+            // PNG: 8-byte signature, then the IHDR chunk (4-byte length, type, big-endian width and height).
+            if (a_header.size() >= 24 && a_header.starts_with(kPngSignature) && a_header.substr(12, 4) == kPngHeaderChunk) {
+                ImageSize size{ ReadU32BE(a_header, 16), ReadU32BE(a_header, 20) };
+                if (size.width > 0 && size.height > 0) {
+                    return size;
+                }
+                return std::nullopt;
+            }
+            // DDS: magic, then DDS_HEADER { dwSize, dwFlags, dwHeight, dwWidth, ... } in little-endian.
+            if (a_header.size() >= 20 && a_header.starts_with(kDdsMagic) && ReadU32LE(a_header, 4) == kDdsHeaderSize) {
+                ImageSize size{ ReadU32LE(a_header, 16), ReadU32LE(a_header, 12) };
+                if (size.width > 0 && size.height > 0) {
+                    return size;
+                }
+            }
+            return std::nullopt;
+        }
+
+        std::string ReadHeader(const std::filesystem::path& a_path) {
+            std::ifstream file(a_path, std::ios::binary);
+            if (!file.is_open()) {
+                return {};
+            }
+            std::string header(kHeaderProbeBytes, '\0');
+            file.read(header.data(), header.size());
+            header.resize(static_cast<std::size_t>(file.gcount()));
+            return header;
+        }
+
+    } // namespace ImageInfo
+} // namespace DynamicBookFramework
@@ -0,0 +1,63 @@
+//ImageInfo.cpp
+#include "ImageInfo.h"
+#include "DynamicBookRegistry.h"
+#include "Log.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+    namespace ImageInfo {
+
+        namespace { // Anonymous namespace for the size cache
+
+            struct CachedSize {
+                std::int64_t writeTime = 0;
+                std::optional<ImageSize> size;
+            };
+
+            std::mutex g_cacheMutex;
+            TitleMap<CachedSize> g_sizeCache; // Keyed by NormalizePath
+        }
+
+        std::string NormalizePath(std::string_view a_imagePath) {
+            std::string key(a_imagePath);
+            for (auto& c : key) {
+                c = c == '/' ? '\\' : static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            return key;
+        }
+
+        std::filesystem::path ResolveOnDisk(std::string_view a_imagePath) {
+            std::filesystem::path path(a_imagePath);
+            return path.is_absolute() ? path : std::filesystem::path("Data") / path;
+        }
+
+        std::optional<ImageSize> GetImageSize(std::string_view a_imagePath) {
+            auto path = ResolveOnDisk(a_imagePath);
+            std::error_code ec;
+            auto fileWriteTime = std::filesystem::last_write_time(path, ec);
+            if (ec) {
+                return std::nullopt; // Not a loose file; the caller falls back to its defaults.
+            }
+            std::int64_t writeTime = static_cast<std::int64_t>(fileWriteTime.time_since_epoch().count());
+
+            std::string key = NormalizePath(a_imagePath);
+            {
+                std::lock_guard<std::mutex> lock(g_cacheMutex);
+                if (auto it = g_sizeCache.find(key); it != g_sizeCache.end() && it->second.writeTime == writeTime) {
+                    return it->second.size;
+                }
+            }
+
+            auto size = ParseHeader(ReadHeader(path));
+            if (!size) {
+                Log::Watcher().debug("ImageInfo: '{}' is not a PNG or DDS with a readable header.", a_imagePath);
+            }
+
+            std::lock_guard<std::mutex> lock(g_cacheMutex);
+            g_sizeCache[key] = { writeTime, size };
+            return size;
+        }
+
+    } // namespace ImageInfo
+} // namespace DynamicBookFramework
@@ -0,0 +1,152 @@
+//ImageRegistry.cpp
+#include "ImageRegistry.h"
+#include "ImageInfo.h"
+#include "Log.h"
+#include "Trace.h"
+#include "WorkerPool.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+
+    namespace { // Anonymous namespace for file warming and size estimates
+
+        // Charged for an image whose header could not be read (for example one packed in a BSA).
+        constexpr std::size_t kUnsizedImageBytes = 1024 * 1024;
+
+        // Reads the whole file and throws the bytes away; only the OS file cache is meant to keep them.
+        bool ReadThrough(const std::filesystem::path& a_path) {
+            std::ifstream file(a_path, std::ios::binary);
+            if (!file.is_open()) {
+                return false;
+            }
+            std::array<char, 64 * 1024> buffer;
+            while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+            }
+            return true;
+        }
+
+        // What the decoded texture costs: RGBA8 at the header's dimensions.
+        std::size_t EstimateBytes(std::string_view a_imagePath) {
+            auto size = ImageInfo::GetImageSize(a_imagePath);
+            return size ? static_cast<std::size_t>(size->width) * size->height * 4 : kUnsizedImageBytes;
+        }
+    }
+
+    ImageRegistry* ImageRegistry::GetSingleton() {
+        // Never destroyed: releasing textures from a static destructor would run after the renderer is gone.
+        static ImageRegistry* singleton = new ImageRegistry();
+        return singleton;
+    }
+
+    void ImageRegistry::Warm(std::vector<std::string> a_imagePaths, const CancellationToken& a_cancel) {
+        if (a_imagePaths.empty()) {
+            return;
+        }
+        WorkerPool::GetSingleton()->Submit([this, imagePaths = std::move(a_imagePaths), a_cancel]() {
+            WarmNow(imagePaths, a_cancel);
+        }, WorkerPool::Priority::kLow);
+    }
+
+    void ImageRegistry::WarmNow(const std::vector<std::string>& a_imagePaths, const CancellationToken& a_cancel) {
+        Trace::ScopedEvent traceEvent("WarmImages", "image");
+        for (const auto& imagePath : a_imagePaths) {
+            if (a_cancel.IsCancelled()) {
+                return;
+            }
+            auto path = ImageInfo::ResolveOnDisk(imagePath);
+            std::error_code ec;
+            auto fileWriteTime = std::filesystem::last_write_time(path, ec);
+            if (ec) {
+                // Not a loose file (it may live in a BSA); LoadPNG still resolves it on the game thread.
+                Log::Watcher().debug("ImageRegistry: '{}' is not a loose file. Nothing to read ahead.", imagePath);
+                continue;
+            }
+            std::int64_t writeTime = static_cast<std::int64_t>(fileWriteTime.time_since_epoch().count());
+
+            std::string key = ImageInfo::NormalizePath(imagePath);
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_index.contains(key)) {
+                    continue; // Already a texture; the game thread will not read the file again.
+                }
+                if (auto it = _warmed.find(key); it != _warmed.end() && it->second == writeTime) {
+                    continue;
+                }
+            }
+
+            // Fills ImageInfo's size cache too, so Acquire's estimate does not touch the disk.
+            ImageInfo::GetImageSize(imagePath);
+            if (!ReadThrough(path)) {
+                continue;
+            }
+            std::lock_guard<std::mutex> lock(_mutex);
+            _warmed[key] = writeTime;
+            ++_warmedCount;
+        }
+    }
+
+    bool ImageRegistry::Acquire(std::string_view a_imagePath, RE::BSScaleformExternalTexture& a_texture) {
+        std::string key = ImageInfo::NormalizePath(a_imagePath);
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (auto it = _index.find(key); it != _index.end()) {
+                _lru.splice(_lru.begin(), _lru, it->second);
+                ++_reuses;
+                a_texture = it->second->texture;
+                return true;
+            }
+        }
+
+        Trace::ScopedEvent traceEvent("LoadPNG", "image", key);
+        Entry entry{ key };
+        RE::BSFixedString bsPath(std::string(a_imagePath));
+        if (!entry.texture.LoadPNG(bsPath) || !entry.texture.gamebryoTexture) {
+            Log::Watcher().warn("ImageRegistry: LoadPNG failed for '{}'.", a_imagePath);
+            return false;
+        }
+        entry.texture.filePath = ("img://" + std::string(a_imagePath)).c_str();
+        entry.bytes = EstimateBytes(a_imagePath);
+        a_texture = entry.texture;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_uploads;
+        _warmed.erase(key);
+        _bytes += entry.bytes;
+        _lru.push_front(std::move(entry));
+        _index.emplace(std::move(key), _lru.begin());
+        EvictToBudget();
+        return true;
+    }
+
+    void ImageRegistry::SetByteBudget(std::size_t a_byteBudget) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _byteBudget = a_byteBudget;
+        EvictToBudget();
+    }
+
+    void ImageRegistry::Clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lru.clear();
+        _index.clear();
+        _warmed.clear();
+        _bytes = 0;
+    }
+
+    ImageRegistry::Stats ImageRegistry::GetStats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return { _lru.size(), _bytes, _byteBudget, _uploads, _reuses, _evictions, _warmedCount };
+    }
+
+    void ImageRegistry::EvictToBudget() {
+        while (_bytes > _byteBudget && _lru.size() > 1) {
+            const auto& victim = _lru.back();
+            Log::Watcher().debug("ImageRegistry: Evicting '{}' ({} bytes) to stay within {} bytes.", victim.key, victim.bytes, _byteBudget);
+            _bytes -= victim.bytes;
+            _index.erase(victim.key);
+            _lru.pop_back();
+            ++_evictions;
+        }
+    }
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,85 @@
+//IncrementalFormatter.cpp
+#include "IncrementalFormatter.h"
+
+
+namespace DynamicBookFramework {
+
+    namespace { // Anonymous namespace for the cut rule
+        // Past kMinSegmentBytes, roughly one blank-line run in this many ends a segment.
+        constexpr std::size_t kCutModulus = 4;
+    }
+
+    std::vector<std::string_view> IncrementalFormatter::Split(std::string_view a_text) {
+        std::vector<std::string_view> segments;
+        std::size_t segmentStart = 0;
+        std::string_view previousLine;
+        std::size_t pos = 0;
+        while (pos < a_text.size()) {
+            std::size_t lineEnd = a_text.find('\n', pos);
+            lineEnd = lineEnd == std::string_view::npos ? a_text.size() : lineEnd;
+            std::string_view line = a_text.substr(pos, lineEnd - pos);
+
+            if (line.empty() && !previousLine.empty()) {
+                std::size_t length = pos - segmentStart;
+                bool cut = length >= kMaxSegmentBytes ||
+                           (length >= kMinSegmentBytes && std::hash<std::string_view>{}(previousLine) % kCutModulus == 0);
+                if (cut) {
+                    segments.push_back(a_text.substr(segmentStart, length));
+                    segmentStart = pos;
+                }
+            }
+            previousLine = line;
+            pos = lineEnd + 1;
+        }
+        if (segmentStart < a_text.size()) {
+            segments.push_back(a_text.substr(segmentStart));
+        }
+        return segments;
+    }
+
+    IncrementalFormatter::Result IncrementalFormatter::Format(std::string_view a_text) {
+        ++_generation;
+        Result result;
+        auto segments = Split(a_text);
+        result.segments = segments.size();
+        result.segmentKeys.reserve(segments.size());
+        result.segmentEnds.reserve(segments.size());
+
+        std::vector<const std::string*> parts;
+        parts.reserve(segments.size());
+        std::size_t htmlSize = 0;
+        for (auto segment : segments) {
+            std::size_t hash = std::hash<std::string_view>{}(segment);
+            Entry* entry = nullptr;
+            auto [first, last] = _cache.equal_range(hash);
+            for (auto it = first; it != last; ++it) {
+                if (it->second.text == segment) {
+                    entry = &it->second;
+                    break;
+                }
+            }
+            if (!entry) {
+                Entry fresh;
+                fresh.text.assign(segment);
+                fresh.html = _format(fresh.text);
+                entry = &_cache.emplace(hash, std::move(fresh))->second;
+                ++result.formattedSegments;
+            }
+            entry->lastUsed = _generation;
+            parts.push_back(&entry->html);
+            htmlSize += entry->html.size();
+            result.segmentKeys.push_back(hash);
+            result.segmentEnds.push_back(htmlSize);
+        }
+
+        result.html.reserve(htmlSize);
+        for (const auto* part : parts) {
+            result.html += *part;
+        }
+
+        // Keep only what this text uses; an undo of the last edit formats the old segment again.
+        std::erase_if(_cache, [this](const auto& item) { return item.second.lastUsed != _generation; });
+        return result;
+    }
+
+} // namespace DynamicBookFramework
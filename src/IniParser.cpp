@@ -0,0 +1,275 @@
+//IniParser.cpp
+#include "IniParser.h"
+
+#include <algorithm>
+#include <fstream>
+#include <unordered_set>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+
+namespace DynamicBookFramework {
+    namespace IniParser {
+
+        namespace { // Anonymous namespace for decoding helpers
+
+            constexpr std::string_view kWhitespace = " \t\r\n";
+
+            std::string_view Trim(std::string_view text) {
+                size_t start = text.find_first_not_of(kWhitespace);
+                if (start == std::string_view::npos) {
+                    return {};
+                }
+                size_t end = text.find_last_not_of(kWhitespace);
+                return text.substr(start, end - start + 1);
+            }
+
+            void AppendUtf8(std::string& out, char32_t codePoint) {
+                if (codePoint < 0x80) {
+                    out += static_cast<char>(codePoint);
+                } else if (codePoint < 0x800) {
+                    out += static_cast<char>(0xC0 | (codePoint >> 6));
+                    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+                } else if (codePoint < 0x10000) {
+                    out += static_cast<char>(0xE0 | (codePoint >> 12));
+                    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+                } else {
+                    out += static_cast<char>(0xF0 | (codePoint >> 18));
+                    out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (codePoint & 0x3F));
+                }
+            }
+
+            // Converts raw UTF-16 bytes (starting after any BOM) to UTF-8. Unpaired surrogates become U+FFFD.
+            std::string Utf16ToUtf8(std::string_view bytes, bool bigEndian) {
+                auto unitAt = [&](size_t i) -> char16_t {
+                    auto lo = static_cast<unsigned char>(bytes[i + (bigEndian ? 1 : 0)]);
+                    auto hi = static_cast<unsigned char>(bytes[i + (bigEndian ? 0 : 1)]);
+                    return static_cast<char16_t>((hi << 8) | lo);
+                };
+
+                std::string out;
+                out.reserve(bytes.size() / 2);
+                size_t i = 0;
+                while (i + 1 < bytes.size()) {
+                    char16_t unit = unitAt(i);
+                    i += 2;
+                    if (unit >= 0xD800 && unit <= 0xDBFF && i + 1 < bytes.size()) {
+                        char16_t low = unitAt(i);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            i += 2;
+                            AppendUtf8(out, 0x10000 + ((static_cast<char32_t>(unit) - 0xD800) << 10) + (low - 0xDC00));
+                            continue;
+                        }
+                        AppendUtf8(out, 0xFFFD);
+                    } else if (unit >= 0xD800 && unit <= 0xDFFF) {
+                        AppendUtf8(out, 0xFFFD);
+                    } else {
+                        AppendUtf8(out, unit);
+                    }
+                }
+                return out;
+            }
+
+            // Strict UTF-8: no overlong forms, surrogates or code points past U+10FFFF.
+            bool IsValidUtf8(std::string_view bytes) {
+                size_t i = 0;
+                while (i < bytes.size()) {
+                    auto lead = static_cast<unsigned char>(bytes[i]);
+                    size_t length;
+                    char32_t min;
+                    char32_t codePoint;
+                    if (lead < 0x80) {
+                        ++i;
+                        continue;
+                    } else if ((lead & 0xE0) == 0xC0) {
+                        length = 2;
+                        min = 0x80;
+                        codePoint = lead & 0x1F;
+                    } else if ((lead & 0xF0) == 0xE0) {
+                        length = 3;
+                        min = 0x800;
+                        codePoint = lead & 0x0F;
+                    } else if ((lead & 0xF8) == 0xF0) {
+                        length = 4;
+                        min = 0x10000;
+                        codePoint = lead & 0x07;
+                    } else {
+                        return false;
+                    }
+                    if (bytes.size() - i < length) {
+                        return false;
+                    }
+                    for (size_t j = 1; j < length; ++j) {
+                        auto next = static_cast<unsigned char>(bytes[i + j]);
+                        if ((next & 0xC0) != 0x80) {
+                            return false;
+                        }
+                        codePoint = (codePoint << 6) | (next & 0x3F);
+                    }
+                    if (codePoint < min || codePoint > 0x10FFFF || (codePoint >= 0xD800 && codePoint <= 0xDFFF)) {
+                        return false;
+                    }
+                    i += length;
+                }
+                return true;
+            }
+
+            // INIs saved by older tools are in the user's ANSI code page, which the profile APIs used to read them in.
+            std::string AnsiToUtf8(std::string_view bytes) {
+#ifdef _WIN32
+                int wideSize = MultiByteToWideChar(CP_ACP, 0, bytes.data(), static_cast<int>(bytes.size()), nullptr, 0);
+                std::wstring wide(static_cast<size_t>(wideSize), L'\0');
+                MultiByteToWideChar(CP_ACP, 0, bytes.data(), static_cast<int>(bytes.size()), wide.data(), wideSize);
+                int size = WideCharToMultiByte(CP_UTF8, 0, wide.data(), wideSize, nullptr, 0, nullptr, nullptr);
+                std::string out(static_cast<size_t>(size), '\0');
+                WideCharToMultiByte(CP_UTF8, 0, wide.data(), wideSize, out.data(), size, nullptr, nullptr);
+                return out;
+#else
+                std::string out;
+                out.reserve(bytes.size());
+                for (char c : bytes) {
+                    AppendUtf8(out, static_cast<unsigned char>(c));
+                }
+                return out;
+#endif
+            }
+
+            char ToLowerAscii(char c) {
+                return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+            }
+
+            // Notepad and the Windows profile APIs write UTF-16 LE, sometimes without a BOM.
+            // Treat the file as BOM-less UTF-16 LE if the high bytes of the first few characters are all zero.
+            bool LooksLikeUtf16LE(std::string_view bytes) {
+                if (bytes.size() < 4) {
+                    return false;
+                }
+                size_t probe = std::min<size_t>(bytes.size() & ~size_t{ 1 }, 16);
+                for (size_t i = 0; i < probe; i += 2) {
+                    if (bytes[i] == '\0' || bytes[i + 1] != '\0') {
+                        return false;
+                    }
+                }
+                return true;
+            }
+        }
+
+        std::optional<std::string> ReadFileAsUtf8(const std::filesystem::path& filePath) {
+            std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) {
+                return std::nullopt;
+            }
+
+            std::string bytes;
+            auto size = file.tellg();
+            if (size > 0) {
+                bytes.resize(static_cast<size_t>(size));
+                file.seekg(0);
+                file.read(bytes.data(), size);
+                bytes.resize(static_cast<size_t>(file.gcount()));
+            }
+
+            std::string_view view(bytes);
+            if (view.starts_with("\xEF\xBB\xBF")) {
+                return bytes.substr(3);
+            }
+            if (view.starts_with("\xFF\xFE")) {
+                return Utf16ToUtf8(view.substr(2), false);
+            }
+            if (view.starts_with("\xFE\xFF")) {
+                return Utf16ToUtf8(view.substr(2), true);
+            }
+            if (LooksLikeUtf16LE(view)) {
+                return Utf16ToUtf8(view, false);
+            }
+            if (!IsValidUtf8(view)) {
+                return AnsiToUtf8(view);
+            }
+            return bytes;
+        }
+
+        void Parse(std::string_view text, const EntryCallback& callback) {
+            std::string_view currentSection;
+
+            size_t lineStart = 0;
+            while (lineStart < text.size()) {
+                size_t lineEnd = text.find('\n', lineStart);
+                if (lineEnd == std::string_view::npos) {
+                    lineEnd = text.size();
+                }
+                std::string_view line = Trim(text.substr(lineStart, lineEnd - lineStart));
+                lineStart = lineEnd + 1;
+
+                if (line.empty() || line[0] == ';' || line[0] == '#') {
+                    continue;
+                }
+
+                if (line[0] == '[') {
+                    size_t close = line.find(']');
+                    if (close != std::string_view::npos) {
+                        currentSection = Trim(line.substr(1, close - 1));
+                    }
+                    continue;
+                }
+
+                size_t equals = line.find('=');
+                if (equals == std::string_view::npos) {
+                    continue;
+                }
+
+                std::string_view key = Trim(line.substr(0, equals));
+                std::string_view value = Trim(line.substr(equals + 1));
+                if (value.size() >= 2 && (value.front() == '"' || value.front() == '\'') && value.back() == value.front()) {
+                    value = value.substr(1, value.size() - 2);
+                }
+
+                if (!key.empty()) {
+                    callback(currentSection, key, value);
+                }
+            }
+        }
+
+        std::vector<std::pair<std::string, std::string>> CollectSection(std::string_view text, std::string_view section) {
+            std::vector<std::pair<std::string, std::string>> entries;
+            std::unordered_set<std::string> foldedKeys;
+            Parse(text, [&](std::string_view entrySection, std::string_view key, std::string_view value) {
+                if (value.empty() || !EqualsIgnoreCase(entrySection, section)) {
+                    return;
+                }
+                std::string folded(key);
+                std::transform(folded.begin(), folded.end(), folded.begin(), ToLowerAscii);
+                if (foldedKeys.insert(std::move(folded)).second) {
+                    entries.emplace_back(key, value);
+                }
+            });
+            return entries;
+        }
+
+        bool ParseFile(const std::filesystem::path& filePath, const EntryCallback& callback) {
+            auto text = ReadFileAsUtf8(filePath);
+            if (!text) {
+                return false;
+            }
+            Parse(*text, callback);
+            return true;
+        }
+
+        bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+            if (a.size() != b.size()) {
+                return false;
+            }
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (ToLowerAscii(a[i]) != ToLowerAscii(b[i])) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    } // namespace IniParser
+} // namespace DynamicBookFramework
@@ -2,26 +2,107 @@
 #include "ImGuiMenu.h" // We need this to call ToggleMenu()
 #include "BookUIManager.h"
 #include "Settings.h"
-#include "SetBookTextHook.h" // You no longer need this for bookmarks
+#include "DynamicBookRegistry.h"
 #include "Utility.h"
+#include "Log.h"
+
+namespace Log = DynamicBookFramework::Log;
 
 namespace { // Anonymous namespace for local helpers and state
 
-	// Helper to find a book form from its title string
-	RE::TESObjectBOOK* GetBookFormByTitle(const std::string& a_title) {
-		auto* dataHandler = RE::TESDataHandler::GetSingleton();
-		if (!dataHandler) return nullptr;
-		for (const auto& book : dataHandler->GetFormArray<RE::TESObjectBOOK>()) {
-			if (book && book->GetFullName() == a_title) {
-				return book;
+	// State for tracking bookmark cycling
+	static int g_currentBookmarkIndex = -1;
+	static RE::FormID g_lastBookForCycle = 0;
+
+	const char* GetActionName(HotkeyAction a_action) {
+		switch (a_action) {
+		case HotkeyAction::kToggleEditor:     return "OpenMenu";
+		case HotkeyAction::kFocusTextInput:   return "FocusTextInput";
+		case HotkeyAction::kSubmitTextInput:  return "SubmitTextInput";
+		case HotkeyAction::kNextBookmark:     return "NextBookmark";
+		case HotkeyAction::kPreviousBookmark: return "PreviousBookmark";
+		default:                              return "None";
+		}
+	}
+
+	// Steps through the bookmarks of the open book. Returns false if it has none, so the key reaches the game.
+	bool CycleBookmark(RE::GFxMovieView* a_movieView, RE::TESObjectBOOK* a_book, bool a_forward) {
+		// Bookmarks are stored under the mapped title, which the registry already holds; no per-press name copy.
+		auto record = DynamicBookFramework::DynamicBookRegistry::GetSingleton()->FindByFormID(a_book->GetFormID());
+		if (!record) {
+			return false;
+		}
+
+		const auto& anchors = Settings::GetBookmarksForBook(record->key);
+		if (anchors.empty()) {
+			return false; // Exit if there are no bookmarks for this book.
+		}
+
+		// Reset the index if the book has changed
+		if (g_lastBookForCycle != a_book->GetFormID()) {
+			g_currentBookmarkIndex = -1;
+			g_lastBookForCycle = a_book->GetFormID();
+		}
+
+		if (a_forward) {
+			g_currentBookmarkIndex++;
+			if (g_currentBookmarkIndex >= static_cast<int>(anchors.size())) {
+				g_currentBookmarkIndex = 0; // Wrap around to the start
+			}
+		} else {
+			g_currentBookmarkIndex--;
+			if (g_currentBookmarkIndex < 0) {
+				g_currentBookmarkIndex = static_cast<int>(anchors.size()) - 1; // Wrap around to the end
 			}
 		}
-		return nullptr;
+
+		std::string targetAnchor = anchors[g_currentBookmarkIndex];
+
+		RE::FxResponseArgs<1> gotoArgs;
+		gotoArgs.Add(targetAnchor.c_str());
+		RE::FxDelegate::Invoke(a_movieView, "GotoPageByAnchor", gotoArgs);
+		return true;
 	}
 
-	// State for tracking bookmark cycling
-	static int g_currentBookmarkIndex = -1;
-	static std::string g_lastBookTitleForCycle = "";
+	// Runs a BookMenu-only action. Only reached after the table lookup matched, so the menu lookup is off the common path.
+	bool HandleBookMenuAction(HotkeyAction a_action) {
+		auto* ui = RE::UI::GetSingleton();
+		auto menu = ui ? ui->GetMenu(RE::BookMenu::MENU_NAME) : nullptr;
+		auto* bookMenu = menu ? static_cast<RE::BookMenu*>(menu.get()) : nullptr;
+		if (!bookMenu || !bookMenu->uiMovie) {
+			return false;
+		}
+
+		auto& rtData = REL::RelocateMember<RE::BookMenu::RUNTIME_DATA>(bookMenu, 0x50, 0x60);
+		auto* movieView = rtData.book.get();
+		auto* currentBook = bookMenu->GetTargetForm();
+		if (!currentBook) {
+			return false;
+		}
+
+		switch (a_action) {
+		case HotkeyAction::kFocusTextInput:
+			{
+				RE::FxResponseArgs<0> emptyArgs;
+				RE::FxDelegate::Invoke(movieView, "FocusTextInput", emptyArgs);
+				Log::UI().debug("FocusTextInput hotkey pressed, requesting text input focus...");
+				return true;
+			}
+		case HotkeyAction::kSubmitTextInput:
+			{
+				RE::FxResponseArgs<0> emptyArgs;
+				RE::FxDelegate::Invoke(movieView, "SubmitTextInput", emptyArgs);
+				Log::UI().debug("SubmitTextInput hotkey pressed, requesting text input submit...");
+				return true;
+			}
+		case HotkeyAction::kNextBookmark:
+			return CycleBookmark(movieView, currentBook, true);
+		case HotkeyAction::kPreviousBookmark:
+			return CycleBookmark(movieView, currentBook, false);
+		default:
+			return false;
+		}
+	}
 }
 
 // All of your class's functions must be defined within its namespace
@@ -34,15 +115,49 @@ InputListener* InputListener::GetSingleton() {
 void InputListener::Install() {
     auto* inputDeviceManager = RE::BSInputDeviceManager::GetSingleton();
     if (inputDeviceManager) {
+        GetSingleton()->RebuildActionTable();
         inputDeviceManager->AddEventSink(InputListener::GetSingleton());
-        SKSE::log::info("Registered input event listener.");
+        Log::UI().info("Registered input event listener.");
     }
 }
 
+void InputListener::RebuildActionTable() {
+    std::array<HotkeyAction, kActionTableSize> table{};
+
+    // Earlier bindings win, matching the order the old chain of comparisons checked them in.
+    auto bind = [&table](int a_key, HotkeyAction a_action) {
+        if (a_key <= 0 || a_key >= static_cast<int>(kActionTableSize)) {
+            Log::UI().warn("InputListener: {} hotkey has invalid scancode {}. It will be ignored.", GetActionName(a_action), a_key);
+            return;
+        }
+        if (table[a_key] != HotkeyAction::kNone) {
+            Log::UI().warn("InputListener: {} hotkey ({}) is already bound to {}. It will be ignored.",
+                GetActionName(a_action), Settings::GetNameFromScancode(a_key), GetActionName(table[a_key]));
+            return;
+        }
+        table[a_key] = a_action;
+    };
+
+    bind(Settings::openMenuHotkey, HotkeyAction::kToggleEditor);
+    bind(Settings::focusTextInputHotkey, HotkeyAction::kFocusTextInput);
+    bind(Settings::submitTextInputHotkey, HotkeyAction::kSubmitTextInput);
+    bind(Settings::nextBookmarkHotkey, HotkeyAction::kNextBookmark);
+    bind(Settings::previousBookmarkHotkey, HotkeyAction::kPreviousBookmark);
+
+    for (std::size_t i = 0; i < kActionTableSize; ++i) {
+        _actions[i].store(table[i], std::memory_order_relaxed);
+    }
+}
+
+void InputListener::SetBookMenuOpen(bool a_open) {
+    _bookMenuOpen.store(a_open, std::memory_order_relaxed);
+}
+
 RE::BSEventNotifyControl InputListener::ProcessEvent(RE::InputEvent* const* a_event, RE::BSTEventSource<RE::InputEvent*>*) {
     if (!a_event) return RE::BSEventNotifyControl::kContinue;
 
-    if (ImGuiRender::EditorWindow && ImGuiRender::EditorWindow->IsOpen) {
+    const bool editorOpen = ImGuiRender::EditorWindow && ImGuiRender::EditorWindow->IsOpen;
+    if (editorOpen) {
         ImGuiIO* io = ImGui::GetIO();
         if (io->WantCaptureKeyboard) {
             // If ImGui is expecting keyboard input (e.g., you've clicked a text box),
@@ -58,87 +173,25 @@ RE::BSEventNotifyControl InputListener::ProcessEvent(RE::InputEvent* const* a_ev
         if (!buttonEvent || !buttonEvent->IsDown() || buttonEvent->GetDevice() != RE::INPUT_DEVICE::kKeyboard) continue;
         
         const auto key = buttonEvent->GetIDCode();
-        auto* ui = RE::UI::GetSingleton();
+        if (key >= kActionTableSize) continue;
+
+        const auto action = _actions[key].load(std::memory_order_relaxed);
+        if (action == HotkeyAction::kNone) continue;
 
         // --- ImGui Editor Hotkey Logic ---
-        if (ImGuiRender::EditorWindow && ImGuiRender::EditorWindow->IsOpen) {
-            // ... (your logic for closing the editor) ...
-        } else {
-            if (key == static_cast<uint32_t>(Settings::openMenuHotkey)) {
+        // While the editor is open its own window handles the hotkey (see RenderEditorWindow).
+        if (action == HotkeyAction::kToggleEditor) {
+            if (!editorOpen) {
                 ImGuiRender::ToggleMenu();
                 return RE::BSEventNotifyControl::kStop;
             }
+            continue;
         }
 
-       
         // --- In-Game Book Menu Hotkey Logic ---
-        if (ui && ui->IsMenuOpen(RE::BookMenu::MENU_NAME)) {
-            auto menu = ui->GetMenu(RE::BookMenu::MENU_NAME);
-            auto* bookMenu = menu ? static_cast<RE::BookMenu*>(menu.get()) : nullptr;
-
-
-            if (bookMenu && bookMenu->uiMovie) {
-                auto& rtData = REL::RelocateMember<RE::BookMenu::RUNTIME_DATA>(bookMenu, 0x50, 0x60);
-                auto* movieView = rtData.book.get();
-                auto* currentBook = bookMenu->GetTargetForm();
-
-                if (!currentBook) continue;
-                std::string currentTitle = currentBook->GetName();
-
-                if (g_lastBookTitleForCycle != currentTitle) {
-                    g_currentBookmarkIndex = -1;
-                    g_lastBookTitleForCycle = currentTitle;
-                }
-
-                if (key == 0x2D) { // DirectX scancode for 'X' key
-                    RE::FxResponseArgs<0> emptyArgs;
-                    RE::FxDelegate::Invoke(movieView, "FocusTextInput", emptyArgs);
-                    logger::info("X key pressed, requesting text input focus...");
-                    return RE::BSEventNotifyControl::kStop;
-                }
-
-                if (key == 0x1C) { // DirectX scancode for 'Enter' key
-                    RE::FxResponseArgs<0> emptyArgs;
-                    RE::FxDelegate::Invoke(movieView, "SubmitTextInput", emptyArgs);
-                    logger::info("Enter key pressed, requesting text input submit...");
-                    return RE::BSEventNotifyControl::kStop;
-                }
-                // 2. Next/Previous Bookmark Hotkeys
-                if (key == static_cast<uint32_t>(Settings::nextBookmarkHotkey) || key == static_cast<uint32_t>(Settings::previousBookmarkHotkey)) {
-                    const auto& anchors = Settings::GetBookmarksForBook(currentTitle);
-                    if (anchors.empty()) {
-                        continue; // Exit if there are no bookmarks for this book.
-                    }
-
-                    // --- NEW: Reset the index if the book has changed ---
-                    if (g_lastBookTitleForCycle != currentTitle) {
-                        g_currentBookmarkIndex = -1;
-                        g_lastBookTitleForCycle = currentTitle;
-                    }
-                    // --- END NEW ---
-
-                    if (key == static_cast<uint32_t>(Settings::nextBookmarkHotkey)) {
-                        g_currentBookmarkIndex++;
-                        if (g_currentBookmarkIndex >= static_cast<int>(anchors.size())) {
-                            g_currentBookmarkIndex = 0; // Wrap around to the start
-                        }
-                    } else { // Previous
-                        g_currentBookmarkIndex--;
-                        if (g_currentBookmarkIndex < 0) {
-                            g_currentBookmarkIndex = static_cast<int>(anchors.size()) - 1; // Wrap around to the end
-                        }
-                    }
-
-                    std::string targetAnchor = anchors[g_currentBookmarkIndex];
-
-                    RE::FxResponseArgs<1> gotoArgs;
-                    gotoArgs.Add(targetAnchor.c_str());
-                    RE::FxDelegate::Invoke(movieView, "GotoPageByAnchor", gotoArgs);
-
-                    return RE::BSEventNotifyControl::kStop;
-                }
-            }
+        if (_bookMenuOpen.load(std::memory_order_relaxed) && HandleBookMenuAction(action)) {
+            return RE::BSEventNotifyControl::kStop;
         }
     }
     return RE::BSEventNotifyControl::kContinue;
-}
\ No newline at end of file
+}
@@ -0,0 +1,205 @@
+//Log.cpp
+#include "Log.h"
+#include "IniParser.h"
+#include "PCH.h"
+#include <spdlog/async.h>
+#include <exception>
+
+
+namespace DynamicBookFramework {
+    namespace Log {
+
+        namespace { // Anonymous namespace for the logger table
+
+            constexpr std::size_t kSubsystemCount = static_cast<std::size_t>(Subsystem::kCount);
+
+            // Ring buffer slots. When the writer falls behind, the oldest queued message is dropped rather than blocking the game.
+            constexpr std::size_t kQueueSize = 8192;
+            constexpr auto kFlushInterval = std::chrono::seconds(1);
+
+            constexpr std::array<const char*, kSubsystemCount> kLoggerNames{ "hook", "session", "watcher", "ui" };
+            constexpr std::array<std::string_view, kSubsystemCount> kSettingNames{ "Hook", "Session", "Watcher", "UI" };
+            constexpr std::array<spdlog::level::level_enum, kSubsystemCount> kDefaultLevels{
+                spdlog::level::warn,    // Hook: runs on every SetBookText call
+                spdlog::level::info,
+                spdlog::level::info,
+                spdlog::level::info
+            };
+
+            std::array<std::shared_ptr<spdlog::logger>, kSubsystemCount> g_loggers;
+            std::shared_ptr<spdlog::logger> g_defaultLogger;
+            std::atomic<bool> g_shutDown{ false };
+            std::terminate_handler g_previousTerminate = nullptr;
+            LPTOP_LEVEL_EXCEPTION_FILTER g_previousFilter = nullptr;
+
+            // The sink of every logger. Messages below error level go to an async logger and are written by the
+            // background thread. Errors are written and flushed on the calling thread, so the message explaining a
+            // crash is on disk before the crash; flush_on(err) on an async logger would only queue the flush.
+            // An error can therefore land ahead of info lines that are still queued.
+            class SplitSink final : public spdlog::sinks::sink {
+            public:
+                SplitSink(std::shared_ptr<spdlog::async_logger> a_background, spdlog::sink_ptr a_file) :
+                    _background(std::move(a_background)), _file(std::move(a_file)) {}
+
+                void log(const spdlog::details::log_msg& a_msg) override {
+                    // After Shutdown the writer thread is gone, so everything is written directly.
+                    if (a_msg.level >= spdlog::level::err || g_shutDown.load()) {
+                        _file->log(a_msg);
+                        _file->flush();
+                    } else {
+                        _background->log(a_msg.time, a_msg.source, a_msg.level, a_msg.payload);
+                    }
+                }
+
+                void flush() override {
+                    if (!g_shutDown.load()) {
+                        _background->flush();
+                    }
+                    _file->flush();
+                }
+
+                // Formatting belongs to the file sink.
+                void set_pattern(const std::string&) override {}
+                void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+
+            private:
+                std::shared_ptr<spdlog::async_logger> _background;
+                spdlog::sink_ptr _file;
+            };
+
+            std::shared_ptr<spdlog::logger> MakeLogger(const std::string& a_name, const spdlog::sink_ptr& a_fileSink) {
+                // Same name as the front logger, so both paths print the same [name] in the file. Filtering is done
+                // by the front logger; the background one passes everything it is given.
+                auto background = std::make_shared<spdlog::async_logger>(a_name, a_fileSink, spdlog::thread_pool(),
+                    spdlog::async_overflow_policy::overrun_oldest);
+                background->set_level(spdlog::level::trace);
+                return std::make_shared<spdlog::logger>(a_name, std::make_shared<SplitSink>(std::move(background), a_fileSink));
+            }
+
+            void OnTerminate() {
+                Shutdown();
+                if (g_previousTerminate) {
+                    g_previousTerminate();
+                }
+                std::abort();
+            }
+
+            // Game crashes are structured exceptions, not std::terminate. Runs on the crashing thread while the
+            // writer thread still exists, then lets the previous filter (or a crash logger) see the exception.
+            LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS* a_info) {
+                Shutdown();
+                return g_previousFilter ? g_previousFilter(a_info) : EXCEPTION_CONTINUE_SEARCH;
+            }
+
+            // Quitting is confirmed in a message box, which sets Main::quitGame before it closes. Shutting down on
+            // that close joins the threads from the game thread, before process exit terminates them.
+            class QuitSink final : public RE::BSTEventSink<RE::MenuOpenCloseEvent> {
+            public:
+                RE::BSEventNotifyControl ProcessEvent(const RE::MenuOpenCloseEvent* a_event, RE::BSTEventSource<RE::MenuOpenCloseEvent>*) override {
+                    auto* main = RE::Main::GetSingleton();
+                    if (a_event && !a_event->opening && main && main->quitGame) {
+                        Shutdown();
+                    }
+                    return RE::BSEventNotifyControl::kContinue;
+                }
+            };
+        }
+
+        void Setup() {
+            auto logsFolder = SKSE::log::log_directory();
+            if (!logsFolder) SKSE::stl::report_and_fail("SKSE log_directory not provided, logs disabled.");
+            auto pluginName = SKSE::PluginDeclaration::GetSingleton()->GetName();
+            auto logFilePath = *logsFolder / std::format("{}.log", pluginName);
+
+            spdlog::init_thread_pool(kQueueSize, 1);
+            auto fileSink = std::make_shared<spdlog::sinks::basic_file_sink_mt>(logFilePath.string(), true);
+
+            // The default logger serves every SKSE::log call outside the subsystems (startup, settings, mappings).
+            g_defaultLogger = MakeLogger("log", fileSink);
+            g_defaultLogger->set_level(spdlog::level::info);
+            spdlog::set_default_logger(g_defaultLogger);
+
+            for (std::size_t i = 0; i < kSubsystemCount; ++i) {
+                g_loggers[i] = MakeLogger(kLoggerNames[i], fileSink);
+                g_loggers[i]->set_level(kDefaultLevels[i]);
+                spdlog::register_logger(g_loggers[i]);
+            }
+
+            // Background flush of everything below error level.
+            spdlog::flush_every(kFlushInterval);
+
+            g_previousTerminate = std::set_terminate(OnTerminate);
+            g_previousFilter = SetUnhandledExceptionFilter(OnUnhandledException);
+            // Nothing shuts down on DLL detach: joining threads under the loader lock can hang, and at process exit
+            // they are already gone. Queued lines are written by the quit hook or the crash handlers instead.
+        }
+
+        void InstallQuitHook() {
+            static QuitSink sink;
+            if (auto* ui = RE::UI::GetSingleton()) {
+                ui->AddEventSink<RE::MenuOpenCloseEvent>(&sink);
+            }
+        }
+
+        void Shutdown() {
+            if (g_shutDown.exchange(true)) {
+                return;
+            }
+            // Writes out what is still queued and joins the writer and flusher threads.
+            spdlog::shutdown();
+            // shutdown() also dropped the default logger that SKSE::log writes through; it now writes directly.
+            if (g_defaultLogger) {
+                spdlog::set_default_logger(g_defaultLogger);
+            }
+        }
+
+        void SetLevel(Subsystem a_subsystem, spdlog::level::level_enum a_level) {
+            Get(a_subsystem).set_level(a_level);
+        }
+
+        spdlog::level::level_enum GetLevel(Subsystem a_subsystem) {
+            return Get(a_subsystem).level();
+        }
+
+        void ResetLevels() {
+            for (std::size_t i = 0; i < kSubsystemCount; ++i) {
+                SetLevel(static_cast<Subsystem>(i), kDefaultLevels[i]);
+            }
+        }
+
+        std::optional<spdlog::level::level_enum> ParseLevel(std::string_view a_name) {
+            using IniParser::EqualsIgnoreCase;
+            if (EqualsIgnoreCase(a_name, "trace")) return spdlog::level::trace;
+            if (EqualsIgnoreCase(a_name, "debug")) return spdlog::level::debug;
+            if (EqualsIgnoreCase(a_name, "info")) return spdlog::level::info;
+            if (EqualsIgnoreCase(a_name, "warn") || EqualsIgnoreCase(a_name, "warning")) return spdlog::level::warn;
+            if (EqualsIgnoreCase(a_name, "error")) return spdlog::level::err;
+            if (EqualsIgnoreCase(a_name, "critical")) return spdlog::level::critical;
+            if (EqualsIgnoreCase(a_name, "off")) return spdlog::level::off;
+            return std::nullopt;
+        }
+
+        std::string_view LevelToString(spdlog::level::level_enum a_level) {
+            switch (a_level) {
+            case spdlog::level::trace:    return "trace";
+            case spdlog::level::debug:    return "debug";
+            case spdlog::level::info:     return "info";
+            case spdlog::level::warn:     return "warn";
+            case spdlog::level::err:      return "error";
+            case spdlog::level::critical: return "critical";
+            default:                      return "off";
+            }
+        }
+
+        std::string_view GetSettingName(Subsystem a_subsystem) {
+            return kSettingNames[static_cast<std::size_t>(a_subsystem)];
+        }
+
+        spdlog::logger& Get(Subsystem a_subsystem) {
+            const auto& logger = g_loggers[static_cast<std::size_t>(a_subsystem)];
+            // Only reachable before Setup() has run; fall back to the default logger rather than crash.
+            return logger ? *logger : *spdlog::default_logger_raw();
+        }
+
+    } // namespace Log
+} // namespace DynamicBookFramework
@@ -0,0 +1,183 @@
+//Lz4.cpp
+#include "Lz4.h"
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <vector>
+
+
+namespace DynamicBookFramework {
+    namespace Lz4 {
+
+        namespace { // Anonymous namespace for the block format constants
+
+            constexpr std::size_t kMinMatch = 4;
+            constexpr std::size_t kLastLiterals = 5;    // The last 5 bytes of a block are always literals
+            constexpr std::size_t kMatchFindLimit = 12; // The last match starts at least 12 bytes before the end
+            constexpr std::size_t kMaxOffset = 65535;
+            constexpr unsigned kHashBits = 16;
+
+            std::uint32_t Read32(const char* a_p) {
+                std::uint32_t value;
+                std::memcpy(&value, a_p, sizeof(value));
+                return value;
+            }
+
+            std::uint32_t Hash(std::uint32_t a_sequence) {
+                return (a_sequence * 2654435761u) >> (32 - kHashBits);
+            }
+
+            // Lengths of 15 and more continue in 255-valued bytes after the token.
+            void WriteLength(std::string& a_out, std::size_t a_length) {
+                for (; a_length >= 255; a_length -= 255) {
+                    a_out.push_back(static_cast<char>(255));
+                }
+                a_out.push_back(static_cast<char>(a_length));
+            }
+
+            void WriteSequence(std::string& a_out, std::string_view a_literals, std::size_t a_offset, std::size_t a_matchLength) {
+                std::size_t literalLength = a_literals.size();
+                bool lastSequence = a_matchLength == 0;
+                std::size_t matchCode = lastSequence ? 0 : a_matchLength - kMinMatch;
+                a_out.push_back(static_cast<char>(((literalLength >= 15 ? 15 : literalLength) << 4) | (matchCode >= 15 ? 15 : matchCode)));
+                if (literalLength >= 15) {
+                    WriteLength(a_out, literalLength - 15);
+                }
+                a_out.append(a_literals);
+                if (lastSequence) {
+                    return;
+                }
+                a_out.push_back(static_cast<char>(a_offset & 0xFF));
+                a_out.push_back(static_cast<char>(a_offset >> 8));
+                if (matchCode >= 15) {
+                    WriteLength(a_out, matchCode - 15);
+                }
+            }
+
+            // Reads a length continued after the token. False if the input ends first.
+            bool ReadLength(std::string_view a_input, std::size_t& a_pos, std::size_t& a_length) {
+                unsigned char byte;
+                do {
+                    if (a_pos >= a_input.size()) {
+                        return false;
+                    }
+                    byte = static_cast<unsigned char>(a_input[a_pos++]);
+                    a_length += byte;
+                } while (byte == 255);
+                return true;
+            }
+        }
+
+        std::string Compress(std::string_view a_input) {
+            std::string out;
+            out.reserve(GetMaxCompressedSize(a_input.size()));
+            const std::size_t size = a_input.size();
+            const char* data = a_input.data();
+            std::size_t anchor = 0;
+
+            if (size > kMatchFindLimit) {
+                // Positions are stored plus one, so zero means empty.
+                std::vector<std::uint32_t> table(std::size_t{ 1 } << kHashBits, 0);
+                const std::size_t matchStartLimit = size - kMatchFindLimit;
+                const std::size_t matchEndLimit = size - kLastLiterals;
+                std::size_t pos = 0;
+                while (pos <= matchStartLimit) {
+                    std::uint32_t sequence = Read32(data + pos);
+                    std::uint32_t& slot = table[Hash(sequence)];
+                    std::size_t candidate = slot;
+                    slot = static_cast<std::uint32_t>(pos + 1);
+                    if (candidate == 0 || pos - (candidate - 1) > kMaxOffset || Read32(data + candidate - 1) != sequence) {
+                        ++pos;
+                        continue;
+                    }
+                    std::size_t reference = candidate - 1;
+
+                    // Extend backwards into the pending literals, then forwards up to the end limit.
+                    while (pos > anchor && reference > 0 && data[pos - 1] == data[reference - 1]) {
+                        --pos;
+                        --reference;
+                    }
+                    std::size_t length = kMinMatch;
+                    while (pos + length < matchEndLimit && data[pos + length] == data[reference + length]) {
+                        ++length;
+                    }
+
+                    WriteSequence(out, a_input.substr(anchor, pos - anchor), pos - reference, length);
+                    pos += length;
+                    anchor = pos;
+                    if (pos - 2 <= matchStartLimit) {
+                        table[Hash(Read32(data + pos - 2))] = static_cast<std::uint32_t>(pos - 1);
+                    }
+                }
+            }
+
+            WriteSequence(out, a_input.substr(anchor), 0, 0);
+            return out;
+        }
+
+        bool Decompress(std::string_view a_input, std::size_t a_rawSize, std::string& a_out) {
+            if (a_rawSize > GetMaxDecompressedSize(a_input.size())) {
+                return false;
+            }
+            try {
+                a_out.resize(a_rawSize);
+            } catch (const std::exception&) { // bad_alloc or length_error
+                return false;
+            }
+            char* out = a_out.data();
+            std::size_t in = 0;
+            std::size_t written = 0;
+            while (true) {
+                if (in >= a_input.size()) {
+                    return false;
+                }
+                unsigned token = static_cast<unsigned char>(a_input[in++]);
+
+                std::size_t literalLength = token >> 4;
+                if (literalLength == 15 && !ReadLength(a_input, in, literalLength)) {
+                    return false;
+                }
+                if (literalLength > a_input.size() - in || literalLength > a_rawSize - written) {
+                    return false;
+                }
+                std::memcpy(out + written, a_input.data() + in, literalLength);
+                in += literalLength;
+                written += literalLength;
+                if (in == a_input.size()) {
+                    break; // The last sequence has literals only.
+                }
+
+                if (a_input.size() - in < 2) {
+                    return false;
+                }
+                std::size_t offset = static_cast<unsigned char>(a_input[in]) | (static_cast<std::size_t>(static_cast<unsigned char>(a_input[in + 1])) << 8);
+                in += 2;
+                if (offset == 0 || offset > written) {
+                    return false;
+                }
+                std::size_t matchLength = token & 15;
+                if (matchLength == 15 && !ReadLength(a_input, in, matchLength)) {
+                    return false;
+                }
+                matchLength += kMinMatch;
+                if (matchLength > a_rawSize - written) {
+                    return false;
+                }
+                const char* source = out + written - offset;
+                if (offset >= matchLength) {
+                    std::memcpy(out + written, source, matchLength);
+                } else {
+                    // Byte by byte: the match overlaps the bytes it is producing (a run).
+                    for (std::size_t i = 0; i < matchLength; ++i) {
+                        out[written + i] = source[i];
+                    }
+                }
+                written += matchLength;
+            }
+            return written == a_rawSize;
+        }
+
+    } // namespace Lz4
+
+} // namespace DynamicBookFramework
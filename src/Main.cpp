@@ -5,9 +5,14 @@
 #include "FileWatcher.h"
 #include "SessionDataManager.h"
 #include "API.h"
+#include "ApiInterface.h"
 #include "ImGuiMenu.h"
 #include "InputListener.h"
 #include "Settings.h"
+#include "WorkerPool.h"
+#include "Prefetcher.h"
+#include "BookSearch.h"
+#include "Log.h"
 <<<<<<< Updated upstream
 =======
 #include "ModEventHandler.h"
@@ -43,6 +48,14 @@ void ApiMessageHandler(SKSE::MessagingInterface::Message* a_msg) {
                 }
             }
             break;
+        case DynamicBookFramework_API::kRequestInterface:
+            if (a_msg->data && a_msg->dataLen == sizeof(DynamicBookFramework_API::RequestInterfaceMessage)) {
+                auto* request = static_cast<DynamicBookFramework_API::RequestInterfaceMessage*>(a_msg->data);
+                DynamicBookFramework::ApiInterface::HandleRequest(*request, a_msg->sender);
+            } else {
+                logger::error("RequestInterface API message received with invalid data or data length.");
+            }
+            break;
         default:
             logger::warn("Received unknown API message of type: {}", a_msg->type);
             break;
@@ -81,6 +94,7 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_msg) {
                 if (auto* ui = RE::UI::GetSingleton()) {
                     ui->AddEventSink(DynamicBookFramework::BookMenuWatcher::GetSingleton());
                 }
+                DynamicBookFramework::Log::InstallQuitHook();
 
                 LoadBookMappings();
                 DynamicBookFramework::FileWatcher::Start();
@@ -90,6 +104,9 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_msg) {
                 BookHooks::Install();
 >>>>>>> Stashed changes
                 Settings::LoadSettings();
+                DynamicBookFramework::WorkerPool::GetSingleton()->Start(static_cast<std::size_t>(Settings::workerThreadCount));
+                VerifyBookMappingListing();
+                DynamicBookFramework::Prefetcher::GetSingleton()->Register();
 
                 ModEventHandler::Register();
 
@@ -97,15 +114,36 @@ void MessageHandler(SKSE::MessagingInterface::Message* a_msg) {
             }
             break;
 
+        case SKSE::MessagingInterface::kPostLoadGame:
+            {
+                // Once per session, in the background: the pass reads every book, and saves are rarely deleted mid-session.
+                // Compression runs in the same pass, so each book is rewritten at most once.
+                static bool compacted = false;
+                if ((Settings::compactSaveDataOnLoad || Settings::compressColdBlocks) && !compacted) {
+                    compacted = true;
+                    DynamicBookFramework::SaveCompactor::RetentionPolicy policy;
+                    policy.keepRecentTimelines = static_cast<std::size_t>(Settings::keepRecentTimelines);
+                    policy.removeUnreachable = Settings::compactSaveDataOnLoad;
+                    policy.compressColdBlocks = Settings::compressColdBlocks;
+                    policy.plainRecentSaves = static_cast<std::size_t>(Settings::plainRecentSaves);
+                    DynamicBookFramework::SessionDataManager::GetSingleton()->ScheduleCompaction(policy, false);
+                }
+            }
+            break;
+
         // Handle NewGame, PreLoadGame, and SaveGame events...            
         case SKSE::MessagingInterface::kNewGame:
             DynamicBookFramework::SessionDataManager::GetSingleton()->OnGameLoad(static_cast<const char*>(a_msg->data));
+            DynamicBookFramework::BookSearch::Rebuild();
             break;
         case SKSE::MessagingInterface::kPreLoadGame:
             DynamicBookFramework::SessionDataManager::GetSingleton()->OnGameLoad(static_cast<const char*>(a_msg->data));
+            DynamicBookFramework::Prefetcher::GetSingleton()->GetPolicy().Reset();
+            DynamicBookFramework::BookSearch::Rebuild();
             break;
         case SKSE::MessagingInterface::kSaveGame:
             DynamicBookFramework::SessionDataManager::GetSingleton()->OnGameSave(static_cast<const char*>(a_msg->data));
+            DynamicBookFramework::BookSearch::OnGameSaved();
             break;
         
         case DynamicBookFramework_API::kAppendEntry:
@@ -2,11 +2,34 @@
 #include "PapyrusFuncs.h"
 #include "Utility.h"
 #include "SessionDataManager.h"
+#include "Trace.h"
+#include "DynamicBookRegistry.h"
+#include "BookSearch.h"
+#include "BookMenuWatcher.h"
 #include "PCH.h"
 
 
 namespace { // Anonymous namespace for file-local native function implementations
 
+    // Search natives look at this many hits, so a book with a few matches is not crowded out by busier ones.
+    constexpr std::size_t kMaxScriptSearchHits = 10000;
+
+    // Papyrus strings live in the game's string pool for good, so a whole journal is never handed to a script.
+    constexpr std::size_t kMaxScriptTextBytes = 64 * 1024;
+
+    // The text, cut at the last whole UTF-8 character within kMaxScriptTextBytes.
+    std::string CapForScript(std::string_view text) {
+        if (text.size() <= kMaxScriptTextBytes) {
+            return std::string(text);
+        }
+        std::size_t end = kMaxScriptTextBytes;
+        while (end > 0 && (static_cast<unsigned char>(text[end]) & 0xC0) == 0x80) {
+            --end;
+        }
+        logger::debug("GetBookTextAsync: Cut a {} byte page to {} bytes for Papyrus.", text.size(), end);
+        return std::string(text.substr(0, end));
+    }
+
     // This is the native implementation of your API function.
     // Papyrus scripts will call "AppendToFile" (or whatever you name it).
     // It now uses the SessionDataManager instead of writing to disk directly.
@@ -23,7 +46,7 @@ namespace { // Anonymous namespace for file-local native function implementation
         std::string bookFileKey = bookTitleKeyBS.c_str();
         std::string entry = textToAppend.c_str();
         
-        logger::info("Papyrus AppendToFile called for file key: '{}'. Adding to session buffer.", bookFileKey);
+        logger::debug("Papyrus AppendToFile called for file key: '{}'. Adding to session buffer.", bookFileKey);
 
         // --- THE KEY CHANGE ---
         // Instead of handling file I/O here, we call the framework's core service.
@@ -31,12 +54,135 @@ namespace { // Anonymous namespace for file-local native function implementation
         DynamicBookFramework::SessionDataManager::GetSingleton()->AppendEntry(bookFileKey, entry);
     }
 
+    // Appends many lines in one native call: one VM round trip and one queue push instead of one per line.
+    std::int32_t Papyrus_AppendEntries(RE::StaticFunctionTag* /*base*/, RE::BSFixedString bookTitleKeyBS, std::vector<RE::BSFixedString> lines) {
+        if (bookTitleKeyBS.empty()) {
+            logger::warn("Papyrus AppendEntries called with an empty bookTitleKey.");
+            return 0;
+        }
+        std::vector<std::string> entries;
+        entries.reserve(lines.size());
+        for (const auto& line : lines) {
+            if (line.c_str()) {
+                entries.emplace_back(line.c_str());
+            }
+        }
+        return static_cast<std::int32_t>(DynamicBookFramework::SessionDataManager::GetSingleton()->AppendEntries(bookTitleKeyBS.c_str(), std::move(entries)));
+    }
+
+    // -1 while the book's saved entries are still being counted in the background; ask again a moment later.
+    std::int32_t Papyrus_GetEntryCount(RE::StaticFunctionTag* /*base*/, RE::BSFixedString bookTitleKeyBS) {
+        if (bookTitleKeyBS.empty()) {
+            return 0;
+        }
+        auto count = DynamicBookFramework::SessionDataManager::GetSingleton()->GetEntryCount(bookTitleKeyBS.c_str());
+        return count ? static_cast<std::int32_t>(*count) : -1;
+    }
+
+    std::int32_t Papyrus_GetPendingCount(RE::StaticFunctionTag* /*base*/, RE::BSFixedString bookTitleKeyBS) {
+        if (bookTitleKeyBS.empty()) {
+            return 0;
+        }
+        return static_cast<std::int32_t>(DynamicBookFramework::SessionDataManager::GetSingleton()->GetPendingEntryCount(bookTitleKeyBS.c_str()));
+    }
+
+    // Sends DBF_OnBookTextReady for one request. Called on the game thread.
+    void SendBookTextReady(std::int32_t requestID, RE::FormID bookFormID, std::string_view bookText) {
+        auto* book = bookFormID ? RE::TESForm::LookupByID<RE::TESObjectBOOK>(bookFormID) : nullptr;
+        SKSE::ModCallbackEvent modEvent{ "DBF_OnBookTextReady", RE::BSFixedString(bookText), static_cast<float>(requestID), book };
+        if (auto* modEventSource = SKSE::GetModCallbackEventSource()) {
+            modEventSource->SendEvent(&modEvent);
+        }
+    }
+
+    // Prepares the book the way opening it would and answers with the mod event
+    //     DBF_OnBookTextReady(string eventName, string bookText, float requestID, Form sender)
+    // where bookText is the rendered page HTML, cut to kMaxScriptTextBytes, and sender is the book form. Unmapped
+    // titles get an empty text and None. Returns the request ID, or 0 if nothing was queued.
+    std::int32_t Papyrus_GetBookTextAsync(RE::StaticFunctionTag* /*base*/, RE::BSFixedString bookTitleKeyBS) {
+        static std::atomic<std::int32_t> nextRequestID{ 1 };
+        if (bookTitleKeyBS.empty()) {
+            logger::warn("Papyrus GetBookTextAsync called with an empty bookTitleKey.");
+            return 0;
+        }
+        auto* taskInterface = SKSE::GetTaskInterface();
+        if (!taskInterface) {
+            return 0;
+        }
+        std::int32_t requestID = nextRequestID.fetch_add(1);
+        std::string bookFileKey = bookTitleKeyBS.c_str();
+
+        // The form lookup and the render settings PrefetchBook captures belong to the game thread.
+        taskInterface->AddTask([bookFileKey, requestID]() {
+            auto* book = DynamicBookFramework::DynamicBookRegistry::GetSingleton()->FindBookByTitle(bookFileKey);
+            RE::FormID bookFormID = book ? book->GetFormID() : 0;
+            auto* watcher = DynamicBookFramework::BookMenuWatcher::GetSingleton();
+            bool queued = book && watcher->PrefetchBook(bookFormID, [watcher, bookFormID, requestID]() {
+                std::string bookText;
+                if (auto html = watcher->GetCachedHtmlForBook(bookFormID)) {
+                    bookText = CapForScript(*html);
+                }
+                SKSE::GetTaskInterface()->AddTask([bookFormID, requestID, bookText = std::move(bookText)]() {
+                    SendBookTextReady(requestID, bookFormID, bookText);
+                });
+            });
+            if (!queued) {
+                SendBookTextReady(requestID, 0, {});
+            }
+        });
+        return requestID;
+    }
+
+    // Titles of the books containing every word of the query, most matches first. Reads only the search index.
+    std::vector<RE::BSFixedString> Papyrus_SearchBooks(RE::StaticFunctionTag* /*base*/, RE::BSFixedString queryBS, std::int32_t maxResults) {
+        std::vector<RE::BSFixedString> titles;
+        if (queryBS.empty() || maxResults <= 0) {
+            return titles;
+        }
+        // Hits come grouped by book, so the per-book counts are runs.
+        std::vector<std::pair<std::string, std::size_t>> counts;
+        for (auto& hit : DynamicBookFramework::BookSearch::Query(queryBS.c_str(), kMaxScriptSearchHits)) {
+            if (counts.empty() || counts.back().first != hit.bookKey) {
+                counts.emplace_back(std::move(hit.bookKey), 0);
+            }
+            ++counts.back().second;
+        }
+        std::stable_sort(counts.begin(), counts.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+        for (auto& [title, count] : counts) {
+            if (titles.size() >= static_cast<std::size_t>(maxResults)) {
+                break;
+            }
+            titles.emplace_back(title);
+        }
+        return titles;
+    }
+
+    // Opens the book at the page holding the first match for the query. False if the book has no match.
+    bool Papyrus_OpenBookAtSearchResult(RE::StaticFunctionTag* /*base*/, RE::BSFixedString bookTitleKeyBS, RE::BSFixedString queryBS) {
+        if (bookTitleKeyBS.empty() || queryBS.empty()) {
+            return false;
+        }
+        std::string_view bookTitle = bookTitleKeyBS.c_str();
+        for (const auto& hit : DynamicBookFramework::BookSearch::Query(queryBS.c_str(), kMaxScriptSearchHits)) {
+            if (hit.bookKey == bookTitle) {
+                DynamicBookFramework::BookSearch::OpenAtHit(hit.bookKey, hit.anchor);
+                return true;
+            }
+        }
+        return false;
+    }
+
     void Papyrus_ReloadDynamicBookINI(RE::StaticFunctionTag* /*base*/) {
         logger::info("Papyrus_ReloadDynamicBookINI called. Reloading INI mappings...");
-        LoadBookMappings();
+        LoadBookMappings(DynamicBookFramework::BookMappingCache::ScanMode::kReparseAll);
         // RE::DebugNotification("Dynamic book INI reloaded."); // Optional feedback
     }
 
+    // Writes the activity trace next to the plugin log, for attaching to performance reports.
+    bool Papyrus_DumpTrace(RE::StaticFunctionTag* /*base*/) {
+        return DynamicBookFramework::Trace::DumpToLogFolder().has_value();
+    }
+
 } // end anonymous namespace
 
 namespace PapyrusFuncs {
@@ -48,8 +194,19 @@ namespace PapyrusFuncs {
         }
 
         // The script name "DBF_ScriptUtil" must match the .psc file.
-        a_vm->RegisterFunction("AppendToFile", "DBF_ScriptUtil", Papyrus_AppendToFile);
+        // Callable from tasklets, so the VM runs them on its own thread instead of waiting for a game-thread slot.
+        // None of them waits on the session lock or reads a book: appends only push onto a lock-free queue, the
+        // counts read per-book atomics (draining the queue only if the lock is free), and the search natives read
+        // the index under its own short lock.
+        a_vm->RegisterFunction("AppendToFile", "DBF_ScriptUtil", Papyrus_AppendToFile, true);
+        a_vm->RegisterFunction("AppendEntries", "DBF_ScriptUtil", Papyrus_AppendEntries, true);
+        a_vm->RegisterFunction("GetEntryCount", "DBF_ScriptUtil", Papyrus_GetEntryCount, true);
+        a_vm->RegisterFunction("GetPendingCount", "DBF_ScriptUtil", Papyrus_GetPendingCount, true);
+        a_vm->RegisterFunction("GetBookTextAsync", "DBF_ScriptUtil", Papyrus_GetBookTextAsync, true);
+        a_vm->RegisterFunction("SearchBooks", "DBF_ScriptUtil", Papyrus_SearchBooks, true);
+        a_vm->RegisterFunction("OpenBookAtSearchResult", "DBF_ScriptUtil", Papyrus_OpenBookAtSearchResult);
         a_vm->RegisterFunction("ReloadDynamicBookINI", "DBF_ScriptUtil", Papyrus_ReloadDynamicBookINI);
+        a_vm->RegisterFunction("DumpTrace", "DBF_ScriptUtil", Papyrus_DumpTrace);
         
         logger::info("Registered Papyrus native functions for DBF_ScriptUtil.");
         return true;
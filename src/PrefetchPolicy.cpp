@@ -0,0 +1,65 @@
+//PrefetchPolicy.cpp
+#include "PrefetchPolicy.h"
+
+
+namespace DynamicBookFramework {
+
+    namespace {
+        // Cooldown entries are only pruned once the table grows past this, which it rarely does.
+        constexpr std::size_t kMaxTrackedAttempts = 512;
+    }
+
+    void PrefetchPolicy::SetConfig(const PrefetchConfig& a_config) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _config = a_config;
+    }
+
+    PrefetchConfig PrefetchPolicy::GetConfig() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _config;
+    }
+
+    std::optional<PrefetchJob> PrefetchPolicy::TryBegin(std::uint32_t a_formID, PrefetchSource a_source, bool a_alreadyPrepared, std::size_t a_cachedBytes, Clock::time_point a_now) {
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        bool sourceEnabled = a_source == PrefetchSource::kCrosshair ? _config.crosshair : _config.inventory;
+        if (!sourceEnabled || a_alreadyPrepared || _activeJobs.contains(a_formID)) {
+            return std::nullopt;
+        }
+        if (_activeJobs.size() >= _config.maxConcurrentJobs || a_cachedBytes >= _config.memoryBudgetBytes) {
+            return std::nullopt;
+        }
+
+        // Crosshair events repeat every time the player glances back at the same book.
+        if (auto it = _lastAttempt.find(a_formID); it != _lastAttempt.end() && a_now - it->second < _config.retryCooldown) {
+            return std::nullopt;
+        }
+
+        if (_lastAttempt.size() >= kMaxTrackedAttempts) {
+            std::erase_if(_lastAttempt, [&](const auto& entry) { return a_now - entry.second >= _config.retryCooldown; });
+        }
+        _lastAttempt[a_formID] = a_now;
+        _activeJobs.insert(a_formID);
+        return PrefetchJob{ a_formID, _generation };
+    }
+
+    void PrefetchPolicy::OnJobFinished(const PrefetchJob& a_job) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (a_job.generation == _generation) {
+            _activeJobs.erase(a_job.formID);
+        }
+    }
+
+    std::size_t PrefetchPolicy::GetActiveJobCount() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _activeJobs.size();
+    }
+
+    void PrefetchPolicy::Reset() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        ++_generation;
+        _activeJobs.clear();
+        _lastAttempt.clear();
+    }
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,70 @@
+//Prefetcher.cpp
+#include "Prefetcher.h"
+#include "BookMenuWatcher.h"
+#include "Log.h"
+#include "Trace.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+
+    Prefetcher* Prefetcher::GetSingleton() {
+        static Prefetcher singleton;
+        return &singleton;
+    }
+
+    void Prefetcher::Register() {
+        if (auto* crosshairSource = SKSE::GetCrosshairRefEventSource()) {
+            crosshairSource->AddEventSink(this);
+        } else {
+            Log::Watcher().warn("Prefetcher: Crosshair event source not available. Crosshair prefetch disabled.");
+        }
+        if (auto* scriptEvents = RE::ScriptEventSourceHolder::GetSingleton()) {
+            scriptEvents->AddEventSink<RE::TESContainerChangedEvent>(this);
+        } else {
+            Log::Watcher().warn("Prefetcher: Script event source not available. Inventory prefetch disabled.");
+        }
+        Log::Watcher().info("Prefetcher: Registered for crosshair and container events.");
+    }
+
+    RE::BSEventNotifyControl Prefetcher::ProcessEvent(const SKSE::CrosshairRefEvent* a_event, RE::BSTEventSource<SKSE::CrosshairRefEvent>*) {
+        if (a_event && a_event->crosshairRef) {
+            if (auto* baseObject = a_event->crosshairRef->GetBaseObject()) {
+                Consider(baseObject->As<RE::TESObjectBOOK>(), PrefetchSource::kCrosshair);
+            }
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    RE::BSEventNotifyControl Prefetcher::ProcessEvent(const RE::TESContainerChangedEvent* a_event, RE::BSTEventSource<RE::TESContainerChangedEvent>*) {
+        auto* player = RE::PlayerCharacter::GetSingleton();
+        if (a_event && player && a_event->newContainer == player->GetFormID()) {
+            Consider(RE::TESForm::LookupByID<RE::TESObjectBOOK>(a_event->baseObj), PrefetchSource::kInventory);
+        }
+        return RE::BSEventNotifyControl::kContinue;
+    }
+
+    void Prefetcher::Consider(const RE::TESObjectBOOK* a_book, PrefetchSource a_source) {
+        if (!a_book) {
+            return;
+        }
+        RE::FormID formID = a_book->GetFormID();
+        auto* watcher = BookMenuWatcher::GetSingleton();
+        if (!watcher->IsDynamicBook(formID)) {
+            return;
+        }
+
+        std::size_t cachedBytes = watcher->GetTextCache().GetStats().bytes;
+        auto job = _policy.TryBegin(formID, a_source, watcher->IsBookPrepared(formID), cachedBytes, PrefetchPolicy::Clock::now());
+        if (!job) {
+            return;
+        }
+
+        Log::Watcher().debug("Prefetcher: Warming FormID {:X} ({}).", formID, a_source == PrefetchSource::kCrosshair ? "crosshair" : "inventory");
+        Trace::ScopedEvent traceEvent("Prefetch", "book");
+        if (!watcher->PrefetchBook(formID, [this, job = *job]() { _policy.OnJobFinished(job); })) {
+            _policy.OnJobFinished(*job);
+        }
+    }
+
+} // namespace DynamicBookFramework
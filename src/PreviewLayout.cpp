@@ -0,0 +1,80 @@
+//PreviewLayout.cpp
+#include "PreviewLayout.h"
+
+#include <algorithm>
+
+
+namespace DynamicBookFramework {
+
+    void PreviewLayout::Assign(const std::vector<std::size_t>& a_blockSegments, float a_width, const EstimateFunc& a_estimate) {
+        if (a_width != _width) {
+            _measured.clear();
+            _width = a_width;
+        }
+
+        std::unordered_map<std::size_t, std::vector<float>> measured;
+        _heights.resize(a_blockSegments.size());
+        _slots.resize(a_blockSegments.size());
+        std::size_t index = 0;
+        for (std::size_t i = 0; i < a_blockSegments.size(); ++i) {
+            std::size_t segment = a_blockSegments[i];
+            index = i > 0 && a_blockSegments[i - 1] == segment ? index + 1 : 0;
+            _slots[i] = { segment, index };
+
+            auto& heights = measured[segment];
+            if (heights.size() <= index) {
+                heights.resize(index + 1, 0.0f);
+            }
+            // A segment that is unchanged since the last document produces the same blocks in the same order.
+            if (heights[index] == 0.0f) {
+                if (auto it = _measured.find(segment); it != _measured.end() && index < it->second.size()) {
+                    heights[index] = it->second[index];
+                }
+            }
+            _heights[i] = heights[index] > 0.0f ? heights[index] : a_estimate(i);
+        }
+        // Segments the new document no longer has are dropped with the old table.
+        _measured = std::move(measured);
+        _offsetsDirty = true;
+    }
+
+    float PreviewLayout::GetOffset(std::size_t a_block) const {
+        UpdateOffsets();
+        return _offsets[std::min(a_block, _heights.size())];
+    }
+
+    std::pair<std::size_t, std::size_t> PreviewLayout::GetVisibleRange(float a_top, float a_bottom) const {
+        UpdateOffsets();
+        // _offsets[i + 1] is the bottom of block i.
+        auto first = std::upper_bound(_offsets.begin() + 1, _offsets.end(), a_top);
+        auto last = std::lower_bound(first, _offsets.end(), a_bottom);
+        std::size_t firstBlock = static_cast<std::size_t>(first - _offsets.begin()) - 1;
+        std::size_t lastBlock = std::min(static_cast<std::size_t>(last - _offsets.begin()), _heights.size());
+        return { std::min(firstBlock, lastBlock), lastBlock };
+    }
+
+    void PreviewLayout::SetMeasuredHeight(std::size_t a_block, float a_height) {
+        if (a_block >= _heights.size() || a_height <= 0.0f) {
+            return;
+        }
+        const auto& slot = _slots[a_block];
+        _measured[slot.segment][slot.index] = a_height;
+        if (_heights[a_block] != a_height) {
+            _heights[a_block] = a_height;
+            _offsetsDirty = true;
+        }
+    }
+
+    void PreviewLayout::UpdateOffsets() const {
+        if (!_offsetsDirty) {
+            return;
+        }
+        _offsets.resize(_heights.size() + 1);
+        _offsets[0] = 0.0f;
+        for (std::size_t i = 0; i < _heights.size(); ++i) {
+            _offsets[i + 1] = _offsets[i] + _heights[i];
+        }
+        _offsetsDirty = false;
+    }
+
+} // namespace DynamicBookFramework
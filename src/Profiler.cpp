@@ -0,0 +1,142 @@
+//Profiler.cpp
+#include "Profiler.h"
+#include "PCH.h"
+#include <bit>
+#include <cmath>
+
+
+namespace DynamicBookFramework {
+    namespace Profiler {
+
+        namespace { // Anonymous namespace for the histogram storage
+
+            constexpr std::size_t kStageCount = static_cast<std::size_t>(Stage::kCount);
+
+            // Log-linear buckets: four sub-buckets per power of two of nanoseconds covers 1ns to ~584 years in 256 slots.
+            constexpr unsigned kSubBucketBits = 2;
+            constexpr std::size_t kSubBuckets = 1u << kSubBucketBits;
+            constexpr std::size_t kBucketCount = 64 * kSubBuckets;
+
+            struct Histogram {
+                std::array<std::atomic<std::uint64_t>, kBucketCount> buckets{};
+                std::atomic<std::uint64_t> count{ 0 };
+                std::atomic<std::uint64_t> totalNs{ 0 };
+                std::atomic<std::uint64_t> maxNs{ 0 };
+            };
+
+            std::array<Histogram, kStageCount> g_histograms;
+
+            constexpr std::size_t BucketIndex(std::uint64_t a_value) {
+                if (a_value < kSubBuckets) {
+                    return static_cast<std::size_t>(a_value);
+                }
+                unsigned exponent = static_cast<unsigned>(std::bit_width(a_value)) - 1;
+                std::size_t subBucket = static_cast<std::size_t>(a_value >> (exponent - kSubBucketBits)) & (kSubBuckets - 1);
+                return exponent * kSubBuckets + subBucket;
+            }
+
+            // The largest value that lands in a bucket, so reported percentiles never understate.
+            constexpr std::uint64_t BucketUpperBound(std::size_t a_index) {
+                std::size_t exponent = a_index / kSubBuckets;
+                std::size_t subBucket = a_index % kSubBuckets;
+                if (exponent < kSubBucketBits) {
+                    return a_index;
+                }
+                std::uint64_t width = std::uint64_t{ 1 } << (exponent - kSubBucketBits);
+                return ((kSubBuckets + subBucket) * width) + (width - 1);
+            }
+
+            static_assert(BucketIndex(0) == 0 && BucketIndex(3) == 3);
+            static_assert(BucketIndex(4) == 8 && BucketIndex(7) == 11 && BucketIndex(8) == 12);
+            static_assert(BucketIndex(~std::uint64_t{ 0 }) == kBucketCount - 1);
+            static_assert(BucketUpperBound(BucketIndex(1000)) >= 1000);
+
+            constexpr std::array<const char*, kStageCount> kStageNames{
+                "Prepare: total",
+                "Prepare: get content",
+                "Prepare: bookmarks",
+                "Prepare: markup",
+                "Prepare: font wrapper",
+
+                "GetFullContent: total",
+                "GetFullContent: parse file",
+                "GetFullContent: history chain",
+                "GetFullContent: assemble",
+
+                "Markup: ProcessChunk",
+
+                "OnGameSave: total",
+                "OnGameSave: history log",
+                "OnGameSave: write blocks",
+
+                "Refresh: total",
+                "Refresh: reload",
+                "Refresh: SetBookText"
+            };
+        }
+
+        void Record(Stage a_stage, std::uint64_t a_nanoseconds) noexcept {
+            auto& histogram = g_histograms[static_cast<std::size_t>(a_stage)];
+            histogram.buckets[BucketIndex(a_nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+            histogram.count.fetch_add(1, std::memory_order_relaxed);
+            histogram.totalNs.fetch_add(a_nanoseconds, std::memory_order_relaxed);
+
+            auto currentMax = histogram.maxNs.load(std::memory_order_relaxed);
+            while (a_nanoseconds > currentMax &&
+                   !histogram.maxNs.compare_exchange_weak(currentMax, a_nanoseconds, std::memory_order_relaxed)) {
+            }
+        }
+
+        StageStats GetStats(Stage a_stage) {
+            const auto& histogram = g_histograms[static_cast<std::size_t>(a_stage)];
+
+            // Snapshot the buckets first; the count is taken from them so percentiles stay consistent with concurrent writers.
+            std::array<std::uint64_t, kBucketCount> snapshot{};
+            std::uint64_t bucketTotal = 0;
+            for (std::size_t i = 0; i < kBucketCount; ++i) {
+                snapshot[i] = histogram.buckets[i].load(std::memory_order_relaxed);
+                bucketTotal += snapshot[i];
+            }
+
+            StageStats stats;
+            stats.count = bucketTotal;
+            stats.totalNs = histogram.totalNs.load(std::memory_order_relaxed);
+            stats.maxNs = histogram.maxNs.load(std::memory_order_relaxed);
+            if (bucketTotal == 0) {
+                return stats;
+            }
+
+            auto percentile = [&](double a_fraction) {
+                auto rank = static_cast<std::uint64_t>(std::ceil(a_fraction * static_cast<double>(bucketTotal)));
+                std::uint64_t seen = 0;
+                for (std::size_t i = 0; i < kBucketCount; ++i) {
+                    seen += snapshot[i];
+                    if (seen >= rank) {
+                        return std::min(BucketUpperBound(i), stats.maxNs);
+                    }
+                }
+                return stats.maxNs;
+            };
+            stats.p50Ns = percentile(0.50);
+            stats.p95Ns = percentile(0.95);
+            stats.p99Ns = percentile(0.99);
+            return stats;
+        }
+
+        void Reset() {
+            for (auto& histogram : g_histograms) {
+                for (auto& bucket : histogram.buckets) {
+                    bucket.store(0, std::memory_order_relaxed);
+                }
+                histogram.count.store(0, std::memory_order_relaxed);
+                histogram.totalNs.store(0, std::memory_order_relaxed);
+                histogram.maxNs.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        const char* GetStageName(Stage a_stage) {
+            return kStageNames[static_cast<std::size_t>(a_stage)];
+        }
+
+    } // namespace Profiler
+} // namespace DynamicBookFramework
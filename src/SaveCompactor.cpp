@@ -0,0 +1,188 @@
+//SaveCompactor.cpp
+#include "SaveCompactor.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace DynamicBookFramework {
+    namespace SaveCompactor {
+
+        namespace { // Anonymous namespace for line handling
+
+            constexpr std::string_view kBlockStart = ";;SAVE_BLOCK ";
+            constexpr std::string_view kBlockEnd = ";;END_SAVE_DATA;;";
+
+            // Lines are split on '\n' and keep it; files written in text mode also carry a '\r' before it.
+            std::string_view NextLine(std::string_view a_text, std::size_t& a_pos) {
+                std::size_t end = a_text.find('\n', a_pos);
+                end = end == std::string_view::npos ? a_text.size() : end + 1;
+                std::string_view line = a_text.substr(a_pos, end - a_pos);
+                a_pos = end;
+                return line;
+            }
+
+            bool IsBlank(std::string_view a_line) {
+                return a_line.find_first_not_of("\r\n") == std::string_view::npos;
+            }
+
+            // Save IDs are stored without the .ess extension, but be lenient with records written before that was enforced.
+            std::string_view StripExtension(std::string_view a_id) {
+                if (a_id.size() > 4 && a_id.substr(a_id.size() - 4) == ".ess") {
+                    a_id.remove_suffix(4);
+                }
+                return a_id;
+            }
+        }
+
+        std::string_view ParseValue(std::string_view a_line, std::string_view a_key) {
+            std::size_t pos = 0;
+            while ((pos = a_line.find(a_key, pos)) != std::string_view::npos) {
+                bool wordStart = pos == 0 || a_line[pos - 1] == ' ';
+                std::size_t valueStart = pos + a_key.size();
+                if (wordStart && a_line.substr(valueStart, 2) == "=\"") {
+                    valueStart += 2;
+                    std::size_t valueEnd = a_line.find('"', valueStart);
+                    return valueEnd == std::string_view::npos ? std::string_view() : a_line.substr(valueStart, valueEnd - valueStart);
+                }
+                pos = valueStart;
+            }
+            return {};
+        }
+
+        std::vector<HistoryRecord> ParseHistory(std::string_view a_historyText) {
+            std::vector<HistoryRecord> records;
+            std::size_t pos = 0;
+            while (pos < a_historyText.size()) {
+                std::string_view line = NextLine(a_historyText, pos);
+                std::string_view id = ParseValue(line, "ID");
+                if (id.empty()) {
+                    continue;
+                }
+                records.push_back({ std::string(StripExtension(id)), std::string(ParseValue(line, "TIMELINE")),
+                                    std::string(StripExtension(ParseValue(line, "PARENT"))) });
+            }
+            return records;
+        }
+
+        std::unordered_set<std::string> FindLiveSaves(const std::vector<HistoryRecord>& a_history,
+            const std::vector<std::string>& a_roots, const RetentionPolicy& a_policy) {
+            // A save ID is logged again every time it is overwritten; the last record is the one AssembleContent follows.
+            std::unordered_map<std::string_view, std::string_view> parents;
+            for (const auto& record : a_history) {
+                parents[record.id] = record.parent;
+            }
+
+            std::vector<std::string_view> roots;
+            for (const auto& root : a_roots) {
+                roots.push_back(StripExtension(root));
+            }
+            if (a_policy.keepRecentTimelines > 0) {
+                // Timeline IDs are creation timestamps (YYYY-MM-DD_HH-MM-SS), so they sort by age.
+                std::vector<std::string_view> timelines;
+                for (const auto& record : a_history) {
+                    if (!record.timeline.empty()) {
+                        timelines.push_back(record.timeline);
+                    }
+                }
+                std::sort(timelines.begin(), timelines.end(), std::greater<>());
+                timelines.erase(std::unique(timelines.begin(), timelines.end()), timelines.end());
+                if (timelines.size() > a_policy.keepRecentTimelines) {
+                    timelines.resize(a_policy.keepRecentTimelines);
+                }
+                for (const auto& record : a_history) {
+                    if (std::find(timelines.begin(), timelines.end(), record.timeline) != timelines.end()) {
+                        roots.push_back(record.id);
+                    }
+                }
+            }
+
+            // Retained saves are roots too: a save kept without its ancestors could not show its own history.
+            std::unordered_set<std::string> live;
+            for (std::string_view id : roots) {
+                // The length bound stops a corrupt log whose parents form a cycle.
+                for (std::size_t steps = 0; !id.empty() && steps <= parents.size(); ++steps) {
+                    if (!live.emplace(id).second) {
+                        break; // The rest of this chain is already live.
+                    }
+                    auto it = parents.find(id);
+                    if (it == parents.end()) {
+                        break;
+                    }
+                    id = it->second;
+                }
+            }
+            return live;
+        }
+
+        BookResult CompactBook(std::string_view a_text, const std::unordered_set<std::string>& a_live) {
+            BookResult result;
+            result.text.reserve(a_text.size());
+            std::size_t pos = 0;
+            std::size_t pendingBlank = std::string_view::npos; // Start of a blank line not yet copied
+            while (pos < a_text.size()) {
+                std::size_t lineStart = pos;
+                std::string_view line = NextLine(a_text, pos);
+
+                if (line.starts_with(kBlockStart)) {
+                    // Find the end marker; a block cut off by a crash is left alone.
+                    std::size_t scan = pos;
+                    std::size_t blockEnd = std::string_view::npos;
+                    while (scan < a_text.size()) {
+                        std::string_view inner = NextLine(a_text, scan);
+                        if (inner.starts_with(kBlockEnd)) {
+                            blockEnd = scan;
+                            break;
+                        }
+                        if (inner.starts_with(kBlockStart)) {
+                            break;
+                        }
+                    }
+                    std::string id(StripExtension(ParseValue(line, "ID")));
+                    if (blockEnd != std::string_view::npos && !a_live.contains(id)) {
+                        ++result.blocksRemoved;
+                        pendingBlank = std::string_view::npos; // OnGameSave wrote it as part of the block
+                        pos = blockEnd;
+                        continue;
+                    }
+                    if (blockEnd != std::string_view::npos) {
+                        ++result.blocksKept;
+                    }
+                }
+
+                if (pendingBlank != std::string_view::npos) {
+                    result.text.append(a_text.substr(pendingBlank, lineStart - pendingBlank));
+                    pendingBlank = std::string_view::npos;
+                }
+                if (IsBlank(line)) {
+                    pendingBlank = lineStart;
+                } else {
+                    result.text.append(line);
+                }
+            }
+            if (pendingBlank != std::string_view::npos) {
+                result.text.append(a_text.substr(pendingBlank));
+            }
+            return result;
+        }
+
+        std::size_t CompactHistory(std::string_view a_historyText, const std::unordered_set<std::string>& a_live, std::string& a_out) {
+            a_out.clear();
+            a_out.reserve(a_historyText.size());
+            std::size_t removed = 0;
+            std::size_t pos = 0;
+            while (pos < a_historyText.size()) {
+                std::string_view line = NextLine(a_historyText, pos);
+                std::string_view id = ParseValue(line, "ID");
+                if (!id.empty() && !a_live.contains(std::string(StripExtension(id)))) {
+                    ++removed;
+                    continue;
+                }
+                a_out.append(line);
+            }
+            return removed;
+        }
+
+    } // namespace SaveCompactor
+
+} // namespace DynamicBookFramework
@@ -0,0 +1,280 @@
+//SearchIndex.cpp
+#include "SearchIndex.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+
+namespace DynamicBookFramework {
+
+    namespace { // Anonymous namespace for snippet and anchor helpers
+
+        constexpr std::size_t kSnippetBefore = 40;
+        constexpr std::size_t kSnippetAfter = 60;
+
+        constexpr std::string_view kAnchorOpen = "<a name='";
+        constexpr std::string_view kBookmarkOpen = "[bookmark";
+
+        // Cuts a view back to the nearest UTF-8 character boundary so snippets never start or end mid-character.
+        std::size_t AlignToCharacter(std::string_view a_text, std::size_t a_pos) {
+            while (a_pos > 0 && a_pos < a_text.size() && (static_cast<unsigned char>(a_text[a_pos]) & 0xC0) == 0x80) {
+                --a_pos;
+            }
+            return a_pos;
+        }
+    }
+
+    std::uint32_t SearchIndex::GetOrAddBook(const std::string& a_bookKey) {
+        if (auto it = _bookIds.find(a_bookKey); it != _bookIds.end()) {
+            return it->second;
+        }
+        std::uint32_t id;
+        if (!_freeBooks.empty()) {
+            id = _freeBooks.back();
+            _freeBooks.pop_back();
+        } else {
+            id = static_cast<std::uint32_t>(_books.size());
+            _books.emplace_back();
+        }
+        _books[id].key = a_bookKey;
+        _books[id].live = true;
+        _bookIds.emplace(a_bookKey, id);
+        return id;
+    }
+
+    void SearchIndex::IndexText(std::uint32_t a_book, std::size_t a_from) {
+        Book& book = _books[a_book];
+        std::string_view text(book.text);
+
+        Tokenize(text.substr(a_from), a_from, [&](std::string_view a_token, std::size_t a_offset) {
+            auto it = _tokenIds.find(a_token);
+            if (it == _tokenIds.end()) {
+                it = _tokenIds.emplace(std::string(a_token), static_cast<std::uint32_t>(_postings.size())).first;
+                _postings.emplace_back();
+            }
+            auto& postings = _postings[it->second];
+            if (postings.empty() || postings.back().book != a_book) {
+                book.tokens.push_back(it->second);
+            }
+            postings.push_back({ a_book, static_cast<std::uint32_t>(a_offset) });
+        });
+
+        // Save blocks get an <a name='ID'> from SessionDataManager; [bookmarkN] tags are the anchors the bookmark hotkeys use.
+        for (std::size_t pos = text.find(kAnchorOpen, a_from); pos != std::string_view::npos; pos = text.find(kAnchorOpen, pos + 1)) {
+            std::size_t nameStart = pos + kAnchorOpen.size();
+            std::size_t nameEnd = text.find('\'', nameStart);
+            if (nameEnd != std::string_view::npos) {
+                book.anchors.push_back({ static_cast<std::uint32_t>(pos), std::string(text.substr(nameStart, nameEnd - nameStart)) });
+            }
+        }
+        for (std::size_t pos = text.find(kBookmarkOpen, a_from); pos != std::string_view::npos; pos = text.find(kBookmarkOpen, pos + 1)) {
+            std::size_t tagEnd = text.find(']', pos);
+            if (tagEnd != std::string_view::npos) {
+                book.anchors.push_back({ static_cast<std::uint32_t>(pos), std::string(text.substr(pos, tagEnd - pos + 1)) });
+            }
+        }
+        std::stable_sort(book.anchors.begin(), book.anchors.end(), [](const Anchor& a, const Anchor& b) { return a.offset < b.offset; });
+    }
+
+    void SearchIndex::RemoveBookLocked(std::uint32_t a_book) {
+        Book& book = _books[a_book];
+        std::sort(book.tokens.begin(), book.tokens.end());
+        book.tokens.erase(std::unique(book.tokens.begin(), book.tokens.end()), book.tokens.end());
+        for (auto token : book.tokens) {
+            std::erase_if(_postings[token], [a_book](const Posting& p) { return p.book == a_book; });
+        }
+        book.tokens.clear();
+        book.anchors.clear();
+        book.text.clear();
+    }
+
+    void SearchIndex::ReplaceBook(const std::string& a_bookKey, std::string a_text) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::uint32_t id = GetOrAddBook(a_bookKey);
+        RemoveBookLocked(id);
+        _books[id].text = std::move(a_text);
+        IndexText(id, 0);
+        ++_version;
+    }
+
+    void SearchIndex::AppendToBook(const std::string& a_bookKey, std::string_view a_text) {
+        if (a_text.empty()) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::uint32_t id = GetOrAddBook(a_bookKey);
+        std::size_t from = _books[id].text.size();
+        _books[id].text.append(a_text);
+        IndexText(id, from);
+        ++_version;
+    }
+
+    void SearchIndex::RemoveBook(std::string_view a_bookKey) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _bookIds.find(std::string(a_bookKey));
+        if (it == _bookIds.end()) {
+            return;
+        }
+        std::uint32_t id = it->second;
+        RemoveBookLocked(id);
+        _books[id].live = false;
+        _books[id].key.clear();
+        _freeBooks.push_back(id);
+        _bookIds.erase(it);
+        ++_version;
+    }
+
+    void SearchIndex::Clear() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _books.clear();
+        _bookIds.clear();
+        _freeBooks.clear();
+        _tokenIds.clear();
+        _postings.clear();
+        ++_version;
+    }
+
+    std::string SearchIndex::MakeSnippet(const Book& a_book, std::uint32_t a_offset, std::size_t a_length) const {
+        std::string_view text(a_book.text);
+        std::size_t begin = AlignToCharacter(text, a_offset > kSnippetBefore ? a_offset - kSnippetBefore : 0);
+        std::size_t end = AlignToCharacter(text, std::min(text.size(), a_offset + a_length + kSnippetAfter));
+
+        std::string snippet;
+        snippet.reserve(end - begin + 6);
+        if (begin > 0) {
+            snippet += "...";
+        }
+        for (std::size_t pos = begin; pos < end; ++pos) {
+            char c = text[pos];
+            if (c == '<') {
+                std::size_t tagEnd = text.find('>', pos);
+                if (tagEnd != std::string_view::npos && tagEnd < end && tagEnd - pos <= kMaxTagLength) {
+                    pos = tagEnd;
+                    continue;
+                }
+            }
+            bool space = c == '\n' || c == '\r' || c == '\t';
+            if (space && (snippet.empty() || snippet.back() == ' ')) {
+                continue;
+            }
+            snippet.push_back(space ? ' ' : c);
+        }
+        if (end < text.size()) {
+            snippet += "...";
+        }
+        return snippet;
+    }
+
+    std::string SearchIndex::FindAnchor(const Book& a_book, std::uint32_t a_offset) const {
+        auto it = std::upper_bound(a_book.anchors.begin(), a_book.anchors.end(), a_offset,
+            [](std::uint32_t offset, const Anchor& anchor) { return offset < anchor.offset; });
+        return it == a_book.anchors.begin() ? std::string() : std::prev(it)->name;
+    }
+
+    std::vector<SearchIndex::Hit> SearchIndex::Query(std::string_view a_query, std::size_t a_maxHits) const {
+        std::vector<std::string> words;
+        Tokenize(a_query, 0, [&](std::string_view a_token, std::size_t) { words.emplace_back(a_token); });
+        if (words.empty() || a_maxHits == 0) {
+            return {};
+        }
+
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // Postings per query word; the last word collects every token it is a prefix of.
+        std::vector<std::vector<const std::vector<Posting>*>> wordPostings(words.size());
+        std::vector<std::size_t> wordLengths(words.size(), 0);
+        for (std::size_t i = 0; i + 1 < words.size(); ++i) {
+            auto it = _tokenIds.find(words[i]);
+            if (it == _tokenIds.end()) {
+                return {};
+            }
+            wordPostings[i].push_back(&_postings[it->second]);
+            wordLengths[i] = words[i].size();
+        }
+        const std::string& last = words.back();
+        wordLengths.back() = last.size();
+        if (auto it = _tokenIds.find(last); it != _tokenIds.end()) {
+            wordPostings.back().push_back(&_postings[it->second]);
+        }
+        for (const auto& [token, id] : _tokenIds) {
+            if (token.size() > last.size() && token.starts_with(last)) {
+                wordPostings.back().push_back(&_postings[id]);
+            }
+        }
+        if (wordPostings.back().empty()) {
+            return {};
+        }
+
+        // Books that contain every word.
+        std::unordered_set<std::uint32_t> books;
+        for (std::size_t i = 0; i < words.size(); ++i) {
+            std::unordered_set<std::uint32_t> wordBooks;
+            for (const auto* postings : wordPostings[i]) {
+                for (const auto& posting : *postings) {
+                    if (i == 0 || books.contains(posting.book)) {
+                        wordBooks.insert(posting.book);
+                    }
+                }
+            }
+            books = std::move(wordBooks);
+            if (books.empty()) {
+                return {};
+            }
+        }
+
+        // Report the occurrences of the first word in those books.
+        std::vector<Posting> matches;
+        for (const auto* postings : wordPostings.front()) {
+            for (const auto& posting : *postings) {
+                if (books.contains(posting.book)) {
+                    matches.push_back(posting);
+                }
+            }
+        }
+        std::sort(matches.begin(), matches.end(), [this](const Posting& a, const Posting& b) {
+            if (a.book != b.book) {
+                return _books[a.book].key < _books[b.book].key;
+            }
+            return a.offset < b.offset;
+        });
+        if (matches.size() > a_maxHits) {
+            matches.resize(a_maxHits);
+        }
+
+        std::vector<Hit> hits;
+        hits.reserve(matches.size());
+        for (const auto& match : matches) {
+            const Book& book = _books[match.book];
+            hits.push_back({ book.key, match.offset, MakeSnippet(book, match.offset, wordLengths.front()), FindAnchor(book, match.offset) });
+        }
+        return hits;
+    }
+
+    SearchIndex::Stats SearchIndex::GetStats() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        Stats stats;
+        stats.tokens = _tokenIds.size();
+        for (const auto& book : _books) {
+            if (!book.live) {
+                continue;
+            }
+            ++stats.books;
+            stats.textBytes += book.text.capacity();
+            stats.memoryBytes += sizeof(Book) + book.key.capacity() + book.text.capacity() +
+                                 book.tokens.capacity() * sizeof(std::uint32_t) + book.anchors.capacity() * sizeof(Anchor);
+            for (const auto& anchor : book.anchors) {
+                stats.memoryBytes += anchor.name.capacity();
+            }
+        }
+        for (const auto& [token, id] : _tokenIds) {
+            // Node, key and bucket per token, roughly.
+            stats.memoryBytes += token.capacity() + sizeof(std::string) + 3 * sizeof(void*) + sizeof(std::uint32_t);
+        }
+        for (const auto& postings : _postings) {
+            stats.postings += postings.size();
+            stats.memoryBytes += sizeof(postings) + postings.capacity() * sizeof(Posting);
+        }
+        return stats;
+    }
+
+} // namespace DynamicBookFramework
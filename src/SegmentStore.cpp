@@ -0,0 +1,421 @@
+//SegmentStore.cpp
+#include "SegmentStore.h"
+#include "BlockCodec.h"
+#include "BookFile.h"
+#include "SaveCompactor.h"
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <optional>
+#include <set>
+#include <system_error>
+
+
+namespace DynamicBookFramework {
+    namespace SegmentStore {
+
+        namespace { // Anonymous namespace for parsing book text into template and blocks
+
+            constexpr std::string_view kBlockStart = ";;SAVE_BLOCK ";
+            constexpr std::string_view kBlockEnd = ";;END_SAVE_DATA;;";
+            constexpr std::string_view kSegmentExtension = ".txt";
+
+            struct Block {
+                std::string id;
+                std::string timeline;
+                std::string text;    // The block as stored, from the blank line before it through the end marker
+                std::string content; // The lines between them, each ending in '\n', without '\r'
+                std::optional<std::size_t> rawSize; // Set if content holds the block compressed (see BlockCodec)
+                bool blankBefore = false;
+            };
+
+            struct ParsedFile {
+                std::string staticText;               // Everything outside complete blocks, as stored
+                std::size_t journalOffset = std::string::npos; // Where in staticText the journal goes
+                std::vector<Block> blocks;
+            };
+
+            std::string_view NextLine(std::string_view a_text, std::size_t& a_pos) {
+                std::size_t end = a_text.find('\n', a_pos);
+                end = end == std::string_view::npos ? a_text.size() : end + 1;
+                std::string_view line = a_text.substr(a_pos, end - a_pos);
+                a_pos = end;
+                return line;
+            }
+
+            // The line without its '\n' or '\r\n', as std::getline on a text-mode stream returns it.
+            std::string_view TrimEnd(std::string_view a_line) {
+                while (!a_line.empty() && (a_line.back() == '\n' || a_line.back() == '\r')) {
+                    a_line.remove_suffix(1);
+                }
+                return a_line;
+            }
+
+            /**
+             * Splits a book into static text and complete blocks. A block cut off by a crash stays in the static text
+             * as stored. The blank line OnGameSave writes ahead of each block moves with the block.
+             */
+            ParsedFile Parse(std::string_view a_text) {
+                ParsedFile parsed;
+                parsed.staticText.reserve(a_text.size());
+                std::size_t pos = 0;
+                std::size_t pendingBlank = std::string_view::npos; // Start of a blank line not yet copied
+                while (pos < a_text.size()) {
+                    std::size_t lineStart = pos;
+                    std::string_view line = NextLine(a_text, pos);
+
+                    if (line.starts_with(kBlockStart)) {
+                        Block block;
+                        std::size_t scan = pos;
+                        bool complete = false;
+                        while (scan < a_text.size()) {
+                            std::string_view inner = NextLine(a_text, scan);
+                            if (inner.starts_with(kBlockEnd)) {
+                                complete = true;
+                                break;
+                            }
+                            if (inner.starts_with(kBlockStart)) {
+                                break;
+                            }
+                            block.content.append(TrimEnd(inner));
+                            block.content.push_back('\n');
+                        }
+                        if (complete) {
+                            if (parsed.journalOffset == std::string::npos) {
+                                parsed.journalOffset = parsed.staticText.size();
+                            }
+                            std::size_t blockStart = pendingBlank != std::string_view::npos ? pendingBlank : lineStart;
+                            pendingBlank = std::string_view::npos;
+                            block.blankBefore = blockStart != lineStart;
+                            block.id = SaveCompactor::ParseValue(line, "ID");
+                            block.timeline = SaveCompactor::ParseValue(line, "TIMELINE");
+                            block.rawSize = BlockCodec::GetRawSize(line);
+                            block.text = a_text.substr(blockStart, scan - blockStart);
+                            parsed.blocks.push_back(std::move(block));
+                            pos = scan;
+                            continue;
+                        }
+                    }
+
+                    if (pendingBlank != std::string_view::npos) {
+                        parsed.staticText.append(a_text.substr(pendingBlank, lineStart - pendingBlank));
+                        pendingBlank = std::string_view::npos;
+                    }
+                    if (TrimEnd(line).empty() && line.ends_with('\n')) {
+                        pendingBlank = lineStart;
+                    } else {
+                        parsed.staticText.append(line);
+                    }
+                }
+                if (pendingBlank != std::string_view::npos) {
+                    parsed.staticText.append(a_text.substr(pendingBlank));
+                }
+                return parsed;
+            }
+
+            bool ReadFile(const std::filesystem::path& a_path, std::string& a_out) {
+                std::ifstream file(a_path, std::ios::binary | std::ios::ate);
+                if (!file.is_open()) {
+                    return false;
+                }
+                auto size = file.tellg();
+                if (size < 0) {
+                    return false;
+                }
+                a_out.resize(static_cast<std::size_t>(size));
+                file.seekg(0);
+                file.read(a_out.data(), static_cast<std::streamsize>(a_out.size()));
+                return file.gcount() == static_cast<std::streamsize>(a_out.size());
+            }
+
+            // Timeline IDs are timestamps, but the file name must survive whatever a hand-edited history holds.
+            std::string SegmentFileName(std::string_view a_timeline) {
+                std::string name;
+                for (char c : a_timeline) {
+                    bool safe = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '-' || c == '_' || c == '.';
+                    name.push_back(safe ? c : '_');
+                }
+                if (name.empty()) {
+                    name = "_untimed";
+                }
+                name += kSegmentExtension;
+                return name;
+            }
+        }
+
+        std::filesystem::path GetDirectory(const std::filesystem::path& a_bookPath) {
+            auto directory = a_bookPath;
+            directory.replace_extension(L".segments");
+            return directory;
+        }
+
+        bool IsSegmented(const std::filesystem::path& a_bookPath) {
+            std::error_code ec;
+            return std::filesystem::is_directory(GetDirectory(a_bookPath), ec);
+        }
+
+        std::filesystem::path GetSegmentPath(const std::filesystem::path& a_bookPath, std::string_view a_timeline) {
+            return GetDirectory(a_bookPath) / SegmentFileName(a_timeline);
+        }
+
+        std::vector<std::filesystem::path> ListSegments(const std::filesystem::path& a_bookPath) {
+            std::vector<std::filesystem::path> segments;
+            std::error_code ec;
+            for (const auto& entry : std::filesystem::directory_iterator(GetDirectory(a_bookPath), ec)) {
+                if (entry.is_regular_file(ec) && entry.path().extension() == kSegmentExtension) {
+                    segments.push_back(entry.path());
+                }
+            }
+            // Timeline names are creation timestamps, so this is oldest first.
+            std::sort(segments.begin(), segments.end());
+            return segments;
+        }
+
+        std::string Assemble(const std::filesystem::path& a_bookPath, const std::vector<ChainLink>& a_chain, std::size_t* a_entryLineCount) {
+            std::string templateText;
+            if (!ReadFile(a_bookPath, templateText)) {
+                return {};
+            }
+
+            // Only the timelines on the chain are opened. A save missing from the history could be in any of them.
+            bool needAll = std::any_of(a_chain.begin(), a_chain.end(), [](const ChainLink& link) { return link.timeline.empty(); });
+            std::vector<std::filesystem::path> segmentPaths;
+            if (needAll) {
+                segmentPaths = ListSegments(a_bookPath);
+            } else {
+                std::set<std::string_view> timelines;
+                for (const auto& link : a_chain) {
+                    if (timelines.insert(link.timeline).second) {
+                        segmentPaths.push_back(GetSegmentPath(a_bookPath, link.timeline));
+                    }
+                }
+            }
+
+            // The content a save shows is its last block in its own timeline's segment, as the history resolves it.
+            std::map<std::pair<std::string, std::string>, Block> blocks;
+            std::string segmentText;
+            for (const auto& segmentPath : segmentPaths) {
+                if (!ReadFile(segmentPath, segmentText)) {
+                    continue;
+                }
+                std::string fileTimeline = segmentPath.stem().string();
+                for (auto& block : Parse(segmentText).blocks) {
+                    std::string id = block.id;
+                    blocks[{ needAll ? std::string() : fileTimeline, std::move(id) }] = std::move(block);
+                }
+            }
+
+            std::string journal;
+            for (const auto& link : a_chain) {
+                std::string timelineKey = needAll ? std::string() : GetSegmentPath(a_bookPath, link.timeline).stem().string();
+                auto it = blocks.find({ timelineKey, link.id });
+                if (it == blocks.end()) {
+                    continue;
+                }
+                // Compressed blocks are decoded only here, once the chain has picked them.
+                if (it->second.rawSize) {
+                    auto decoded = BlockCodec::Decode(it->second.content, *it->second.rawSize);
+                    it->second.content = decoded ? std::move(*decoded) : std::string();
+                    it->second.rawSize.reset();
+                }
+                // A single file shows the blank line written ahead of a block as static text.
+                if (it->second.blankBefore) {
+                    journal += '\n';
+                }
+                journal += "<a name='" + link.id + "'></a>";
+                journal += it->second.content;
+                if (a_entryLineCount) {
+                    *a_entryLineCount += static_cast<std::size_t>(std::count(it->second.content.begin(), it->second.content.end(), '\n'));
+                }
+            }
+
+            // The template is read the way a single file is: line by line, without '\r', complete blocks skipped.
+            std::string assembled;
+            assembled.reserve(templateText.size() + journal.size());
+            bool journalPlaced = false;
+            std::size_t pos = 0;
+            bool inBlock = false;
+            while (pos < templateText.size()) {
+                std::string_view line = TrimEnd(NextLine(templateText, pos));
+                if (line.starts_with(kBlockStart)) {
+                    inBlock = true;
+                } else if (line.starts_with(kBlockEnd)) {
+                    inBlock = false;
+                } else if (inBlock) {
+                    continue;
+                } else if (line == kJournalMarker) {
+                    if (!journalPlaced) {
+                        assembled += journal;
+                        journalPlaced = true;
+                    }
+                } else {
+                    assembled.append(line);
+                    assembled.push_back('\n');
+                }
+            }
+            if (!journalPlaced) {
+                assembled += journal;
+            }
+            return assembled;
+        }
+
+        bool AppendBlock(const std::filesystem::path& a_bookPath, std::string_view a_timeline, std::string_view a_blockText) {
+            std::error_code ec;
+            std::filesystem::create_directories(GetDirectory(a_bookPath), ec);
+            // Text mode, as OnGameSave writes a single-file book, so both layouts hold the same bytes.
+            std::ofstream out(GetSegmentPath(a_bookPath, a_timeline), std::ios::app);
+            if (!out.is_open()) {
+                return false;
+            }
+            out.write(a_blockText.data(), static_cast<std::streamsize>(a_blockText.size()));
+            out.flush();
+            return out.good();
+        }
+
+        MigrationResult Split(const std::filesystem::path& a_bookPath) {
+            MigrationResult result;
+            if (IsSegmented(a_bookPath)) {
+                result.error = "already segmented";
+                return result;
+            }
+            std::string text;
+            if (!ReadFile(a_bookPath, text)) {
+                result.error = "could not read the book";
+                return result;
+            }
+
+            ParsedFile parsed = Parse(text);
+            std::map<std::string, std::string> segments;
+            for (const auto& block : parsed.blocks) {
+                segments[SegmentFileName(block.timeline)] += block.text;
+            }
+            std::string templateText = std::move(parsed.staticText);
+            if (parsed.journalOffset != std::string::npos) {
+                std::string_view lineEnd = templateText.find("\r\n") != std::string::npos ? "\r\n" : "\n";
+                templateText.insert(parsed.journalOffset, std::string(kJournalMarker) + std::string(lineEnd));
+            }
+
+            // Segments are written to a staging directory that is renamed into place, then the template replaces
+            // the book. Interrupted in between, the book reads the same: blocks left in a template are skipped.
+            // Segments and the rename are flushed before the template is written, so after a power loss a
+            // template on disk always has its segments.
+            auto directory = GetDirectory(a_bookPath);
+            auto staging = directory;
+            staging += L".tmp";
+            std::error_code ec;
+            std::filesystem::remove_all(staging, ec);
+            if (!std::filesystem::create_directories(staging, ec)) {
+                result.error = "could not create " + staging.filename().string();
+                return result;
+            }
+            for (const auto& [fileName, segment] : segments) {
+                if (!BookFile::WriteDurably(staging / fileName, segment)) {
+                    std::filesystem::remove_all(staging, ec);
+                    result.error = "could not write segment " + fileName;
+                    return result;
+                }
+            }
+            if (!BookFile::MoveDurably(staging, directory)) {
+                std::filesystem::remove_all(staging, ec);
+                result.error = "could not move the segments into place";
+                return result;
+            }
+            if (!BookFile::ReplaceAtomically(a_bookPath, templateText)) {
+                result.error = "could not write the template";
+                return result;
+            }
+            result.ok = true;
+            result.blocks = parsed.blocks.size();
+            result.segments = segments.size();
+            return result;
+        }
+
+        MigrationResult Merge(const std::filesystem::path& a_bookPath,
+            const std::unordered_map<std::string, std::vector<std::size_t>>& a_historyOrder) {
+            MigrationResult result;
+            if (!IsSegmented(a_bookPath)) {
+                result.error = "not segmented";
+                return result;
+            }
+            std::string templateText;
+            if (!ReadFile(a_bookPath, templateText)) {
+                result.error = "could not read the template";
+                return result;
+            }
+
+            struct Placed {
+                std::size_t order;
+                std::string text;
+            };
+            std::vector<Placed> placed;
+            std::unordered_map<std::string, std::size_t> occurrences;
+            std::string segmentText;
+            auto segmentPaths = ListSegments(a_bookPath);
+            for (const auto& segmentPath : segmentPaths) {
+                if (!ReadFile(segmentPath, segmentText)) {
+                    result.error = "could not read segment " + segmentPath.filename().string();
+                    return result;
+                }
+                for (auto& block : Parse(segmentText).blocks) {
+                    std::size_t order = std::numeric_limits<std::size_t>::max();
+                    std::size_t occurrence = occurrences[block.id]++;
+                    if (auto it = a_historyOrder.find(block.id); it != a_historyOrder.end() && occurrence < it->second.size()) {
+                        order = it->second[occurrence];
+                    }
+                    placed.push_back({ order, std::move(block.text) });
+                }
+            }
+            std::stable_sort(placed.begin(), placed.end(), [](const Placed& a, const Placed& b) { return a.order < b.order; });
+
+            std::string journal;
+            for (const auto& block : placed) {
+                journal += block.text;
+            }
+
+            // Complete blocks still in the template are leftovers of an interrupted Split and already in the segments.
+            // Each block carries the blank line written ahead of it, so the journal replaces the marker's line.
+            ParsedFile parsed = Parse(templateText);
+            std::string merged;
+            merged.reserve(parsed.staticText.size() + journal.size());
+            bool journalPlaced = false;
+            std::size_t pos = 0;
+            while (pos < parsed.staticText.size()) {
+                std::string_view line = NextLine(parsed.staticText, pos);
+                if (!journalPlaced && TrimEnd(line) == kJournalMarker) {
+                    merged += journal;
+                    journalPlaced = true;
+                    continue;
+                }
+                merged.append(line);
+            }
+            if (!journalPlaced) {
+                merged += journal;
+            }
+
+            if (!BookFile::ReplaceAtomically(a_bookPath, merged)) {
+                result.error = "could not write the book";
+                return result;
+            }
+            // Renamed first, so a failed delete cannot leave a directory that makes the book read as segmented.
+            auto directory = GetDirectory(a_bookPath);
+            auto retired = directory;
+            retired += L".old";
+            std::error_code ec;
+            std::filesystem::remove_all(retired, ec);
+            std::filesystem::rename(directory, retired, ec);
+            if (ec) {
+                result.error = "merged, but could not remove " + directory.filename().string();
+                return result;
+            }
+            std::filesystem::remove_all(retired, ec);
+            result.ok = true;
+            result.blocks = placed.size();
+            result.segments = segmentPaths.size();
+            return result;
+        }
+
+    } // namespace SegmentStore
+
+} // namespace DynamicBookFramework
@@ -2,6 +2,16 @@
 #include "SessionDataManager.h"
 #include "Utility.h"
 #include "BookMenuWatcher.h"
+#include "DynamicBookRegistry.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "BookSearch.h"
+#include "BookFile.h"
+#include "FileWatcher.h"
+#include "WorkerPool.h"
+#include "BookPakRegistry.h"
+#include "BlockCodec.h"
 #include "PCH.h" // For common headers like SKSE, RE, and standard library
 
 
@@ -41,6 +51,84 @@ namespace { // Use an anonymous namespace to keep it local to this file
         // 5. Extracts and returns the substring between the start and end.
         return metadata.substr(startPos, endPos - startPos);
     }
+
+    // The game's save folder: My Games/<game>/<sLocalSavePath>, next to the SKSE log folder.
+    std::optional<std::filesystem::path> GetSavesDirectory() {
+        auto logDirectory = SKSE::log::log_directory();
+        if (!logDirectory) {
+            return std::nullopt;
+        }
+        std::string localSavePath = "Saves\\";
+        if (auto* iniSettings = RE::INISettingCollection::GetSingleton()) {
+            if (auto* setting = iniSettings->GetSetting("sLocalSavePath:General"); setting && setting->GetString() && *setting->GetString()) {
+                localSavePath = setting->GetString();
+            }
+        }
+        return logDirectory->parent_path() / localSavePath;
+    }
+
+    // Save identifiers (file names without .ess) of every save that can still be loaded.
+    std::vector<std::string> FindExistingSaves(const std::filesystem::path& savesDirectory) {
+        std::vector<std::string> saves;
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(savesDirectory, ec)) {
+            if (entry.is_regular_file(ec) && entry.path().extension() == ".ess") {
+                saves.push_back(entry.path().stem().string());
+            }
+        }
+        return saves;
+    }
+
+    struct FileSnapshot {
+        std::string content;
+        std::uintmax_t size = 0;
+        std::filesystem::file_time_type writeTime{};
+    };
+
+    std::optional<FileSnapshot> ReadSnapshot(const std::filesystem::path& path) {
+        std::error_code ec;
+        FileSnapshot snapshot;
+        snapshot.writeTime = std::filesystem::last_write_time(path, ec);
+        if (ec) {
+            return std::nullopt;
+        }
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            return std::nullopt;
+        }
+        snapshot.content.resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(snapshot.content.data(), static_cast<std::streamsize>(snapshot.content.size()));
+        snapshot.size = snapshot.content.size();
+        return snapshot;
+    }
+
+    // True if nothing has written to the file since the snapshot was read.
+    bool IsUnchanged(const std::filesystem::path& path, const FileSnapshot& snapshot) {
+        std::error_code sizeError;
+        std::error_code timeError;
+        auto size = std::filesystem::file_size(path, sizeError);
+        auto writeTime = std::filesystem::last_write_time(path, timeError);
+        return !sizeError && !timeError && size == snapshot.size && writeTime == snapshot.writeTime;
+    }
+
+    // Changes whenever the book's file or any of its segments is written (size and timestamp of each).
+    std::uint64_t GetBookFilesStamp(const std::filesystem::path& bookPath) {
+        std::uint64_t stamp = 14695981039346656037ull;
+        auto mix = [&](std::uint64_t value) { stamp = (stamp ^ value) * 1099511628211ull; };
+        auto mixFile = [&](const std::filesystem::path& path) {
+            std::error_code ec;
+            mix(static_cast<std::uint64_t>(std::filesystem::file_size(path, ec)));
+            mix(static_cast<std::uint64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count()));
+        };
+        mixFile(bookPath);
+        if (DynamicBookFramework::SegmentStore::IsSegmented(bookPath)) {
+            for (const auto& segmentPath : DynamicBookFramework::SegmentStore::ListSegments(bookPath)) {
+                mixFile(segmentPath);
+            }
+        }
+        return stamp;
+    }
 }
 
 namespace DynamicBookFramework {
@@ -68,16 +156,30 @@ namespace DynamicBookFramework {
 
         _currentSaveIdentifier = cleanIdentifier;
         _sessionParentSaveIdentifier = cleanIdentifier; 
+        DrainIncomingEntries(); // Entries appended before the load belong to the session being left
         _sessionPendingEntries.clear();
+        // Saved counts follow the save's history chain, so every one is recounted for the new save.
+        DynamicBookRegistry::GetSingleton()->ForEachRecord([](DynamicBookRecord& record) {
+            record.savedEntryLinesStamp.store(0, std::memory_order_release);
+            record.pendingEntries.store(0);
+            record.pendingEntryLines.store(0);
+        });
+        _saveLoaded.store(true);
+
+        // A different save means a different history chain, so every cached rendering is stale.
+        DynamicBookRegistry::GetSingleton()->InvalidateAll();
     }
 
     void SessionDataManager::OnGameSave(const std::string& newSaveIdentifier) {
+        Profiler::ScopedTimer totalTimer(Profiler::Stage::kSaveTotal);
+        Trace::ScopedEvent traceEvent("GameSave", "session", newSaveIdentifier);
         std::lock_guard<std::mutex> lock(_dataMutex);
 
         std::string cleanNewIdentifier = StripExtension(newSaveIdentifier);
         std::string cleanParentIdentifier = StripExtension(_sessionParentSaveIdentifier);
 
         // --- Step 1: ALWAYS log the save event to the master history file ---
+        Profiler::ScopedTimer stageTimer(Profiler::Stage::kSaveHistoryLog);
         auto historyPath = g_historyLogPath;
         std::ofstream historyFile(historyPath, std::ios::app);
         if (historyFile.is_open()) {
@@ -88,29 +190,57 @@ namespace DynamicBookFramework {
         }
 
         // --- Step 2: If there are pending entries, write them to their specific book files ---
+        stageTimer.Next(Profiler::Stage::kSaveBlocks);
+        DrainIncomingEntries();
         if (!_sessionPendingEntries.empty()) {
             for (auto& [bookKey, entries] : _sessionPendingEntries) {
                 if (entries.empty()) continue;
 
-                auto pathOpt = GetDynamicBookPathByTitle(string_to_wstring(bookKey));
-                if (!pathOpt) continue;
+                auto record = DynamicBookRegistry::GetSingleton()->FindByKey(bookKey);
+                if (!record) continue;
+                // The saved count stays valid across this write only if it described the files as they are now.
+                std::uint64_t countedStamp = record->savedEntryLinesStamp.exchange(0, std::memory_order_acq_rel);
+                bool countCurrent = countedStamp != 0 && countedStamp == GetBookFilesStamp(record->path);
+                std::uint32_t savedLines = record->pendingEntryLines.exchange(0);
+                record->pendingEntries.store(0);
+                // A packed book gets its loose copy first, so the block is appended to its text rather than replacing it.
+                BookPakRegistry::MaterializeLooseCopy(record->key, record->path);
                 
-                std::ofstream out(*pathOpt, std::ios::app);
-                if (out.is_open()) {
-                    out << "\n;;SAVE_BLOCK ID=\"" << cleanNewIdentifier 
-                        << "\" TIMELINE=\"" << _currentTimelineID 
-                        << "\" PARENT=\"" << cleanParentIdentifier << "\";;\n";
-                    
-                    for (const auto& entry : entries) {
-                        out << entry << "\n";
-                    }
+                std::ostringstream block;
+                block << "\n;;SAVE_BLOCK ID=\"" << cleanNewIdentifier 
+                      << "\" TIMELINE=\"" << _currentTimelineID 
+                      << "\" PARENT=\"" << cleanParentIdentifier << "\";;\n";
+                
+                for (const auto& entry : entries) {
+                    block << entry << "\n";
+                }
+
+                block << ";;END_SAVE_DATA;;\n";
 
-                    out << ";;END_SAVE_DATA;;\n";
-                    out.close();
+                bool written = false;
+                if (SegmentStore::IsSegmented(record->path)) {
+                    written = SegmentStore::AppendBlock(record->path, _currentTimelineID, block.str());
+                    if (!written) {
+                        Log::Session().error("SessionDataManager: Could not write the save block for '{}' to its timeline segment.", bookKey);
+                    }
+                } else {
+                    std::ofstream out(record->path, std::ios::app);
+                    if (out.is_open()) {
+                        out << block.str();
+                        out.close();
+                        written = out.good();
+                    }
+                }
+                // The new block is on the new save's chain, so its lines join the saved count.
+                if (written && countCurrent) {
+                    record->savedEntryLines.fetch_add(savedLines);
+                    record->savedEntryLinesStamp.store(GetBookFilesStamp(record->path), std::memory_order_release);
                 }
             }
         }
 
+        stageTimer.Stop();
+
         // --- Step 3: Update the internal state for the next session ---
         _sessionParentSaveIdentifier = cleanNewIdentifier;
         _currentSaveIdentifier = cleanNewIdentifier;
@@ -132,97 +262,222 @@ namespace DynamicBookFramework {
     
     // You will still need the helper structs FileChunk and SaveBlock.
 
+    const SessionDataManager::HistoryCache& SessionDataManager::GetHistory() {
+        std::error_code sizeError;
+        std::error_code timeError;
+        auto size = std::filesystem::file_size(g_historyLogPath, sizeError);
+        auto writeTime = std::filesystem::last_write_time(g_historyLogPath, timeError);
+        bool exists = !sizeError && !timeError;
+        if (exists == _historyCache.exists && (!exists || (size == _historyCache.size && writeTime == _historyCache.writeTime))) {
+            return _historyCache;
+        }
+
+        // Read the entire history log into a map for fast lookups; a save ID logged again keeps its last record.
+        _historyCache = HistoryCache();
+        _historyCache.exists = exists;
+        _historyCache.size = size;
+        _historyCache.writeTime = writeTime;
+        if (exists) {
+            std::ifstream historyFile(g_historyLogPath);
+            std::string historyLine;
+            while (std::getline(historyFile, historyLine)) {
+                std::string id = ParseValue(historyLine, "ID");
+                if (!id.empty()) {
+                    _historyCache.entries[id] = { ParseValue(historyLine, "PARENT"), ParseValue(historyLine, "TIMELINE") };
+                }
+            }
+        }
+        return _historyCache;
+    }
+
+    std::vector<SegmentStore::ChainLink> SessionDataManager::BuildHistoryChain() {
+        std::vector<SegmentStore::ChainLink> chain;
+        const auto& history = GetHistory();
+        if (!history.exists) {
+            return chain;
+        }
+
+        // Trace the history from the current save; the length bound stops a corrupt log whose parents form a cycle.
+        std::string parentTracer = StripExtension(_currentSaveIdentifier);
+        while (!parentTracer.empty() && chain.size() <= history.entries.size()) {
+            auto it = history.entries.find(parentTracer);
+            chain.push_back({ parentTracer, it != history.entries.end() ? it->second.timeline : std::string() });
+            if (it == history.entries.end()) {
+                break; // Reached the end of the chain
+            }
+            parentTracer = StripExtension(it->second.parent);
+        }
+        std::reverse(chain.begin(), chain.end());
+        return chain;
+    }
+
     std::string SessionDataManager::GetFullContent(const std::string& fileKey) {
+        return AssembleContent(fileKey);
+    }
+
+    std::string SessionDataManager::GetFullContent(const std::string& fileKey, std::string_view fileText) {
+        return AssembleContent(fileKey, fileText);
+    }
+
+    std::optional<std::size_t> SessionDataManager::GetEntryCount(const std::string& fileKey) {
+        if (!_saveLoaded.load()) {
+            return 0;
+        }
+        auto record = DynamicBookRegistry::GetSingleton()->FindByKey(fileKey);
+        if (!record) {
+            return 0;
+        }
+        TryCommitQueuedEntries();
+
+        std::uint64_t stamp = record->savedEntryLinesStamp.load(std::memory_order_acquire);
+        std::uint64_t savedLines = record->savedEntryLines.load(std::memory_order_acquire);
+        bool current = stamp != 0 && record->savedEntryLinesStamp.load(std::memory_order_acquire) == stamp &&
+                       stamp == GetBookFilesStamp(record->path);
+        if (current) {
+            return static_cast<std::size_t>(savedLines) + record->pendingEntryLines.load();
+        }
+
+        // Assembling the book records its count; one job per book however often it is asked for meanwhile.
+        if (!record->entryCountQueued.exchange(true)) {
+            WorkerPool::GetSingleton()->Submit([this, record]() {
+                AssembleContent(record->key);
+                record->entryCountQueued.store(false);
+            }, WorkerPool::Priority::kLow);
+        }
+        return std::nullopt;
+    }
+
+    std::string SessionDataManager::AssembleContent(const std::string& fileKey, std::optional<std::string_view> fileText) {
+        Profiler::ScopedTimer totalTimer(Profiler::Stage::kContentTotal);
         std::lock_guard<std::mutex> lock(_dataMutex);
+        DrainIncomingEntries();
 
         if (_currentSaveIdentifier.empty()) return "";
 
-        auto pathOpt = GetDynamicBookPathByTitle(string_to_wstring(fileKey));
-        if (!pathOpt || !std::filesystem::exists(*pathOpt)) {
-            // Handle case where file doesn't exist
+        auto record = DynamicBookRegistry::GetSingleton()->FindByKey(fileKey);
+        if (!record) {
             return "";
         }
+        // Taken before reading, so a write that lands while the book is read is seen by the next GetEntryCount.
+        std::uint64_t filesStamp = GetBookFilesStamp(record->path);
+        std::size_t entryLines = 0;
+        // Without a loose file the book may be packed in a .dbfpak; it is read from the archive until something writes it.
+        // Either way, and for text the caller passed in, the bytes are parsed from memory.
+        std::optional<std::string> packedContent;
+        if (fileText) {
+            packedContent.emplace(*fileText);
+        } else if (!std::filesystem::exists(record->path)) {
+            packedContent = BookPakRegistry::Read(record->key, record->path);
+            if (!packedContent) {
+                // Handle case where file doesn't exist
+                record->savedEntryLinesStamp.store(0, std::memory_order_release);
+                record->savedEntryLines.store(0, std::memory_order_release);
+                record->savedEntryLinesStamp.store(filesStamp, std::memory_order_release);
+                return "";
+            }
+        }
 
-        // --- PHASE 1: A SINGLE, SMART PARSING PASS ---
-        std::vector<FileChunk> fileLayout;
-        std::map<std::string, std::string> dynamicContentMap;
-
-        std::ifstream file(*pathOpt);
-        std::string line;
-        std::stringstream staticBuffer;
-        std::stringstream dynamicBuffer;
-        std::string currentBlockId;
-        bool inDynamicBlock = false;
-
-        while (std::getline(file, line)) {
-            if (line.rfind(";;SAVE_BLOCK ", 0) == 0) {
-                if (staticBuffer.tellp() > 0) {
-                    fileLayout.push_back({false, staticBuffer.str()});
-                    staticBuffer.str("");
-                }
-                inDynamicBlock = true;
-                currentBlockId = ParseValue(line, "ID");
-                fileLayout.push_back({true, currentBlockId});
-                dynamicBuffer.str("");
-            } else if (line.rfind(";;END_SAVE_DATA;;", 0) == 0) {
-                if (inDynamicBlock) {
-                    dynamicContentMap[currentBlockId] = dynamicBuffer.str();
-                }
-                inDynamicBlock = false;
-                currentBlockId = "";
+        std::stringstream finalContent;
+        if (SegmentStore::IsSegmented(record->path)) {
+            // Only the segments of the timelines on this save's chain are opened, however much else is stored.
+            Profiler::ScopedTimer stageTimer(Profiler::Stage::kContentHistory);
+            auto chain = BuildHistoryChain();
+            stageTimer.Next(Profiler::Stage::kContentAssemble);
+            finalContent << SegmentStore::Assemble(record->path, chain, &entryLines);
+        } else {
+            // --- PHASE 1: A SINGLE, SMART PARSING PASS ---
+            Profiler::ScopedTimer stageTimer(Profiler::Stage::kContentParse);
+            std::vector<FileChunk> fileLayout;
+            std::map<std::string, std::string> dynamicContentMap;
+            // Raw sizes of the blocks stored compressed. They are decoded in phase 3, and only if the chain shows them.
+            std::map<std::string, std::size_t> compressedBlockSizes;
+
+            std::ifstream file;
+            std::istringstream packedFile;
+            if (packedContent) {
+                packedFile.str(std::move(*packedContent));
             } else {
-                if (inDynamicBlock) {
-                    dynamicBuffer << line << '\n';
+                file.open(record->path);
+            }
+            std::istream& input = packedContent ? static_cast<std::istream&>(packedFile) : file;
+            std::string line;
+            std::stringstream staticBuffer;
+            std::stringstream dynamicBuffer;
+            std::string currentBlockId;
+            std::optional<std::size_t> currentBlockRawSize;
+            bool inDynamicBlock = false;
+
+            while (std::getline(input, line)) {
+                if (packedContent && !line.empty() && line.back() == '\r') {
+                    line.pop_back(); // Bytes from memory are as written; a text-mode file read drops this.
+                }
+                if (line.rfind(";;SAVE_BLOCK ", 0) == 0) {
+                    if (staticBuffer.tellp() > 0) {
+                        fileLayout.push_back({false, staticBuffer.str()});
+                        staticBuffer.str("");
+                    }
+                    inDynamicBlock = true;
+                    currentBlockId = ParseValue(line, "ID");
+                    currentBlockRawSize = BlockCodec::GetRawSize(line);
+                    fileLayout.push_back({true, currentBlockId});
+                    dynamicBuffer.str("");
+                } else if (line.rfind(";;END_SAVE_DATA;;", 0) == 0) {
+                    if (inDynamicBlock) {
+                        dynamicContentMap[currentBlockId] = dynamicBuffer.str();
+                        if (currentBlockRawSize) {
+                            compressedBlockSizes[currentBlockId] = *currentBlockRawSize;
+                        } else {
+                            compressedBlockSizes.erase(currentBlockId);
+                        }
+                    }
+                    inDynamicBlock = false;
+                    currentBlockId = "";
                 } else {
-                    staticBuffer << line << '\n';
+                    if (inDynamicBlock) {
+                        dynamicBuffer << line << '\n';
+                    } else {
+                        staticBuffer << line << '\n';
+                    }
                 }
             }
-        }
-        if (staticBuffer.tellp() > 0) {
-            fileLayout.push_back({false, staticBuffer.str()});
-        }
+            if (staticBuffer.tellp() > 0) {
+                fileLayout.push_back({false, staticBuffer.str()});
+            }
         
-        // --- PHASE 2: BUILD THE VALID HISTORY CHAIN (Efficiently) ---
-        std::set<std::string> validSaveIDs;
-        std::map<std::string, std::string> historyParentMap;
-        auto historyPath = g_historyLogPath;
-
-        if (std::filesystem::exists(historyPath)) {
-            // First, read the entire history log into a map for fast lookups
-            std::ifstream historyFile(historyPath);
-            std::string historyLine;
-            while (std::getline(historyFile, historyLine)) {
-                std::string id = ParseValue(historyLine, "ID");
-                std::string parent = ParseValue(historyLine, "PARENT");
-                if (!id.empty()) {
-                    historyParentMap[id] = parent;
-                }
+            // --- PHASE 2: BUILD THE VALID HISTORY CHAIN (Efficiently) ---
+            stageTimer.Next(Profiler::Stage::kContentHistory);
+            std::set<std::string> validSaveIDs;
+            for (const auto& link : BuildHistoryChain()) {
+                validSaveIDs.insert(link.id);
             }
 
-            // Now, trace the history using the map
-            std::string parentTracer = StripExtension(_currentSaveIdentifier);
-            while (!parentTracer.empty()) {
-                validSaveIDs.insert(parentTracer);
-                if (historyParentMap.count(parentTracer)) {
-                    parentTracer = StripExtension(historyParentMap.at(parentTracer));
+            // --- PHASE 3: ASSEMBLE THE FINAL CONTENT ---
+            stageTimer.Next(Profiler::Stage::kContentAssemble);
+            for (const auto& chunk : fileLayout) {
+                if (!chunk.isDynamicBlock) {
+                    finalContent << chunk.content;
                 } else {
-                    break; // Reached the end of the chain
+                    if (validSaveIDs.count(chunk.content)) {
+                        auto& blockContent = dynamicContentMap[chunk.content];
+                        if (auto compressed = compressedBlockSizes.find(chunk.content); compressed != compressedBlockSizes.end()) {
+                            auto decoded = BlockCodec::Decode(blockContent, compressed->second);
+                            if (!decoded) {
+                                Log::Session().error("SessionDataManager: The compressed save block '{}' in '{}' is corrupt.", chunk.content, fileKey);
+                            }
+                            blockContent = decoded ? std::move(*decoded) : std::string();
+                            compressedBlockSizes.erase(compressed);
+                        }
+                        finalContent << "<a name='" << chunk.content << "'></a>";
+                        finalContent << blockContent;
+                        entryLines += static_cast<std::size_t>(std::count(blockContent.begin(), blockContent.end(), '\n'));
+                    }
                 }
             }
         }
 
-        // --- PHASE 3: ASSEMBLE THE FINAL CONTENT ---
-        std::stringstream finalContent;
-        for (const auto& chunk : fileLayout) {
-            if (!chunk.isDynamicBlock) {
-                finalContent << chunk.content;
-            } else {
-                if (validSaveIDs.count(chunk.content)) {
-                    finalContent << "<a name='" << chunk.content << "'></a>";
-                    finalContent << dynamicContentMap[chunk.content];
-                }
-            }
-        }
+        record->savedEntryLinesStamp.store(0, std::memory_order_release);
+        record->savedEntryLines.store(entryLines, std::memory_order_release);
+        record->savedEntryLinesStamp.store(filesStamp, std::memory_order_release);
 
         // --- PHASE 4: APPEND PENDING (UNSAVED) ENTRIES ---
         if (_sessionPendingEntries.count(fileKey) && !_sessionPendingEntries.at(fileKey).empty()) {
@@ -237,12 +492,86 @@ namespace DynamicBookFramework {
     
     // This is the public API function that your addon calls
     void SessionDataManager::AppendEntry(const std::string& fileKey, const std::string& entryText) {
-        if (_currentSaveIdentifier.empty()) {
-            logger::warn("SessionDataManager::AppendEntry: No save identifier set. Buffering entry temporarily.");
+        AppendEntries(fileKey, { entryText });
+    }
+
+    std::size_t SessionDataManager::AppendEntries(const std::string& fileKey, std::vector<std::string> entries) {
+        if (entries.empty()) {
+            return 0;
+        }
+        // Everything else (the title lookup, search, tracing) takes locks, so it happens when the queue is drained.
+        std::size_t added = entries.size();
+        _incomingEntries.Push({ fileKey, std::move(entries) });
+        // Bumped after the push, so a consumer that sees the new sequence will also find the entries when it drains.
+        _appendSequence.fetch_add(1, std::memory_order_release);
+        return added;
+    }
+
+    void SessionDataManager::CommitQueuedEntries() {
+        if (_appendSequence.load(std::memory_order_acquire) == _drainedSequence.load(std::memory_order_acquire)) {
+            return;
         }
         std::lock_guard<std::mutex> lock(_dataMutex);
-        _sessionPendingEntries[fileKey].push_back(entryText);
-        logger::info("SessionDataManager::AppendEntry: Added entry to session buffer for key '{}'. Total pending for this key: {}", fileKey, _sessionPendingEntries[fileKey].size());
+        DrainIncomingEntries();
+    }
+
+    void SessionDataManager::TryCommitQueuedEntries() {
+        if (_appendSequence.load(std::memory_order_acquire) == _drainedSequence.load(std::memory_order_acquire)) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock(_dataMutex, std::try_to_lock);
+        if (lock.owns_lock()) {
+            DrainIncomingEntries();
+        }
+    }
+
+    void SessionDataManager::DrainIncomingEntries() {
+        // Read before popping: every push counted in it has completed, so it is drained below.
+        std::uint64_t sequence = _appendSequence.load(std::memory_order_acquire);
+        std::size_t drained = 0;
+        while (auto incoming = _incomingEntries.TryPop()) {
+            Trace::ScopedEvent traceEvent("AppendEntry", "session", incoming->fileKey);
+            // Papyrus and API callers pass free-form titles, so an unknown one is still buffered (the mapping may be
+            // added by a later reload) but flagged.
+            auto record = DynamicBookRegistry::GetSingleton()->FindByKey(incoming->fileKey);
+            if (record) {
+                BookSearch::OnEntriesAppended(incoming->fileKey, incoming->entries);
+            } else {
+                Log::Session().warn("SessionDataManager::AppendEntry: '{}' is not a mapped book title. The entry will be buffered but cannot be saved until a mapping exists.", incoming->fileKey);
+            }
+            auto& pending = _sessionPendingEntries[incoming->fileKey];
+            drained += incoming->entries.size();
+            if (record) {
+                // Lines counted the way OnGameSave will write them, so GetEntryCount does not jump after a save.
+                std::size_t lines = 0;
+                for (const auto& entry : incoming->entries) {
+                    lines += 1 + static_cast<std::size_t>(std::count(entry.begin(), entry.end(), '\n'));
+                }
+                record->pendingEntries.fetch_add(static_cast<std::uint32_t>(incoming->entries.size()));
+                record->pendingEntryLines.fetch_add(static_cast<std::uint32_t>(lines));
+            }
+            pending.insert(pending.end(), std::make_move_iterator(incoming->entries.begin()), std::make_move_iterator(incoming->entries.end()));
+            if (record) {
+                record->contentVersion.fetch_add(1);
+            }
+        }
+        _drainedSequence.store(sequence, std::memory_order_release);
+        if (drained == 0) {
+            return;
+        }
+        if (_currentSaveIdentifier.empty()) {
+            Log::Session().warn("SessionDataManager: No save identifier set. Buffering {} entries temporarily.", drained);
+        }
+        Log::Session().debug("SessionDataManager: Moved {} queued entries into the session buffer.", drained);
+    }
+
+    std::size_t SessionDataManager::GetPendingEntryCount(const std::string& fileKey) {
+        auto record = DynamicBookRegistry::GetSingleton()->FindByKey(fileKey);
+        if (!record) {
+            return 0;
+        }
+        TryCommitQueuedEntries();
+        return record->pendingEntries.load();
     }
 
     std::string SessionDataManager::_getCharacterNameFromIdentifier(const std::string& identifier) const {
@@ -271,13 +600,256 @@ namespace DynamicBookFramework {
             // std::stoi will parse integers and stop at the first non-digit character (like '_')
             return std::stoi(numberPart);
         } catch (const std::invalid_argument& e) {
-            logger::warn("Could not parse save number from identifier '{}': {}", identifier, e.what());
+            Log::Session().warn("Could not parse save number from identifier '{}': {}", identifier, e.what());
             return -1;
         } catch (const std::out_of_range& e) {
-            logger::warn("Save number in identifier '{}' is out of range: {}", identifier, e.what());
+            Log::Session().warn("Save number in identifier '{}' is out of range: {}", identifier, e.what());
             return -1;
         }
     }
+    CompactionReport SessionDataManager::CompactSaveData(const SaveCompactor::RetentionPolicy& policy, bool dryRun) {
+        Trace::ScopedEvent traceEvent("CompactSaveData", "session");
+        auto start = std::chrono::steady_clock::now();
+        CompactionReport report;
+        report.dryRun = dryRun;
+        report.compressionOnly = !policy.removeUnreachable;
+
+        auto history = ReadSnapshot(g_historyLogPath);
+        auto records = history ? SaveCompactor::ParseHistory(history->content) : std::vector<SaveCompactor::HistoryRecord>();
+        std::unordered_set<std::string> live;
+        if (policy.removeUnreachable) {
+            // Without both of these every block would look unreachable, so refuse rather than empty the books.
+            auto savesDirectory = GetSavesDirectory();
+            std::vector<std::string> roots = savesDirectory ? FindExistingSaves(*savesDirectory) : std::vector<std::string>();
+            report.savesFound = roots.size();
+            if (roots.empty()) {
+                report.skippedReason = "No save files were found in the saves folder.";
+                return report;
+            }
+            if (records.empty()) {
+                report.skippedReason = "The save history log is missing or empty.";
+                return report;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_dataMutex);
+                // The save being played may not be on disk (deleted, or never saved after a new game).
+                roots.push_back(_currentSaveIdentifier);
+                roots.push_back(_sessionParentSaveIdentifier);
+            }
+            live = SaveCompactor::FindLiveSaves(records, roots, policy);
+            report.liveSaves = live.size();
+        }
+        // Blocks of saves the history does not know are left as they are: no chain can show them.
+        auto encodingPlan = BlockCodec::PlanEncoding(records, policy.compressColdBlocks, policy.plainRecentSaves);
+
+        std::set<std::filesystem::path> seenPaths;
+        auto* registry = DynamicBookRegistry::GetSingleton();
+        for (const auto& title : GetAllBookTitles()) {
+            auto record = registry->FindByKey(title);
+            if (!record || !seenPaths.insert(record->path).second) {
+                continue;
+            }
+            // A segmented book keeps its blocks in the segment files; its template has none.
+            bool segmented = SegmentStore::IsSegmented(record->path);
+            auto files = segmented ? SegmentStore::ListSegments(record->path) : std::vector<std::filesystem::path>{ record->path };
+            ++report.booksScanned;
+            bool rewritten = false;
+            for (const auto& path : files) {
+                auto snapshot = ReadSnapshot(path);
+                if (!snapshot) {
+                    continue;
+                }
+                SaveCompactor::BookResult result;
+                if (policy.removeUnreachable) {
+                    result = SaveCompactor::CompactBook(snapshot->content, live);
+                }
+                // The blocks that survive compaction are then compressed or expanded by the plan.
+                auto recoded = BlockCodec::RecodeBook(result.blocksRemoved > 0 ? std::string_view(result.text) : std::string_view(snapshot->content), encodingPlan);
+                if (recoded.blocksCorrupt > 0) {
+                    Log::Session().error("SessionDataManager: {} compressed save blocks in '{}' could not be decoded and were left as they are.",
+                        recoded.blocksCorrupt, wstring_to_utf8(path.wstring()));
+                }
+                bool recodedAny = recoded.blocksCompressed + recoded.blocksExpanded > 0;
+                if (recodedAny) {
+                    result.text = std::move(recoded.text);
+                }
+                report.blocksKept += result.blocksKept;
+                report.blocksRemoved += result.blocksRemoved;
+                report.blocksCompressed += recoded.blocksCompressed;
+                report.blocksExpanded += recoded.blocksExpanded;
+                report.bytesBefore += snapshot->size;
+                if (result.blocksRemoved == 0 && !recodedAny) {
+                    report.bytesAfter += snapshot->size;
+                    continue;
+                }
+                report.bytesAfter += result.text.size();
+                if (dryRun) {
+                    rewritten = true;
+                    continue;
+                }
+
+                // A segment left with nothing but blank lines belongs to a timeline no save reaches any more.
+                bool removeSegment = segmented && policy.removeUnreachable && result.blocksKept == 0 && result.text.find_first_not_of("\r\n") == std::string::npos;
+                bool written = false;
+                {
+                    // OnGameSave appends under this lock, so an unchanged file cannot gain a block before the rename.
+                    std::lock_guard<std::mutex> lock(_dataMutex);
+                    std::error_code ec;
+                    if (!IsUnchanged(path, *snapshot)) {
+                        ++report.booksChangedMeanwhile;
+                    } else if (!(written = removeSegment ? std::filesystem::remove(path, ec) : BookFile::ReplaceAtomically(path, result.text))) {
+                        Log::Session().error("SessionDataManager: Could not rewrite '{}' during compaction.", wstring_to_utf8(path.wstring()));
+                    }
+                }
+                if (written) {
+                    rewritten = true;
+                } else {
+                    // Left as it was; count it that way.
+                    report.blocksRemoved -= result.blocksRemoved;
+                    report.blocksKept += result.blocksRemoved;
+                    report.blocksCompressed -= recoded.blocksCompressed;
+                    report.blocksExpanded -= recoded.blocksExpanded;
+                    report.bytesAfter += snapshot->size - result.text.size();
+                }
+            }
+            if (!rewritten) {
+                continue;
+            }
+            ++report.booksRewritten;
+            if (!dryRun) {
+                FileWatcher::NotifyFileUpdated(title);
+                registry->MarkChanged(title);
+            }
+        }
+
+        std::string compactedHistory;
+        if (policy.removeUnreachable) {
+            report.historyRecordsRemoved = SaveCompactor::CompactHistory(history->content, live, compactedHistory);
+        }
+        if (!dryRun && report.historyRecordsRemoved > 0) {
+            std::lock_guard<std::mutex> lock(_dataMutex);
+            if (!IsUnchanged(g_historyLogPath, *history) || !BookFile::ReplaceAtomically(g_historyLogPath, compactedHistory)) {
+                Log::Session().warn("SessionDataManager: The save history changed during compaction. It will be compacted next time.");
+                report.historyRecordsRemoved = 0;
+            }
+        }
+
+        report.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Log::Session().info("SessionDataManager: {} save data: {} of {} blocks unreachable, {} compressed, {} expanded in {} books, {} history records, {} -> {} bytes, {:.1f} ms.",
+            dryRun ? "Scanned" : "Compacted", report.blocksRemoved, report.blocksKept + report.blocksRemoved, report.blocksCompressed,
+            report.blocksExpanded, report.booksRewritten, report.historyRecordsRemoved, report.bytesBefore, report.bytesAfter, report.milliseconds);
+        return report;
+    }
+
+    void SessionDataManager::ScheduleCompaction(const SaveCompactor::RetentionPolicy& policy, bool dryRun) {
+        if (_maintenanceRunning.exchange(true)) {
+            return;
+        }
+        WorkerPool::GetSingleton()->Submit([this, policy, dryRun]() {
+            CompactionReport report;
+            try {
+                report = CompactSaveData(policy, dryRun);
+            } catch (const std::exception& e) {
+                Log::Session().error("SessionDataManager: Save data compaction failed: {}", e.what());
+                report.skippedReason = e.what();
+            }
+            if (!report.skippedReason.empty()) {
+                Log::Session().info("SessionDataManager: Save data compaction skipped: {}", report.skippedReason);
+            }
+            {
+                std::lock_guard<std::mutex> lock(_reportMutex);
+                _lastCompactionReport = std::move(report);
+            }
+            _maintenanceRunning.store(false);
+        }, WorkerPool::Priority::kLow);
+    }
+
+    std::optional<CompactionReport> SessionDataManager::GetLastCompactionReport() {
+        std::lock_guard<std::mutex> lock(_reportMutex);
+        return _lastCompactionReport;
+    }
+
+    StorageMigrationReport SessionDataManager::MigrateStorage(bool toSegments) {
+        Trace::ScopedEvent traceEvent("MigrateStorage", "session", toSegments ? "segments" : "single files");
+        auto start = std::chrono::steady_clock::now();
+        StorageMigrationReport report;
+        report.toSegments = toSegments;
+
+        // Merging puts each block back where OnGameSave appended it, which the order of the history records gives.
+        std::unordered_map<std::string, std::vector<std::size_t>> historyOrder;
+        if (!toSegments) {
+            if (auto history = ReadSnapshot(g_historyLogPath)) {
+                auto records = SaveCompactor::ParseHistory(history->content);
+                for (std::size_t i = 0; i < records.size(); ++i) {
+                    historyOrder[records[i].id].push_back(i);
+                }
+            }
+        }
+
+        std::set<std::filesystem::path> seenPaths;
+        auto* registry = DynamicBookRegistry::GetSingleton();
+        for (const auto& title : GetAllBookTitles()) {
+            auto record = registry->FindByKey(title);
+            if (!record || !seenPaths.insert(record->path).second || !std::filesystem::exists(record->path)) {
+                continue;
+            }
+            SegmentStore::MigrationResult result;
+            {
+                std::lock_guard<std::mutex> lock(_dataMutex);
+                if (SegmentStore::IsSegmented(record->path) == toSegments) {
+                    ++report.booksAlready;
+                    continue;
+                }
+                result = toSegments ? SegmentStore::Split(record->path) : SegmentStore::Merge(record->path, historyOrder);
+            }
+            if (!result.ok) {
+                ++report.booksFailed;
+                Log::Session().error("SessionDataManager: Could not convert '{}': {}", title, result.error);
+                if (report.firstError.empty()) {
+                    report.firstError = title + ": " + result.error;
+                }
+                continue;
+            }
+            ++report.booksConverted;
+            report.blocksMoved += result.blocks;
+            report.segments += result.segments;
+            FileWatcher::NotifyFileUpdated(title);
+            registry->MarkChanged(title);
+        }
+
+        report.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Log::Session().info("SessionDataManager: Converted {} books to {} ({} blocks, {} segments, {} already converted, {} failed) in {:.1f} ms.",
+            report.booksConverted, toSegments ? "timeline segments" : "single files", report.blocksMoved, report.segments,
+            report.booksAlready, report.booksFailed, report.milliseconds);
+        return report;
+    }
+
+    void SessionDataManager::ScheduleStorageMigration(bool toSegments) {
+        if (_maintenanceRunning.exchange(true)) {
+            return;
+        }
+        WorkerPool::GetSingleton()->Submit([this, toSegments]() {
+            StorageMigrationReport report;
+            try {
+                report = MigrateStorage(toSegments);
+            } catch (const std::exception& e) {
+                Log::Session().error("SessionDataManager: Storage migration failed: {}", e.what());
+                report.toSegments = toSegments;
+                report.firstError = e.what();
+            }
+            {
+                std::lock_guard<std::mutex> lock(_reportMutex);
+                _lastStorageMigrationReport = std::move(report);
+            }
+            _maintenanceRunning.store(false);
+        }, WorkerPool::Priority::kLow);
+    }
+
+    std::optional<StorageMigrationReport> SessionDataManager::GetLastStorageMigrationReport() {
+        std::lock_guard<std::mutex> lock(_reportMutex);
+        return _lastStorageMigrationReport;
+    }
+
     std::string SessionDataManager::ExtractTimelineID(const std::string& saveName) {
         size_t lastUnderscore = saveName.rfind('_');
         if (lastUnderscore == std::string::npos) return "";
@@ -3,6 +3,10 @@
 #include "BookMenuWatcher.h"
 #include "BookMenuWatcher.h"
 #include "Utility.h"
+#include "Log.h"
+#include "Settings.h"
+#include "BookSearch.h"
+#include "ImageRegistry.h"
 #include "PCH.h"
 <<<<<<< Updated upstream
 =======
@@ -13,6 +17,7 @@
 
 // --- Namespace alias for convenience ---
 namespace logger = SKSE::log;
+namespace Log = DynamicBookFramework::Log;
 
 namespace SetBookTextHook {
 
@@ -31,6 +36,9 @@ namespace SetBookTextHook {
     // static SetBookTextThunk_t g_rawOriginalThunkPtr = nullptr;
     void (*g_rawOriginalThunkPtr)(RE::GFxMovieView*, const char*, RE::FxResponseArgsBase*, std::uintptr_t) = nullptr;
 
+    // Shown when a book is still being prepared in the background after the prepare timeout; the real page follows with a refresh.
+    constexpr const char* kPreparingPlaceholder = "<p align='center'>Loading...</p>";
+
 <<<<<<< Updated upstream
     
     void Detour_SetBookTextThunk(
@@ -43,8 +51,13 @@ namespace SetBookTextHook {
                     //funcName, reinterpret_cast<uintptr_t>(rawMovieView_param), 
                     //args ? reinterpret_cast<uintptr_t>(args) : 0, v10_param);
 
+        // Keeps the HTML alive until the original thunk below has consumed it, even if the cache evicts it meanwhile.
+        std::shared_ptr<const std::string> customTextHolder;
+        // Set once the book's real text is going in, so a search jump waits for that instead of the placeholder.
+        RE::FormID jumpFormID = 0;
+
         if (rawMovieView_param == nullptr) {
-            logger::critical("CRITICAL: rawMovieView_param is NULL on entry to detour!");
+            Log::Hook().critical("CRITICAL: rawMovieView_param is NULL on entry to detour!");
         }
 
         if (args && strcmp(funcName, "SetBookText") == 0) {
@@ -53,14 +66,20 @@ namespace SetBookTextHook {
             if (currentBookForDisplay) {
                 RE::FormID currentFormID = currentBookForDisplay->GetFormID();
                 std::string currentTitle = currentBookForDisplay->GetFullName() ? currentBookForDisplay->GetFullName() : "";
-                logger::info("SetBookTextHook: Intercepted SetBookText for '{}' (FormID {:X})", currentTitle, currentFormID);
+                Log::Hook().debug("SetBookTextHook: Intercepted SetBookText for '{}' (FormID {:X})", currentTitle, currentFormID);
 
-                auto& textMap = DynamicBookFramework::BookMenuWatcher::GetSingleton()->dynamicBookTexts;
-                auto it = textMap.find(currentFormID);
+                auto* watcher = DynamicBookFramework::BookMenuWatcher::GetSingleton();
+                if (watcher->WaitForPreparedBook(currentFormID, std::chrono::milliseconds(Settings::prepareTimeoutMs))) {
+                    customTextHolder = watcher->GetCachedHtmlForBook(currentFormID);
+                    jumpFormID = currentFormID;
+                } else {
+                    static const auto placeholder = std::make_shared<const std::string>(kPreparingPlaceholder);
+                    customTextHolder = placeholder;
+                }
 
-                if (it != textMap.end()) { // This IS one of our dynamic books
-                    const std::string& customText = it->second;
-                    logger::info("SetBookTextHook: Found custom text for FormID {:X}. Content length: {}", currentFormID, customText.length());
+                if (customTextHolder) { // This IS one of our dynamic books
+                    const std::string& customText = *customTextHolder;
+                    Log::Hook().debug("SetBookTextHook: Found custom text for FormID {:X}. Content length: {}", currentFormID, customText.length());
                     // Log a snippet of the custom text for verification:
                     //logger::trace("SetBookTextHook: Custom text snippet: {:.100}", customText);
 
@@ -76,34 +95,37 @@ namespace SetBookTextHook {
                                 bookTextValue.SetString(customText.c_str());
                                 //logger::info("Book text (astrText) MODIFIED with dynamic content for FormID {:X}.", currentFormID);
                             } else {
-                                logger::warn("Dynamic text for FormID {:X} is empty. Setting a placeholder to avoid issues.", currentFormID);
+                                Log::Hook().warn("Dynamic text for FormID {:X} is empty. Setting a placeholder to avoid issues.", currentFormID);
                                 bookTextValue.SetString("<p> </p>"); // Minimal valid HTML to clear/show empty
                             }
                         } else {
-                            logger::warn("Book text argument (astrText) is not a string type as expected for FormID {:X}. Cannot modify.", currentFormID);
+                            Log::Hook().warn("Book text argument (astrText) is not a string type as expected for FormID {:X}. Cannot modify.", currentFormID);
                         }
                     } else {
-                        logger::warn("FxResponseArgs for SetBookText has unexpected argument count for FormID {:X}. Cannot modify.", currentFormID);
+                        Log::Hook().warn("FxResponseArgs for SetBookText has unexpected argument count for FormID {:X}. Cannot modify.", currentFormID);
                     }
                 } else {
                     // Not one of our dynamic books - do nothing, let original text pass through.
-                    logger::info("SetBookTextHook: No dynamic text in map for FormID {:X} ('{}'). Original text will be used.", currentFormID, currentTitle);
+                    Log::Hook().debug("SetBookTextHook: No dynamic text in map for FormID {:X} ('{}'). Original text will be used.", currentFormID, currentTitle);
                     //logger::info("Original Book Text (Narrow): \n---\n{}\n---", originalNarrowText ? originalNarrowText : "[[NULL NARROW STRING]]");
                 }
             } else {
-                logger::warn("SetBookTextHook: Could not get target form from BookMenu inside detour. Original text will be used.");
+                Log::Hook().warn("SetBookTextHook: Could not get target form from BookMenu inside detour. Original text will be used.");
             }
         } else if (args) {
-            logger::trace("SetBookTextHook: Intercepted for function: {} (not SetBookText)", funcName);
+            Log::Hook().trace("SetBookTextHook: Intercepted for function: {} (not SetBookText)", funcName);
         } else {
-            logger::warn("SetBookTextHook: Detour called with null FxResponseArgsBase.");
+            Log::Hook().warn("SetBookTextHook: Detour called with null FxResponseArgsBase.");
         }
 
         // Call the original thunk function
         if (g_rawOriginalThunkPtr) {
             g_rawOriginalThunkPtr(rawMovieView_param, funcName, args, v10_param);
+            if (jumpFormID && rawMovieView_param) {
+                DynamicBookFramework::BookSearch::ApplyPendingJump(rawMovieView_param, jumpFormID);
+            }
         } else {
-            logger::error("Original thunk (4-arg) RAW function pointer is null! Cannot call original function.");
+            Log::Hook().error("Original thunk (4-arg) RAW function pointer is null! Cannot call original function.");
         }
         
         //logger::trace("SetBookTextThunk: Exiting detour.");
@@ -114,7 +136,7 @@ namespace SetBookTextHook {
 
         uintptr_t functionWithCallBase = FunctionWithCall_ID.address(); 
         if (!functionWithCallBase) {
-            logger::critical("SetBookTextHook: Failed to find address for ID {}. Hook not installed.", FunctionWithCall_ID.id());
+            Log::Hook().critical("SetBookTextHook: Failed to find address for ID {}. Hook not installed.", FunctionWithCall_ID.id());
             return false;
         }
 
@@ -131,7 +153,7 @@ namespace SetBookTextHook {
            // logger::info("SetBookTextHook: Successfully hooked. Original thunk (4-arg, raw ptr) RAW ptr at 0x{:X}", reinterpret_cast<uintptr_t>(g_rawOriginalThunkPtr));
             return true;
         } else {
-            logger::error("SetBookTextHook: Failed to install hook at 0x{:X} (trampoline returned null or invalid address).", callInstructionAddress);
+            Log::Hook().error("SetBookTextHook: Failed to install hook at 0x{:X} (trampoline returned null or invalid address).", callInstructionAddress);
             return false;
         }
     }
@@ -151,37 +173,47 @@ namespace SetBookTextHook {
 		watcher->CacheVanillaText(bookForm->GetName(), vanillaText);
 	}
 	
-	std::string rawBookText = watcher->GetFullDynamicTextForBook(bookForm);
-	if (rawBookText.empty()) {
-		return g_original_Invoke(a_view, a_funcName, a_args);
+	// The worker pool normally has the page ready. If it is still busy after the timeout, a placeholder goes in
+	// and the refresh WaitForPreparedBook scheduled pushes the real page; the game thread never builds it.
+	std::shared_ptr<const std::string> preparedHtml;
+	bool prepared = watcher->WaitForPreparedBook(bookForm->GetFormID(), std::chrono::milliseconds(Settings::prepareTimeoutMs));
+	if (prepared) {
+		preparedHtml = watcher->GetCachedHtmlForBook(bookForm->GetFormID());
+		if (!preparedHtml) {
+			return g_original_Invoke(a_view, a_funcName, a_args); // Not one of our books
+		}
+	} else {
+		static const auto placeholder = std::make_shared<const std::string>(kPreparingPlaceholder);
+		preparedHtml = placeholder;
 	}
+	const std::string& finalHtml = *preparedHtml;
 	
 	// --- FINAL, SAFE IMAGE LOADING ---
 
-	std::vector<std::string> imagePaths = ExtractImagePathsFromText(rawBookText);
+	// The page is already marked up, so its images are found by their <img src='img://'> tags.
+	std::vector<std::string> imagePaths = ExtractImagePathsFromText(finalHtml);
 	auto& textureArray = REL::RelocateMember<RE::BSTArray<RE::BSScaleformExternalTexture>>(bookMenu, 0x50, 0x60);
 	
 	// DO NOT CLEAR THE ARRAY. Only add textures that are new.
+	// Index what the menu already holds once, instead of rescanning the array for every image.
+	std::unordered_set<std::string> loadedTextures;
+	loadedTextures.reserve(textureArray.size() + imagePaths.size());
+	for (const auto& existingTexture : textureArray) {
+		loadedTextures.emplace(existingTexture.filePath.c_str());
+	}
+
 	for (const auto& path : imagePaths) {
 		std::string fullImgPath = "img://" + path;
-		bool alreadyExists = false;
-		for (const auto& existingTexture : textureArray) {
-			if (existingTexture.filePath == fullImgPath.c_str()) {
-				alreadyExists = true;
-				break;
-			}
-		}
-
-		if (!alreadyExists) {
-			auto& newTexture = textureArray.emplace_back();
-			RE::BSFixedString bsPath(path);
-			if (newTexture.LoadPNG(bsPath) && newTexture.gamebryoTexture) {
-				newTexture.filePath = fullImgPath;
+		if (loadedTextures.insert(fullImgPath).second) {
+			// The registry hands out a texture loaded for an earlier book; only images new to it go through LoadPNG,
+			// whose file the worker pool has read ahead.
+			RE::BSScaleformExternalTexture texture;
+			if (DynamicBookFramework::ImageRegistry::GetSingleton()->Acquire(path, texture)) {
+				textureArray.push_back(texture);
 			}
 		}
 	}
 
-	std::string finalHtml = HtmlFormatText::ApplyGeneralBookMarkup_ProcessChunk(rawBookText);
 	originalArgs[1].SetString(finalHtml.c_str());
 	
 	g_original_Invoke(a_view, a_funcName, a_args);
@@ -194,6 +226,11 @@ namespace SetBookTextHook {
     infoArgs.Add(bookForm->GetFormID());
     infoArgs.Add(bookForm->GetName());
     RE::FxDelegate::Invoke2(a_view, "SetBookInfo", infoArgs);
+
+	// After a placeholder the jump waits for the refresh that brings the real page.
+	if (prepared) {
+		DynamicBookFramework::BookSearch::ApplyPendingJump(a_view, bookForm->GetFormID());
+	}
 }
 
 
@@ -219,11 +256,11 @@ namespace SetBookTextHook {
 		g_original_Invoke = trampoline.write_call<5>(callInstructionAddress, reinterpret_cast<uintptr_t>(Detour_SetBookText));
 
 		if (g_original_Invoke.get()) {
-			logger::info("Final SetBookText hook installed successfully.");
+			Log::Hook().info("Final SetBookText hook installed successfully.");
 			return true;
 		}
 		
-		logger::error("Failed to install SetBookText hook.");
+		Log::Hook().error("Failed to install SetBookText hook.");
 		return false;
 	}
 }
@@ -2,6 +2,13 @@
 #include "PCH.h"
 #include "Settings.h"
 #include "Utility.h"
+#include "IniParser.h"
+#include "DynamicBookRegistry.h"
+#include "InputListener.h"
+#include "Log.h"
+#include "BookMenuWatcher.h"
+#include "Prefetcher.h"
+#include "ImageRegistry.h"
 
 
 // We will assume you have a simple INI parser or will use one.
@@ -18,6 +25,20 @@ namespace Settings {
     int bookmarkPageHotkey = 0x30;     // Default B
     int nextBookmarkHotkey = 0x2F;     // Default V
     int previousBookmarkHotkey = 0x2E; // Default C
+    int focusTextInputHotkey = 0x2D;   // Default X
+    int submitTextInputHotkey = 0x1C;  // Default Enter
+    int renderedTextCacheMB = 64;
+    int imageCacheMB = 64;
+    int prepareTimeoutMs = 150;
+    int workerThreadCount = 2;
+    bool prefetchOnCrosshair = true;
+    bool prefetchOnInventory = true;
+    int prefetchMaxJobs = 1;
+    int prefetchBudgetMB = 16;
+    bool compactSaveDataOnLoad = false;
+    int keepRecentTimelines = 1;
+    bool compressColdBlocks = false;
+    int plainRecentSaves = 10;
 
     // --- This will hold all our bookmarks ---
     std::map<std::string, std::vector<std::string>> g_bookmarks;
@@ -45,7 +66,9 @@ namespace Settings {
 		iniFile << "[Hotkeys]\n";
 		iniFile << "OpenMenu = " << GetNameFromScancode(openMenuHotkey) << "\n";
 		iniFile << "NextBookmark = " << GetNameFromScancode(nextBookmarkHotkey) << "\n";
-		iniFile << "PreviousBookmark = " << GetNameFromScancode(previousBookmarkHotkey) << "\n\n";
+		iniFile << "PreviousBookmark = " << GetNameFromScancode(previousBookmarkHotkey) << "\n";
+		iniFile << "FocusTextInput = " << GetNameFromScancode(focusTextInputHotkey) << "\n";
+		iniFile << "SubmitTextInput = " << GetNameFromScancode(submitTextInputHotkey) << "\n\n";
 
         iniFile << "\n";
 
@@ -78,6 +101,50 @@ namespace Settings {
         }
 
         iniFile << "\n";
+
+        // Write Cache section
+        iniFile << "[Cache]\n";
+        iniFile << "; Memory budget for rendered book pages. Least recently opened books are dropped first.\n";
+        iniFile << "RenderedTextMB = " << renderedTextCacheMB << "\n";
+        iniFile << "; Memory budget for book images kept loaded between books. Least recently shown images are dropped first.\n";
+        iniFile << "ImageMB = " << imageCacheMB << "\n\n";
+
+        // Write Performance section
+        iniFile << "[Performance]\n";
+        iniFile << "; Milliseconds a book may take to prepare before a placeholder is shown. The page refreshes once it is ready.\n";
+        iniFile << "PrepareTimeoutMs = " << prepareTimeoutMs << "\n";
+        iniFile << "; Background threads used to prepare books. Takes effect after a restart.\n";
+        iniFile << "WorkerThreads = " << workerThreadCount << "\n\n";
+
+        // Write Prefetch section
+        iniFile << "[Prefetch]\n";
+        iniFile << "; Prepare mapped books in the background before they are opened.\n";
+        iniFile << "Crosshair = " << (prefetchOnCrosshair ? "true" : "false") << "\n";
+        iniFile << "Inventory = " << (prefetchOnInventory ? "true" : "false") << "\n";
+        iniFile << "MaxJobs = " << prefetchMaxJobs << "\n";
+        iniFile << "; Prefetching pauses once this many megabytes of rendered pages are cached.\n";
+        iniFile << "BudgetMB = " << prefetchBudgetMB << "\n\n";
+
+        // Write Save History section
+        iniFile << "[SaveHistory]\n";
+        iniFile << "; Remove save blocks that no save in the saves folder can reach, once per session after the first load.\n";
+        iniFile << "CompactOnLoad = " << (compactSaveDataOnLoad ? "true" : "false") << "\n";
+        iniFile << "; The most recent timelines (playthroughs) are kept whole even if their saves were deleted.\n";
+        iniFile << "KeepRecentTimelines = " << keepRecentTimelines << "\n";
+        iniFile << "; Store the save blocks of older saves LZ4-compressed. They are decompressed only when a journal shows them.\n";
+        iniFile << "CompressColdBlocks = " << (compressColdBlocks ? "true" : "false") << "\n";
+        iniFile << "; The most recent saves of each timeline stay plain text.\n";
+        iniFile << "PlainRecentSaves = " << plainRecentSaves << "\n\n";
+
+        // Write Logging section
+        iniFile << "[Logging]\n";
+        iniFile << "; Per-subsystem log levels: trace, debug, info, warn, error, critical or off.\n";
+        for (std::size_t i = 0; i < static_cast<std::size_t>(DynamicBookFramework::Log::Subsystem::kCount); ++i) {
+            auto subsystem = static_cast<DynamicBookFramework::Log::Subsystem>(i);
+            iniFile << DynamicBookFramework::Log::GetSettingName(subsystem) << " = "
+                    << DynamicBookFramework::Log::LevelToString(DynamicBookFramework::Log::GetLevel(subsystem)) << "\n";
+        }
+        iniFile << "\n";
     }
 
     void LoadSettings() {
@@ -86,36 +153,25 @@ namespace Settings {
         defaultFontFace = "$HandwrittenFont";
         defaultFontSize = 20;
         openMenuHotkey = 0x44; // Default to F10
+        DynamicBookFramework::Log::ResetLevels();
 
-        std::ifstream iniFile(settingsPath);
-        if (!iniFile.is_open()) {
+        if (!std::filesystem::exists(settingsPath)) {
             logger::info("Settings.ini not found. Using default values and creating a new file.");
             userDefinedFonts = officialDefaultFonts;
             SaveSettings();
+            InputListener::GetSingleton()->RebuildActionTable();
             return;
         }
 
         logger::info("Loading settings from {}", settingsPath);
-        std::string line;
-        std::string currentSection;
-        while (std::getline(iniFile, line)) {
-            line.erase(0, line.find_first_not_of(" \t\n\r"));
-            line.erase(line.find_last_not_of(" \t\n\r") + 1);
-
-            if (line.empty() || line[0] == ';') continue;
-
-            if (line[0] == '[' && line.back() == ']') {
-                currentSection = line;
-            } else if (currentSection == "[Hotkeys]") {
-                std::stringstream ss(line);
-                std::string key, value;
-                if (std::getline(ss, key, '=') && std::getline(ss, value)) {
-                    key.erase(key.find_last_not_of(" \t") + 1);
-                    value.erase(0, value.find_first_not_of(" \t"));
+        using DynamicBookFramework::IniParser::EqualsIgnoreCase;
+        DynamicBookFramework::IniParser::ParseFile(settingsPath,
+            [](std::string_view section, std::string_view keyView, std::string_view valueView) {
+                std::string key(keyView);
+                std::string value(valueView);
+                if (EqualsIgnoreCase(section, "Hotkeys")) {
                     if (key == "OpenMenu") {
-                        // Read the string name (e.g., "F10") from the INI
-                        //std::string hotkeyName = value;
-                        // Use our helper function to convert the name to a scancode
+                        // Use our helper function to convert the name (e.g., "F10") to a scancode
                         openMenuHotkey = GetScancodeFromName(value);
                         // As a safety measure, if the name is invalid, default to F10
                         if (openMenuHotkey == 0) {
@@ -130,30 +186,77 @@ namespace Settings {
                     } else if (key == "PreviousBookmark") {
                         previousBookmarkHotkey = GetScancodeFromName(value);
                         if (previousBookmarkHotkey == 0) { previousBookmarkHotkey = 0x2E; } // Default C
+                    } else if (key == "FocusTextInput") {
+                        focusTextInputHotkey = GetScancodeFromName(value);
+                        if (focusTextInputHotkey == 0) { focusTextInputHotkey = 0x2D; } // Default X
+                    } else if (key == "SubmitTextInput") {
+                        submitTextInputHotkey = GetScancodeFromName(value);
+                        if (submitTextInputHotkey == 0) { submitTextInputHotkey = 0x1C; } // Default Enter
                     }
-                }
-            } else if (currentSection == "[Appearance]") {
-                std::stringstream ss(line);
-                std::string key, value;
-                if (std::getline(ss, key, '=') && std::getline(ss, value)) {
-                    key.erase(key.find_last_not_of(" \t") + 1);
-                    value.erase(0, value.find_first_not_of(" \t"));
+                } else if (EqualsIgnoreCase(section, "Appearance")) {
                     if (key == "FontFace") defaultFontFace = value;
-                    else if (key == "FontSize") defaultFontSize = std::stoi(value);
-                }
-            } else if (currentSection == "[Default Fonts]" || currentSection == "[User Fonts]") {
-                std::stringstream ss(line);
-                std::string key, value;
-                if (std::getline(ss, key, '=') && std::getline(ss, value)) {
-                    value.erase(0, value.find_first_not_of(" \t"));
-                    value.erase(value.find_last_not_of(" \t") + 1);
+                    else if (key == "FontSize") {
+                        int size = std::atoi(value.c_str());
+                        if (size > 0) defaultFontSize = size;
+                    }
+                } else if (EqualsIgnoreCase(section, "Default Fonts") || EqualsIgnoreCase(section, "User Fonts")) {
                     if (!value.empty()) {
                         userDefinedFonts.push_back(value);
                     }
+                } else if (EqualsIgnoreCase(section, "Cache")) {
+                    if (key == "RenderedTextMB") {
+                        int megabytes = std::atoi(value.c_str());
+                        if (megabytes > 0) renderedTextCacheMB = megabytes;
+                    } else if (key == "ImageMB") {
+                        int megabytes = std::atoi(value.c_str());
+                        if (megabytes >= 0) imageCacheMB = megabytes;
+                    }
+                } else if (EqualsIgnoreCase(section, "Performance")) {
+                    if (key == "PrepareTimeoutMs") {
+                        int timeout = std::atoi(value.c_str());
+                        if (timeout >= 0) prepareTimeoutMs = timeout;
+                    } else if (key == "WorkerThreads") {
+                        int threads = std::atoi(value.c_str());
+                        if (threads > 0) workerThreadCount = std::min(threads, 8);
+                    }
+                } else if (EqualsIgnoreCase(section, "Prefetch")) {
+                    bool enabled = EqualsIgnoreCase(valueView, "true") || valueView == "1";
+                    if (key == "Crosshair") prefetchOnCrosshair = enabled;
+                    else if (key == "Inventory") prefetchOnInventory = enabled;
+                    else if (key == "MaxJobs") {
+                        int jobs = std::atoi(value.c_str());
+                        if (jobs >= 0) prefetchMaxJobs = jobs;
+                    } else if (key == "BudgetMB") {
+                        int megabytes = std::atoi(value.c_str());
+                        if (megabytes >= 0) prefetchBudgetMB = megabytes;
+                    }
+                } else if (EqualsIgnoreCase(section, "SaveHistory")) {
+                    if (key == "CompactOnLoad") {
+                        compactSaveDataOnLoad = EqualsIgnoreCase(valueView, "true") || valueView == "1";
+                    } else if (key == "KeepRecentTimelines") {
+                        int timelines = std::atoi(value.c_str());
+                        if (timelines >= 0) keepRecentTimelines = timelines;
+                    } else if (key == "CompressColdBlocks") {
+                        compressColdBlocks = EqualsIgnoreCase(valueView, "true") || valueView == "1";
+                    } else if (key == "PlainRecentSaves") {
+                        int saves = std::atoi(value.c_str());
+                        if (saves >= 0) plainRecentSaves = saves;
+                    }
+                } else if (EqualsIgnoreCase(section, "Logging")) {
+                    using namespace DynamicBookFramework;
+                    for (std::size_t i = 0; i < static_cast<std::size_t>(Log::Subsystem::kCount); ++i) {
+                        auto subsystem = static_cast<Log::Subsystem>(i);
+                        if (!EqualsIgnoreCase(keyView, Log::GetSettingName(subsystem))) {
+                            continue;
+                        }
+                        if (auto level = Log::ParseLevel(valueView)) {
+                            Log::SetLevel(subsystem, *level);
+                        } else {
+                            logger::warn("Settings: Unknown log level '{}' for {}. Keeping the default.", value, key);
+                        }
+                    }
                 }
-            }
-            
-        }
+            });
         
         logger::info("Finished loading settings:");
         logger::info("  OpenMenu Hotkey -> {} ({})", openMenuHotkey, GetNameFromScancode(openMenuHotkey));
@@ -162,6 +265,20 @@ namespace Settings {
         for(const auto& font : userDefinedFonts) {
             logger::info("  Loaded Font -> {}", font);
         }
+
+        InputListener::GetSingleton()->RebuildActionTable();
+        DynamicBookFramework::BookMenuWatcher::GetSingleton()->GetTextCache().SetByteBudget(static_cast<std::size_t>(renderedTextCacheMB) * 1024 * 1024);
+        DynamicBookFramework::ImageRegistry::GetSingleton()->SetByteBudget(static_cast<std::size_t>(imageCacheMB) * 1024 * 1024);
+
+        DynamicBookFramework::PrefetchConfig prefetchConfig;
+        prefetchConfig.crosshair = prefetchOnCrosshair;
+        prefetchConfig.inventory = prefetchOnInventory;
+        prefetchConfig.maxConcurrentJobs = static_cast<std::size_t>(prefetchMaxJobs);
+        prefetchConfig.memoryBudgetBytes = static_cast<std::size_t>(prefetchBudgetMB) * 1024 * 1024;
+        DynamicBookFramework::Prefetcher::GetSingleton()->GetPolicy().SetConfig(prefetchConfig);
+
+        // Font settings are baked into the cached HTML, so every book has to be rendered again.
+        DynamicBookFramework::DynamicBookRegistry::GetSingleton()->InvalidateAll();
     }
 
     void ScanAllBooksForBookmarks() {
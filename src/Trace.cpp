@@ -0,0 +1,143 @@
+//Trace.cpp
+#include "Trace.h"
+#include "Utility.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+    namespace Trace {
+
+        namespace { // Anonymous namespace for the ring buffer
+
+            constexpr std::size_t kCapacity = 16384;
+
+            struct Event {
+                const char* name = nullptr;
+                const char* category = nullptr;
+                char phase = 'B';
+                std::uint32_t threadID = 0;
+                std::int64_t timestampUs = 0;
+                std::string detail;
+            };
+
+            std::mutex g_mutex;
+            std::vector<Event> g_events;   // Ring buffer, allocated on first use
+            std::size_t g_next = 0;        // Total events recorded; g_next % kCapacity is the next slot
+
+            const auto g_epoch = std::chrono::steady_clock::now();
+
+            void Push(const char* a_name, const char* a_category, char a_phase, std::string_view a_detail) {
+                auto elapsed = std::chrono::steady_clock::now() - g_epoch;
+                auto timestampUs = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+                auto threadID = static_cast<std::uint32_t>(::GetCurrentThreadId());
+
+                std::lock_guard<std::mutex> lock(g_mutex);
+                if (g_events.empty()) {
+                    g_events.resize(kCapacity);
+                }
+                auto& event = g_events[g_next % kCapacity];
+                event.name = a_name;
+                event.category = a_category;
+                event.phase = a_phase;
+                event.threadID = threadID;
+                event.timestampUs = timestampUs;
+                event.detail.assign(a_detail);
+                ++g_next;
+            }
+
+            void AppendJsonEscaped(std::string& out, std::string_view text) {
+                for (char c : text) {
+                    switch (c) {
+                    case '"':  out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            out += std::format("\\u{:04x}", static_cast<unsigned>(c));
+                        } else {
+                            out += c;
+                        }
+                    }
+                }
+            }
+
+            std::string GetFileTimestamp() {
+                auto now = std::chrono::system_clock::now();
+                auto in_time_t = std::chrono::system_clock::to_time_t(now);
+                std::tm buf;
+                localtime_s(&buf, &in_time_t);
+                std::stringstream ss;
+                ss << std::put_time(&buf, "%Y-%m-%d_%H-%M-%S");
+                return ss.str();
+            }
+        }
+
+        void Begin(const char* a_name, const char* a_category, std::string_view a_detail) {
+            Push(a_name, a_category, 'B', a_detail);
+        }
+
+        void End(const char* a_name, const char* a_category) {
+            Push(a_name, a_category, 'E', {});
+        }
+
+        void Clear() {
+            std::lock_guard<std::mutex> lock(g_mutex);
+            g_events.clear();
+            g_next = 0;
+        }
+
+        std::optional<std::filesystem::path> DumpToLogFolder() {
+            auto logsFolder = SKSE::log::log_directory();
+            if (!logsFolder) {
+                logger::error("Trace: Log directory is not available. Cannot write trace.");
+                return std::nullopt;
+            }
+
+            // Copy out under the lock, format without it, so recording threads are not held up by the write.
+            std::vector<Event> events;
+            {
+                std::lock_guard<std::mutex> lock(g_mutex);
+                std::size_t count = std::min(g_next, g_events.size());
+                events.reserve(count);
+                for (std::size_t i = g_next - count; i < g_next; ++i) {
+                    events.push_back(g_events[i % kCapacity]);
+                }
+            }
+
+            const auto processID = static_cast<std::uint32_t>(::GetCurrentProcessId());
+            std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+            bool first = true;
+            for (const auto& event : events) {
+                if (!first) {
+                    json += ",\n";
+                }
+                first = false;
+                json += "{\"name\":\"";
+                AppendJsonEscaped(json, event.name);
+                json += "\",\"cat\":\"";
+                AppendJsonEscaped(json, event.category);
+                json += std::format("\",\"ph\":\"{}\",\"ts\":{},\"pid\":{},\"tid\":{}", event.phase, event.timestampUs, processID, event.threadID);
+                if (!event.detail.empty()) {
+                    json += ",\"args\":{\"detail\":\"";
+                    AppendJsonEscaped(json, event.detail);
+                    json += "\"}";
+                }
+                json += "}";
+            }
+            json += "\n]}\n";
+
+            auto tracePath = *logsFolder / std::format("DynamicBookFramework_Trace_{}.json", GetFileTimestamp());
+            std::ofstream file(tracePath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                logger::error("Trace: Could not open '{}' for writing.", tracePath.string());
+                return std::nullopt;
+            }
+            file.write(json.data(), json.size());
+            logger::info("Trace: Wrote {} events to '{}'.", events.size(), tracePath.string());
+            return tracePath;
+        }
+
+    } // namespace Trace
+} // namespace DynamicBookFramework
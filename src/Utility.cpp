@@ -1,4 +1,12 @@
 #include "Utility.h"
+#include "IniParser.h"
+#include "BookMappingCache.h"
+#include "BookPakRegistry.h"
+#include "DynamicBookRegistry.h"
+#include "Log.h"
+#include "Profiler.h"
+#include "ImageInfo.h"
+#include "WorkerPool.h"
 #include "PCH.h"
 
 namespace logger = SKSE::log;
@@ -7,15 +15,8 @@ std::wstring g_iniPath = L"Data\\SKSE\\Plugins\\DynamicBookFramework.ini";
 
 
 void SetupLog() {
-    auto logsFolder = SKSE::log::log_directory();
-    if (!logsFolder) SKSE::stl::report_and_fail("SKSE log_directory not provided, logs disabled.");
-    auto pluginName = SKSE::PluginDeclaration::GetSingleton()->GetName();
-    auto logFilePath = *logsFolder / std::format("{}.log", pluginName);
-    auto fileLoggerPtr = std::make_shared<spdlog::sinks::basic_file_sink_mt>(logFilePath.string(), true);
-    auto loggerPtr = std::make_shared<spdlog::logger>("log", std::move(fileLoggerPtr));
-    spdlog::set_default_logger(std::move(loggerPtr));
-    spdlog::set_level(spdlog::level::trace);
-    spdlog::flush_on(spdlog::level::trace);
+    // Async file logger with per-subsystem levels; see Log.h.
+    DynamicBookFramework::Log::Setup();
 }
 
 namespace HtmlFormatText {
@@ -62,6 +63,42 @@ namespace HtmlFormatText {
         paragraphContent.clear();
     }
 
+    // Turns the inside of an [IMG=path|width|height] tag into an <img> paragraph. Omitted dimensions come from the
+    // file's PNG/DDS header: one given dimension keeps the aspect ratio, none uses the natural size clamped to the page.
+    std::string FormatImageTag(const std::string& tagContent) {
+        constexpr std::uint32_t kFallbackWidth = 290;  // Used when the header cannot be read
+        constexpr std::uint32_t kFallbackHeight = 389;
+        constexpr std::uint32_t kMaxPageWidth = 290;
+
+        std::stringstream tagStream(tagContent);
+        std::string imagePath, widthStr, heightStr;
+        std::getline(tagStream, imagePath, '|');
+        std::getline(tagStream, widthStr, '|');
+        std::getline(tagStream, heightStr, '|');
+        std::uint32_t width = static_cast<std::uint32_t>(std::max(0, std::atoi(widthStr.c_str())));
+        std::uint32_t height = static_cast<std::uint32_t>(std::max(0, std::atoi(heightStr.c_str())));
+
+        if (width == 0 || height == 0) {
+            if (auto natural = DynamicBookFramework::ImageInfo::GetImageSize(imagePath)) {
+                double aspect = static_cast<double>(natural->height) / natural->width;
+                if (width != 0) {
+                    height = static_cast<std::uint32_t>(std::lround(width * aspect));
+                } else if (height != 0) {
+                    width = static_cast<std::uint32_t>(std::lround(height / aspect));
+                } else {
+                    width = std::min(natural->width, kMaxPageWidth);
+                    height = static_cast<std::uint32_t>(std::lround(width * aspect));
+                }
+            } else {
+                width = width != 0 ? width : kFallbackWidth;
+                height = height != 0 ? height : kFallbackHeight;
+            }
+        }
+
+        std::replace(imagePath.begin(), imagePath.end(), '/', '\\');
+        return "<p align='center'><img src='img://" + imagePath + "' width='" + std::to_string(width) + "' height='" + std::to_string(height) + "'></p>\n";
+    }
+
     // This is the main processing function with the new trimming logic.
     // std::string ApplyGeneralBookMarkup_ProcessChunk(
     //     const std::string& plainTextChunk,
@@ -178,6 +215,7 @@ namespace HtmlFormatText {
         if (plainTextChunk.empty()) {
             return "";
         }
+        DynamicBookFramework::Profiler::ScopedTimer timer(DynamicBookFramework::Profiler::Stage::kProcessChunk);
         
         std::stringstream resultChunkHtml;
         std::string currentTextParagraphContent;
@@ -226,6 +264,10 @@ namespace HtmlFormatText {
                         FlushTextParagraphBuffer_Chunk(resultChunkHtml, currentTextParagraphContent, defaultParagraphAlign);
                         resultChunkHtml << "<p>[pagebreak]</p>\n";
                         consecutiveBlankLineCount = 0;
+                    } else if (trimmedLine.rfind("[IMG=", 0) == 0 && trimmedLine.back() == ']') {
+                        FlushTextParagraphBuffer_Chunk(resultChunkHtml, currentTextParagraphContent, defaultParagraphAlign);
+                        resultChunkHtml << FormatImageTag(trimmedLine.substr(5, trimmedLine.length() - 6));
+                        consecutiveBlankLineCount = 0;
                     } else {
                         if (consecutiveBlankLineCount >= 2) {
                             resultChunkHtml << "<p>[pagebreak]</p>\n";
@@ -283,48 +325,57 @@ std::string wstring_to_utf8(const std::wstring& wstr) {
     return str;
 }
 
-// Reads all book mappings from the INI file into g_dynamicBooks
-void LoadBookMappings()
+namespace {
+    // This path for the actual .txt files remains the same. Packed books are mapped to where their loose file would be.
+    const std::filesystem::path kBooksFolder = "Data/SKSE/Plugins/DynamicBookFramework/books";
+    // The top-level folder searched for mapping INIs and .dbfpak archives.
+    const std::filesystem::path kMappingFolder = "Data/SKSE/Plugins/DynamicBookFramework";
+
+    // Parses the [Books] section of one mapping INI. As with the profile APIs, keys are case-insensitive and the
+    // first definition of a key in a file wins.
+    std::vector<std::pair<std::wstring, std::wstring>> ParseMappingIni(const std::filesystem::path& iniPath) {
+
+        std::vector<std::pair<std::wstring, std::wstring>> mappings;
+        auto text = DynamicBookFramework::IniParser::ReadFileAsUtf8(iniPath);
+        if (!text) {
+            logger::warn("  -> Could not open '{}'. Skipping.", wstring_to_utf8(iniPath.wstring()));
+            return mappings;
+        }
+        for (const auto& [key, value] : DynamicBookFramework::IniParser::CollectSection(*text, "Books")) {
+            std::filesystem::path fullTxtPath = kBooksFolder / string_to_wstring(value);
+            mappings.emplace_back(string_to_wstring(key), fullTxtPath.wstring());
+        }
+        return mappings;
+    }
+}
+
+// Reads all book mappings from the INI files into g_dynamicBooks
+void LoadBookMappings(DynamicBookFramework::BookMappingCache::ScanMode scanMode)
 {
     g_dynamicBooks.clear(); 
 
     // 1. Set the top-level folder you want to search.
-    std::filesystem::path searchPath = "Data/SKSE/Plugins/DynamicBookFramework";
+    const std::filesystem::path& searchPath = kMappingFolder;
 
     if (!std::filesystem::exists(searchPath) || !std::filesystem::is_directory(searchPath)) {
         logger::warn("Search path folder not found at '{}'. No dynamic books will be loaded.", searchPath.string());
+        DynamicBookFramework::DynamicBookRegistry::GetSingleton()->Rebuild(g_dynamicBooks);
         return;
     }
 
-    logger::info("Scanning for book mapping files in '{}' and all subfolders...", searchPath.string());
-
-    // 2. Use the 'recursive' iterator to look inside subfolders.
-    for (const auto& entry : std::filesystem::recursive_directory_iterator(searchPath)) {
-        if (entry.is_regular_file() && entry.path().extension() == ".ini") {
-            
-            const std::wstring& iniPath = entry.path().wstring();
-            logger::info("  -> Loading mappings from '{}'", wstring_to_utf8(iniPath));
-
-            constexpr size_t bufferSize = 4096;
-            wchar_t keysBuffer[bufferSize] = { 0 };
-            GetPrivateProfileStringW(L"Books", nullptr, nullptr, keysBuffer, bufferSize, iniPath.c_str());
-
-            // This path for the actual .txt files remains the same.
-            std::filesystem::path booksFolder = "Data/SKSE/Plugins/DynamicBookFramework/books";
-
-            wchar_t* currentKey = keysBuffer;
-            while (*currentKey) {
-                wchar_t valueBuffer[bufferSize] = { 0 };
-                GetPrivateProfileStringW(L"Books", currentKey, nullptr, valueBuffer, bufferSize, iniPath.c_str());
+    // 2. Map the .dbfpak archives first, so any INI mapping of the same title overrides the packed one.
+    for (auto& [title, txtPath] : DynamicBookFramework::BookPakRegistry::Load(searchPath, kBooksFolder)) {
+        g_dynamicBooks[std::move(title)] = std::move(txtPath);
+    }
 
-                if (*valueBuffer) {
-                    std::wstring key(currentKey);
-                    std::filesystem::path fullTxtPath = booksFolder / valueBuffer;
+    // 3. Resolve the INIs through the startup manifest. Only new or edited INIs are parsed again, and by default
+    //    the recursive directory walk is left to VerifyBookMappingListing.
+    auto iniRecords = DynamicBookFramework::BookMappingCache::LoadIniRecords(searchPath, ParseMappingIni, scanMode);
 
-                    g_dynamicBooks[key] = fullTxtPath.wstring();
-                }
-                currentKey += wcslen(currentKey) + 1;
-            }
+    // 4. Later INIs in scan order override earlier ones, exactly like the old per-file loop.
+    for (const auto& ini : iniRecords) {
+        for (const auto& [title, txtPath] : ini.mappings) {
+            g_dynamicBooks[title] = txtPath;
         }
     }
     
@@ -343,7 +394,24 @@ void LoadBookMappings()
     } else {
         logger::info("Finished loading. No dynamic book mappings were found.");
     }
+
+    // Resolve book forms against the new table so the hot paths can look books up by FormID.
+    DynamicBookFramework::DynamicBookRegistry::GetSingleton()->Rebuild(g_dynamicBooks);
 }
+void VerifyBookMappingListing()
+{
+    DynamicBookFramework::WorkerPool::GetSingleton()->Submit([]() {
+        if (!DynamicBookFramework::BookMappingCache::RefreshFromListing(kMappingFolder, ParseMappingIni)) {
+            return;
+        }
+        // g_dynamicBooks belongs to the game thread. The manifest is current now, so the reload parses nothing.
+        SKSE::GetTaskInterface()->AddTask([]() {
+            logger::info("Mapping INIs changed since the last run. Reloading the book mappings.");
+            LoadBookMappings();
+        });
+    }, DynamicBookFramework::WorkerPool::Priority::kLow);
+}
+
 // Returns the path if the title matches one of our dynamic books
 std::optional<std::wstring> GetDynamicBookPathByTitle(const std::wstring& bookTitle)
 {
@@ -0,0 +1,99 @@
+//WorkerPool.cpp
+#include "WorkerPool.h"
+#include "Utility.h"
+#include "PCH.h"
+
+
+namespace DynamicBookFramework {
+
+    WorkerPool* WorkerPool::GetSingleton() {
+        static WorkerPool singleton;
+        return &singleton;
+    }
+
+    void WorkerPool::Start(std::size_t a_threadCount) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_running) {
+            logger::warn("WorkerPool: Start() called, but the pool is already running.");
+            return;
+        }
+        _running = true;
+        a_threadCount = std::max<std::size_t>(a_threadCount, 1);
+        for (std::size_t i = 0; i < a_threadCount; ++i) {
+            _threads.emplace_back(&WorkerPool::WorkerLoop, this);
+        }
+        logger::info("WorkerPool: Started {} worker threads.", a_threadCount);
+    }
+
+    void WorkerPool::Stop() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (!_running) {
+                return;
+            }
+            _running = false;
+            for (auto& queue : _queues) {
+                queue.clear();
+            }
+        }
+        _wake.notify_all();
+        for (auto& thread : _threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        _threads.clear();
+    }
+
+    void WorkerPool::Submit(std::function<void()> a_task, Priority a_priority) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            if (_running) {
+                _queues[static_cast<std::size_t>(a_priority)].push_back(std::move(a_task));
+                _wake.notify_one();
+                return;
+            }
+        }
+        a_task();
+    }
+
+    std::size_t WorkerPool::GetQueuedCount() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::size_t count = 0;
+        for (const auto& queue : _queues) {
+            count += queue.size();
+        }
+        return count;
+    }
+
+    void WorkerPool::WorkerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _wake.wait(lock, [this]() {
+                    return !_running || std::any_of(_queues.begin(), _queues.end(), [](const auto& queue) { return !queue.empty(); });
+                });
+                if (!_running) {
+                    return;
+                }
+                for (auto& queue : _queues) {
+                    if (!queue.empty()) {
+                        task = std::move(queue.front());
+                        queue.pop_front();
+                        break;
+                    }
+                }
+            }
+
+            try {
+                task();
+            } catch (const std::exception& e) {
+                logger::error("WorkerPool: Task threw an exception: {}", e.what());
+            } catch (...) {
+                logger::error("WorkerPool: Task threw an unknown exception.");
+            }
+        }
+    }
+
+} // namespace DynamicBookFramework
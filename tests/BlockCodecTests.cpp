@@ -0,0 +1,97 @@
+//BlockCodecTests.cpp
+#include "BlockCodec.h"
+#include "TestSupport.h"
+#include "benchmarks/Journal.h"
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    void TestRoundTrip() {
+        std::mt19937 rng(7);
+        for (std::size_t size : { 0, 1, 2, 3, 4, 5, 75, 76, 77, 1000, 5000, 100000 }) {
+            std::string content;
+            for (std::size_t i = 0; i < size; ++i) {
+                content.push_back("abc de\nfg"[rng() % 9]);
+            }
+            std::string encoded = BlockCodec::Encode(content);
+            auto decoded = BlockCodec::Decode(encoded, content.size());
+            CHECK(decoded && *decoded == content);
+            for (std::size_t pos = 0; pos < encoded.size();) {
+                std::size_t lineEnd = encoded.find('\n', pos);
+                CHECK(lineEnd != std::string::npos && lineEnd - pos <= 76);
+                pos = lineEnd + 1;
+            }
+            if (size > 0) {
+                CHECK(!BlockCodec::Decode(encoded, content.size() + 1));
+            }
+        }
+    }
+
+    void TestCorruptInput() {
+        std::mt19937 rng(11);
+        for (int i = 0; i < 20000; ++i) {
+            std::string garbage;
+            for (std::size_t j = rng() % 200; j > 0; --j) {
+                garbage.push_back("ABCxyz019+/=\n\r!"[rng() % 16]);
+            }
+            (void)BlockCodec::Decode(garbage, rng() % 5000);
+        }
+        // A size no block this short could expand to is refused before anything is allocated.
+        CHECK(!BlockCodec::Decode("QUJD\n", std::size_t(1) << 40));
+        CHECK(!BlockCodec::Decode("QU=D\n", 3));
+    }
+
+    void TestRawSize() {
+        CHECK(BlockCodec::GetRawSize(";;SAVE_BLOCK ID=\"a\" LZ4=\"12\";;") == 12u);
+        CHECK(!BlockCodec::GetRawSize(";;SAVE_BLOCK ID=\"a\" LZ4=\"12x\";;"));
+        CHECK(!BlockCodec::GetRawSize(";;SAVE_BLOCK ID=\"a\" LZ4=\"\";;"));
+        CHECK(!BlockCodec::GetRawSize(";;SAVE_BLOCK ID=\"a\";;"));
+    }
+
+    void TestPlan() {
+        // "b" was overwritten after "x"; its last record places it.
+        std::vector<SaveCompactor::HistoryRecord> history = {
+            { "a", "T1", "" }, { "b", "T1", "a" }, { "c", "T1", "b" }, { "x", "T2", "a" }, { "b", "T1", "a" }, { "y", "T2", "x" }
+        };
+        auto plan = BlockCodec::PlanEncoding(history, true, 2);
+        CHECK(plan.compress == std::unordered_set<std::string>({ "a" }));
+        CHECK(plan.expand == std::unordered_set<std::string>({ "b", "c", "x", "y" }));
+        auto plain = BlockCodec::PlanEncoding(history, false, 2);
+        CHECK(plain.compress.empty() && plain.expand.size() == 5);
+    }
+
+    void TestRecodeBook() {
+        auto journal = Tests::MakeJournal(3, 40, 4000);
+        auto plan = BlockCodec::PlanEncoding(journal.records, true, 10);
+        auto packed = BlockCodec::RecodeBook(journal.book, plan);
+        CHECK(packed.blocksCompressed == 3 * 30);
+        CHECK(packed.text.size() < journal.book.size());
+
+        auto again = BlockCodec::RecodeBook(packed.text, plan);
+        CHECK(again.blocksCompressed == 0 && again.blocksExpanded == 0 && again.text == packed.text);
+
+        // Expanding restores the file byte for byte, CRLF line ends included.
+        auto expanded = BlockCodec::RecodeBook(packed.text, BlockCodec::PlanEncoding(journal.records, false, 0));
+        CHECK(expanded.blocksExpanded == packed.blocksCompressed);
+        CHECK(expanded.text == journal.book);
+
+        // A damaged block is counted and left as it is.
+        std::string damaged = packed.text;
+        std::size_t body = damaged.find("LZ4=\"");
+        body = damaged.find('\n', body) + 1;
+        damaged[body] = '!';
+        auto recovered = BlockCodec::RecodeBook(damaged, BlockCodec::PlanEncoding(journal.records, false, 0));
+        CHECK(recovered.blocksCorrupt == 1);
+        CHECK(recovered.blocksExpanded == packed.blocksCompressed - 1);
+    }
+}
+
+int main() {
+    Tests::Run("RoundTrip", TestRoundTrip);
+    Tests::Run("CorruptInput", TestCorruptInput);
+    Tests::Run("RawSize", TestRawSize);
+    Tests::Run("Plan", TestPlan);
+    Tests::Run("RecodeBook", TestRecodeBook);
+    return Tests::Finish();
+}
@@ -0,0 +1,114 @@
+//BookFileTests.cpp
+#include "BookFile.h"
+#include "TestSupport.h"
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    void TestReplaceAtomically() {
+        auto folder = Tests::MakeTempFolder("BookFileReplace");
+        auto path = folder / "book.txt";
+        std::string large(3 * 1024 * 1024, 'a');
+        large += "\r\nend";
+        CHECK(BookFile::ReplaceAtomically(path, large));
+        CHECK(Tests::ReadFile(path) == large);
+        CHECK(BookFile::ReplaceAtomically(path, "short"));
+        CHECK(Tests::ReadFile(path) == "short");
+        CHECK(BookFile::ReplaceAtomically(path, ""));
+        CHECK(std::filesystem::exists(path) && Tests::ReadFile(path).empty());
+
+        auto tempPath = path;
+        tempPath += ".tmp";
+        CHECK(!std::filesystem::exists(tempPath));
+
+        // A write that cannot start leaves nothing behind.
+        CHECK(!BookFile::ReplaceAtomically(folder / "missing" / "book.txt", "text"));
+        CHECK(!std::filesystem::exists(folder / "missing"));
+    }
+
+    void TestSave() {
+        auto folder = Tests::MakeTempFolder("BookFileSave");
+        auto path = folder / "book.txt";
+        std::string first = "Day 1\nIt rained.\n";
+        CHECK(BookFile::Save(path, "", first) == BookFile::WriteMode::kReplaced);
+        CHECK(Tests::ReadFile(path) == first);
+        CHECK(BookFile::Save(path, first, first) == BookFile::WriteMode::kUnchanged);
+
+        // Edits that are not pure appends go through the temporary file.
+        std::string second = first + "Day 2\nSunny.\n";
+        CHECK(BookFile::Save(path, first, second) == BookFile::WriteMode::kAppended);
+        CHECK(Tests::ReadFile(path) == second);
+        std::string third = "Day 0\n" + second.substr(0, 10);
+        CHECK(BookFile::Save(path, second, third) == BookFile::WriteMode::kReplaced);
+        CHECK(Tests::ReadFile(path) == third);
+
+        // Edited outside the editor since it was loaded: the same buffer is written back rather than skipped.
+        Tests::WriteFile(path, "changed elsewhere");
+        CHECK(BookFile::Save(path, third, third) == BookFile::WriteMode::kReplaced);
+        CHECK(Tests::ReadFile(path) == third);
+
+        CHECK(BookFile::Save(folder / "missing" / "book.txt", "", "text") == BookFile::WriteMode::kFailed);
+        CHECK(std::string_view(BookFile::GetWriteModeName(BookFile::WriteMode::kReplaced)) == "replaced");
+    }
+
+    void TestSaveAppend() {
+        auto folder = Tests::MakeTempFolder("BookFileAppend");
+        auto path = folder / "book.txt";
+        std::string text(200000, 'x');
+        CHECK(BookFile::Save(path, "", text) == BookFile::WriteMode::kReplaced);
+        auto tempPath = path;
+        tempPath += ".tmp";
+
+        for (int day = 1; day <= 20; ++day) {
+            std::string next = text + "\nDay " + std::to_string(day) + "\n";
+            CHECK(BookFile::Save(path, text, next) == BookFile::WriteMode::kAppended);
+            text = std::move(next);
+        }
+        CHECK(Tests::ReadFile(path) == text);
+        CHECK(!std::filesystem::exists(tempPath));
+
+        // Changed on disk since the caller read it: appending would splice onto the wrong text.
+        std::string edited = text;
+        edited.back() = '!';
+        Tests::WriteFile(path, edited);
+        CHECK(BookFile::Save(path, text, text + "more") == BookFile::WriteMode::kReplaced);
+        CHECK(Tests::ReadFile(path) == text + "more");
+
+        // Same length, but differing near the end the append would follow.
+        edited = text + "more";
+        edited[edited.size() - 2] = '?';
+        Tests::WriteFile(path, edited);
+        CHECK(BookFile::Save(path, text + "more", text + "more and more") == BookFile::WriteMode::kReplaced);
+        CHECK(Tests::ReadFile(path) == text + "more and more");
+
+        // A file that is gone is created again rather than appended to.
+        std::filesystem::remove(path);
+        CHECK(BookFile::Save(path, text, text + "again") == BookFile::WriteMode::kReplaced);
+        CHECK(Tests::ReadFile(path) == text + "again");
+        CHECK(std::string_view(BookFile::GetWriteModeName(BookFile::WriteMode::kAppended)) == "appended");
+    }
+
+    void TestMoveDurably() {
+        auto folder = Tests::MakeTempFolder("BookFileMove");
+        CHECK(BookFile::WriteDurably(folder / "a.txt", "first"));
+        CHECK(BookFile::WriteDurably(folder / "b.txt", "second"));
+        CHECK(BookFile::MoveDurably(folder / "a.txt", folder / "b.txt"));
+        CHECK(!std::filesystem::exists(folder / "a.txt") && Tests::ReadFile(folder / "b.txt") == "first");
+
+        // Folders move whole, as SegmentStore::Split moves its staged segments into place.
+        std::filesystem::create_directories(folder / "staging");
+        CHECK(BookFile::WriteDurably(folder / "staging" / "segment.txt", "blocks"));
+        CHECK(BookFile::MoveDurably(folder / "staging", folder / "segments"));
+        CHECK(Tests::ReadFile(folder / "segments" / "segment.txt") == "blocks");
+        CHECK(!BookFile::WriteDurably(folder / "missing" / "c.txt", "text"));
+    }
+}
+
+int main() {
+    Tests::Run("ReplaceAtomically", TestReplaceAtomically);
+    Tests::Run("Save", TestSave);
+    Tests::Run("SaveAppend", TestSaveAppend);
+    Tests::Run("MoveDurably", TestMoveDurably);
+    return Tests::Finish();
+}
@@ -0,0 +1,148 @@
+//BookPakTests.cpp
+#include "BookPak.h"
+#include "Lz4.h"
+#include "TestSupport.h"
+
+#include <cstring>
+#include <random>
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    std::string MakeText(std::mt19937& a_rng, std::size_t a_size) {
+        static constexpr std::string_view kWords[] = { "the ", "dragon ", "of ", "Whiterun ", "journal ", "entry ", "\n" };
+        std::string text;
+        while (text.size() < a_size) {
+            text += kWords[a_rng() % std::size(kWords)];
+        }
+        text.resize(a_size);
+        return text;
+    }
+
+    void TestLz4RoundTrip() {
+        std::mt19937 rng(7);
+        for (int i = 0; i < 2000; ++i) {
+            std::size_t size = rng() % 5000;
+            std::string input(size, '\0');
+            int alphabet = 1 + static_cast<int>(rng() % 20);
+            for (auto& c : input) {
+                c = static_cast<char>('a' + rng() % alphabet);
+            }
+            auto packed = Lz4::Compress(input);
+            std::string output;
+            CHECK(Lz4::Decompress(packed, input.size(), output) && output == input);
+            CHECK(packed.size() <= Lz4::GetMaxCompressedSize(size));
+            CHECK(input.size() <= Lz4::GetMaxDecompressedSize(packed.size()));
+
+            // Corrupt blocks fail cleanly (run under a sanitizer to catch overruns).
+            std::string corrupt = packed;
+            for (int flips = 0; flips < 3 && !corrupt.empty(); ++flips) {
+                corrupt[rng() % corrupt.size()] ^= static_cast<char>(1 << (rng() % 8));
+            }
+            Lz4::Decompress(corrupt, input.size(), output);
+        }
+    }
+
+    void TestLz4RejectsImpossibleSizes() {
+        auto packed = Lz4::Compress(std::string(1000, 'a'));
+        std::string output;
+        CHECK(!Lz4::Decompress(packed, std::size_t(1) << 60, output));
+        CHECK(!Lz4::Decompress(packed, Lz4::GetMaxDecompressedSize(packed.size()) + 1, output));
+        CHECK(!Lz4::Decompress(packed, 999, output));
+        CHECK(!Lz4::Decompress({}, 0, output));
+    }
+
+    // The archive file with one index field overwritten.
+    template <class T>
+    void PatchEntryField(const std::filesystem::path& a_path, const BookPak::Entry& a_entry, std::size_t a_fieldOffset, T a_value) {
+        std::string bytes = Tests::ReadFile(a_path);
+        std::uint64_t indexOffset = 0;
+        std::memcpy(&indexOffset, bytes.data() + 16, sizeof(indexOffset));
+        std::size_t pos = static_cast<std::size_t>(indexOffset) + 2 + a_entry.title.size() + 2 + a_entry.fileName.size() + a_fieldOffset;
+        std::memcpy(bytes.data() + pos, &a_value, sizeof(a_value));
+        Tests::WriteFile(a_path, bytes);
+    }
+
+    void TestArchive() {
+        auto folder = Tests::MakeTempFolder("BookPakArchive");
+        std::mt19937 rng(11);
+        std::vector<BookPak::SourceEntry> sources = {
+            { "Journal", "journal.txt", MakeText(rng, 50000) },
+            { "Random", "random.txt", std::string() },
+            { "Journal", "shadowed.txt", "never read" },
+        };
+        for (int i = 0; i < 64; ++i) {
+            sources[1].content.push_back(static_cast<char>(rng()));
+        }
+        auto path = folder / "books.dbfpak";
+        std::string error;
+        auto stats = BookPak::Write(path, sources, true, error);
+        CHECK(stats && stats->entries == 3 && stats->compressedEntries >= 1);
+
+        auto archive = BookPak::Archive::Open(path, error);
+        CHECK(archive);
+        if (!archive) {
+            return;
+        }
+        const auto* journal = archive->Find("Journal");
+        CHECK(journal && journal->fileName == "journal.txt" && journal->codec == BookPak::Codec::kLz4);
+        CHECK(journal && archive->Read(*journal) == sources[0].content);
+        const auto* random = archive->Find("Random");
+        CHECK(random && random->codec == BookPak::Codec::kStored && archive->Read(*random) == sources[1].content);
+        CHECK(!archive->Find("journal"));
+    }
+
+    void TestCorruptArchives() {
+        auto folder = Tests::MakeTempFolder("BookPakCorrupt");
+        std::mt19937 rng(13);
+        std::vector<BookPak::SourceEntry> sources = { { "Journal", "journal.txt", MakeText(rng, 20000) } };
+        auto path = folder / "books.dbfpak";
+        std::string error;
+        CHECK(BookPak::Write(path, sources, true, error));
+        BookPak::Entry entry;
+        {
+            auto archive = BookPak::Archive::Open(path, error);
+            CHECK(archive);
+            if (!archive) {
+                return;
+            }
+            entry = archive->GetEntries().front();
+        }
+        const std::string original = Tests::ReadFile(path);
+        constexpr std::size_t kStoredSizeField = 8;
+        constexpr std::size_t kRawSizeField = 16;
+
+        // A raw size no stored block can expand to, or beyond the absolute limit, is refused at open.
+        PatchEntryField(path, entry, kRawSizeField, std::uint64_t(Lz4::GetMaxDecompressedSize(entry.storedSize) + 1));
+        CHECK(!BookPak::Archive::Open(path, error) && error.find("inconsistent sizes") != std::string::npos);
+        Tests::WriteFile(path, original);
+        PatchEntryField(path, entry, kRawSizeField, std::uint64_t(1) << 60);
+        CHECK(!BookPak::Archive::Open(path, error) && error.find("larger than") != std::string::npos);
+
+        // A plausible but wrong raw size opens, and the entry then fails to read instead of throwing.
+        Tests::WriteFile(path, original);
+        PatchEntryField(path, entry, kRawSizeField, entry.rawSize + 1);
+        auto archive = BookPak::Archive::Open(path, error);
+        CHECK(archive && !archive->Read(archive->GetEntries().front()));
+        archive.reset();
+
+        Tests::WriteFile(path, original);
+        PatchEntryField(path, entry, kStoredSizeField, std::uint64_t(1) << 40);
+        CHECK(!BookPak::Archive::Open(path, error));
+
+        Tests::WriteFile(path, original.substr(0, original.size() - 3));
+        CHECK(!BookPak::Archive::Open(path, error));
+        Tests::WriteFile(path, "DBFPAK");
+        CHECK(!BookPak::Archive::Open(path, error));
+        CHECK(!BookPak::Archive::Open(folder / "missing.dbfpak", error));
+    }
+}
+
+int main() {
+    Tests::Run("Lz4RoundTrip", TestLz4RoundTrip);
+    Tests::Run("Lz4RejectsImpossibleSizes", TestLz4RejectsImpossibleSizes);
+    Tests::Run("Archive", TestArchive);
+    Tests::Run("CorruptArchives", TestCorruptArchives);
+    return Tests::Finish();
+}
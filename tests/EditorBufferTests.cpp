@@ -0,0 +1,82 @@
+//EditorBufferTests.cpp
+#include "EditorBuffer.h"
+#include "TestSupport.h"
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    std::string MakeLines(int a_count) {
+        std::string text;
+        for (int i = 0; i < a_count; ++i) {
+            text += "line " + std::to_string(i) + " xxxxxxxxxxxx\n";
+        }
+        return text;
+    }
+
+    void TestSmallBook() {
+        EditorBuffer buffer;
+        buffer.Assign("small");
+        CHECK(!buffer.IsPaged());
+        CHECK(buffer.GetEditText() == "small");
+        auto revision = buffer.GetRevision();
+        buffer.GetEditText() += " book";
+        buffer.MarkEdited();
+        CHECK(buffer.GetRevision() != revision);
+        CHECK(buffer.GetText() == "small book");
+        CHECK(buffer.CopyText() == "small book");
+    }
+
+    void TestPaging() {
+        std::string text = MakeLines(20000);
+        EditorBuffer buffer;
+        buffer.Assign(text);
+        CHECK(buffer.IsPaged());
+        CHECK(buffer.GetLineCount() == 20001); // The empty line after the last line break
+        CHECK(buffer.GetLine(5) == "line 5 xxxxxxxxxxxx");
+        CHECK(buffer.GetPageStart() == 0 && buffer.GetPageEnd() == EditorBuffer::kPageLines);
+
+        buffer.SetPageStart(1000);
+        CHECK(buffer.GetEditText().starts_with("line 1000 "));
+        buffer.GetEditText().insert(0, "NEW\nNEW2\n");
+        buffer.MarkEdited();
+        CHECK(buffer.GetSize() == text.size() + 9);
+        // The uncommitted page is part of the copy, and copying leaves it open.
+        CHECK(buffer.CopyText().size() == text.size() + 9);
+        CHECK(buffer.GetEditText().starts_with("NEW\n"));
+
+        buffer.CommitPage();
+        CHECK(buffer.GetLineCount() == 20003);
+        CHECK(buffer.GetLine(1000) == "NEW");
+        CHECK(buffer.GetLine(1002) == "line 1000 xxxxxxxxxxxx");
+        CHECK(buffer.GetText().size() == text.size() + 9);
+
+        buffer.SetPageStart(99999);
+        CHECK(buffer.GetPageStart() == 20002);
+        CHECK(buffer.GetEditText().empty());
+    }
+
+    void TestPageEditsSurviveMoves() {
+        EditorBuffer buffer;
+        buffer.Assign(MakeLines(20000));
+        buffer.SetPageStart(500);
+        buffer.GetEditText().replace(0, buffer.GetEditText().find('\n'), "edited");
+        buffer.MarkEdited();
+        // Moving the page commits the edit first.
+        buffer.SetPageStart(0);
+        CHECK(buffer.GetLine(500) == "edited");
+        CHECK(buffer.GetLine(501) == "line 501 xxxxxxxxxxxx");
+        CHECK(buffer.GetLineCount() == 20001);
+
+        buffer.Clear();
+        CHECK(!buffer.IsPaged());
+        CHECK(buffer.GetSize() == 0);
+    }
+}
+
+int main() {
+    Tests::Run("SmallBook", TestSmallBook);
+    Tests::Run("Paging", TestPaging);
+    Tests::Run("PageEditsSurviveMoves", TestPageEditsSurviveMoves);
+    return Tests::Finish();
+}
@@ -0,0 +1,92 @@
+//ImageHeaderTests.cpp
+#include "ImageHeader.h"
+#include "TestSupport.h"
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for header builders and the test cases
+
+    void PutU32(std::string& a_out, std::uint32_t a_value, bool a_bigEndian) {
+        for (int i = 0; i < 4; ++i) {
+            int shift = a_bigEndian ? 24 - 8 * i : 8 * i;
+            a_out.push_back(static_cast<char>((a_value >> shift) & 0xFF));
+        }
+    }
+
+    std::string MakePng(std::uint32_t a_width, std::uint32_t a_height) {
+        std::string header("\x89PNG\r\n\x1a\n", 8);
+        PutU32(header, 13, true);
+        header += "IHDR";
+        PutU32(header, a_width, true);
+        PutU32(header, a_height, true);
+        header += std::string("\x08\x06\x00\x00\x00", 5); // Rest of IHDR: depth, colour type, ...
+        return header;
+    }
+
+    std::string MakeDds(std::uint32_t a_width, std::uint32_t a_height, std::uint32_t a_headerSize = 124) {
+        std::string header = "DDS ";
+        PutU32(header, a_headerSize, false);
+        PutU32(header, 0x1007, false); // dwFlags
+        PutU32(header, a_height, false);
+        PutU32(header, a_width, false);
+        header.resize(4 + 124, '\0');
+        return header;
+    }
+
+    bool IsSize(const std::optional<ImageInfo::ImageSize>& a_size, std::uint32_t a_width, std::uint32_t a_height) {
+        return a_size && a_size->width == a_width && a_size->height == a_height;
+    }
+
+    void TestPng() {
+        CHECK(IsSize(ImageInfo::ParseHeader(MakePng(640, 480)), 640, 480));
+        CHECK(IsSize(ImageInfo::ParseHeader(MakePng(70000, 1).substr(0, ImageInfo::kHeaderProbeBytes)), 70000, 1));
+        CHECK(!ImageInfo::ParseHeader(MakePng(640, 480).substr(0, ImageInfo::kHeaderProbeBytes - 1)));
+        CHECK(!ImageInfo::ParseHeader(MakePng(0, 480)));
+        CHECK(!ImageInfo::ParseHeader(MakePng(640, 0)));
+
+        std::string badSignature = MakePng(640, 480);
+        badSignature[1] = 'Q';
+        CHECK(!ImageInfo::ParseHeader(badSignature));
+        // The first chunk of a PNG must be IHDR; anything else means the file is not one we can size.
+        std::string otherChunk = MakePng(640, 480);
+        otherChunk.replace(12, 4, "IDAT");
+        CHECK(!ImageInfo::ParseHeader(otherChunk));
+    }
+
+    void TestDds() {
+        CHECK(IsSize(ImageInfo::ParseHeader(MakeDds(1024, 256)), 1024, 256));
+        CHECK(IsSize(ImageInfo::ParseHeader(MakeDds(1024, 256).substr(0, ImageInfo::kHeaderProbeBytes)), 1024, 256));
+        CHECK(IsSize(ImageInfo::ParseHeader(MakeDds(1024, 256).substr(0, 20)), 1024, 256));
+        CHECK(!ImageInfo::ParseHeader(MakeDds(1024, 256).substr(0, 19)));
+        CHECK(!ImageInfo::ParseHeader(MakeDds(0, 256)));
+        CHECK(!ImageInfo::ParseHeader(MakeDds(1024, 0)));
+        CHECK(!ImageInfo::ParseHeader(MakeDds(1024, 256, 128)));
+        CHECK(!ImageInfo::ParseHeader("DDX " + MakeDds(1024, 256).substr(4)));
+    }
+
+    void TestOtherInput() {
+        CHECK(!ImageInfo::ParseHeader(""));
+        CHECK(!ImageInfo::ParseHeader("GIF89a\x10\x00\x10\x00 some more bytes here"));
+        CHECK(!ImageInfo::ParseHeader(std::string(ImageInfo::kHeaderProbeBytes, '\0')));
+    }
+
+    void TestReadHeader() {
+        auto folder = Tests::MakeTempFolder("ImageHeader");
+        Tests::WriteFile(folder / "cover.png", MakePng(300, 200));
+        Tests::WriteFile(folder / "short.png", MakePng(300, 200).substr(0, 10));
+
+        std::string header = ImageInfo::ReadHeader(folder / "cover.png");
+        CHECK(header.size() == ImageInfo::kHeaderProbeBytes);
+        CHECK(IsSize(ImageInfo::ParseHeader(header), 300, 200));
+        CHECK(ImageInfo::ReadHeader(folder / "short.png").size() == 10);
+        CHECK(ImageInfo::ReadHeader(folder / "missing.png").empty());
+    }
+}
+
+int main() {
+    Tests::Run("Png", TestPng);
+    Tests::Run("Dds", TestDds);
+    Tests::Run("OtherInput", TestOtherInput);
+    Tests::Run("ReadHeader", TestReadHeader);
+    return Tests::Finish();
+}
@@ -0,0 +1,182 @@
+//IncrementalFormatterTests.cpp
+#include "IncrementalFormatter.h"
+#include "PreviewLayout.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <random>
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the stand-in markup and the test cases
+
+    void FlushParagraph(std::string& a_out, std::string& a_paragraph) {
+        std::size_t start = a_paragraph.find_first_not_of('\n');
+        if (start != std::string::npos) {
+            std::string content = a_paragraph.substr(start, a_paragraph.find_last_not_of('\n') - start + 1);
+            for (std::size_t pos = 0; (pos = content.find('\n', pos)) != std::string::npos; pos += 4) {
+                content.replace(pos, 1, "<br>");
+            }
+            a_out += "<p>" + content + "</p>\n";
+        }
+        a_paragraph.clear();
+    }
+
+    // A reduced ApplyGeneralBookMarkup_ProcessChunk with the same state: open paragraphs and lists, and
+    // two blank lines before text becoming a page break.
+    std::string FormatMarkup(const std::string& a_text) {
+        std::string out;
+        std::string paragraph;
+        int blankLines = 0;
+        bool inList = false;
+        std::size_t pos = 0;
+        while (pos < a_text.size()) {
+            std::size_t lineEnd = a_text.find('\n', pos);
+            lineEnd = lineEnd == std::string::npos ? a_text.size() : lineEnd;
+            std::string line = a_text.substr(pos, lineEnd - pos);
+            pos = lineEnd + 1;
+            if (line.starts_with("*")) {
+                if (!inList) {
+                    FlushParagraph(out, paragraph);
+                    out += "<ul>\n";
+                    inList = true;
+                }
+                out += "<li>" + line.substr(1) + "</li>\n";
+                blankLines = 0;
+                continue;
+            }
+            if (inList) {
+                out += "</ul>\n";
+                inList = false;
+            }
+            if (line.empty()) {
+                FlushParagraph(out, paragraph);
+                ++blankLines;
+            } else {
+                if (blankLines >= 2) {
+                    out += "<p>[pagebreak]</p>\n";
+                }
+                blankLines = 0;
+                paragraph += paragraph.empty() ? line : "\n" + line;
+            }
+        }
+        if (inList) {
+            out += "</ul>\n";
+        }
+        FlushParagraph(out, paragraph);
+        return out;
+    }
+
+    std::string MakeBook(std::mt19937& a_rng, int a_lines) {
+        const char* kinds[] = { "", "", "* item", "text line", "more words here" };
+        std::string text;
+        for (int i = 0; i < a_lines; ++i) {
+            text += kinds[a_rng() % 5];
+            if (a_rng() % 3 == 0) {
+                text += std::to_string(a_rng());
+            }
+            text += '\n';
+        }
+        return text;
+    }
+
+    void TestMatchesWholeText() {
+        std::mt19937 rng(1);
+        std::string text = MakeBook(rng, 20000);
+        IncrementalFormatter formatter(FormatMarkup);
+        auto result = formatter.Format(text);
+        CHECK(result.html == FormatMarkup(text));
+        CHECK(result.segments > 10);
+        CHECK(result.formattedSegments == result.segments);
+        CHECK(result.segmentKeys.size() == result.segments);
+        CHECK(!result.segmentEnds.empty() && result.segmentEnds.back() == result.html.size());
+
+        for (int edit = 0; edit < 50; ++edit) {
+            text.insert(rng() % text.size(), rng() % 2 ? "\n" : "x");
+            auto edited = formatter.Format(text);
+            CHECK(edited.html == FormatMarkup(text));
+            // One edit touches the segment it falls in, and at most its neighbours when it moves a cut.
+            CHECK(edited.formattedSegments <= 3);
+        }
+    }
+
+    void TestSplit() {
+        CHECK(IncrementalFormatter::Split("").empty());
+        std::string text;
+        while (text.size() < 4 * IncrementalFormatter::kMaxSegmentBytes) {
+            text += "a line of text\n";
+        }
+        text += "\nthe end\n";
+        auto segments = IncrementalFormatter::Split(text);
+        std::string joined;
+        for (auto segment : segments) {
+            joined += segment;
+        }
+        CHECK(joined == text);
+        // There is only one blank-line run to cut at, however long the text before it.
+        CHECK(segments.size() == 2);
+    }
+
+    void TestSegmentKeysSurviveEdits() {
+        std::mt19937 rng(2);
+        std::string text = MakeBook(rng, 5000);
+        IncrementalFormatter formatter(FormatMarkup);
+        auto before = formatter.Format(text);
+        text.insert(text.size() / 2, "x");
+        auto after = formatter.Format(text);
+        std::size_t shared = 0;
+        for (auto key : after.segmentKeys) {
+            shared += std::ranges::count(before.segmentKeys, key) > 0;
+        }
+        CHECK(shared + 3 >= after.segmentKeys.size());
+    }
+
+    void TestLayoutOffsets() {
+        PreviewLayout layout;
+        layout.Assign({ 1, 1, 1, 2, 2 }, 400.0f, [](std::size_t a_block) { return 10.0f * static_cast<float>(a_block + 1); });
+        CHECK(layout.GetOffset(0) == 0.0f);
+        CHECK(layout.GetOffset(3) == 60.0f);
+        CHECK(layout.GetTotalHeight() == 150.0f);
+        CHECK((layout.GetVisibleRange(0.0f, 10.0f) == std::pair<std::size_t, std::size_t>{ 0, 1 }));
+        CHECK((layout.GetVisibleRange(15.0f, 65.0f) == std::pair<std::size_t, std::size_t>{ 1, 4 }));
+        CHECK((layout.GetVisibleRange(140.0f, 500.0f) == std::pair<std::size_t, std::size_t>{ 4, 5 }));
+        CHECK(layout.GetVisibleRange(200.0f, 300.0f).first == layout.GetVisibleRange(200.0f, 300.0f).second);
+
+        // A drawn block that turned out taller moves everything below it.
+        layout.SetMeasuredHeight(1, 120.0f);
+        CHECK(layout.GetOffset(2) == 130.0f);
+        CHECK(layout.GetTotalHeight() == 250.0f);
+
+        PreviewLayout empty;
+        empty.Assign({}, 400.0f, [](std::size_t) { return 1.0f; });
+        CHECK(empty.GetTotalHeight() == 0.0f);
+        CHECK((empty.GetVisibleRange(0.0f, 100.0f) == std::pair<std::size_t, std::size_t>{ 0, 0 }));
+    }
+
+    void TestLayoutReusesSegments() {
+        PreviewLayout layout;
+        auto estimate = [](std::size_t) { return 10.0f; };
+        layout.Assign({ 1, 1, 2, 3 }, 400.0f, estimate);
+        for (std::size_t i = 0; i < 4; ++i) {
+            layout.SetMeasuredHeight(i, 50.0f);
+        }
+
+        // Segment 2 was edited into segment 4; the unchanged segments keep their measured heights.
+        layout.Assign({ 1, 1, 4, 4, 3 }, 400.0f, estimate);
+        CHECK(layout.GetOffset(2) == 100.0f);
+        CHECK(layout.GetTotalHeight() == 100.0f + 10.0f + 10.0f + 50.0f);
+
+        // Heights measured at another wrap width no longer apply.
+        layout.Assign({ 1, 1, 4, 4, 3 }, 300.0f, estimate);
+        CHECK(layout.GetTotalHeight() == 50.0f);
+    }
+}
+
+int main() {
+    Tests::Run("MatchesWholeText", TestMatchesWholeText);
+    Tests::Run("Split", TestSplit);
+    Tests::Run("SegmentKeysSurviveEdits", TestSegmentKeysSurviveEdits);
+    Tests::Run("LayoutOffsets", TestLayoutOffsets);
+    Tests::Run("LayoutReusesSegments", TestLayoutReusesSegments);
+    return Tests::Finish();
+}
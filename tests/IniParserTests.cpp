@@ -0,0 +1,139 @@
+//IniParserTests.cpp
+#include "IniParser.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace DynamicBookFramework;
+using Entries = std::vector<std::pair<std::string, std::string>>;
+
+namespace { // Anonymous namespace for the test cases
+
+    struct Entry {
+        std::string section;
+        std::string key;
+        std::string value;
+        bool operator==(const Entry&) const = default;
+    };
+
+    std::vector<Entry> ParseAll(std::string_view a_text) {
+        std::vector<Entry> entries;
+        IniParser::Parse(a_text, [&](std::string_view section, std::string_view key, std::string_view value) {
+            entries.push_back({ std::string(section), std::string(key), std::string(value) });
+        });
+        return entries;
+    }
+
+    // UTF-16 code units of an ASCII string, in the given byte order.
+    std::string Utf16(std::string_view a_ascii, bool a_bigEndian) {
+        std::string bytes;
+        for (char c : a_ascii) {
+            bytes += a_bigEndian ? std::string{ '\0', c } : std::string{ c, '\0' };
+        }
+        return bytes;
+    }
+
+    void TestParse() {
+        auto entries = ParseAll(
+            "; comment\r\n"
+            "top = before any section\r\n"
+            "[ Books ]\r\n"
+            "  Title One  =  one.txt  \r\n"
+            "# another comment\r\n"
+            "Quoted = \"spaced name.txt\"\r\n"
+            "Single = 'single.txt'\r\n"
+            "Mismatched = \"half.txt'\r\n"
+            "no equals sign\r\n"
+            " = no key\r\n"
+            "Empty =\r\n"
+            "[Other]\n"
+            "Last=value without newline");
+        std::vector<Entry> expected = {
+            { "", "top", "before any section" },
+            { "Books", "Title One", "one.txt" },
+            { "Books", "Quoted", "spaced name.txt" },
+            { "Books", "Single", "single.txt" },
+            { "Books", "Mismatched", "\"half.txt'" },
+            { "Books", "Empty", "" },
+            { "Other", "Last", "value without newline" },
+        };
+        CHECK(entries == expected);
+    }
+
+    void TestLargeSection() {
+        // GetPrivateProfileStringW truncated the key list at 4096 characters; the parser has no limit.
+        std::string text = "[Books]\n";
+        for (int i = 0; i < 5000; ++i) {
+            text += "A rather long book title number " + std::to_string(i) + "=" + std::string(300, 'x') + std::to_string(i) + ".txt\n";
+        }
+        auto entries = IniParser::CollectSection(text, "Books");
+        CHECK(entries.size() == 5000);
+        CHECK(entries.back().first == "A rather long book title number 4999");
+        CHECK(entries.back().second == std::string(300, 'x') + "4999.txt");
+    }
+
+    void TestCollectSection() {
+        auto entries = IniParser::CollectSection(
+            "[books]\n"
+            "Foo=first.txt\n"
+            "foo=second.txt\n"
+            "FOO=third.txt\n"
+            "Blank=\n"
+            "blank=filled.txt\n"
+            "[Settings]\n"
+            "Bar=ignored.txt\n"
+            "[BOOKS]\n"
+            "Bar=bar.txt\n",
+            "Books");
+        Entries expected = { { "Foo", "first.txt" }, { "blank", "filled.txt" }, { "Bar", "bar.txt" } };
+        CHECK(entries == expected);
+    }
+
+    void TestEncodings() {
+        auto folder = Tests::MakeTempFolder("IniParserEncodings");
+        const std::string text = "[Books]\r\nTitle=book.txt\r\n";
+        auto check = [&](const char* a_name, const std::string& a_bytes, const std::string& a_expected) {
+            auto path = folder / a_name;
+            Tests::WriteFile(path, a_bytes);
+            auto decoded = IniParser::ReadFileAsUtf8(path);
+            CHECK(decoded && *decoded == a_expected);
+        };
+        check("plain.ini", text, text);
+        check("bom.ini", "\xEF\xBB\xBF" + text, text);
+        check("utf16le.ini", "\xFF\xFE" + Utf16(text, false), text);
+        check("utf16be.ini", "\xFE\xFF" + Utf16(text, true), text);
+        check("utf16le-nobom.ini", Utf16(text, false), text);
+        check("utf8.ini", "[Books]\nCaf\xC3\xA9=caf\xC3\xA9.txt\n", "[Books]\nCaf\xC3\xA9=caf\xC3\xA9.txt\n");
+        // A surrogate pair in UTF-16 becomes one four-byte UTF-8 sequence.
+        check("utf16-pair.ini", std::string("\xFF\xFE" "=\xD8\x00\xDE", 6), "\xF0\x9F\x98\x80");
+#ifndef _WIN32
+        // Not UTF-8: read in the ANSI code page, which is Latin-1 here.
+        check("ansi.ini", "[Books]\nCaf\xE9=caf\xE9.txt\n", "[Books]\nCaf\xC3\xA9=caf\xC3\xA9.txt\n");
+        // An overlong encoding is not valid UTF-8 either.
+        check("overlong.ini", "\xC0\xAF", "\xC3\x80\xC2\xAF");
+#endif
+
+        CHECK(!IniParser::ReadFileAsUtf8(folder / "missing.ini"));
+        CHECK(!IniParser::ParseFile(folder / "missing.ini", [](std::string_view, std::string_view, std::string_view) {}));
+        auto empty = folder / "empty.ini";
+        Tests::WriteFile(empty, "");
+        auto decoded = IniParser::ReadFileAsUtf8(empty);
+        CHECK(decoded && decoded->empty());
+    }
+
+    void TestEqualsIgnoreCase() {
+        CHECK(IniParser::EqualsIgnoreCase("Books", "bOOKS"));
+        CHECK(!IniParser::EqualsIgnoreCase("Books", "Book"));
+        CHECK(!IniParser::EqualsIgnoreCase("Books", "Boats"));
+        CHECK(IniParser::EqualsIgnoreCase("", ""));
+    }
+}
+
+int main() {
+    Tests::Run("Parse", TestParse);
+    Tests::Run("LargeSection", TestLargeSection);
+    Tests::Run("CollectSection", TestCollectSection);
+    Tests::Run("Encodings", TestEncodings);
+    Tests::Run("EqualsIgnoreCase", TestEqualsIgnoreCase);
+    return Tests::Finish();
+}
@@ -0,0 +1,87 @@
+//MpscQueueTests.cpp
+#include "MpscQueue.h"
+#include "TestSupport.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    void TestSingleThread() {
+        MpscQueue<std::string> queue;
+        CHECK(!queue.TryPop());
+        queue.Push("first");
+        queue.Push("second");
+        auto first = queue.TryPop();
+        CHECK(first && *first == "first");
+        queue.Push("third");
+        auto second = queue.TryPop();
+        auto third = queue.TryPop();
+        CHECK(second && *second == "second");
+        CHECK(third && *third == "third");
+        CHECK(!queue.TryPop());
+
+        // Items left in the queue are freed with it.
+        auto tracked = std::make_shared<int>(0);
+        {
+            MpscQueue<std::shared_ptr<int>> owning;
+            owning.Push(tracked);
+            owning.Push(tracked);
+        }
+        CHECK(tracked.use_count() == 1);
+    }
+
+    // Many producers push while one consumer drains, as appends from Papyrus, the API and mod events do while a
+    // reader holds the session lock. Every item arrives once, and each producer's items arrive in order.
+    void TestConcurrentProducers() {
+        constexpr int kProducers = 8;
+        constexpr int kItemsPerProducer = 100000;
+        MpscQueue<std::pair<int, int>> queue;
+        std::atomic<bool> start{ false };
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < kProducers; ++producer) {
+            producers.emplace_back([&, producer]() {
+                while (!start.load()) {
+                    std::this_thread::yield();
+                }
+                for (int i = 0; i < kItemsPerProducer; ++i) {
+                    queue.Push({ producer, i });
+                }
+            });
+        }
+        start.store(true);
+
+        std::vector<int> next(kProducers, 0);
+        long received = 0;
+        bool ordered = true;
+        while (received < static_cast<long>(kProducers) * kItemsPerProducer) {
+            auto item = queue.TryPop();
+            if (!item) {
+                std::this_thread::yield();
+                continue;
+            }
+            ordered = ordered && item->second == next[item->first];
+            next[item->first] = item->second + 1;
+            ++received;
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        CHECK(ordered);
+        CHECK(!queue.TryPop());
+        for (int count : next) {
+            CHECK(count == kItemsPerProducer);
+        }
+    }
+}
+
+int main() {
+    Tests::Run("SingleThread", TestSingleThread);
+    Tests::Run("ConcurrentProducers", TestConcurrentProducers);
+    return Tests::Finish();
+}
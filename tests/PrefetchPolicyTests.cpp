@@ -0,0 +1,123 @@
+//PrefetchPolicyTests.cpp
+#include "PrefetchPolicy.h"
+#include "TestSupport.h"
+
+#include <thread>
+#include <vector>
+
+using namespace DynamicBookFramework;
+using namespace std::chrono_literals;
+
+namespace { // Anonymous namespace for the fake event source and the test cases
+
+    // Stands in for Prefetcher: feeds crosshair and inventory events to the policy and keeps the jobs it
+    // reserved until the test finishes them, the way the WorkerPool would.
+    struct FakeEventSource {
+        PrefetchPolicy policy;
+        PrefetchPolicy::Clock::time_point now = PrefetchPolicy::Clock::now();
+        std::size_t cachedBytes = 0;
+        std::unordered_set<std::uint32_t> prepared;
+        std::vector<PrefetchJob> running;
+
+        bool See(std::uint32_t a_formID, PrefetchSource a_source = PrefetchSource::kCrosshair) {
+            auto job = policy.TryBegin(a_formID, a_source, prepared.contains(a_formID), cachedBytes, now);
+            if (job) {
+                running.push_back(*job);
+            }
+            return job.has_value();
+        }
+
+        void FinishAll() {
+            for (const auto& job : running) {
+                policy.OnJobFinished(job);
+            }
+            running.clear();
+        }
+    };
+
+    void TestConcurrencyAndCooldown() {
+        FakeEventSource source;
+        CHECK(source.See(1));
+        CHECK(!source.See(2)); // One job at a time by default
+        CHECK(!source.See(1)); // Already running
+        source.FinishAll();
+        CHECK(source.policy.GetActiveJobCount() == 0);
+
+        CHECK(!source.See(1)); // Glanced at again within the cooldown
+        CHECK(source.See(2));
+        source.FinishAll();
+        source.now += 31s;
+        CHECK(source.See(1));
+        source.FinishAll();
+    }
+
+    void TestFilters() {
+        FakeEventSource source;
+        source.prepared.insert(1);
+        CHECK(!source.See(1));
+
+        source.cachedBytes = source.policy.GetConfig().memoryBudgetBytes;
+        CHECK(!source.See(2));
+        source.cachedBytes = 0;
+
+        PrefetchConfig config;
+        config.inventory = false;
+        config.maxConcurrentJobs = 2;
+        source.policy.SetConfig(config);
+        CHECK(!source.See(3, PrefetchSource::kInventory));
+        CHECK(source.See(3, PrefetchSource::kCrosshair));
+        CHECK(source.See(4, PrefetchSource::kCrosshair));
+        CHECK(source.policy.GetActiveJobCount() == 2);
+    }
+
+    void TestResetIgnoresStaleJobs() {
+        FakeEventSource source;
+        CHECK(source.See(1));
+        auto stale = source.running;
+        source.running.clear();
+
+        // A save is loaded while the job is still running; the same book is seen again in the new session.
+        source.policy.Reset();
+        CHECK(source.policy.GetActiveJobCount() == 0);
+        CHECK(source.See(1));
+
+        // The old job finishing must not release the new one, or a second job could start beside it.
+        source.policy.OnJobFinished(stale.front());
+        CHECK(source.policy.GetActiveJobCount() == 1);
+        CHECK(!source.See(2));
+        source.FinishAll();
+        CHECK(source.policy.GetActiveJobCount() == 0);
+    }
+
+    void TestResetWhileWorkersFinish() {
+        PrefetchConfig config;
+        config.maxConcurrentJobs = 4;
+        config.retryCooldown = 0ms;
+        PrefetchPolicy policy;
+        policy.SetConfig(config);
+
+        std::vector<std::thread> workers;
+        for (std::uint32_t formID = 0; formID < 2000; ++formID) {
+            auto job = policy.TryBegin(formID % 16, PrefetchSource::kInventory, false, 0, PrefetchPolicy::Clock::now());
+            if (job) {
+                workers.emplace_back([&policy, job = *job]() { policy.OnJobFinished(job); });
+            }
+            if (formID % 100 == 0) {
+                policy.Reset();
+            }
+            CHECK(policy.GetActiveJobCount() <= config.maxConcurrentJobs);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        CHECK(policy.GetActiveJobCount() == 0);
+    }
+}
+
+int main() {
+    Tests::Run("ConcurrencyAndCooldown", TestConcurrencyAndCooldown);
+    Tests::Run("Filters", TestFilters);
+    Tests::Run("ResetIgnoresStaleJobs", TestResetIgnoresStaleJobs);
+    Tests::Run("ResetWhileWorkersFinish", TestResetWhileWorkersFinish);
+    return Tests::Finish();
+}
@@ -0,0 +1,88 @@
+//SaveCompactorTests.cpp
+#include "SaveCompactor.h"
+#include "TestSupport.h"
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    // Save1 starts the first timeline; Save2 and Save3 branch from it, and Save4 continues Save3 in a newer
+    // timeline. Old1 belongs to a playthrough nothing reaches any more.
+    constexpr std::string_view kHistory =
+        "ID=\"Save1\" TIMELINE=\"2024-01-01_10-00-00\" PARENT=\"MainMenu\"\n"
+        "ID=\"Save2\" TIMELINE=\"2024-01-01_10-00-00\" PARENT=\"Save1\"\n"
+        "ID=\"Save3\" TIMELINE=\"2024-01-01_10-00-00\" PARENT=\"Save1\"\n"
+        "ID=\"Save4\" TIMELINE=\"2024-02-01_10-00-00\" PARENT=\"Save3\"\n"
+        "ID=\"Old1\" TIMELINE=\"2023-01-01_10-00-00\" PARENT=\"\"\n";
+
+    void TestParse() {
+        auto history = SaveCompactor::ParseHistory(kHistory);
+        CHECK(history.size() == 5);
+        CHECK(history[3].id == "Save4" && history[3].parent == "Save3" && history[3].timeline == "2024-02-01_10-00-00");
+        CHECK(SaveCompactor::ParseValue(";;SAVE_BLOCK ID=\"A\" PARENT=\"B\";;", "PARENT") == "B");
+        CHECK(SaveCompactor::ParseValue(";;SAVE_BLOCK ID=\"A\";;", "PARENT").empty());
+    }
+
+    void TestLiveSaves() {
+        auto history = SaveCompactor::ParseHistory(kHistory);
+        SaveCompactor::RetentionPolicy policy;
+        policy.keepRecentTimelines = 0;
+        auto live = SaveCompactor::FindLiveSaves(history, { "Save2.ess" }, policy);
+        CHECK(live.contains("Save2") && live.contains("Save1") && live.contains("MainMenu"));
+        CHECK(!live.contains("Save3") && !live.contains("Save4") && !live.contains("Old1"));
+
+        // The most recent timeline is kept whole, and with it the saves its blocks descend from.
+        policy.keepRecentTimelines = 1;
+        live = SaveCompactor::FindLiveSaves(history, { "Save2" }, policy);
+        CHECK(live.contains("Save4") && live.contains("Save3"));
+        CHECK(!live.contains("Old1"));
+    }
+
+    void TestCompactBook() {
+        auto history = SaveCompactor::ParseHistory(kHistory);
+        SaveCompactor::RetentionPolicy policy;
+        policy.keepRecentTimelines = 0;
+        auto live = SaveCompactor::FindLiveSaves(history, { "Save2" }, policy);
+
+        std::string book =
+            "Intro\r\n\r\n"
+            ";;SAVE_BLOCK ID=\"Save1\" TIMELINE=\"t\" PARENT=\"MainMenu\";;\r\nA\r\n;;END_SAVE_DATA;;\r\n\r\n"
+            ";;SAVE_BLOCK ID=\"Save3\" TIMELINE=\"t\" PARENT=\"Save1\";;\r\nB\r\n;;END_SAVE_DATA;;\r\n\r\n"
+            ";;SAVE_BLOCK ID=\"Save2\" TIMELINE=\"t\" PARENT=\"Save1\";;\r\nC\r\n;;END_SAVE_DATA;;\r\n"
+            "Tail\n\n;;SAVE_BLOCK ID=\"Old1\";;\nunterminated\n";
+        std::string expected =
+            "Intro\r\n\r\n"
+            ";;SAVE_BLOCK ID=\"Save1\" TIMELINE=\"t\" PARENT=\"MainMenu\";;\r\nA\r\n;;END_SAVE_DATA;;\r\n\r\n"
+            ";;SAVE_BLOCK ID=\"Save2\" TIMELINE=\"t\" PARENT=\"Save1\";;\r\nC\r\n;;END_SAVE_DATA;;\r\n"
+            "Tail\n\n;;SAVE_BLOCK ID=\"Old1\";;\nunterminated\n";
+        auto result = SaveCompactor::CompactBook(book, live);
+        CHECK(result.blocksRemoved == 1);
+        CHECK(result.blocksKept == 2);
+        // The unterminated block is left alone even though its save is not live.
+        CHECK(result.text == expected);
+
+        auto again = SaveCompactor::CompactBook(expected, live);
+        CHECK(again.blocksRemoved == 0);
+    }
+
+    void TestCompactHistory() {
+        auto history = SaveCompactor::ParseHistory(kHistory);
+        SaveCompactor::RetentionPolicy policy;
+        policy.keepRecentTimelines = 0;
+        auto live = SaveCompactor::FindLiveSaves(history, { "Save2" }, policy);
+        std::string compacted;
+        CHECK(SaveCompactor::CompactHistory(std::string(kHistory) + "not a record\n", live, compacted) == 3);
+        CHECK(compacted ==
+              "ID=\"Save1\" TIMELINE=\"2024-01-01_10-00-00\" PARENT=\"MainMenu\"\n"
+              "ID=\"Save2\" TIMELINE=\"2024-01-01_10-00-00\" PARENT=\"Save1\"\n"
+              "not a record\n");
+    }
+}
+
+int main() {
+    Tests::Run("Parse", TestParse);
+    Tests::Run("LiveSaves", TestLiveSaves);
+    Tests::Run("CompactBook", TestCompactBook);
+    Tests::Run("CompactHistory", TestCompactHistory);
+    return Tests::Finish();
+}
@@ -0,0 +1,64 @@
+//SearchIndexTests.cpp
+#include "SearchIndex.h"
+#include "TestSupport.h"
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    constexpr std::string_view kJournal =
+        "Day one.\n<a name='Save1'></a>The Dragon attacked Whiterun.\n[bookmark1]\nWe fled to Riverwood < far away.\n";
+
+    void TestTokenize() {
+        std::vector<std::pair<std::string, std::size_t>> tokens;
+        SearchIndex::Tokenize("<p align='center'>Caf\xC3\xA9 I saw a < b, A2B</p>", 10, [&](std::string_view token, std::size_t offset) {
+            tokens.emplace_back(std::string(token), offset);
+        });
+        // Tags are skipped, single letters dropped, UTF-8 kept whole and offsets shifted by the base.
+        std::vector<std::pair<std::string, std::size_t>> expected = { { "caf\xC3\xA9", 28 }, { "saw", 36 }, { "a2b", 47 } };
+        CHECK(tokens == expected);
+    }
+
+    void TestQuery() {
+        SearchIndex index;
+        index.ReplaceBook("Journal", std::string(kJournal));
+        auto hits = index.Query("dragon", 10);
+        CHECK(hits.size() == 1 && hits[0].bookKey == "Journal" && hits[0].anchor == "Save1");
+        CHECK(hits.size() == 1 && hits[0].snippet.find("Dragon attacked") != std::string::npos);
+        hits = index.Query("river", 10); // The last word matches as a prefix
+        CHECK(hits.size() == 1 && hits[0].anchor == "[bookmark1]");
+        CHECK(index.Query("DRAGON white", 10).size() == 1);
+        CHECK(index.Query("dragon nope", 10).empty());
+        CHECK(index.Query("name", 10).empty()); // Inside markup
+        CHECK(index.Query("far", 10).size() == 1); // After a '<' that does not open a tag
+    }
+
+    void TestUpdates() {
+        SearchIndex index;
+        index.ReplaceBook("Journal", std::string(kJournal));
+        index.ReplaceBook("Other", "Another dragon, far to the north.");
+        auto version = index.GetVersion();
+        index.AppendToBook("Journal", "\nA second dragon appeared.\n");
+        CHECK(index.GetVersion() != version);
+        auto hits = index.Query("dragon", 10);
+        CHECK(hits.size() == 3);
+        CHECK(hits.size() == 3 && hits[0].bookKey == hits[1].bookKey && hits[0].offset < hits[1].offset);
+        CHECK(index.Query("dragon", 2).size() == 2);
+
+        index.ReplaceBook("Journal", "nothing here");
+        CHECK(index.Query("dragon", 10).size() == 1);
+        index.RemoveBook("Other");
+        CHECK(index.Query("dragon", 10).empty());
+        CHECK(index.GetStats().books == 1);
+        index.Clear();
+        CHECK(index.Query("nothing", 10).empty());
+        CHECK(index.GetStats().postings == 0);
+    }
+}
+
+int main() {
+    Tests::Run("Tokenize", TestTokenize);
+    Tests::Run("Query", TestQuery);
+    Tests::Run("Updates", TestUpdates);
+    return Tests::Finish();
+}
@@ -0,0 +1,102 @@
+//SegmentStoreTests.cpp
+#include "SegmentStore.h"
+#include "BlockCodec.h"
+#include "TestSupport.h"
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the test cases
+
+    constexpr std::string_view kTimelineA = "2024-01-01_10-00-00";
+    constexpr std::string_view kTimelineB = "2024-02-01_10-00-00";
+
+    std::string Block(const std::string& a_id, std::string_view a_timeline, const std::string& a_parent, int a_lines, const std::string& a_eol) {
+        std::string block = a_eol + ";;SAVE_BLOCK ID=\"" + a_id + "\" TIMELINE=\"" + std::string(a_timeline) + "\" PARENT=\"" + a_parent + "\";;" + a_eol;
+        for (int i = 0; i < a_lines; ++i) {
+            block += "Entry " + a_id + " line " + std::to_string(i) + " the quick brown fox jumps over the lazy dog" + a_eol;
+        }
+        return block + ";;END_SAVE_DATA;;" + a_eol;
+    }
+
+    // Two characters interleaved in one book, with a block cut off by a crash at the end.
+    void TestRoundTrip(const std::string& a_eol) {
+        auto folder = Tests::MakeTempFolder(a_eol == "\n" ? "SegmentStoreLF" : "SegmentStoreCRLF");
+        auto book = folder / "Journal.txt";
+        const std::string intro = "Title" + a_eol + "Intro line" + a_eol;
+        const std::string tail = "Footer" + a_eol + a_eol + ";;SAVE_BLOCK ID=\"Broken\" TIMELINE=\"x\" PARENT=\"\";;" + a_eol + "partial" + a_eol;
+        std::string text = intro + Block("SaveA1", kTimelineA, "", 3, a_eol) + Block("SaveB1", kTimelineB, "", 2, a_eol) +
+            Block("SaveA2", kTimelineA, "SaveA1", 4, a_eol) + Block("SaveB2", kTimelineB, "SaveB1", 1, a_eol) + tail;
+        Tests::WriteFile(book, text);
+
+        auto split = SegmentStore::Split(book);
+        CHECK(split.ok && split.blocks == 4 && split.segments == 2);
+        CHECK(SegmentStore::IsSegmented(book));
+        CHECK(SegmentStore::ListSegments(book).size() == 2);
+
+        std::vector<SegmentStore::ChainLink> chain = { { "SaveA1", std::string(kTimelineA) }, { "SaveA2", std::string(kTimelineA) } };
+        std::size_t lines = 0;
+        std::string assembled = SegmentStore::Assemble(book, chain, &lines);
+        CHECK(lines == 7);
+        CHECK(assembled.find("<a name='SaveA1'></a>Entry SaveA1 line 0 ") != std::string::npos);
+        CHECK(assembled.find("SaveB1") == std::string::npos);
+        CHECK(assembled.find('\r') == std::string::npos);
+        CHECK(assembled.find("Footer\n") != std::string::npos);
+
+        // A save the history has no timeline for could be in any segment.
+        auto unknown = chain;
+        unknown[0].timeline.clear();
+        CHECK(SegmentStore::Assemble(book, unknown, nullptr) == assembled);
+
+        // A block saved while segmented lands in its timeline and is placed by its history record on merge.
+        std::string appended = Block("SaveA3", kTimelineA, "SaveA2", 2, "\n");
+        CHECK(SegmentStore::AppendBlock(book, kTimelineA, appended));
+        std::unordered_map<std::string, std::vector<std::size_t>> historyOrder = {
+            { "SaveA1", { 0 } }, { "SaveB1", { 1 } }, { "SaveA2", { 2 } }, { "SaveB2", { 3 } }, { "SaveA3", { 4 } }
+        };
+        auto merge = SegmentStore::Merge(book, historyOrder);
+        CHECK(merge.ok && merge.blocks == 5);
+        CHECK(!SegmentStore::IsSegmented(book));
+
+        std::string expected = text;
+        expected.insert(expected.find("Footer"), appended);
+        CHECK(Tests::ReadFile(book) == expected);
+    }
+
+    void TestCompressedSegments() {
+        auto folder = Tests::MakeTempFolder("SegmentStoreCompressed");
+        auto plainBook = folder / "Plain.txt";
+        auto packedBook = folder / "Packed.txt";
+        std::string text = "Title\n";
+        std::vector<SaveCompactor::HistoryRecord> history;
+        std::vector<SegmentStore::ChainLink> chain;
+        std::string parent;
+        for (int save = 0; save < 20; ++save) {
+            std::string id = "Save" + std::to_string(save);
+            text += Block(id, kTimelineA, parent, 40, "\n");
+            history.push_back({ id, std::string(kTimelineA), parent });
+            chain.push_back({ id, std::string(kTimelineA) });
+            parent = id;
+        }
+        Tests::WriteFile(plainBook, text);
+        Tests::WriteFile(packedBook, text);
+        CHECK(SegmentStore::Split(plainBook).ok && SegmentStore::Split(packedBook).ok);
+
+        auto plan = BlockCodec::PlanEncoding(history, true, 5);
+        for (const auto& segment : SegmentStore::ListSegments(packedBook)) {
+            auto recoded = BlockCodec::RecodeBook(Tests::ReadFile(segment), plan);
+            CHECK(recoded.blocksCompressed == 15);
+            Tests::WriteFile(segment, recoded.text);
+        }
+        std::size_t plainLines = 0;
+        std::size_t packedLines = 0;
+        CHECK(SegmentStore::Assemble(plainBook, chain, &plainLines) == SegmentStore::Assemble(packedBook, chain, &packedLines));
+        CHECK(plainLines == packedLines && plainLines == 20 * 40);
+    }
+}
+
+int main() {
+    Tests::Run("RoundTripLF", []() { TestRoundTrip("\n"); });
+    Tests::Run("RoundTripCRLF", []() { TestRoundTrip("\r\n"); });
+    Tests::Run("CompressedSegments", TestCompressedSegments);
+    return Tests::Finish();
+}
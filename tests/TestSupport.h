@@ -0,0 +1,76 @@
+//TestSupport.h
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+// Minimal checks for the standalone tests: a failed CHECK is reported and counted, and the test keeps going.
+#define CHECK(expr)                                                                                     \
+    do {                                                                                                \
+        if (!(expr)) {                                                                                  \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr);               \
+            ++DynamicBookFramework::Tests::g_failures;                                                  \
+        }                                                                                               \
+    } while (0)
+
+namespace DynamicBookFramework {
+    namespace Tests {
+
+        inline int g_failures = 0;
+
+        // Runs one named test case and reports it.
+        template <class Fn>
+        void Run(const char* a_name, Fn&& a_test) {
+            int before = g_failures;
+            a_test();
+            std::printf("%s %s\n", g_failures == before ? "[ ok ]" : "[FAIL]", a_name);
+        }
+
+        // The exit code for main.
+        inline int Finish() {
+            if (g_failures > 0) {
+                std::printf("%d check(s) failed\n", g_failures);
+                return 1;
+            }
+            return 0;
+        }
+
+        // An empty scratch folder for a test, under DBF_TEST_TEMP (set by ctest) or the system temp folder.
+        inline std::filesystem::path MakeTempFolder(std::string_view a_name) {
+            const char* root = std::getenv("DBF_TEST_TEMP");
+            std::filesystem::path folder = root ? std::filesystem::path(root) : std::filesystem::temp_directory_path() / "dbf-tests";
+            folder /= a_name;
+            std::error_code ec;
+            std::filesystem::remove_all(folder, ec);
+            std::filesystem::create_directories(folder, ec);
+            return folder;
+        }
+
+        inline std::string ReadFile(const std::filesystem::path& a_path) {
+            std::ifstream file(a_path, std::ios::binary);
+            std::stringstream content;
+            content << file.rdbuf();
+            return content.str();
+        }
+
+        inline void WriteFile(const std::filesystem::path& a_path, std::string_view a_content) {
+            std::ofstream file(a_path, std::ios::binary | std::ios::trunc);
+            file.write(a_content.data(), static_cast<std::streamsize>(a_content.size()));
+        }
+
+        // Wall time of one call, in milliseconds.
+        template <class Fn>
+        double TimeMs(Fn&& a_fn) {
+            auto start = std::chrono::steady_clock::now();
+            a_fn();
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+
+    } // namespace Tests
+} // namespace DynamicBookFramework
@@ -0,0 +1,98 @@
+//BlockCodecBenchmark.cpp
+// Opens a generated journal the way SessionDataManager does for a single-file book (read the file, keep the blocks
+// on the current save's chain, decode the compressed ones among them), once stored plain and once with all but
+// the 10 most recent saves of each timeline compressed.
+// usage: BlockCodecBenchmark [timelines (default 3)] [saves per timeline (default 300)] [block bytes (default 8000)]
+#include "BlockCodec.h"
+#include "TestSupport.h"
+#include "Journal.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the reader
+
+    // The text the book shows for a_chain: static lines plus each chain block's content.
+    std::string OpenBook(const std::filesystem::path& a_path, const std::unordered_set<std::string>& a_chain) {
+        std::string text = Tests::ReadFile(a_path);
+        std::string assembled;
+        std::string block;
+        std::string_view id;
+        std::optional<std::size_t> rawSize;
+        bool inBlock = false;
+        std::size_t pos = 0;
+        while (pos < text.size()) {
+            std::size_t lineEnd = text.find('\n', pos);
+            lineEnd = lineEnd == std::string::npos ? text.size() : lineEnd + 1;
+            std::string_view line(text.data() + pos, lineEnd - pos);
+            pos = lineEnd;
+            if (line.starts_with(";;SAVE_BLOCK ")) {
+                id = SaveCompactor::ParseValue(line, "ID");
+                rawSize = BlockCodec::GetRawSize(line);
+                block.clear();
+                inBlock = true;
+            } else if (line.starts_with(";;END_SAVE_DATA;;")) {
+                if (a_chain.contains(std::string(id))) {
+                    assembled += rawSize ? BlockCodec::Decode(block, *rawSize).value_or(std::string()) : block;
+                }
+                inBlock = false;
+            } else if (inBlock) {
+                block.append(line.substr(0, line.ends_with("\r\n") ? line.size() - 2 : line.size()));
+                block.push_back('\n');
+            } else {
+                assembled.append(line);
+            }
+        }
+        return assembled;
+    }
+
+    double BestOf(int a_runs, const std::filesystem::path& a_path, const std::unordered_set<std::string>& a_chain) {
+        double best = 1e30;
+        for (int run = 0; run < a_runs; ++run) {
+            best = std::min(best, Tests::TimeMs([&]() { OpenBook(a_path, a_chain); }));
+        }
+        return best;
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::size_t timelines = argc > 1 ? std::atoi(argv[1]) : 3;
+    const std::size_t saves = argc > 2 ? std::atoi(argv[2]) : 300;
+    const std::size_t blockBytes = argc > 3 ? std::atoi(argv[3]) : 8000;
+
+    auto journal = Tests::MakeJournal(timelines, saves, blockBytes);
+    auto packed = BlockCodec::RecodeBook(journal.book, BlockCodec::PlanEncoding(journal.records, true, 10));
+
+    // The chain of the last save: every save of the last timeline.
+    std::unordered_set<std::string> chain;
+    for (const auto& record : journal.records) {
+        if (record.timeline == journal.records.back().timeline) {
+            chain.insert(record.id);
+        }
+    }
+
+    auto folder = Tests::MakeTempFolder("BlockCodecBenchmark");
+    Tests::WriteFile(folder / "plain.txt", journal.book);
+    Tests::WriteFile(folder / "packed.txt", packed.text);
+    if (OpenBook(folder / "plain.txt", chain) != OpenBook(folder / "packed.txt", chain)) {
+        std::printf("The compressed book does not open to the same text.\n");
+        return 1;
+    }
+
+    double plainMs = BestOf(7, folder / "plain.txt", chain);
+    double packedMs = BestOf(7, folder / "packed.txt", chain);
+    double plainMB = journal.book.size() / 1048576.0;
+    double packedMB = packed.text.size() / 1048576.0;
+    std::printf("%zu timelines x %zu saves, %zu blocks compressed\n", timelines, saves, packed.blocksCompressed);
+    std::printf("  plain       %8.2f MB %8.2f ms (file cached)\n", plainMB, plainMs);
+    std::printf("  compressed  %8.2f MB %8.2f ms (file cached)\n", packedMB, packedMs);
+    // The cached timings leave out the disk; estimate a cold open at a few read speeds.
+    for (double mbPerSecond : { 500.0, 100.0, 30.0 }) {
+        std::printf("  at %4.0f MB/s: plain %8.2f ms, compressed %8.2f ms\n", mbPerSecond,
+            plainMs + plainMB / mbPerSecond * 1000.0, packedMs + packedMB / mbPerSecond * 1000.0);
+    }
+    std::filesystem::remove_all(folder);
+    return 0;
+}
@@ -0,0 +1,77 @@
+//ImageHeaderBenchmark.cpp
+// Writes a folder of PNG and DDS files of realistic size, then times sizing every one of them the way
+// ImageInfo::GetImageSize does on a cache miss (read kHeaderProbeBytes, ParseHeader) against reading each
+// whole file, which is the least any decode-based lookup would cost. Run it twice to see the warm file cache.
+// usage: ImageHeaderBenchmark [files (default 400)] [bytes per file (default 262144)]
+#include "ImageHeader.h"
+#include "TestSupport.h"
+
+#include <random>
+#include <vector>
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the file generator
+
+    void PutU32(std::string& a_out, std::uint32_t a_value, bool a_bigEndian) {
+        for (int i = 0; i < 4; ++i) {
+            int shift = a_bigEndian ? 24 - 8 * i : 8 * i;
+            a_out.push_back(static_cast<char>((a_value >> shift) & 0xFF));
+        }
+    }
+
+    // A header the parser accepts followed by noise up to a_bytes; the pixel data is never looked at.
+    std::string MakeImage(bool a_dds, std::uint32_t a_width, std::uint32_t a_height, std::size_t a_bytes, std::mt19937& a_rng) {
+        std::string file;
+        if (a_dds) {
+            file = "DDS ";
+            PutU32(file, 124, false);
+            PutU32(file, 0x1007, false);
+            PutU32(file, a_height, false);
+            PutU32(file, a_width, false);
+        } else {
+            file.assign("\x89PNG\r\n\x1a\n", 8);
+            PutU32(file, 13, true);
+            file += "IHDR";
+            PutU32(file, a_width, true);
+            PutU32(file, a_height, true);
+        }
+        while (file.size() < a_bytes) {
+            file.push_back(static_cast<char>(a_rng()));
+        }
+        return file;
+    }
+}
+
+int main(int argc, char** argv) {
+    const int fileCount = argc > 1 ? std::atoi(argv[1]) : 400;
+    const std::size_t fileBytes = argc > 2 ? std::atoi(argv[2]) : 262144;
+
+    auto folder = Tests::MakeTempFolder("ImageHeaderBenchmark");
+    std::mt19937 rng(11);
+    std::vector<std::filesystem::path> paths;
+    for (int i = 0; i < fileCount; ++i) {
+        bool dds = i % 2 == 1;
+        auto path = folder / ("image" + std::to_string(i) + (dds ? ".dds" : ".png"));
+        Tests::WriteFile(path, MakeImage(dds, 64u << (i % 5), 64u << (i % 3), fileBytes, rng));
+        paths.push_back(std::move(path));
+    }
+
+    std::size_t sized = 0;
+    double probeMs = Tests::TimeMs([&]() {
+        for (const auto& path : paths) {
+            sized += ImageInfo::ParseHeader(ImageInfo::ReadHeader(path)).has_value();
+        }
+    });
+    std::size_t wholeBytes = 0;
+    double wholeMs = Tests::TimeMs([&]() {
+        for (const auto& path : paths) {
+            wholeBytes += Tests::ReadFile(path).size();
+        }
+    });
+
+    std::printf("%d files of %.0f KB (%zu sized)\n", fileCount, fileBytes / 1024.0, sized);
+    std::printf("  header probe          %8.1f ms  (%.3f ms per file)\n", probeMs, probeMs / fileCount);
+    std::printf("  whole-file read       %8.1f ms  (%.3f ms per file, %.1f MB)\n", wholeMs, wholeMs / fileCount, wholeBytes / 1048576.0);
+    return sized == paths.size() ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+//IniParserBenchmark.cpp
+// Loads a generated load order of mapping INIs the way LoadBookMappings does: one read and one parse per file.
+// For comparison it also resolves every key the way the per-key GetPrivateProfileStringW loop did, re-opening
+// and re-parsing the file once per key.
+// usage: IniParserBenchmark [ini count (default 600)] [mappings per ini (default 20)]
+#include "IniParser.h"
+#include "TestSupport.h"
+
+#include <vector>
+
+using namespace DynamicBookFramework;
+
+int main(int argc, char** argv) {
+    const int iniCount = argc > 1 ? std::atoi(argv[1]) : 600;
+    const int mappingsPerIni = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    auto folder = Tests::MakeTempFolder("IniParserBenchmark");
+    for (int i = 0; i < iniCount; ++i) {
+        auto modFolder = folder / ("Mod" + std::to_string(i % 50));
+        std::filesystem::create_directories(modFolder);
+        std::string text = "; Generated mapping INI\r\n[Books]\r\n";
+        for (int j = 0; j < mappingsPerIni; ++j) {
+            text += "Journal of Mod " + std::to_string(i) + " Volume " + std::to_string(j) + " = Mod" + std::to_string(i) + "/volume" + std::to_string(j) + ".txt\r\n";
+        }
+        Tests::WriteFile(modFolder / ("Mapping" + std::to_string(i) + ".ini"), text);
+    }
+
+    std::vector<std::filesystem::path> inis;
+    double scanMs = Tests::TimeMs([&]() {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(folder)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".ini") {
+                inis.push_back(entry.path());
+            }
+        }
+    });
+
+    std::size_t mappings = 0;
+    double onePassMs = Tests::TimeMs([&]() {
+        for (const auto& ini : inis) {
+            if (auto text = IniParser::ReadFileAsUtf8(ini)) {
+                mappings += IniParser::CollectSection(*text, "Books").size();
+            }
+        }
+    });
+
+    std::size_t perKeyMappings = 0;
+    double perKeyMs = Tests::TimeMs([&]() {
+        for (const auto& ini : inis) {
+            auto keys = IniParser::CollectSection(*IniParser::ReadFileAsUtf8(ini), "Books");
+            for (const auto& [key, value] : keys) {
+                // One open and parse per value lookup, as each GetPrivateProfileStringW call did.
+                auto text = IniParser::ReadFileAsUtf8(ini);
+                for (const auto& [otherKey, otherValue] : IniParser::CollectSection(*text, "Books")) {
+                    if (otherKey == key) {
+                        ++perKeyMappings;
+                        break;
+                    }
+                }
+            }
+        }
+    });
+
+    std::printf("%zu INIs, %zu mappings\n", inis.size(), mappings);
+    std::printf("  directory scan          %8.2f ms\n", scanMs);
+    std::printf("  single pass per file    %8.2f ms\n", onePassMs);
+    std::printf("  re-parse per key        %8.2f ms (%zu mappings)\n", perKeyMs, perKeyMappings);
+    std::filesystem::remove_all(folder);
+    return 0;
+}
@@ -0,0 +1,59 @@
+//Journal.h
+#pragma once
+#include "SaveCompactor.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace DynamicBookFramework {
+    namespace Tests {
+
+        // A generated journal book the way OnGameSave writes one: static text, then for every save a CRLF block of
+        // roughly a_blockBytes of prose. Timelines are numbered characters, each a chain of a_saves saves.
+        struct Journal {
+            std::string book;
+            std::string history; // _SaveHistory.log lines
+            std::vector<SaveCompactor::HistoryRecord> records;
+        };
+
+        inline std::string TimelineName(std::size_t a_timeline) {
+            return "2024-01-" + std::to_string(10 + a_timeline) + "_10-00-00";
+        }
+
+        inline Journal MakeJournal(std::size_t a_timelines, std::size_t a_saves, std::size_t a_blockBytes, unsigned a_seed = 7) {
+            static const char* kWords[] = { "the", "dragon", "road", "Whiterun", "I", "walked", "through", "snow", "and", "met",
+                "a", "stranger", "who", "spoke", "of", "ancient", "ruins", "beneath", "mountain", "my", "sword", "was", "cold",
+                "we", "rested", "by", "fire", "tonight", "Jarl", "asked", "help", "bandits", "north", "river", "gold" };
+            std::mt19937 rng(a_seed);
+            Journal journal;
+            journal.book = "Static header of the chronicle.\r\n\r\nSome more static text.\r\n";
+            for (std::size_t timeline = 0; timeline < a_timelines; ++timeline) {
+                std::string timelineName = TimelineName(timeline);
+                std::string parent;
+                for (std::size_t save = 0; save < a_saves; ++save) {
+                    std::string id = "Save" + std::to_string(timeline * a_saves + save) + "_Char" + std::to_string(timeline);
+                    std::string header = "ID=\"" + id + "\" TIMELINE=\"" + timelineName + "\" PARENT=\"" + parent + "\"";
+                    journal.book += "\r\n;;SAVE_BLOCK " + header + ";;\r\n";
+                    std::size_t length = 0;
+                    while (length < a_blockBytes) {
+                        std::string line = "[Day " + std::to_string(save) + "] ";
+                        for (int word = 0; word < 14; ++word) {
+                            line += kWords[rng() % std::size(kWords)];
+                            line += ' ';
+                        }
+                        line += "\r\n";
+                        length += line.size();
+                        journal.book += line;
+                    }
+                    journal.book += ";;END_SAVE_DATA;;\r\n";
+                    journal.history += header + "\n";
+                    journal.records.push_back({ id, timelineName, parent });
+                    parent = id;
+                }
+            }
+            return journal;
+        }
+
+    } // namespace Tests
+} // namespace DynamicBookFramework
@@ -0,0 +1,106 @@
+//SearchIndexBenchmark.cpp
+// Builds the search index over a generated library the way BookSearch does at startup, then times queries,
+// appends and re-indexing one book. Memory is the index's own estimate and, where available, the growth of the
+// process working set during the build.
+// usage: SearchIndexBenchmark [books (default 60)] [bytes per book (default 300000)]
+#include "SearchIndex.h"
+#include "TestSupport.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#endif
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the memory probe
+
+    // Resident memory of this process in bytes, or 0 where it cannot be read.
+    std::size_t GetResidentBytes() {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters{};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return counters.WorkingSetSize;
+        }
+        return 0;
+#else
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.starts_with("VmRSS:")) {
+                return static_cast<std::size_t>(std::atol(line.c_str() + 6)) * 1024;
+            }
+        }
+        return 0;
+#endif
+    }
+}
+
+int main(int argc, char** argv) {
+    const int bookCount = argc > 1 ? std::atoi(argv[1]) : 60;
+    const std::size_t bookBytes = argc > 2 ? std::atoi(argv[2]) : 300000;
+
+    // Words drawn with a skew towards the front of the vocabulary, so common words have long posting lists.
+    std::mt19937 rng(7);
+    std::vector<std::string> vocabulary;
+    for (int i = 0; i < 20000; ++i) {
+        std::string word;
+        for (int length = 3 + static_cast<int>(rng() % 8); length > 0; --length) {
+            word.push_back(static_cast<char>('a' + rng() % 26));
+        }
+        vocabulary.push_back(std::move(word));
+    }
+    std::vector<std::string> books;
+    std::size_t totalBytes = 0;
+    for (int book = 0; book < bookCount; ++book) {
+        std::string text;
+        while (text.size() < bookBytes) {
+            text += vocabulary[std::min(rng() % vocabulary.size(), rng() % vocabulary.size())];
+            text += rng() % 12 == 0 ? ".\n" : " ";
+            if (rng() % 5000 == 0) {
+                text += "<a name='Save" + std::to_string(rng()) + "'></a>";
+            }
+        }
+        totalBytes += text.size();
+        books.push_back(std::move(text));
+    }
+
+    SearchIndex index;
+    std::size_t residentBefore = GetResidentBytes();
+    double buildMs = Tests::TimeMs([&]() {
+        for (int book = 0; book < bookCount; ++book) {
+            index.ReplaceBook("Book" + std::to_string(book), books[book]);
+        }
+    });
+    std::size_t residentAfter = GetResidentBytes();
+    auto stats = index.GetStats();
+
+    std::size_t hits = 0;
+    double queryMs = Tests::TimeMs([&]() {
+        for (int query = 0; query < 100; ++query) {
+            hits += index.Query(vocabulary[rng() % 200].substr(0, 4), 200).size();
+        }
+    });
+    double appendMs = Tests::TimeMs([&]() {
+        for (int entry = 0; entry < 1000; ++entry) {
+            index.AppendToBook("Book3", "\nA new entry about " + vocabulary[entry] + " and more.\n");
+        }
+    });
+    double reindexMs = Tests::TimeMs([&]() { index.ReplaceBook("Book5", books[5]); });
+
+    std::printf("%zu books, %.1f MB of text, %zu distinct tokens, %zu postings\n", stats.books, totalBytes / 1048576.0, stats.tokens, stats.postings);
+    std::printf("  build                 %8.1f ms\n", buildMs);
+    std::printf("  memory (estimate)     %8.1f MB\n", stats.memoryBytes / 1048576.0);
+    if (residentBefore && residentAfter) {
+        std::printf("  memory (resident)     %8.1f MB\n", (static_cast<double>(residentAfter) - static_cast<double>(residentBefore)) / 1048576.0);
+    }
+    std::printf("  prefix query          %8.3f ms avg (%zu hits over 100 queries)\n", queryMs / 100, hits);
+    std::printf("  append one entry      %8.3f ms avg\n", appendMs / 1000);
+    std::printf("  re-index one book     %8.1f ms\n", reindexMs);
+    return 0;
+}
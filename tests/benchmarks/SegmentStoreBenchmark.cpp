@@ -0,0 +1,49 @@
+//SegmentStoreBenchmark.cpp
+// Assembles one character's journal from a book shared with a growing number of other characters. A single-file
+// book has to be read whole whoever is playing, so its time is given as the cost of just reading the file; a
+// segmented book only opens the segment of the playing character's timeline.
+// usage: SegmentStoreBenchmark [saves per character (default 20)] [block bytes (default 2000)]
+#include "SegmentStore.h"
+#include "TestSupport.h"
+#include "Journal.h"
+
+#include <algorithm>
+
+using namespace DynamicBookFramework;
+
+int main(int argc, char** argv) {
+    const std::size_t saves = argc > 1 ? std::atoi(argv[1]) : 20;
+    const std::size_t blockBytes = argc > 2 ? std::atoi(argv[2]) : 2000;
+    auto folder = Tests::MakeTempFolder("SegmentStoreBenchmark");
+
+    std::printf("other characters | file MB | single-file read ms | segmented assemble ms\n");
+    for (std::size_t others : { 0, 10, 50, 200 }) {
+        auto journal = Tests::MakeJournal(others + 1, saves, blockBytes);
+        std::vector<SegmentStore::ChainLink> chain;
+        for (const auto& record : journal.records) {
+            if (record.timeline == journal.records.back().timeline) {
+                chain.push_back({ record.id, record.timeline });
+            }
+        }
+        auto book = folder / ("Journal" + std::to_string(others) + ".txt");
+        Tests::WriteFile(book, journal.book);
+
+        auto bestOf = [](auto&& a_fn) {
+            double best = 1e30;
+            for (int run = 0; run < 10; ++run) {
+                best = std::min(best, Tests::TimeMs(a_fn));
+            }
+            return best;
+        };
+        double readMs = bestOf([&]() { Tests::ReadFile(book); });
+        if (!SegmentStore::Split(book).ok) {
+            std::printf("Split failed for %zu other characters.\n", others);
+            return 1;
+        }
+        std::size_t lines = 0;
+        double assembleMs = bestOf([&]() { SegmentStore::Assemble(book, chain, &lines); });
+        std::printf("%16zu | %7.2f | %19.2f | %21.2f\n", others, journal.book.size() / 1048576.0, readMs, assembleMs);
+    }
+    std::filesystem::remove_all(folder);
+    return 0;
+}
@@ -0,0 +1,218 @@
+//main.cpp
+// dbfpak: builds, lists, verifies and extracts .dbfpak book archives.
+#include "BookPak.h"
+#include "IniParser.h"
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+using namespace DynamicBookFramework;
+
+namespace { // Anonymous namespace for the commands
+
+    int PrintUsage() {
+        std::fprintf(stderr,
+            "usage:\n"
+            "  dbfpak build <out.dbfpak> <mapping.ini>... [--books <dir>] [--compress]\n"
+            "      Packs every book mapped in the [Books] sections of the INIs. Book files are read from <dir>\n"
+            "      (default: books), as the plugin reads them from DynamicBookFramework/books. Later INIs override\n"
+            "      earlier ones. --compress stores entries with LZ4 where that saves at least a tenth.\n"
+            "  dbfpak list <archive.dbfpak>\n"
+            "  dbfpak verify <archive.dbfpak>\n"
+            "      Decompresses every entry and checks it against its recorded hash.\n"
+            "  dbfpak extract <archive.dbfpak> <dir>\n"
+            "      Writes the books to <dir>/books and their mappings to <dir>/<archive>.ini.\n");
+        return 2;
+    }
+
+    std::optional<std::string> ReadFile(const std::filesystem::path& a_path) {
+        std::ifstream file(a_path, std::ios::binary);
+        if (!file.is_open()) {
+            return std::nullopt;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    std::string FormatSize(std::uint64_t a_bytes) {
+        char buffer[32];
+        if (a_bytes >= 1024 * 1024) {
+            std::snprintf(buffer, sizeof(buffer), "%.1f MB", static_cast<double>(a_bytes) / (1024.0 * 1024.0));
+        } else if (a_bytes >= 1024) {
+            std::snprintf(buffer, sizeof(buffer), "%.1f KB", static_cast<double>(a_bytes) / 1024.0);
+        } else {
+            std::snprintf(buffer, sizeof(buffer), "%llu B", static_cast<unsigned long long>(a_bytes));
+        }
+        return buffer;
+    }
+
+    std::unique_ptr<BookPak::Archive> OpenOrReport(const std::filesystem::path& a_path) {
+        std::string error;
+        auto archive = BookPak::Archive::Open(a_path, error);
+        if (!archive) {
+            std::fprintf(stderr, "dbfpak: %s: %s\n", a_path.string().c_str(), error.c_str());
+        }
+        return archive;
+    }
+
+    int Build(const std::vector<std::string>& a_args) {
+        std::filesystem::path output;
+        std::filesystem::path booksFolder = "books";
+        std::vector<std::filesystem::path> inis;
+        bool compress = false;
+        for (std::size_t i = 0; i < a_args.size(); ++i) {
+            if (a_args[i] == "--compress") {
+                compress = true;
+            } else if (a_args[i] == "--books" && i + 1 < a_args.size()) {
+                booksFolder = a_args[++i];
+            } else if (output.empty()) {
+                output = a_args[i];
+            } else {
+                inis.emplace_back(a_args[i]);
+            }
+        }
+        if (output.empty() || inis.empty()) {
+            return PrintUsage();
+        }
+
+        // Later INIs override earlier ones, as in the plugin's scan; the archive keeps the first-seen order.
+        std::vector<std::pair<std::string, std::string>> mappings;
+        std::map<std::string, std::size_t> byTitle;
+        for (const auto& ini : inis) {
+            // Read exactly as the plugin reads mapping INIs, encodings and duplicate titles included.
+            auto text = IniParser::ReadFileAsUtf8(ini);
+            if (!text) {
+                std::fprintf(stderr, "dbfpak: could not read %s\n", ini.string().c_str());
+                return 1;
+            }
+            for (auto& [title, fileName] : IniParser::CollectSection(*text, "Books")) {
+                if (auto it = byTitle.find(title); it != byTitle.end()) {
+                    mappings[it->second].second = std::move(fileName);
+                } else {
+                    byTitle.emplace(title, mappings.size());
+                    mappings.emplace_back(std::move(title), std::move(fileName));
+                }
+            }
+        }
+
+        std::vector<BookPak::SourceEntry> entries;
+        for (const auto& [title, fileName] : mappings) {
+            auto content = ReadFile(booksFolder / fileName);
+            if (!content) {
+                std::fprintf(stderr, "dbfpak: '%s' maps to %s, which could not be read\n", title.c_str(), (booksFolder / fileName).string().c_str());
+                return 1;
+            }
+            entries.push_back({ title, fileName, std::move(*content) });
+        }
+
+        std::string error;
+        auto stats = BookPak::Write(output, entries, compress, error);
+        if (!stats) {
+            std::fprintf(stderr, "dbfpak: %s\n", error.c_str());
+            return 1;
+        }
+        std::printf("%s: %zu books (%zu compressed), %s -> %s\n", output.string().c_str(), stats->entries, stats->compressedEntries,
+            FormatSize(stats->rawBytes).c_str(), FormatSize(stats->storedBytes).c_str());
+        return 0;
+    }
+
+    int List(const std::vector<std::string>& a_args) {
+        if (a_args.size() != 1) {
+            return PrintUsage();
+        }
+        auto archive = OpenOrReport(a_args[0]);
+        if (!archive) {
+            return 1;
+        }
+        std::uint64_t raw = 0;
+        std::uint64_t stored = 0;
+        std::printf("%-6s %10s %10s  %-16s  %-32s %s\n", "codec", "raw", "stored", "hash", "file", "title");
+        for (const auto& entry : archive->GetEntries()) {
+            std::printf("%-6s %10s %10s  %016llx  %-32s %s\n", BookPak::GetCodecName(entry.codec), FormatSize(entry.rawSize).c_str(),
+                FormatSize(entry.storedSize).c_str(), static_cast<unsigned long long>(entry.hash), entry.fileName.c_str(), entry.title.c_str());
+            raw += entry.rawSize;
+            stored += entry.storedSize;
+        }
+        std::printf("%zu books, %s -> %s\n", archive->GetEntries().size(), FormatSize(raw).c_str(), FormatSize(stored).c_str());
+        return 0;
+    }
+
+    int Verify(const std::vector<std::string>& a_args) {
+        if (a_args.size() != 1) {
+            return PrintUsage();
+        }
+        auto archive = OpenOrReport(a_args[0]);
+        if (!archive) {
+            return 1;
+        }
+        std::size_t bad = 0;
+        for (const auto& entry : archive->GetEntries()) {
+            if (!archive->Read(entry)) {
+                std::fprintf(stderr, "dbfpak: '%s' (%s) is corrupt\n", entry.title.c_str(), entry.fileName.c_str());
+                ++bad;
+            }
+        }
+        std::printf("%zu of %zu books intact\n", archive->GetEntries().size() - bad, archive->GetEntries().size());
+        return bad == 0 ? 0 : 1;
+    }
+
+    int Extract(const std::vector<std::string>& a_args) {
+        if (a_args.size() != 2) {
+            return PrintUsage();
+        }
+        auto archive = OpenOrReport(a_args[0]);
+        if (!archive) {
+            return 1;
+        }
+        std::filesystem::path outFolder = a_args[1];
+        std::string ini = "[Books]\n";
+        for (const auto& entry : archive->GetEntries()) {
+            auto content = archive->Read(entry);
+            // The file name comes from the archive, so keep it inside the books folder.
+            std::filesystem::path relative = std::filesystem::path(entry.fileName).lexically_normal();
+            if (!content || relative.is_absolute() || relative.empty() || *relative.begin() == "..") {
+                std::fprintf(stderr, "dbfpak: skipping '%s' (%s)\n", entry.title.c_str(), content ? "unsafe file name" : "corrupt");
+                continue;
+            }
+            auto target = outFolder / "books" / relative;
+            std::error_code ec;
+            std::filesystem::create_directories(target.parent_path(), ec);
+            std::ofstream file(target, std::ios::binary | std::ios::trunc);
+            file.write(content->data(), static_cast<std::streamsize>(content->size()));
+            if (!file.good()) {
+                std::fprintf(stderr, "dbfpak: could not write %s\n", target.string().c_str());
+                return 1;
+            }
+            ini += entry.title + "=" + entry.fileName + "\n";
+        }
+        auto iniPath = outFolder / std::filesystem::path(a_args[0]).filename().replace_extension(".ini");
+        std::ofstream iniFile(iniPath, std::ios::binary | std::ios::trunc);
+        iniFile << ini;
+        std::printf("%zu books written to %s\n", archive->GetEntries().size(), outFolder.string().c_str());
+        return iniFile.good() ? 0 : 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        return PrintUsage();
+    }
+    std::string_view command = argv[1];
+    std::vector<std::string> args(argv + 2, argv + argc);
+    if (command == "build") {
+        return Build(args);
+    }
+    if (command == "list") {
+        return List(args);
+    }
+    if (command == "verify") {
+        return Verify(args);
+    }
+    if (command == "extract") {
+        return Extract(args);
+    }
+    return PrintUsage();
+}